@@ -177,8 +177,8 @@ void OnDeath(void* cookie) {
   *_aidl_return = phNxpNciHal_getVerboseLogging();
   return ndk::ScopedAStatus::ok();
 }
-binder_status_t Nfc::dump(int /* fd */, const char** /* p */,
-                          uint32_t /* q */) {
+binder_status_t Nfc::dump(int fd, const char** /* p */, uint32_t /* q */) {
+  phNxpNciHal_dump(fd);
   LOG(INFO) << "\n NFC AIDL HAL MemoryLeak Info = \n"
             << ::android::GetUnreachableMemoryString(true, 10000).c_str();
   return STATUS_OK;
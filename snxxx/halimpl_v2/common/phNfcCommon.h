@@ -27,6 +27,7 @@
 ************************* Include Files ****************************************
 */
 
+#include <NxpNfcTimerWheel.h>
 #include <phDal4Nfc_messageQueueLib.h>
 #include <phNfcCompId.h>
 #include <phNfcStatus.h>
@@ -200,8 +201,8 @@ enum phOsalNfc_TimerStates_t : uint8_t {
  **Timer Handle structure containing details of a timer.
  */
 typedef struct phOsalNfc_TimerHandle {
-  uint32_t TimerId;     /* ID of the timer */
-  timer_t hTimerHandle; /* Handle of the timer */
+  uint32_t TimerId;               /* ID of the timer */
+  NfcHalTimerEntry_t tWheelEntry; /* Timer wheel entry of the timer */
   /* Timer callback function to be invoked */
   pphOsalNfc_TimerCallbck_t Application_callback;
   void* pContext; /* Parameter to be passed to the callback function */
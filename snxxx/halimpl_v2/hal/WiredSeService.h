@@ -19,6 +19,7 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <memory>
 
@@ -66,6 +67,17 @@ typedef struct NfcPkt {
   }
 } NfcPkt;
 
+// Received packets consumed by the WiredSe service. Only packets matching
+// the filter are dispatched as NFC_PKT_RECEIVED.
+typedef struct WiredSePktFilter {
+  // Bit per GID of received control packets
+  uint16_t ctrlGidMask;
+  // Bit per connection ID of received data packets
+  uint16_t dataConnMask;
+  // Bit per pipe ID of HCP packets received on the HCI connection
+  uint64_t hciPipeMask[2];
+} WiredSePktFilter;
+
 typedef union WiredSeEvtData {
   NfcState nfcState;
   std::shared_ptr<NfcPkt> nfcPkt = NULL;
@@ -102,3 +114,6 @@ typedef struct WiredSeEvt {
 extern "C" int32_t WiredSeService_Start(WiredSeService** wiredSeService);
 extern "C" int32_t WiredSeService_DispatchEvent(WiredSeService* wiredSeService,
                                                 WiredSeEvt evt);
+// Optional, every received packet is dispatched if not exported.
+extern "C" int32_t WiredSeService_GetPktFilter(WiredSeService* wiredSeService,
+                                               WiredSePktFilter* pktFilter);
@@ -33,6 +33,7 @@
 #include <phNxpNciHal_ext.h>
 #include <phNxpTempMgr.h>
 #include <phTmlNfc.h>
+#include <phTmlNfc_Capture.h>
 #include <sys/stat.h>
 
 #include <thread>
@@ -42,16 +43,23 @@
 #include "NfcWriter.h"
 #include "NfccTransportFactory.h"
 #include "NxpNfcExtension.h"
+#include "NxpNfcLatencyStats.h"
+#include "NxpNfcLockStats.h"
+#include "NxpNfcNciTrace.h"
 #include "NxpNfcThreadMutex.h"
 #include "ObserveMode.h"
 #include "ReaderPollConfigParser.h"
+#include "phNxpNciHal_ConfigShadow.h"
+#include "phNxpNciHal_ConnCredits.h"
 #include "phNxpNciHal_IoctlOperations.h"
 #include "phNxpNciHal_LxDebug.h"
 #include "phNxpNciHal_PowerTrackerIface.h"
 #include "phNxpNciHal_ReaderThread.h"
+#include "phNxpNciHal_SetConfigBatch.h"
 #include "phNxpNciHal_ULPDet.h"
 #include "phNxpNciHal_VendorProp.h"
 #include "phNxpNciHal_WiredSeIface.h"
+#include "phNxpNciHal_ExtCmdSeq.h"
 #include "phNxpNciHal_WriterThread.h"
 #include "phNxpNciHal_extOperations.h"
 
@@ -65,6 +73,9 @@ using android::base::WriteStringToFile;
 #define EOS_FW_SESSION_STATE_LOCKED 0x02
 #define NS_PER_S 1000000000
 #define MAX_WAIT_MS_FOR_RESET_NTF 1600
+/* SN1xx and later clock configuration, value offset in its GET_CONFIG_RSP */
+#define CLK_CFG_PARAM_ID 0xA011
+#define CLK_CFG_VAL_OFFSET 8
 
 bool bEnableMfcReader = false;
 
@@ -125,7 +136,6 @@ static uint8_t gRecFwRetryCount;  // variable to hold recovery FW retry count
 uint8_t write_unlocked_status = NFCSTATUS_SUCCESS;
 uint8_t wFwUpdateReq = false;
 bool wRfUpdateReq = false;
-uint32_t timeoutTimerId = 0;
 bool nfc_debug_enabled = true;
 PowerTrackerHandle gPowerTrackerHandle;
 WiredSeHandle* gWiredSeHandle;
@@ -546,6 +556,8 @@ int phNxpNciHal_MinOpen() {
   unsigned long value = 0;
   sIsHalOpenErrorRecovery = false;
   setObserveModeFlag(false);
+  ReaderPollConfigParserInstance.setReaderPollCallBack(
+      phNxpNciHal_notifyPollingFrame);
   NciDiscoveryCommandBuilderInstance.setObserveModePerTech(
       NCI_ANDROID_PASSIVE_OBSERVE_PARAM_DISABLE);
   NciDiscoveryCommandBuilderInstance.setRfDiscoveryReceived(false);
@@ -566,12 +578,11 @@ int phNxpNciHal_MinOpen() {
   /* initialize trace level */
   phNxpLog_InitializeLogLevel();
 
+  phNxpNciHal_ConnCredits::getInstance().Init();
+
   /* initialize Mifare flags*/
   phNxpNciHal_initialize_mifare_flag();
 
-  /*Create the timer for extns write response*/
-  timeoutTimerId = phOsalNfc_Timer_Create();
-
   if (phNxpNciHal_init_monitor() == NULL) {
     NXPLOG_NCIHAL_E("Init monitor failed");
     CONCURRENCY_UNLOCK();
@@ -635,12 +646,22 @@ int phNxpNciHal_MinOpen() {
     return phNxpNciHal_MinOpen_Clean(&nfc_dev_node);
   }
 
-  /* Create the client thread */
-  if (g_readerThread.Start() != true) {
+  /* Create the client thread, it reads the NFCC itself in event loop mode */
+  value = 0;
+  bool eventLoop = (GetNxpNumValue(NAME_NXP_HAL_EVENT_LOOP, &value,
+                                   sizeof(value)) > 0) &&
+                   (value == 0x01);
+  if (g_readerThread.Start(eventLoop) != true) {
     NXPLOG_NCIHAL_E("pthread_create failed");
     CONCURRENCY_UNLOCK();
     return phNxpNciHal_MinOpen_Clean(&nfc_dev_node);
   }
+  tTmlConfig.bEventLoop = g_readerThread.IsEventLoopMode();
+
+  value = 0;
+  NfcHalLockStats::setEnabled(
+      (GetNxpNumValue(NAME_NXP_LOCK_STATS, &value, sizeof(value)) > 0) &&
+      (value == 0x01));
 
   /* Initialize TML layer */
   wConfigStatus = phTmlNfc_Init(&tTmlConfig);
@@ -1048,6 +1069,28 @@ int phNxpNciHal_write_unlocked(uint16_t data_len, const uint8_t* p_data,
                                int origin) {
   return nfcData.write_unlocked(data_len, p_data, origin);
 }
+/******************************************************************************
+ * Function         phNxpNciHal_is_ext_cmd_rsp
+ *
+ * Description      Checks that a response received while a HAL extension
+ *                  command is pending answers that command, so that the late
+ *                  response of a command which timed out does not complete
+ *                  the next one.
+ *
+ * Returns          true if the response has the GID and OID of the command,
+ *                  or in FW download mode where frames are not NCI.
+ *
+ ******************************************************************************/
+static bool phNxpNciHal_is_ext_cmd_rsp(const uint8_t* p_rsp,
+                                       uint16_t rsp_len) {
+  if (phTmlNfc_IsFwDnldModeEnabled()) return true;
+  return (rsp_len >= NCI_HEADER_SIZE) &&
+         ((nxpncihal_ctrl.p_cmd_data[0] & NCI_GID_MASK) ==
+          (p_rsp[0] & NCI_GID_MASK)) &&
+         ((nxpncihal_ctrl.p_cmd_data[1] & NCI_OID_MASK) ==
+          (p_rsp[1] & NCI_OID_MASK));
+}
+
 /******************************************************************************
  * Function         phNxpNciHal_read_complete
  *
@@ -1067,6 +1110,7 @@ static void phNxpNciHal_read_complete(void* pContext,
   NFCSTATUS status = NFCSTATUS_FAILED;
   int sem_val;
   UNUSED_PROP(pContext);
+  NfcHalLatencyStats::getInstance().rxComplete();
   if (nxpncihal_ctrl.read_retry_cnt == 1) {
     nxpncihal_ctrl.read_retry_cnt = 0;
   }
@@ -1089,13 +1133,25 @@ static void phNxpNciHal_read_complete(void* pContext,
       }
     }
     phNxpNciHal_print_res_status(pInfo->pBuff, &pInfo->wLength);
+    phNxpNciHal_ConfigShadow::getInstance().OnRspReceived(pInfo->pBuff,
+                                                          pInfo->wLength);
+    phNxpNciHal_ConnCredits::getInstance().OnPktReceived(pInfo->pBuff,
+                                                         pInfo->wLength);
     if (nxpncihal_ctrl.power_reset_triggered == true) {
       nxpncihal_ctrl.power_reset_triggered = false;
     }
 
     /* Check if response should go to hal module only */
     if (nxpncihal_ctrl.hal_ext_enabled == true &&
-        (pInfo->pBuff[0x00] & NCI_MT_MASK) == NCI_MT_RSP) {
+        (pInfo->pBuff[0x00] & NCI_MT_MASK) == NCI_MT_RSP &&
+        !phNxpNciHal_is_ext_cmd_rsp(pInfo->pBuff, pInfo->wLength)) {
+      NXPLOG_NCIHAL_E("Late response %02X %02X dropped, ext cmd %02X %02X "
+                      "pending",
+                      pInfo->pBuff[0], pInfo->pBuff[1],
+                      nxpncihal_ctrl.p_cmd_data[0],
+                      nxpncihal_ctrl.p_cmd_data[1]);
+    } else if (nxpncihal_ctrl.hal_ext_enabled == true &&
+               (pInfo->pBuff[0x00] & NCI_MT_MASK) == NCI_MT_RSP) {
       if (status == NFCSTATUS_FAILED) {
         NXPLOG_NCIHAL_D("enter into NFCC init recovery");
         nxpncihal_ctrl.ext_cb_data.status = status;
@@ -1129,9 +1185,8 @@ static void phNxpNciHal_read_complete(void* pContext,
       NXPLOG_NCIHAL_D("Mfc Response Status = 0x%x", mfcRspStatus);
       phNxpNciHal_update_ext_buffer(pInfo->wLength, pInfo->pBuff);
       SEM_POST(&(nxpncihal_ctrl.ext_cb_data));
-    } else if (phNxpNciHal_WiredSeDispatchEvent(
-                   gWiredSeHandle, NFC_PKT_RECEIVED,
-                   createWiredSeEvtData(pInfo->pBuff, pInfo->wLength)) ==
+    } else if (phNxpNciHal_WiredSeDispatchPkt(gWiredSeHandle, NFC_PKT_RECEIVED,
+                                              pInfo->pBuff, pInfo->wLength) ==
                NFCSTATUS_SUCCESS) {
       NXPLOG_NCIHAL_D("%s => %d, Processed WiredSe Packet", __func__, __LINE__);
     }
@@ -1194,18 +1249,10 @@ void phNxpNciHal_client_data_callback(uint16_t rx_data_len,
 
   if (isObserveModeEnabled() && p_rx_data[NCI_GID_INDEX] == NCI_PROP_NTF_GID &&
       p_rx_data[NCI_OID_INDEX] == NCI_PROP_LX_NTF_OID) {
-    unsigned long notificationType = 0;
-    ReaderPollConfigParser readerPollConfigParser;
-    int isFound = GetNxpNumValue(NAME_NXP_OBSERVE_MODE_REQ_NOTIFICATION_TYPE,
-                                 &notificationType, sizeof(notificationType));
-    if (isFound == 0) {
-      notificationType = 0;
-    }
-    readerPollConfigParser.setNotificationType(notificationType);
-    readerPollConfigParser.setReaderPollCallBack(
-        phNxpNciHal_notifyPollingFrame);
-
-    readerPollConfigParser.parseAndSendReaderPollInfo(p_rx_data, rx_data_len);
+    handleReaderPollInfo(p_rx_data, rx_data_len);
+  } else {
+    // Polling frames held back by batching go before this packet
+    flushPollingFrames();
   }
   if (rx_data_len > 6 && p_rx_data[NCI_GID_INDEX] == NCI_RF_DISC_NTF_GID &&
       p_rx_data[NCI_OID_INDEX] == NCI_RF_DEACTIVATE_NTY_OID &&
@@ -1222,12 +1269,14 @@ void phNxpNciHal_client_data_callback(uint16_t rx_data_len,
        p_rx_data[RF_DEACTIVATE_REASON_INDEX] ==
            RF_DEACTIVATE_REASON_REMOTE_END_POINT_REMOVED)) {
     (*nxpncihal_ctrl.p_nfc_stack_data_cback)(rx_data_len, p_rx_data);
+    NfcHalLatencyStats::getInstance().rxDelivered();
     // Check if observe mode request was received during tag read in progress
     // and reset the discovery with observe mode flags
     resetDiscovery();
     return;
   } else {
     (*nxpncihal_ctrl.p_nfc_stack_data_cback)(rx_data_len, p_rx_data);
+    NfcHalLatencyStats::getInstance().rxDelivered();
   }
   // workaround for sync issue between SPI and NFC
   if (IS_CHIP_TYPE_EQ(pn557) && p_rx_data[0] == 0x62 && p_rx_data[1] == 0x00 &&
@@ -1264,6 +1313,26 @@ NFCSTATUS phNxpNciHal_enableTmlRead() {
   }
   return status;
 }
+/******************************************************************************
+ * Function         phNxpNciHal_core_reset_init_seq
+ *
+ * Description      Builds the CORE_RESET keeping the configuration then
+ *                  CORE_INIT sequence for the NCI version of the NFCC.
+ *
+ * Returns          Sequence for phNxpNciHal_send_ext_cmd_seq.
+ *
+ ******************************************************************************/
+static std::vector<phNxpNciHal_ExtCmd> phNxpNciHal_core_reset_init_seq() {
+  std::vector<phNxpNciHal_ExtCmd> seq(2);
+  seq[0].cmd = {0x20, 0x00, 0x01, 0x00};
+  if (nxpncihal_ctrl.nci_info.nci_version >= NCI_VERSION_2_0) {
+    seq[1].cmd = {0x20, 0x01, 0x02, 0x00, 0x00};
+  } else {
+    seq[1].cmd = {0x20, 0x01, 0x00};
+  }
+  return seq;
+}
+
 /******************************************************************************
  * Function         phNxpNciHal_core_initialized
  *
@@ -1470,7 +1539,9 @@ int phNxpNciHal_core_initialized(uint16_t core_init_rsp_params_len,
     NXPLOG_NCIHAL_E("%s: NXP get FW DW Flag failed", __FUNCTION__);
   }
   fw_dwnld_flag |= fw_download_success;
+  phNxpNciHal_ConfigShadow::getInstance().Load(wFwVerRsp, getNxpConfigCrc32());
   if (fw_dwnld_flag) {
+    phNxpNciHal_ConfigShadow::getInstance().Invalidate();
     phNxpNciHal_hci_network_reset();
   }
   if (IS_CHIP_TYPE_L(sn100u)) {
@@ -1577,29 +1648,37 @@ int phNxpNciHal_core_initialized(uint16_t core_init_rsp_params_len,
                        sizeof(retlen))) {
       if (retlen > 0) phNxpNciHal_enableDefaultUICC2SWPline((uint8_t)retlen);
     }
-    status = phNxpNciHal_setExtendedFieldMode();
-    if (status != NFCSTATUS_SUCCESS &&
-        status != NFCSTATUS_FEATURE_NOT_SUPPORTED) {
-      NXPLOG_NCIHAL_E("phNxpNciHal_setExtendedFieldMode failed");
-      retry_core_init_cnt++;
-      goto retry_core_init;
-    }
-    status = phNxpNciHal_setGuardTimer();
-    if (status != NFCSTATUS_SUCCESS &&
-        status != NFCSTATUS_FEATURE_NOT_SUPPORTED) {
-      NXPLOG_NCIHAL_E("phNxpNciHal_setGuardTimer failed");
-      retry_core_init_cnt++;
-      goto retry_core_init;
-    }
+    {
+      phNxpNciHal_SetConfigBatch setCfgBatch;
+      NFCSTATUS extFieldModeStatus = NFCSTATUS_SUCCESS;
+      NFCSTATUS guardTimerStatus = NFCSTATUS_SUCCESS;
+      NFCSTATUS srdTimeoutStatus = NFCSTATUS_FEATURE_NOT_SUPPORTED;
+
+      phNxpNciHal_setExtendedFieldMode(&setCfgBatch, &extFieldModeStatus);
+      phNxpNciHal_setGuardTimer(&setCfgBatch, &guardTimerStatus);
 #if (NXP_SRD == TRUE)
-    status = phNxpNciHal_setSrdtimeout();
-    if (status != NFCSTATUS_SUCCESS &&
-        status != NFCSTATUS_FEATURE_NOT_SUPPORTED) {
-      NXPLOG_NCIHAL_E("phNxpNciHal_setSrdtimeout failed");
-      retry_core_init_cnt++;
-      goto retry_core_init;
-    }
+      phNxpNciHal_setSrdtimeout(&setCfgBatch, &srdTimeoutStatus);
 #endif
+      setCfgBatch.Flush();
+      if (extFieldModeStatus != NFCSTATUS_SUCCESS &&
+          extFieldModeStatus != NFCSTATUS_FEATURE_NOT_SUPPORTED) {
+        NXPLOG_NCIHAL_E("phNxpNciHal_setExtendedFieldMode failed");
+        retry_core_init_cnt++;
+        goto retry_core_init;
+      }
+      if (guardTimerStatus != NFCSTATUS_SUCCESS &&
+          guardTimerStatus != NFCSTATUS_FEATURE_NOT_SUPPORTED) {
+        NXPLOG_NCIHAL_E("phNxpNciHal_setGuardTimer failed");
+        retry_core_init_cnt++;
+        goto retry_core_init;
+      }
+      if (srdTimeoutStatus != NFCSTATUS_SUCCESS &&
+          srdTimeoutStatus != NFCSTATUS_FEATURE_NOT_SUPPORTED) {
+        NXPLOG_NCIHAL_E("phNxpNciHal_setSrdtimeout failed");
+        retry_core_init_cnt++;
+        goto retry_core_init;
+      }
+    }
     config_access = true;
     retlen = 0;
     NXPLOG_NCIHAL_D("Performing ndef nfcee config settings");
@@ -1652,18 +1731,32 @@ int phNxpNciHal_core_initialized(uint16_t core_init_rsp_params_len,
     retlen = 0;
     isfound = GetNxpByteArrayValue(NAME_NXP_CORE_CONF, (char*)buffer, bufflen,
                                    &retlen);
-    if (isfound > 0 && retlen > 0) {
-      /* NXP ACT Proprietary Ext */
-      status = phNxpNciHal_send_ext_cmd(retlen, buffer, &rsp_len, rsp);
-      if (status != NFCSTATUS_SUCCESS) {
+    {
+      /* NXP_CORE_CONF and DCDC settings are coalesced when they fit */
+      phNxpNciHal_SetConfigBatch setCfgBatch;
+      NFCSTATUS coreConfStatus = NFCSTATUS_SUCCESS;
+      NFCSTATUS dcdcStatus = NFCSTATUS_SUCCESS;
+
+      if (isfound > 0 && retlen > 0 &&
+          setCfgBatch.AddCmd(buffer, retlen, &coreConfStatus) !=
+              NFCSTATUS_PENDING) {
+        /* NXP ACT Proprietary Ext */
+        coreConfStatus =
+            phNxpNciHal_send_ext_cmd(retlen, buffer, &rsp_len, rsp);
+      }
+      phNxpNciHal_setDCDCConfig(&setCfgBatch, &dcdcStatus);
+      setCfgBatch.Flush();
+      if (coreConfStatus != NFCSTATUS_SUCCESS) {
         NXPLOG_NCIHAL_E("Core Set Config failed");
         retry_core_init_cnt++;
         goto retry_core_init;
       }
+      if (dcdcStatus != NFCSTATUS_SUCCESS &&
+          dcdcStatus != NFCSTATUS_FEATURE_NOT_SUPPORTED) {
+        NXPLOG_NCIHAL_E("SetConfig for DCDC failed");
+      }
     }
 
-    phNxpNciHal_setDCDCConfig();
-
     if (fpVerInfoStoreInEeprom != NULL) {
       fpVerInfoStoreInEeprom();
     }
@@ -1679,7 +1772,10 @@ int phNxpNciHal_core_initialized(uint16_t core_init_rsp_params_len,
       strlcat(rf_conf_block, rf_block_num[loopcnt++], sizeof(rf_conf_block));
       isfound =
           GetNxpByteArrayValue(rf_conf_block, (char*)buffer, bufflen, &retlen);
-      if (isfound > 0 && retlen > 0) {
+      if (isfound > 0 && retlen > 0 &&
+          phNxpNciHal_ConfigShadow::getInstance().Holds(buffer, retlen)) {
+        NXPLOG_NCIHAL_D(" RF Settings BLK %ld already applied", loopcnt);
+      } else if (isfound > 0 && retlen > 0) {
         NXPLOG_NCIHAL_D(" Performing RF Settings BLK %ld", loopcnt);
         status = phNxpNciHal_send_ext_cmd(retlen, buffer, &rsp_len, rsp);
         if (status == NFCSTATUS_SUCCESS) {
@@ -1715,16 +1811,21 @@ int phNxpNciHal_core_initialized(uint16_t core_init_rsp_params_len,
   isfound = GetNxpByteArrayValue(NAME_NXP_CORE_RF_FIELD, (char*)buffer, bufflen,
                                  &retlen);
   if (isfound > 0 && retlen > 0) {
-    /* NXP ACT Proprietary Ext */
-    status = phNxpNciHal_send_ext_cmd(retlen, buffer, &rsp_len, rsp);
-    if (status == NFCSTATUS_SUCCESS) {
-      status = phNxpNciHal_CheckRFCmdRespStatus(rsp_len, rsp);
-      /*STATUS INVALID PARAM 0x09*/
-      if (status == 0x09) {
-        phNxpNciHalRFConfigCmdRecSequence();
-        retry_core_init_cnt++;
-        goto retry_core_init;
+    /* NXP ACT Proprietary Ext, sent on every init: skipped if unchanged */
+    phNxpNciHal_SetConfigBatch setCfgBatch;
+    if (setCfgBatch.AddCmd(buffer, retlen) == NFCSTATUS_PENDING) {
+      status = setCfgBatch.Flush();
+    } else {
+      status = phNxpNciHal_send_ext_cmd(retlen, buffer, &rsp_len, rsp);
+      if (status == NFCSTATUS_SUCCESS) {
+        status = phNxpNciHal_CheckRFCmdRespStatus(rsp_len, rsp);
       }
+    }
+    /*STATUS INVALID PARAM 0x09*/
+    if (status == 0x09) {
+      phNxpNciHalRFConfigCmdRecSequence();
+      retry_core_init_cnt++;
+      goto retry_core_init;
     } else if (status != NFCSTATUS_SUCCESS) {
       NXPLOG_NCIHAL_E("Setting NXP_CORE_RF_FIELD status failed");
       retry_core_init_cnt++;
@@ -1733,37 +1834,6 @@ int phNxpNciHal_core_initialized(uint16_t core_init_rsp_params_len,
   }
   config_access = true;
 
-  retlen = 0;
-  /* NXP SWP switch timeout Setting*/
-  if (GetNxpNumValue(NAME_NXP_SWP_SWITCH_TIMEOUT, (void*)&retlen,
-                     sizeof(retlen))) {
-    // Check the permissible range [0 - 60]
-    if (0 <= retlen && retlen <= 60) {
-      if (0 < retlen) {
-        unsigned int timeout = (uint32_t)retlen * 1000;
-        unsigned int timeoutHx = 0x0000;
-
-        char tmpbuffer[10] = {0};
-        snprintf((char*)tmpbuffer, 10, "%04x", timeout);
-        int ret = sscanf((char*)tmpbuffer, "%x", &timeoutHx);
-        if (!ret) timeoutHx = 0x0000;
-
-        swp_switch_timeout_cmd[7] = (timeoutHx & 0xFF);
-        swp_switch_timeout_cmd[8] = ((timeoutHx & 0xFF00) >> 8);
-      }
-
-      status = phNxpNciHal_send_ext_cmd(sizeof(swp_switch_timeout_cmd),
-                                        swp_switch_timeout_cmd, &rsp_len, rsp);
-      if (status != NFCSTATUS_SUCCESS) {
-        NXPLOG_NCIHAL_E("SWP switch timeout Setting Failed");
-        retry_core_init_cnt++;
-        goto retry_core_init;
-      }
-    } else {
-      NXPLOG_NCIHAL_E("SWP switch timeout Setting Failed - out of range!");
-    }
-  }
-
   status = phNxpNciHal_china_tianjin_rf_setting();
   if (status != NFCSTATUS_SUCCESS) {
     NXPLOG_NCIHAL_E("phNxpNciHal_china_tianjin_rf_setting failed");
@@ -1778,33 +1848,63 @@ int phNxpNciHal_core_initialized(uint16_t core_init_rsp_params_len,
     }
   }
 
-  retlen = 0;
-  config_access = false;
+  {
+    /* SWP switch timeout and SWP full power mode share one set config */
+    phNxpNciHal_SetConfigBatch setCfgBatch;
+    NFCSTATUS swpSwitchTimeoutStatus = NFCSTATUS_SUCCESS;
+    NFCSTATUS swpFullPwrStatus = NFCSTATUS_SUCCESS;
 
-  retlen = 0;
+    retlen = 0;
+    /* NXP SWP switch timeout Setting*/
+    if (GetNxpNumValue(NAME_NXP_SWP_SWITCH_TIMEOUT, (void*)&retlen,
+                       sizeof(retlen))) {
+      // Check the permissible range [0 - 60]
+      if (0 <= retlen && retlen <= 60) {
+        if (0 < retlen) {
+          unsigned int timeout = (uint32_t)retlen * 1000;
+          unsigned int timeoutHx = 0x0000;
+
+          char tmpbuffer[10] = {0};
+          snprintf((char*)tmpbuffer, 10, "%04x", timeout);
+          int ret = sscanf((char*)tmpbuffer, "%x", &timeoutHx);
+          if (!ret) timeoutHx = 0x0000;
+
+          swp_switch_timeout_cmd[7] = (timeoutHx & 0xFF);
+          swp_switch_timeout_cmd[8] = ((timeoutHx & 0xFF00) >> 8);
+        }
 
-  /* SWP FULL PWR MODE SETTING ON */
-  if (GetNxpNumValue(NAME_NXP_SWP_FULL_PWR_ON, (void*)&retlen,
-                     sizeof(retlen))) {
-    if (1 == retlen) {
-      status =
-          phNxpNciHal_send_ext_cmd(sizeof(swp_full_pwr_mode_on_cmd),
-                                   swp_full_pwr_mode_on_cmd, &rsp_len, rsp);
-      if (status != NFCSTATUS_SUCCESS) {
-        NXPLOG_NCIHAL_E("SWP FULL PWR MODE SETTING ON CMD FAILED");
-        retry_core_init_cnt++;
-        goto retry_core_init;
+        setCfgBatch.AddCmd(swp_switch_timeout_cmd,
+                           sizeof(swp_switch_timeout_cmd),
+                           &swpSwitchTimeoutStatus);
+      } else {
+        NXPLOG_NCIHAL_E("SWP switch timeout Setting Failed - out of range!");
       }
-    } else {
-      swp_full_pwr_mode_on_cmd[7] = 0x00;
-      status =
-          phNxpNciHal_send_ext_cmd(sizeof(swp_full_pwr_mode_on_cmd),
-                                   swp_full_pwr_mode_on_cmd, &rsp_len, rsp);
-      if (status != NFCSTATUS_SUCCESS) {
-        NXPLOG_NCIHAL_E("SWP FULL PWR MODE SETTING OFF CMD FAILED");
-        retry_core_init_cnt++;
-        goto retry_core_init;
+    }
+
+    retlen = 0;
+    config_access = false;
+
+    /* SWP FULL PWR MODE SETTING ON */
+    if (GetNxpNumValue(NAME_NXP_SWP_FULL_PWR_ON, (void*)&retlen,
+                       sizeof(retlen))) {
+      if (1 != retlen) {
+        swp_full_pwr_mode_on_cmd[7] = 0x00;
       }
+      setCfgBatch.AddCmd(swp_full_pwr_mode_on_cmd,
+                         sizeof(swp_full_pwr_mode_on_cmd), &swpFullPwrStatus);
+    }
+
+    if (!setCfgBatch.Empty()) status = setCfgBatch.Flush();
+    if (swpSwitchTimeoutStatus != NFCSTATUS_SUCCESS) {
+      NXPLOG_NCIHAL_E("SWP switch timeout Setting Failed");
+      retry_core_init_cnt++;
+      goto retry_core_init;
+    }
+    if (swpFullPwrStatus != NFCSTATUS_SUCCESS) {
+      NXPLOG_NCIHAL_E("SWP FULL PWR MODE SETTING %s CMD FAILED",
+                      swp_full_pwr_mode_on_cmd[7] ? "ON" : "OFF");
+      retry_core_init_cnt++;
+      goto retry_core_init;
     }
   }
 
@@ -1840,17 +1940,7 @@ int phNxpNciHal_core_initialized(uint16_t core_init_rsp_params_len,
           NXPLOG_NCIHAL_E("Updation of the SRAM contents failed");
         }
       }
-      status = phNxpNciHal_send_ext_cmd(sizeof(cmd_reset_nci), cmd_reset_nci,
-                                        &rsp_len, rsp);
-      if (status == NFCSTATUS_SUCCESS) {
-        if (nxpncihal_ctrl.nci_info.nci_version >= NCI_VERSION_2_0) {
-          status = phNxpNciHal_send_ext_cmd(sizeof(cmd_init_nci2_0),
-                                            cmd_init_nci2_0, &rsp_len, rsp);
-        } else {
-          status = phNxpNciHal_send_ext_cmd(sizeof(cmd_init_nci), cmd_init_nci,
-                                            &rsp_len, rsp);
-        }
-      }
+      status = phNxpNciHal_send_ext_cmd_seq(phNxpNciHal_core_reset_init_seq());
     }
     if (status == NFCSTATUS_SUCCESS) {
       status = phNxpNciHal_restore_uicc_params();
@@ -1886,6 +1976,7 @@ int phNxpNciHal_core_initialized(uint16_t core_init_rsp_params_len,
   if (!sIsHalOpenErrorRecovery) {
     phNxpNciHal_complete(status, PHNXP_NCIHAL_OP_CORE_INIT);
   }
+  phNxpNciHal_ConfigShadow::getInstance().Save();
   if (isNxpConfigModified()) {
     updateNxpConfigTimestamp();
   }
@@ -2184,6 +2275,7 @@ close_and_return:
         if (retry > 3) {
           NXPLOG_NCIHAL_E(
               "Maximum retries performed, shall restart HAL to recover");
+          phTmlNfc_CaptureFlush();
           abort();
         }
       }
@@ -2710,13 +2802,37 @@ NFCSTATUS phNxpNciHal_nfccClockCfgApply(void) {
     get_clk_size = sizeof(get_clck_cmd_sn100);
   }
   phNxpNciHal_nfccClockCfgRead();
-  phNxpNciClock.isClockSet = true;
-  status = phNxpNciHal_send_ext_cmd(get_clk_size, get_clock_cmd, &rsp_len, rsp);
-  phNxpNciClock.isClockSet = false;
+  std::vector<uint8_t> clk_val;
+  bool clk_verified = false;
+  if (IS_CHIP_TYPE_GE(sn100u) &&
+      phNxpNciHal_ConfigShadow::getInstance().Lookup(CLK_CFG_PARAM_ID, clk_val,
+                                                     clk_verified) &&
+      clk_verified &&
+      clk_val.size() <= sizeof(phNxpNciClock.p_rx_data) - CLK_CFG_VAL_OFFSET) {
+    /* Applied since the HAL started, rebuild its CORE_GET_CONFIG_RSP */
+    uint8_t get_clk_rsp[] = {
+        0x40, 0x03, (uint8_t)(clk_val.size() + 5), 0x00, 0x01, 0xA0, 0x11,
+        (uint8_t)clk_val.size()};
+    memcpy(phNxpNciClock.p_rx_data, get_clk_rsp, sizeof(get_clk_rsp));
+    memcpy(&phNxpNciClock.p_rx_data[CLK_CFG_VAL_OFFSET], clk_val.data(),
+           clk_val.size());
+  } else {
+    phNxpNciClock.isClockSet = true;
+    status =
+        phNxpNciHal_send_ext_cmd(get_clk_size, get_clock_cmd, &rsp_len, rsp);
+    phNxpNciClock.isClockSet = false;
 
-  if (status != NFCSTATUS_SUCCESS) {
-    NXPLOG_NCIHAL_E("unable to retrieve get_clk_src_sel");
-    return status;
+    if (status != NFCSTATUS_SUCCESS) {
+      NXPLOG_NCIHAL_E("unable to retrieve get_clk_src_sel");
+      return status;
+    }
+    if (IS_CHIP_TYPE_GE(sn100u) &&
+        phNxpNciClock.p_rx_data[CLK_CFG_VAL_OFFSET - 1] <=
+            sizeof(phNxpNciClock.p_rx_data) - CLK_CFG_VAL_OFFSET) {
+      phNxpNciHal_ConfigShadow::getInstance().Update(
+          CLK_CFG_PARAM_ID, &phNxpNciClock.p_rx_data[CLK_CFG_VAL_OFFSET],
+          phNxpNciClock.p_rx_data[CLK_CFG_VAL_OFFSET - 1]);
+    }
   }
 
   nfcc_cfg_clock_src = phNxpNciHal_determineConfiguredClockSrc();
@@ -3853,6 +3969,23 @@ void phNxpNciHal_setVerboseLogging(bool enable) { nfc_debug_enabled = enable; }
 
 bool phNxpNciHal_getVerboseLogging() { return nfc_debug_enabled; }
 
+/******************************************************************************
+ * Function         phNxpNciHal_dump
+ *
+ * Description      This function writes the last NCI packets of the HAL
+ *                  with their timestamps, the packet latency by stage and
+ *                  the HAL lock statistics to fd
+ *
+ * Returns          void
+ *
+ *****************************************************************************/
+
+void phNxpNciHal_dump(int fd) {
+  NfcHalNciTrace::getInstance().dump(fd);
+  NfcHalLatencyStats::getInstance().dump(fd);
+  NfcHalLockStats::dumpAll(fd);
+}
+
 /******************************************************************************
  * Function         phNxpNciHal_check_and_recover_fw
  *
@@ -187,6 +187,7 @@ typedef struct phNxpNciInfo {
   uint8_t nci_version;
   bool_t wait_for_ntf;
   uint8_t lastResetNtfReason;
+  uint8_t max_ctrl_payload; /* from CORE_INIT_RSP, 0 if not known yet */
 } phNxpNciInfo_t;
 /* NCI Control structure */
 typedef struct phNxpNciHal_Control {
@@ -383,6 +384,7 @@ typedef struct phNxpNciProfile_Control {
 #define NCI_HAL_TML_WRITE_MSG 0x417
 #define HAL_CTRL_GRANTED_MSG 0x418
 #define NCI_HAL_OEM_RSP_NTF_MSG 0x419
+#define NCI_HAL_TML_WRITE_DATA_MSG 0x41A
 #define NCI_HAL_RX_MSG 0xF01
 #define NCI_HAL_VENDOR_MSG 0xF02
 #define HAL_NFC_FW_UPDATE_STATUS_EVT 0x0A
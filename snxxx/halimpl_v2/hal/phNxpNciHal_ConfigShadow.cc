@@ -0,0 +1,321 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "phNxpNciHal_ConfigShadow.h"
+
+#include <errno.h>
+#include <phNxpLog.h>
+#include <phNxpNciHal_ext.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "NciDef.h"
+#include "phNxpNciHal_SetConfigBatch.h"
+#include "sparse_crc32.h"
+
+static const char config_shadow_path[] =
+    "/data/vendor/nfc/libnfc-nxpConfigShadow.bin";
+static const char config_shadow_tmp_path[] =
+    "/data/vendor/nfc/libnfc-nxpConfigShadow.tmp";
+
+#define CONFIG_SHADOW_MAGIC 0x4853434E /* "NCSH" */
+#define CONFIG_SHADOW_VERSION 1
+/* Entry: id (2), len (1), value */
+#define CONFIG_SHADOW_ENTRY_HDR_LEN 3
+#define CONFIG_SHADOW_MAX_SIZE 0x4000
+/* CORE_RESET_CMD reset type and CORE_RESET_NTF/RSP configuration status */
+#define CORE_RESET_KEEP_CONFIG 0x00
+/* NCI 1.0 CORE_RESET_RSP: status, NCI version, configuration status */
+#define NCI1_0_CORE_RESET_RSP_LEN 0x03
+#define NCI1_0_CORE_RESET_RSP_CFG_INDEX 0x05
+
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t fwVersion;
+  uint32_t configCrc;
+  uint32_t count;
+  uint32_t dataLen;
+  uint32_t dataCrc;
+} phNxpNciHal_ConfigShadowHdr_t;
+
+phNxpNciHal_ConfigShadow::phNxpNciHal_ConfigShadow()
+    : mFwVersion(0),
+      mConfigCrc(0),
+      mLoaded(false),
+      mOnDisk(false) {}
+
+phNxpNciHal_ConfigShadow& phNxpNciHal_ConfigShadow::getInstance() {
+  static phNxpNciHal_ConfigShadow instance;
+  return instance;
+}
+
+void phNxpNciHal_ConfigShadow::Load(uint32_t fwVersion, uint32_t configCrc) {
+  std::lock_guard<std::mutex> lock(mLock);
+
+  mPending.clear();
+  /* Values learnt since the last Load() are newer than the stored ones */
+  if (mLoaded && mFwVersion == fwVersion && mConfigCrc == configCrc) return;
+
+  mValues.clear();
+  mVerified.clear();
+  mFwVersion = fwVersion;
+  mConfigCrc = configCrc;
+  mLoaded = true;
+  mOnDisk = false;
+
+  FILE* fd = fopen(config_shadow_path, "rb");
+  if (fd == nullptr) {
+    NXPLOG_NCIHAL_D("%s: no stored shadow", __func__);
+    return;
+  }
+  phNxpNciHal_ConfigShadowHdr_t hdr;
+  std::vector<uint8_t> data;
+  bool valid = (fread(&hdr, sizeof(hdr), 1, fd) == 1 &&
+                hdr.magic == CONFIG_SHADOW_MAGIC &&
+                hdr.version == CONFIG_SHADOW_VERSION &&
+                hdr.dataLen <= CONFIG_SHADOW_MAX_SIZE);
+  if (valid) {
+    data.resize(hdr.dataLen);
+    valid =
+        (hdr.dataLen == 0 || fread(data.data(), hdr.dataLen, 1, fd) == 1) &&
+        sparse_crc32(0, data.data(), (int)data.size()) == hdr.dataCrc;
+  }
+  fclose(fd);
+
+  if (!valid) {
+    NXPLOG_NCIHAL_E("%s: stored shadow is corrupted", __func__);
+    unlink(config_shadow_path);
+    return;
+  }
+  if (hdr.fwVersion != fwVersion || hdr.configCrc != configCrc) {
+    NXPLOG_NCIHAL_D("%s: FW or config changed, shadow dropped", __func__);
+    unlink(config_shadow_path);
+    return;
+  }
+
+  size_t i = 0;
+  for (uint32_t n = 0; n < hdr.count; n++) {
+    if (i + CONFIG_SHADOW_ENTRY_HDR_LEN > data.size() ||
+        i + CONFIG_SHADOW_ENTRY_HDR_LEN + data[i + 2] > data.size()) {
+      mValues.clear();
+      NXPLOG_NCIHAL_E("%s: stored shadow is truncated", __func__);
+      return;
+    }
+    uint16_t id = (uint16_t)((data[i] << 8) | data[i + 1]);
+    const uint8_t* p_val = &data[i + CONFIG_SHADOW_ENTRY_HDR_LEN];
+    mValues[id].assign(p_val, p_val + data[i + 2]);
+    i += CONFIG_SHADOW_ENTRY_HDR_LEN + data[i + 2];
+  }
+  mOnDisk = true;
+  NXPLOG_NCIHAL_D("%s: %zu params loaded", __func__, mValues.size());
+}
+
+void phNxpNciHal_ConfigShadow::Save() {
+  std::lock_guard<std::mutex> lock(mLock);
+  if (!mLoaded || mOnDisk) return;
+
+  std::vector<uint8_t> data;
+  for (const auto& it : mValues) {
+    data.push_back((uint8_t)(it.first >> 8));
+    data.push_back((uint8_t)it.first);
+    data.push_back((uint8_t)it.second.size());
+    data.insert(data.end(), it.second.begin(), it.second.end());
+  }
+  phNxpNciHal_ConfigShadowHdr_t hdr = {
+      .magic = CONFIG_SHADOW_MAGIC,
+      .version = CONFIG_SHADOW_VERSION,
+      .fwVersion = mFwVersion,
+      .configCrc = mConfigCrc,
+      .count = (uint32_t)mValues.size(),
+      .dataLen = (uint32_t)data.size(),
+      .dataCrc = sparse_crc32(0, data.data(), (int)data.size())};
+
+  /* Write aside and rename so that a torn write is never loaded */
+  FILE* fd = fopen(config_shadow_tmp_path, "wb");
+  if (fd == nullptr) {
+    NXPLOG_NCIHAL_E("%s: unable to open %s (errno=%d)", __func__,
+                    config_shadow_tmp_path, errno);
+    return;
+  }
+  bool written =
+      fwrite(&hdr, sizeof(hdr), 1, fd) == 1 &&
+      (data.empty() || fwrite(data.data(), data.size(), 1, fd) == 1) &&
+      fflush(fd) == 0 && fsync(fileno(fd)) == 0;
+  fclose(fd);
+  if (!written || rename(config_shadow_tmp_path, config_shadow_path) != 0) {
+    NXPLOG_NCIHAL_E("%s: unable to store shadow (errno=%d)", __func__, errno);
+    unlink(config_shadow_tmp_path);
+    return;
+  }
+  mOnDisk = true;
+  NXPLOG_NCIHAL_D("%s: %zu params stored", __func__, mValues.size());
+}
+
+void phNxpNciHal_ConfigShadow::Invalidate() {
+  std::lock_guard<std::mutex> lock(mLock);
+  Drop();
+}
+
+bool phNxpNciHal_ConfigShadow::Lookup(uint16_t id, std::vector<uint8_t>& val,
+                                      bool& verified) {
+  std::lock_guard<std::mutex> lock(mLock);
+  if (!mLoaded) return false;
+  auto it = mValues.find(id);
+  if (it == mValues.end()) return false;
+  val = it->second;
+  verified = (mVerified.count(id) > 0);
+  return true;
+}
+
+bool phNxpNciHal_ConfigShadow::Holds(const uint8_t* p_cmd, uint16_t cmd_len) {
+  if (cmd_len < 4 || p_cmd[0] != NCI_MT_CMD ||
+      p_cmd[1] != NCI_MSG_CORE_SET_CONFIG || p_cmd[2] + 3 != cmd_len) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mLock);
+  if (!mLoaded) return false;
+
+  uint16_t i = 4;
+  uint8_t n = 0;
+  for (; n < p_cmd[3] && i < cmd_len; n++) {
+    uint16_t id = phNxpNciHal_SetConfigBatch::ParseId(&p_cmd[i], cmd_len - i);
+    if (id == 0xFFFF || phNxpNciHal_SetConfigBatch::IdLen(id) != 2) {
+      return false;
+    }
+    i += 2;
+    if (i >= cmd_len || i + 1 + p_cmd[i] > cmd_len) return false;
+    auto it = mValues.find(id);
+    if (it == mValues.end() || mVerified.count(id) == 0 ||
+        it->second.size() != p_cmd[i] ||
+        memcmp(it->second.data(), &p_cmd[i + 1], p_cmd[i]) != 0) {
+      return false;
+    }
+    i += 1 + p_cmd[i];
+  }
+  return n == p_cmd[3] && i == cmd_len;
+}
+
+void phNxpNciHal_ConfigShadow::Update(uint16_t id, const uint8_t* p_val,
+                                      uint8_t len) {
+  if (phNxpNciHal_SetConfigBatch::IdLen(id) != 2) return;
+  std::lock_guard<std::mutex> lock(mLock);
+  if (!mLoaded) return;
+  mVerified.insert(id);
+  std::vector<uint8_t>& val = mValues[id];
+  if (val.size() == len && memcmp(val.data(), p_val, len) == 0) return;
+  val.assign(p_val, p_val + len);
+  MarkChanged();
+}
+
+void phNxpNciHal_ConfigShadow::MarkChanged() {
+  /* The stored shadow must never claim a value the NFCC may not hold */
+  if (mOnDisk) {
+    unlink(config_shadow_path);
+    mOnDisk = false;
+  }
+}
+
+void phNxpNciHal_ConfigShadow::Erase(uint16_t id) {
+  mVerified.erase(id);
+  if (mValues.erase(id) > 0) MarkChanged();
+}
+
+void phNxpNciHal_ConfigShadow::Drop() {
+  NXPLOG_NCIHAL_D("%s: %zu params dropped", __func__, mValues.size());
+  mValues.clear();
+  mVerified.clear();
+  mPending.clear();
+  MarkChanged();
+}
+
+void phNxpNciHal_ConfigShadow::OnCmdSent(const uint8_t* p_cmd,
+                                         uint16_t cmd_len) {
+  if (cmd_len < 4 || p_cmd[0] != NCI_MT_CMD) return;
+  if (p_cmd[1] == NCI_MSG_CORE_RESET) {
+    /* Any reset type but keep configuration */
+    if (p_cmd[3] != CORE_RESET_KEEP_CONFIG) Invalidate();
+    return;
+  }
+  if (p_cmd[1] != NCI_MSG_CORE_SET_CONFIG) return;
+  std::lock_guard<std::mutex> lock(mLock);
+  mPending.clear();
+  if (!mLoaded) return;
+
+  uint16_t end = std::min<uint16_t>(cmd_len, p_cmd[2] + 3);
+  uint16_t i = 4;
+  for (uint8_t n = 0; n < p_cmd[3] && i < end; n++) {
+    uint16_t id = phNxpNciHal_SetConfigBatch::ParseId(&p_cmd[i], end - i);
+    if (id == 0xFFFF) break;
+    i += phNxpNciHal_SetConfigBatch::IdLen(id);
+    if (i >= end || i + 1 + p_cmd[i] > end) break;
+    if (phNxpNciHal_SetConfigBatch::IdLen(id) == 2) {
+      /* Unknown until the NFCC accepted it */
+      Erase(id);
+      mPending.emplace_back(
+          id, std::vector<uint8_t>(&p_cmd[i + 1], &p_cmd[i + 1] + p_cmd[i]));
+    }
+    i += 1 + p_cmd[i];
+  }
+}
+
+void phNxpNciHal_ConfigShadow::OnRspReceived(const uint8_t* p_rsp,
+                                             uint16_t rsp_len) {
+  if (rsp_len < 5) return;
+  if (p_rsp[1] == NCI_MSG_CORE_RESET &&
+      ((p_rsp[0] == NCI_MT_NTF &&
+        (p_rsp[3] != CORE_RESET_TRIGGER_TYPE_CORE_RESET_CMD_RECEIVED ||
+         p_rsp[4] != CORE_RESET_KEEP_CONFIG)) ||
+       (p_rsp[0] == NCI_MT_RSP && p_rsp[2] == NCI1_0_CORE_RESET_RSP_LEN &&
+        rsp_len > NCI1_0_CORE_RESET_RSP_CFG_INDEX &&
+        p_rsp[NCI1_0_CORE_RESET_RSP_CFG_INDEX] != CORE_RESET_KEEP_CONFIG))) {
+    /* Powered on, reset by itself or lost its configuration */
+    NXPLOG_NCIHAL_D("%s: NFCC reset, shadow dropped", __func__);
+    Invalidate();
+    return;
+  }
+  if (p_rsp[0] != NCI_MT_RSP || p_rsp[1] != NCI_MSG_CORE_SET_CONFIG) return;
+  std::lock_guard<std::mutex> lock(mLock);
+  if (mPending.empty()) return;
+
+  uint8_t status = p_rsp[3];
+  uint8_t num = p_rsp[4];
+  if (status == NFCSTATUS_SUCCESS || num > 0) {
+    /* Listed parameters were rejected, the others applied */
+    std::vector<uint16_t> rejected;
+    uint16_t end = std::min<uint16_t>(rsp_len, p_rsp[2] + 3);
+    uint16_t i = 5;
+    for (uint8_t n = 0; status != NFCSTATUS_SUCCESS && n < num && i < end; n++) {
+      uint16_t id = phNxpNciHal_SetConfigBatch::ParseId(&p_rsp[i], end - i);
+      if (id == 0xFFFF) break;
+      rejected.push_back(id);
+      i += phNxpNciHal_SetConfigBatch::IdLen(id);
+    }
+    for (auto& param : mPending) {
+      if (std::find(rejected.begin(), rejected.end(), param.first) !=
+          rejected.end()) {
+        continue;
+      }
+      mValues[param.first] = std::move(param.second);
+      mVerified.insert(param.first);
+      MarkChanged();
+    }
+  }
+  mPending.clear();
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NXPNCIHALCONFIGSHADOW_H
+#define NXPNCIHALCONFIGSHADOW_H
+
+#include <stdint.h>
+
+#include <map>
+#include <mutex>
+#include <set>
+#include <vector>
+
+/******************************************************************************
+ * Class         phNxpNciHal_ConfigShadow
+ *
+ * Description   Last value applied to each NXP proprietary (0xA0xx, 0xA1xx)
+ *               parameter, learnt from every CORE_SET_CONFIG going through
+ *               the HAL and every CORE_GET_CONFIG made by
+ *               phNxpNciHal_SetConfigBatch. A value is verified once it was
+ *               accepted by or read back from the NFCC since the HAL
+ *               started: phNxpNciHal_SetConfigBatch skips a parameter
+ *               holding a verified value, reads back one holding a value
+ *               only known from the stored shadow, and writes a known
+ *               different value without reading it first.
+ *
+ *               The shadow is stored in /data/vendor/nfc and is only reused
+ *               for the same FW version and config files. It is dropped
+ *               after FW download, on a CORE_RESET_CMD resetting the
+ *               configuration, and when the NFCC reports any other reset.
+ *
+ ******************************************************************************/
+class phNxpNciHal_ConfigShadow {
+ public:
+  static phNxpNciHal_ConfigShadow& getInstance();
+
+  phNxpNciHal_ConfigShadow(const phNxpNciHal_ConfigShadow&) = delete;
+  phNxpNciHal_ConfigShadow& operator=(const phNxpNciHal_ConfigShadow&) =
+      delete;
+
+  /******************************************************************************
+   * Function:       Load()
+   *
+   * Description:    Starts a core initialization: loads the stored shadow,
+   *                 if it was saved for fwVersion and configCrc.
+   *
+   * Returns:        void
+   ******************************************************************************/
+  void Load(uint32_t fwVersion, uint32_t configCrc);
+
+  /******************************************************************************
+   * Function:       Save()
+   *
+   * Description:    Stores the shadow if it changed since Load()/Save().
+   *
+   * Returns:        void
+   ******************************************************************************/
+  void Save();
+
+  /******************************************************************************
+   * Function:       Invalidate()
+   *
+   * Description:    Forgets every value, e.g. after FW download or an NFCC
+   *                 reset, and removes the stored shadow.
+   *
+   * Returns:        void
+   ******************************************************************************/
+  void Invalidate();
+
+  /******************************************************************************
+   * Function:       Lookup()
+   *
+   * Description:    Gets the last value applied to proprietary parameter id
+   *                 and whether it was verified since the HAL started.
+   *
+   * Returns:        true if the value is known.
+   ******************************************************************************/
+  bool Lookup(uint16_t id, std::vector<uint8_t>& val, bool& verified);
+
+  /******************************************************************************
+   * Function:       Holds()
+   *
+   * Description:    Checks a complete CORE_SET_CONFIG command, e.g. an RF
+   *                 block read from the configuration file, against the
+   *                 shadow.
+   *
+   * Returns:        true if every parameter is proprietary and holds a
+   *                 verified value equal to the one of the command.
+   ******************************************************************************/
+  bool Holds(const uint8_t* p_cmd, uint16_t cmd_len);
+
+  /* Records a value read back from the NFCC */
+  void Update(uint16_t id, const uint8_t* p_val, uint8_t len);
+
+  /* Hooks for every NCI command written and every response read */
+  void OnCmdSent(const uint8_t* p_cmd, uint16_t cmd_len);
+  void OnRspReceived(const uint8_t* p_rsp, uint16_t rsp_len);
+
+ private:
+  phNxpNciHal_ConfigShadow();
+
+  void MarkChanged();
+  void Erase(uint16_t id);
+  void Drop();
+
+  std::mutex mLock;
+  std::map<uint16_t, std::vector<uint8_t>> mValues;
+  /* Parameters whose value was accepted or read back since the HAL started */
+  std::set<uint16_t> mVerified;
+  /* Parameters of the CORE_SET_CONFIG waiting for its response */
+  std::vector<std::pair<uint16_t, std::vector<uint8_t>>> mPending;
+  uint32_t mFwVersion;
+  uint32_t mConfigCrc;
+  bool mLoaded;      /* Load() was called, the key is known */
+  bool mOnDisk;      /* the stored shadow matches mValues */
+};
+
+#endif  // NXPNCIHALCONFIGSHADOW_H
@@ -0,0 +1,305 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "phNxpNciHal_ConnCredits.h"
+
+#include <phNxpConfig.h>
+#include <phNxpLog.h>
+#include <phNxpNciHal.h>
+#include <phNxpNciHal_Adaptation.h>
+#include <phNxpNciHal_ext.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "NciDef.h"
+#include "phNxpNciHal_WriterThread.h"
+
+#define NCI_DATA_HDR_LEN 3
+#define NCI_DATA_PBF_MASK 0x10
+#define NCI_DATA_CONN_ID_MASK 0x0F
+#define NCI_MT_DATA 0x00
+#define NCI_CONN_STATIC_RF 0x00
+#define NCI_CONN_STATIC_HCI 0x01
+/* Initial credits of a connection not using data flow control */
+#define NCI_CONN_NO_FLOW_CONTROL 0xFF
+/* Credits kept below NCI_CONN_NO_FLOW_CONTROL if over returned */
+#define NCI_CONN_MAX_CREDITS 0xFE
+/* Queued segments per connection */
+#define NCI_CONN_MAX_PENDING 64
+
+/* CORE_INIT_RSP (NCI 2.0): static HCI connection payload and credits */
+#define CORE_INIT_RSP_HCI_PAYLOAD_INDEX 12
+#define CORE_INIT_RSP_HCI_CREDITS_INDEX 13
+/* RF_INTF_ACTIVATED_NTF: static RF connection payload and credits */
+#define RF_INTF_ACTIVATED_PAYLOAD_INDEX 7
+#define RF_INTF_ACTIVATED_CREDITS_INDEX 8
+/* CORE_CONN_CREATE_RSP: status, payload, credits, connection ID */
+#define CONN_CREATE_RSP_PAYLOAD_INDEX 4
+#define CONN_CREATE_RSP_CREDITS_INDEX 5
+#define CONN_CREATE_RSP_CONN_ID_INDEX 6
+/* CORE_CONN_CREDITS_NTF: number of entries, then connection ID/credits */
+#define CONN_CREDITS_NTF_NUM_INDEX 3
+#define CONN_CREDITS_NTF_ENTRY_INDEX 4
+
+extern phNxpNciHal_Control_t nxpncihal_ctrl;
+
+phNxpNciHal_ConnCredits::phNxpNciHal_ConnCredits() : mEnabled(false) {
+  for (auto& conn : mConns) {
+    conn.tracked = false;
+    conn.maxPayload = 0;
+    conn.credits = 0;
+    conn.posted = 0;
+  }
+}
+
+phNxpNciHal_ConnCredits& phNxpNciHal_ConnCredits::getInstance() {
+  static phNxpNciHal_ConnCredits instance;
+  return instance;
+}
+
+void phNxpNciHal_ConnCredits::Init() {
+  unsigned long num = 0;
+  bool enable = GetNxpNumValue(NAME_NXP_CONN_CREDIT_FLOW_CONTROL, &num,
+                               sizeof(num)) &&
+                num != 0;
+
+  std::lock_guard<std::mutex> lock(mLock);
+  mEnabled = enable;
+  for (uint8_t connId = 0; connId < NCI_CONN_MAX_COUNT; connId++) {
+    CloseConn(connId);
+  }
+  NXPLOG_NCIHAL_D("%s: flow control %s", __func__,
+                  mEnabled ? "enabled" : "disabled");
+}
+
+int phNxpNciHal_ConnCredits::Write(uint16_t data_len, const uint8_t* p_data) {
+  if (data_len < NCI_DATA_HDR_LEN ||
+      (p_data[0] & NCI_MT_MASK) != NCI_MT_DATA) {
+    return phNxpNciHal_write_internal(data_len, p_data);
+  }
+  const uint8_t connId = p_data[0] & NCI_DATA_CONN_ID_MASK;
+  uint16_t payloadLen = data_len - NCI_DATA_HDR_LEN;
+  std::vector<std::vector<uint8_t>> send;
+  std::vector<std::vector<uint8_t>> post;
+  bool sendAsIs = false;
+  /* Segments granted here are written before the ones released later */
+  std::lock_guard<std::mutex> writeLock(mWriteLock);
+  {
+    std::lock_guard<std::mutex> lock(mLock);
+    tConnState& conn = mConns[connId];
+    if (!mEnabled || conn.maxPayload == 0 ||
+        (!conn.tracked && payloadLen <= conn.maxPayload)) {
+      sendAsIs = true;
+    } else if (payloadLen <= conn.maxPayload && conn.pending.empty() &&
+               conn.posted == 0 && conn.credits > 0) {
+      /* Common case: a single segment with a credit left */
+      conn.credits--;
+      sendAsIs = true;
+    } else {
+      size_t segments = (payloadLen + conn.maxPayload - 1) / conn.maxPayload;
+      if (segments == 0) segments = 1;
+      if (conn.pending.size() + segments > NCI_CONN_MAX_PENDING) {
+        NXPLOG_NCIHAL_E("%s: conn 0x%x queue full, %zu pending", __func__,
+                        connId, conn.pending.size());
+        return 0;
+      }
+      uint16_t offset = 0;
+      do {
+        uint8_t len = (uint8_t)std::min<uint16_t>(payloadLen - offset,
+                                                  conn.maxPayload);
+        bool last = (offset + len == payloadLen);
+        std::vector<uint8_t> segment(NCI_DATA_HDR_LEN + len);
+        /* The last segment keeps the PBF of the packet from libnfc */
+        segment[0] = last ? p_data[0] : (p_data[0] | NCI_DATA_PBF_MASK);
+        segment[1] = p_data[1];
+        segment[2] = len;
+        memcpy(&segment[NCI_DATA_HDR_LEN],
+               &p_data[NCI_DATA_HDR_LEN + offset], len);
+        offset += len;
+        if (!conn.tracked || (conn.pending.empty() && conn.credits > 0)) {
+          if (conn.tracked) conn.credits--;
+          if (conn.posted > 0) {
+            /* Behind segments posted to the writer thread */
+            conn.posted++;
+            post.push_back(std::move(segment));
+          } else {
+            send.push_back(std::move(segment));
+          }
+        } else {
+          conn.pending.push_back(std::move(segment));
+        }
+      } while (offset < payloadLen);
+      NXPLOG_NCIHAL_D("%s: conn 0x%x %zu segments, %zu queued", __func__,
+                      connId, segments, conn.pending.size());
+    }
+  }
+  if (sendAsIs) return phNxpNciHal_write_internal(data_len, p_data);
+
+  for (auto& segment : send) {
+    if (phNxpNciHal_write_internal(segment.size(), segment.data()) !=
+        (int)segment.size()) {
+      return 0;
+    }
+  }
+  Post(post);
+  return data_len;
+}
+
+void phNxpNciHal_ConnCredits::WritePosted(uint16_t data_len,
+                                          const uint8_t* p_data) {
+  const uint8_t connId = p_data[0] & NCI_DATA_CONN_ID_MASK;
+  std::lock_guard<std::mutex> writeLock(mWriteLock);
+  {
+    std::lock_guard<std::mutex> lock(mLock);
+    tConnState& conn = mConns[connId];
+    if (conn.maxPayload == 0) {
+      NXPLOG_NCIHAL_W("%s: conn 0x%x closed, segment dropped", __func__,
+                      connId);
+      return;
+    }
+  }
+  if (phNxpNciHal_write_internal(data_len, p_data) != data_len) {
+    NXPLOG_NCIHAL_E("%s: conn 0x%x write failed", __func__, connId);
+  }
+  std::lock_guard<std::mutex> lock(mLock);
+  tConnState& conn = mConns[connId];
+  if (conn.posted > 0) conn.posted--;
+}
+
+void phNxpNciHal_ConnCredits::Post(
+    std::vector<std::vector<uint8_t>>& segments) {
+  for (auto& segment : segments) {
+    phLibNfc_Message_t msg;
+    msg.eMsgType = NCI_HAL_TML_WRITE_DATA_MSG;
+    msg.pMsgData = NULL;
+    msg.w_status = 0;
+    msg.Size = segment.size();
+    memcpy(msg.data, segment.data(), segment.size());
+    if (!phNxpNciHal_WriterThread::getInstance().Post(msg)) {
+      NXPLOG_NCIHAL_E("%s: failed to post segment", __func__);
+      std::lock_guard<std::mutex> lock(mLock);
+      tConnState& conn = mConns[segment[0] & NCI_DATA_CONN_ID_MASK];
+      if (conn.posted > 0) conn.posted--;
+    }
+  }
+}
+
+void phNxpNciHal_ConnCredits::OnCmdSent(const uint8_t* p_cmd,
+                                        uint16_t cmd_len) {
+  if (cmd_len < 4 || p_cmd[0] != (NCI_MT_CMD | NCI_GID_CORE) ||
+      p_cmd[1] != NCI_MSG_CORE_CONN_CLOSE) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mLock);
+  CloseConn(p_cmd[3] & NCI_DATA_CONN_ID_MASK);
+}
+
+void phNxpNciHal_ConnCredits::OnPktReceived(const uint8_t* p_pkt,
+                                            uint16_t pkt_len) {
+  if (pkt_len < 4 || (p_pkt[0] & NCI_MT_MASK) == NCI_MT_DATA) return;
+  std::vector<std::vector<uint8_t>> release;
+  {
+    std::lock_guard<std::mutex> lock(mLock);
+    if (!mEnabled) return;
+
+    const uint8_t mtGid = p_pkt[0];
+    const uint8_t oid = p_pkt[1] & NCI_OID_MASK;
+    if (mtGid == (NCI_MT_RSP | NCI_GID_CORE)) {
+      if (oid == NCI_MSG_CORE_RESET) {
+        for (uint8_t connId = 0; connId < NCI_CONN_MAX_COUNT; connId++) {
+          CloseConn(connId);
+        }
+      } else if (oid == NCI_MSG_CORE_INIT && p_pkt[3] == NFCSTATUS_SUCCESS &&
+                 pkt_len > CORE_INIT_RSP_HCI_CREDITS_INDEX &&
+                 nxpncihal_ctrl.nci_info.nci_version >= NCI_VERSION_2_0) {
+        OpenConn(NCI_CONN_STATIC_HCI, p_pkt[CORE_INIT_RSP_HCI_PAYLOAD_INDEX],
+                 p_pkt[CORE_INIT_RSP_HCI_CREDITS_INDEX]);
+      } else if (oid == NCI_MSG_CORE_CONN_CREATE &&
+                 p_pkt[3] == NFCSTATUS_SUCCESS &&
+                 pkt_len > CONN_CREATE_RSP_CONN_ID_INDEX) {
+        OpenConn(p_pkt[CONN_CREATE_RSP_CONN_ID_INDEX] & NCI_DATA_CONN_ID_MASK,
+                 p_pkt[CONN_CREATE_RSP_PAYLOAD_INDEX],
+                 p_pkt[CONN_CREATE_RSP_CREDITS_INDEX]);
+      }
+    } else if (mtGid == (NCI_MT_NTF | NCI_GID_CORE)) {
+      if (oid == NCI_MSG_CORE_RESET) {
+        for (uint8_t connId = 0; connId < NCI_CONN_MAX_COUNT; connId++) {
+          CloseConn(connId);
+        }
+      } else if (oid == NCI_MSG_CORE_CONN_CREDITS) {
+        uint8_t num = p_pkt[CONN_CREDITS_NTF_NUM_INDEX];
+        for (uint16_t i = CONN_CREDITS_NTF_ENTRY_INDEX;
+             num > 0 && i + 1 < pkt_len; i += 2, num--) {
+          AddCredits(p_pkt[i] & NCI_DATA_CONN_ID_MASK, p_pkt[i + 1], release);
+        }
+      }
+    } else if (mtGid == (NCI_MT_NTF | NCI_GID_RF_MANAGE)) {
+      if (oid == NCI_MSG_RF_INTF_ACTIVATED &&
+          pkt_len > RF_INTF_ACTIVATED_CREDITS_INDEX) {
+        OpenConn(NCI_CONN_STATIC_RF, p_pkt[RF_INTF_ACTIVATED_PAYLOAD_INDEX],
+                 p_pkt[RF_INTF_ACTIVATED_CREDITS_INDEX]);
+      } else if (oid == NCI_MSG_RF_DEACTIVATE) {
+        CloseConn(NCI_CONN_STATIC_RF);
+      }
+    }
+  }
+  /* The client thread must not block on the write path */
+  Post(release);
+}
+
+void phNxpNciHal_ConnCredits::OpenConn(uint8_t connId, uint8_t maxPayload,
+                                       uint8_t credits) {
+  tConnState& conn = mConns[connId];
+  if (!conn.pending.empty()) {
+    NXPLOG_NCIHAL_W("%s: conn 0x%x dropping %zu segments", __func__, connId,
+                    conn.pending.size());
+    conn.pending.clear();
+  }
+  conn.maxPayload = maxPayload;
+  conn.tracked = (credits != NCI_CONN_NO_FLOW_CONTROL);
+  conn.credits = conn.tracked ? credits : 0;
+  NXPLOG_NCIHAL_D("%s: conn 0x%x payload %d credits %d", __func__, connId,
+                  maxPayload, credits);
+}
+
+void phNxpNciHal_ConnCredits::CloseConn(uint8_t connId) {
+  tConnState& conn = mConns[connId];
+  if (!conn.pending.empty()) {
+    NXPLOG_NCIHAL_W("%s: conn 0x%x dropping %zu segments", __func__, connId,
+                    conn.pending.size());
+  }
+  conn.pending.clear();
+  conn.tracked = false;
+  conn.maxPayload = 0;
+  conn.credits = 0;
+  conn.posted = 0;
+}
+
+void phNxpNciHal_ConnCredits::AddCredits(
+    uint8_t connId, uint8_t credits,
+    std::vector<std::vector<uint8_t>>& release) {
+  tConnState& conn = mConns[connId];
+  if (!conn.tracked) return;
+  conn.credits = (uint8_t)std::min<uint16_t>(conn.credits + credits,
+                                             NCI_CONN_MAX_CREDITS);
+  while (conn.credits > 0 && !conn.pending.empty()) {
+    conn.credits--;
+    conn.posted++;
+    release.push_back(std::move(conn.pending.front()));
+    conn.pending.pop_front();
+  }
+}
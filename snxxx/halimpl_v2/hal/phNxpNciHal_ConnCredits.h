@@ -0,0 +1,114 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NXPNCIHALCONNCREDITS_H
+#define NXPNCIHALCONNCREDITS_H
+
+#include <stdint.h>
+
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#define NCI_CONN_MAX_COUNT 16
+
+/******************************************************************************
+ * Class         phNxpNciHal_ConnCredits
+ *
+ * Description   Data flow control of the NCI logical connections. Credits
+ *               and maximum data packet payload of each connection are
+ *               learnt from CORE_INIT_RSP, CORE_CONN_CREATE_RSP and
+ *               RF_INTF_ACTIVATED_NTF, and given back by
+ *               CORE_CONN_CREDITS_NTF.
+ *
+ *               Data packets larger than the connection payload are
+ *               segmented (PBF). Segments are sent as long as credits are
+ *               left, so several are in flight; the others are queued per
+ *               connection and posted to the writer thread as credits come
+ *               back.
+ *
+ *               Enabled by NXP_CONN_CREDIT_FLOW_CONTROL, data packets are
+ *               sent as is otherwise.
+ *
+ ******************************************************************************/
+class phNxpNciHal_ConnCredits {
+ public:
+  static phNxpNciHal_ConnCredits& getInstance();
+
+  phNxpNciHal_ConnCredits(const phNxpNciHal_ConnCredits&) = delete;
+  phNxpNciHal_ConnCredits& operator=(const phNxpNciHal_ConnCredits&) =
+      delete;
+
+  /******************************************************************************
+   * Function:       Init()
+   *
+   * Description:    Reads NXP_CONN_CREDIT_FLOW_CONTROL and forgets every
+   *                 connection.
+   *
+   * Returns:        void
+   ******************************************************************************/
+  void Init();
+
+  /******************************************************************************
+   * Function:       Write()
+   *
+   * Description:    Sends a data packet within the credits of its
+   *                 connection, segmenting it to the connection payload.
+   *                 Segments without credit are queued.
+   *
+   * Returns:        number of bytes accepted, 0 on failure.
+   ******************************************************************************/
+  int Write(uint16_t data_len, const uint8_t* p_data);
+
+  /******************************************************************************
+   * Function:       WritePosted()
+   *
+   * Description:    Writes a segment posted to the writer thread, in the
+   *                 writer thread.
+   *
+   * Returns:        void
+   ******************************************************************************/
+  void WritePosted(uint16_t data_len, const uint8_t* p_data);
+
+  /* Hooks for every NCI command written and every packet read */
+  void OnCmdSent(const uint8_t* p_cmd, uint16_t cmd_len);
+  void OnPktReceived(const uint8_t* p_pkt, uint16_t pkt_len);
+
+ private:
+  typedef struct {
+    bool tracked;       /* flow control is used on the connection */
+    uint8_t maxPayload; /* max data packet payload */
+    uint8_t credits;
+    uint8_t posted; /* segments posted to the writer thread, not written */
+    std::deque<std::vector<uint8_t>> pending;
+  } tConnState;
+
+  phNxpNciHal_ConnCredits();
+
+  void OpenConn(uint8_t connId, uint8_t maxPayload, uint8_t credits);
+  void CloseConn(uint8_t connId);
+  void Post(std::vector<std::vector<uint8_t>>& segments);
+  void AddCredits(uint8_t connId, uint8_t credits,
+                  std::vector<std::vector<uint8_t>>& release);
+
+  std::mutex mLock;
+  /* Keeps the segments of a connection in order on the write path */
+  std::mutex mWriteLock;
+  bool mEnabled;
+  tConnState mConns[NCI_CONN_MAX_COUNT];
+};
+
+#endif  // NXPNCIHALCONNCREDITS_H
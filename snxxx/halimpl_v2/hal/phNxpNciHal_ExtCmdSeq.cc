@@ -0,0 +1,39 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "phNxpNciHal_ExtCmdSeq.h"
+
+#include <phNxpLog.h>
+
+NFCSTATUS phNxpNciHal_send_ext_cmd_seq(
+    const std::vector<phNxpNciHal_ExtCmd>& seq) {
+  NFCSTATUS seqStatus = NFCSTATUS_SUCCESS;
+  uint8_t rsp[NCI_MAX_DATA_LEN];
+
+  for (size_t i = 0; i < seq.size(); i++) {
+    uint16_t rsp_len = 0;
+    NFCSTATUS status = phNxpNciHal_send_ext_cmd_timeout(
+        (uint16_t)seq[i].cmd.size(), (uint8_t*)seq[i].cmd.data(), &rsp_len,
+        rsp, seq[i].timeout_ms);
+    if (status != NFCSTATUS_SUCCESS) {
+      NXPLOG_NCIHAL_E("%s: command %zu of %zu failed, status=0x%x", __func__,
+                      i + 1, seq.size(), status);
+      if (seqStatus == NFCSTATUS_SUCCESS) seqStatus = status;
+      if (seq[i].stop_on_failure) break;
+    }
+  }
+  return seqStatus;
+}
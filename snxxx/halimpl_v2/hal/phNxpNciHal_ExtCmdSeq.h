@@ -0,0 +1,50 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NXPNCIHALEXTCMDSEQ_H
+#define NXPNCIHALEXTCMDSEQ_H
+
+#include <vector>
+
+#include "phNxpNciHal_ext.h"
+
+/* One HAL extension command of a sequence */
+struct phNxpNciHal_ExtCmd {
+  std::vector<uint8_t> cmd;
+  /* Timeout for the response and, if expected, for the notification */
+  uint32_t timeout_ms = HAL_EXTNS_WRITE_RSP_TIMEOUT;
+  /* Abort the rest of the sequence if this command fails */
+  bool stop_on_failure = true;
+};
+
+/******************************************************************************
+ * Function         phNxpNciHal_send_ext_cmd_seq
+ *
+ * Description      Sends a sequence of HAL extension commands back to back on
+ *                  the calling thread, each with its own timeout. Meant for
+ *                  callers which already hold CONCURRENCY_LOCK, e.g. open and
+ *                  core initialization. There is no queued variant: NCI
+ *                  allows one outstanding command and every caller needs the
+ *                  result before going on.
+ *
+ * Returns          NFCSTATUS_SUCCESS if every command succeeded, else the
+ *                  status of the first failing command.
+ *
+ ******************************************************************************/
+NFCSTATUS phNxpNciHal_send_ext_cmd_seq(
+    const std::vector<phNxpNciHal_ExtCmd>& seq);
+
+#endif  // NXPNCIHALEXTCMDSEQ_H
@@ -26,13 +26,15 @@
 #include <phNxpNciHal.h>
 #include <phNxpNciHal_ext.h>
 #include <phTmlNfc.h>
+#include <poll.h>
 
 #include "NfcExtension.h"
+#include "NxpNfcLatencyStats.h"
 
 extern phNxpNciHal_Control_t nxpncihal_ctrl;
 
 phNxpNciHal_ReaderThread::phNxpNciHal_ReaderThread()
-    : reader_thread(0), thread_running(false) {}
+    : reader_thread(0), thread_running(false), event_loop(false) {}
 
 phNxpNciHal_ReaderThread::~phNxpNciHal_ReaderThread() { Stop(); }
 
@@ -41,12 +43,13 @@ phNxpNciHal_ReaderThread& phNxpNciHal_ReaderThread::getInstance() {
   return instance;
 }
 
-bool phNxpNciHal_ReaderThread::Start() {
+bool phNxpNciHal_ReaderThread::Start(bool eventLoop) {
   /* The thread_running.load() and thread_running.store() methods are
      part of the C++11 std::atomic class. These methods are used to
      perform atomic operations on variables, which ensures that the
      operations are thread-safe without needing explicit locks or mutexes */
   if (!thread_running.load()) {
+    event_loop = eventLoop;
     thread_running.store(true);
     int val = pthread_create(&reader_thread, NULL,
                              phNxpNciHal_ReaderThread::ReaderThread, this);
@@ -81,6 +84,11 @@ void phNxpNciHal_ReaderThread::Run() {
   phLibNfc_Message_t msg;
   NXPLOG_NCIHAL_D("HAL Reader thread started");
 
+  if (event_loop) {
+    RunEventLoop();
+    return;
+  }
+
   while (thread_running.load()) {
     memset(&msg, 0x00, sizeof(phLibNfc_Message_t));
     if (phDal4Nfc_msgrcv(nxpncihal_ctrl.gDrvCfg.nClientId, &msg, 0, 0) == -1) {
@@ -92,138 +100,207 @@ void phNxpNciHal_ReaderThread::Run() {
       break;
     }
 
-    switch (msg.eMsgType) {
-      case NCI_HAL_OEM_RSP_NTF_MSG: {
-        REENTRANCE_LOCK();
-        phLibNfc_DeferredCall_t* deferCall =
-            (phLibNfc_DeferredCall_t*)(msg.pMsgData);
-        phTmlNfc_TransactInfo_t* pInfo =
-            (phTmlNfc_TransactInfo_t*)deferCall->pParameter;
-        if (nxpncihal_ctrl.p_nfc_stack_data_cback != NULL) {
-          (*nxpncihal_ctrl.p_nfc_stack_data_cback)(pInfo->wLength,
-                                                   pInfo->pBuff);
-        }
-        REENTRANCE_UNLOCK();
-        break;
+    HandleMessage(msg);
+  }
+  return;
+}
+
+/******************************************************************************
+ * Function:       RunEventLoop()
+ *
+ * Description:    Event loop mode: waits on the client queue and on the NFCC
+ *                 read pending in the TML at once. Packets are read and their
+ *                 completion invoked on this thread, without the TML reader
+ *                 thread and the post through the client queue in between.
+ *
+ * Returns:        void
+ ******************************************************************************/
+void phNxpNciHal_ReaderThread::RunEventLoop() {
+  const intptr_t queue = nxpncihal_ctrl.gDrvCfg.nClientId;
+  phLibNfc_Message_t msg;
+  uint32_t backoffMs = 0;
+  NXPLOG_NCIHAL_D("HAL Reader thread running the event loop");
+
+  while (thread_running.load()) {
+    while (thread_running.load() && phDal4Nfc_msgtryrcv(queue, &msg) == 0) {
+      HandleMessage(msg);
+    }
+    if (!thread_running.load()) {
+      break;
+    }
+
+    /* Armed before the read state is fetched: a read enabled from now on
+     * signals the queue eventfd */
+    bool idle = phDal4Nfc_msgarm(queue);
+    struct pollfd fds[2] = {
+        {phDal4Nfc_msgfd(queue), POLLIN, 0},
+        {(backoffMs == 0) ? phTmlNfc_EventLoopGetReadFd() : -1, POLLIN, 0},
+    };
+    int timeoutMs = !idle ? 0 : (backoffMs != 0) ? (int)backoffMs : -1;
+    int ret = poll(fds, 2, timeoutMs);
+    phDal4Nfc_msgdisarm(queue, (ret > 0) && (fds[0].revents & POLLIN));
+    /* Read errors only delay the next read until the queue is served */
+    backoffMs = 0;
+    if (ret < 0) {
+      if (errno != EINTR) {
+        NXPLOG_NCIHAL_E("NFC reader poll failed errno = %d", errno);
       }
-      case PH_LIBNFC_DEFERREDCALL_MSG: {
+      continue;
+    }
+
+    if ((ret > 0) && (fds[1].revents != 0)) {
+      phLibNfc_DeferredCall_t* deferCall = phTmlNfc_EventLoopRead(&backoffMs);
+      if (deferCall != NULL) {
+        /* Same as a posted TML read completion */
+        NfcHalLatencyStats::getInstance().markDequeue();
         REENTRANCE_LOCK();
-        phLibNfc_DeferredCall_t* deferCall =
-            (phLibNfc_DeferredCall_t*)(msg.pMsgData);
-
-        phTmlNfc_TransactInfo_t transact_info;
-        phTmlNfc_TransactInfo_t* ptransact_info = &transact_info;
-        if (ptransact_info != NULL && msg.Size > 0) {
-          ptransact_info->pBuff = msg.data;
-          ptransact_info->wLength = msg.Size;
-          ptransact_info->wStatus = msg.w_status;
-          deferCall->pCallback(ptransact_info);
-        } else {
-          NXPLOG_NCIHAL_D("Processing the response timeout");
-          deferCall->pCallback(deferCall->pParameter);
-        }
+        deferCall->pCallback(deferCall->pParameter);
         REENTRANCE_UNLOCK();
-        break;
       }
+    }
+  }
+  return;
+}
 
-      case NCI_HAL_OPEN_CPLT_MSG: {
-        REENTRANCE_LOCK();
-        phNxpExtn_HandleHalEvent(HAL_NFC_OPEN_CPLT_EVT);
-        if (nxpncihal_ctrl.p_nfc_stack_cback != NULL) {
-          /* Send the event */
-          (*nxpncihal_ctrl.p_nfc_stack_cback)(HAL_NFC_OPEN_CPLT_EVT,
-                                              HAL_NFC_STATUS_OK);
-        }
-        REENTRANCE_UNLOCK();
-        break;
+/******************************************************************************
+ * Function:       HandleMessage()
+ *
+ * Description:    Handles a message of the client queue.
+ *
+ * Returns:        void
+ ******************************************************************************/
+void phNxpNciHal_ReaderThread::HandleMessage(phLibNfc_Message_t& msg) {
+  switch (msg.eMsgType) {
+    case NCI_HAL_OEM_RSP_NTF_MSG: {
+      REENTRANCE_LOCK();
+      phLibNfc_DeferredCall_t* deferCall =
+          (phLibNfc_DeferredCall_t*)(msg.pMsgData);
+      phTmlNfc_TransactInfo_t* pInfo =
+          (phTmlNfc_TransactInfo_t*)deferCall->pParameter;
+      if (nxpncihal_ctrl.p_nfc_stack_data_cback != NULL) {
+        (*nxpncihal_ctrl.p_nfc_stack_data_cback)(pInfo->wLength, pInfo->pBuff);
       }
+      REENTRANCE_UNLOCK();
+      break;
+    }
+    case PH_LIBNFC_DEFERREDCALL_MSG: {
+      NfcHalLatencyStats::getInstance().markDequeue();
+      REENTRANCE_LOCK();
+      phLibNfc_DeferredCall_t* deferCall =
+          (phLibNfc_DeferredCall_t*)(msg.pMsgData);
 
-      case NCI_HAL_CLOSE_CPLT_MSG: {
-        REENTRANCE_LOCK();
-        if (nxpncihal_ctrl.p_nfc_stack_cback != NULL) {
-          /* Send the event */
-          (*nxpncihal_ctrl.p_nfc_stack_cback)(HAL_NFC_CLOSE_CPLT_EVT,
-                                              HAL_NFC_STATUS_OK);
-        }
-        Stop();
-        REENTRANCE_UNLOCK();
-        break;
+      phTmlNfc_TransactInfo_t transact_info;
+      phTmlNfc_TransactInfo_t* ptransact_info = &transact_info;
+      if (ptransact_info != NULL && msg.Size > 0) {
+        ptransact_info->pBuff = msg.data;
+        ptransact_info->wLength = msg.Size;
+        ptransact_info->wStatus = msg.w_status;
+        deferCall->pCallback(ptransact_info);
+      } else {
+        /* Timer expiry or TML read completion, the parameter carries the
+         * context (pooled RX buffer for reads) */
+        deferCall->pCallback(deferCall->pParameter);
       }
+      REENTRANCE_UNLOCK();
+      break;
+    }
 
-      case NCI_HAL_POST_INIT_CPLT_MSG: {
-        REENTRANCE_LOCK();
-        if (nxpncihal_ctrl.p_nfc_stack_cback != NULL) {
-          /* Send the event */
-          (*nxpncihal_ctrl.p_nfc_stack_cback)(HAL_NFC_POST_INIT_CPLT_EVT,
-                                              HAL_NFC_STATUS_OK);
-        }
-        REENTRANCE_UNLOCK();
-        break;
+    case NCI_HAL_OPEN_CPLT_MSG: {
+      REENTRANCE_LOCK();
+      phNxpExtn_HandleHalEvent(HAL_NFC_OPEN_CPLT_EVT);
+      if (nxpncihal_ctrl.p_nfc_stack_cback != NULL) {
+        /* Send the event */
+        (*nxpncihal_ctrl.p_nfc_stack_cback)(HAL_NFC_OPEN_CPLT_EVT,
+                                            HAL_NFC_STATUS_OK);
       }
+      REENTRANCE_UNLOCK();
+      break;
+    }
 
-      case NCI_HAL_PRE_DISCOVER_CPLT_MSG: {
-        REENTRANCE_LOCK();
-        if (nxpncihal_ctrl.p_nfc_stack_cback != NULL) {
-          /* Send the event */
-          (*nxpncihal_ctrl.p_nfc_stack_cback)(HAL_NFC_PRE_DISCOVER_CPLT_EVT,
-                                              HAL_NFC_STATUS_OK);
-        }
-        REENTRANCE_UNLOCK();
-        break;
+    case NCI_HAL_CLOSE_CPLT_MSG: {
+      REENTRANCE_LOCK();
+      if (nxpncihal_ctrl.p_nfc_stack_cback != NULL) {
+        /* Send the event */
+        (*nxpncihal_ctrl.p_nfc_stack_cback)(HAL_NFC_CLOSE_CPLT_EVT,
+                                            HAL_NFC_STATUS_OK);
       }
+      Stop();
+      REENTRANCE_UNLOCK();
+      break;
+    }
 
-      case NCI_HAL_HCI_NETWORK_RESET_MSG: {
-        REENTRANCE_LOCK();
-        if (nxpncihal_ctrl.p_nfc_stack_cback != NULL) {
-          /* Send the event */
-          (*nxpncihal_ctrl.p_nfc_stack_cback)(
-              (uint32_t)HAL_HCI_NETWORK_RESET_EVT, HAL_NFC_STATUS_OK);
-        }
-        REENTRANCE_UNLOCK();
-        break;
+    case NCI_HAL_POST_INIT_CPLT_MSG: {
+      REENTRANCE_LOCK();
+      if (nxpncihal_ctrl.p_nfc_stack_cback != NULL) {
+        /* Send the event */
+        (*nxpncihal_ctrl.p_nfc_stack_cback)(HAL_NFC_POST_INIT_CPLT_EVT,
+                                            HAL_NFC_STATUS_OK);
       }
+      REENTRANCE_UNLOCK();
+      break;
+    }
 
-      case NCI_HAL_ERROR_MSG: {
-        REENTRANCE_LOCK();
-        phNxpExtn_HandleHalEvent(NFCC_HAL_TRANS_ERR_CODE);
-        if (nxpncihal_ctrl.p_nfc_stack_cback != NULL) {
-          /* Send the event */
-          (*nxpncihal_ctrl.p_nfc_stack_cback)(HAL_NFC_ERROR_EVT,
-                                              HAL_NFC_STATUS_FAILED);
-        }
-        REENTRANCE_UNLOCK();
-        break;
+    case NCI_HAL_PRE_DISCOVER_CPLT_MSG: {
+      REENTRANCE_LOCK();
+      if (nxpncihal_ctrl.p_nfc_stack_cback != NULL) {
+        /* Send the event */
+        (*nxpncihal_ctrl.p_nfc_stack_cback)(HAL_NFC_PRE_DISCOVER_CPLT_EVT,
+                                            HAL_NFC_STATUS_OK);
       }
+      REENTRANCE_UNLOCK();
+      break;
+    }
 
-      case NCI_HAL_RX_MSG: {
-        REENTRANCE_LOCK();
-        if (nxpncihal_ctrl.p_nfc_stack_data_cback != NULL) {
-          (*nxpncihal_ctrl.p_nfc_stack_data_cback)(nxpncihal_ctrl.rsp_len,
-                                                   nxpncihal_ctrl.p_rsp_data);
-        }
-        REENTRANCE_UNLOCK();
-        break;
+    case NCI_HAL_HCI_NETWORK_RESET_MSG: {
+      REENTRANCE_LOCK();
+      if (nxpncihal_ctrl.p_nfc_stack_cback != NULL) {
+        /* Send the event */
+        (*nxpncihal_ctrl.p_nfc_stack_cback)(
+            (uint32_t)HAL_HCI_NETWORK_RESET_EVT, HAL_NFC_STATUS_OK);
       }
-      case NCI_HAL_VENDOR_MSG: {
-        REENTRANCE_LOCK();
-        if (nxpncihal_ctrl.p_nfc_stack_data_cback != NULL) {
-          (*nxpncihal_ctrl.p_nfc_stack_data_cback)(
-              nxpncihal_ctrl.vendor_msg_len, nxpncihal_ctrl.vendor_msg);
-        }
-        REENTRANCE_UNLOCK();
-        break;
+      REENTRANCE_UNLOCK();
+      break;
+    }
+
+    case NCI_HAL_ERROR_MSG: {
+      REENTRANCE_LOCK();
+      phNxpExtn_HandleHalEvent(NFCC_HAL_TRANS_ERR_CODE);
+      if (nxpncihal_ctrl.p_nfc_stack_cback != NULL) {
+        /* Send the event */
+        (*nxpncihal_ctrl.p_nfc_stack_cback)(HAL_NFC_ERROR_EVT,
+                                            HAL_NFC_STATUS_FAILED);
       }
-      case HAL_NFC_FW_UPDATE_STATUS_EVT: {
-        REENTRANCE_LOCK();
-        if (nxpncihal_ctrl.p_nfc_stack_cback != NULL) {
-          /* Send the event */
-          (*nxpncihal_ctrl.p_nfc_stack_cback)(msg.eMsgType,
-                                              *((uint8_t*)msg.pMsgData));
-        }
-        REENTRANCE_UNLOCK();
-        break;
+      REENTRANCE_UNLOCK();
+      break;
+    }
+
+    case NCI_HAL_RX_MSG: {
+      REENTRANCE_LOCK();
+      if (nxpncihal_ctrl.p_nfc_stack_data_cback != NULL) {
+        (*nxpncihal_ctrl.p_nfc_stack_data_cback)(nxpncihal_ctrl.rsp_len,
+                                                 nxpncihal_ctrl.p_rsp_data);
       }
+      REENTRANCE_UNLOCK();
+      break;
+    }
+    case NCI_HAL_VENDOR_MSG: {
+      REENTRANCE_LOCK();
+      if (nxpncihal_ctrl.p_nfc_stack_data_cback != NULL) {
+        (*nxpncihal_ctrl.p_nfc_stack_data_cback)(
+            nxpncihal_ctrl.vendor_msg_len, nxpncihal_ctrl.vendor_msg);
+      }
+      REENTRANCE_UNLOCK();
+      break;
+    }
+    case HAL_NFC_FW_UPDATE_STATUS_EVT: {
+      REENTRANCE_LOCK();
+      if (nxpncihal_ctrl.p_nfc_stack_cback != NULL) {
+        /* Send the event */
+        (*nxpncihal_ctrl.p_nfc_stack_cback)(msg.eMsgType,
+                                            *((uint8_t*)msg.pMsgData));
+      }
+      REENTRANCE_UNLOCK();
+      break;
     }
   }
-  return;
 }
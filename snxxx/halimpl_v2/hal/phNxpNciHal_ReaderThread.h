@@ -17,6 +17,7 @@
 #ifndef NXPNCIHALREADER_H
 #define NXPNCIHALREADER_H
 
+#include <phNfcTypes.h>
 #include <pthread.h>
 
 #include <atomic>
@@ -34,11 +35,23 @@ class phNxpNciHal_ReaderThread {
    *
    * Description:    This method creates & initiates the reader thread for
    *                 handling NFCC communication.
+   *                 In event loop mode the thread also polls and reads the
+   *                 NFCC in place of the TML reader thread.
    *
    * Returns:        bool: True if the reader thread was successfully started
    *                 otherwise false.
    ******************************************************************************/
-  bool Start();
+  bool Start(bool eventLoop = false);
+
+  /******************************************************************************
+   * Function:       IsEventLoopMode()
+   *
+   * Description:    Tells whether the started thread runs the event loop, for
+   *                 the TML to be configured accordingly.
+   *
+   * Returns:        bool: True in event loop mode otherwise false.
+   ******************************************************************************/
+  bool IsEventLoopMode() const { return event_loop; }
 
   /******************************************************************************
    * Function:       Stop()
@@ -56,7 +69,10 @@ class phNxpNciHal_ReaderThread {
 
   static void* ReaderThread(void* arg);
   void Run();
+  void RunEventLoop();
+  void HandleMessage(phLibNfc_Message_t& msg);
   pthread_t reader_thread;
   volatile std::atomic<bool> thread_running;
+  bool event_loop;
 };
 #endif  // NXPNCIHALREADER_H
@@ -0,0 +1,369 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "phNxpNciHal_SetConfigBatch.h"
+
+#include <phNxpLog.h>
+#include <phNxpNciHal_ext.h>
+
+#include <algorithm>
+
+#include "NciDef.h"
+#include "phNxpNciHal_ConfigShadow.h"
+
+extern phNxpNciHal_Control_t nxpncihal_ctrl;
+
+#define NCI_MODE_HEADER_LEN 3
+/* CORE_SET_CONFIG/CORE_GET_CONFIG: header, length, status/num params */
+#define SET_CFG_HDR_LEN 0x04
+#define CFG_RSP_STATUS_INDEX 0x03
+#define CFG_RSP_NUM_INDEX 0x04
+#define CFG_RSP_PARAM_INDEX 0x05
+
+phNxpNciHal_SetConfigBatch::phNxpNciHal_SetConfigBatch()
+    : mStatus(NFCSTATUS_SUCCESS) {}
+
+uint8_t phNxpNciHal_SetConfigBatch::MaxPayload() {
+  uint8_t max = nxpncihal_ctrl.nci_info.max_ctrl_payload;
+  return (max != 0) ? max : NCI_DEFAULT_MAX_CTRL_PAYLOAD;
+}
+
+uint16_t phNxpNciHal_SetConfigBatch::ParseId(const uint8_t* p, uint16_t len) {
+  if (len < 1) return 0xFFFF;
+  if ((p[0] & 0xF0) != NXP_NFC_SET_CONFIG_PARAM_EXT) return p[0];
+  if (len < 2) return 0xFFFF;
+  return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+NFCSTATUS phNxpNciHal_SetConfigBatch::Queue(Param&& param) {
+  /* num params + id + len + value must fit in one command */
+  if (1 + IdLen(param.id) + 1 + param.val.size() > MaxPayload()) {
+    NXPLOG_NCIHAL_E("%s: param 0x%04x len %zu does not fit", __func__,
+                    param.id, param.val.size());
+    if (param.p_status != nullptr) {
+      *param.p_status = NFCSTATUS_INVALID_PARAMETER;
+    }
+    return NFCSTATUS_INVALID_PARAMETER;
+  }
+  if (param.p_status != nullptr) *param.p_status = NFCSTATUS_PENDING;
+  mParams.push_back(std::move(param));
+  return NFCSTATUS_PENDING;
+}
+
+NFCSTATUS phNxpNciHal_SetConfigBatch::Add(uint16_t id, const uint8_t* p_val,
+                                          uint8_t len, NFCSTATUS* p_status,
+                                          bool onlyIfChanged) {
+  Param param = {.id = id,
+                 .val = std::vector<uint8_t>(p_val, p_val + len),
+                 .p_status = p_status,
+                 .read = onlyIfChanged,
+                 .modify = false,
+                 .offset = 0,
+                 .mask = 0,
+                 .write = true};
+  return Queue(std::move(param));
+}
+
+NFCSTATUS phNxpNciHal_SetConfigBatch::AddBits(uint16_t id, uint8_t offset,
+                                              uint8_t mask, uint8_t bits,
+                                              NFCSTATUS* p_status) {
+  Param param = {.id = id,
+                 .val = std::vector<uint8_t>(1, bits & mask),
+                 .p_status = p_status,
+                 .read = true,
+                 .modify = true,
+                 .offset = offset,
+                 .mask = mask,
+                 .write = false};
+  return Queue(std::move(param));
+}
+
+NFCSTATUS phNxpNciHal_SetConfigBatch::AddCmd(const uint8_t* p_cmd,
+                                             uint16_t cmd_len,
+                                             NFCSTATUS* p_status) {
+  if (cmd_len < SET_CFG_HDR_LEN || p_cmd[0] != NCI_MT_CMD ||
+      p_cmd[1] != NCI_MSG_CORE_SET_CONFIG ||
+      cmd_len != p_cmd[2] + NCI_MODE_HEADER_LEN) {
+    NXPLOG_NCIHAL_E("%s: not a CORE_SET_CONFIG command", __func__);
+    return NFCSTATUS_INVALID_PARAMETER;
+  }
+
+  /* Validate the whole command before queuing anything */
+  std::vector<Param> params;
+  uint16_t i = SET_CFG_HDR_LEN;
+  for (uint8_t n = 0; n < p_cmd[3]; n++) {
+    uint16_t id = ParseId(&p_cmd[i], cmd_len - i);
+    if (id == 0xFFFF) break;
+    i += IdLen(id);
+    if (i >= cmd_len || i + 1 + p_cmd[i] > cmd_len) {
+      i = cmd_len + 1;
+      break;
+    }
+    Param param = {.id = id,
+                   .val = std::vector<uint8_t>(&p_cmd[i + 1],
+                                               &p_cmd[i + 1] + p_cmd[i]),
+                   .p_status = p_status,
+                   .read = false,
+                   .modify = false,
+                   .offset = 0,
+                   .mask = 0,
+                   .write = true};
+    params.push_back(std::move(param));
+    i += 1 + p_cmd[i];
+  }
+  if (i != cmd_len || params.size() != p_cmd[3]) {
+    NXPLOG_NCIHAL_E("%s: malformed CORE_SET_CONFIG command", __func__);
+    return NFCSTATUS_INVALID_PARAMETER;
+  }
+  for (Param& param : params) {
+    NFCSTATUS status = Queue(std::move(param));
+    if (status != NFCSTATUS_PENDING) return status;
+  }
+  return NFCSTATUS_PENDING;
+}
+
+void phNxpNciHal_SetConfigBatch::Resolve(Param& param, NFCSTATUS status) {
+  param.write = false;
+  if (mStatus == NFCSTATUS_SUCCESS) mStatus = status;
+  if (param.p_status == nullptr) return;
+  if (*param.p_status == NFCSTATUS_PENDING ||
+      (*param.p_status == NFCSTATUS_SUCCESS && status != NFCSTATUS_SUCCESS)) {
+    *param.p_status = status;
+  }
+}
+
+void phNxpNciHal_SetConfigBatch::ApplyCurrent(const uint8_t* p_rsp,
+                                              uint16_t rsp_len, size_t first,
+                                              size_t last) {
+  std::vector<bool> matched(last - first, false);
+
+  if (rsp_len > CFG_RSP_PARAM_INDEX && p_rsp[0] == NCI_MT_RSP &&
+      p_rsp[1] == NCI_MSG_CORE_GET_CONFIG) {
+    uint16_t end = std::min<uint16_t>(rsp_len, p_rsp[2] + NCI_MODE_HEADER_LEN);
+    uint16_t i = CFG_RSP_PARAM_INDEX;
+    for (uint8_t n = 0; n < p_rsp[CFG_RSP_NUM_INDEX] && i < end; n++) {
+      uint16_t id = ParseId(&p_rsp[i], end - i);
+      if (id == 0xFFFF) break;
+      i += IdLen(id);
+      if (i >= end || i + 1 + p_rsp[i] > end) break;
+      const uint8_t* p_cur = &p_rsp[i + 1];
+      uint8_t cur_len = p_rsp[i];
+      i += 1 + cur_len;
+      if (cur_len == 0) continue; /* listed as invalid */
+      phNxpNciHal_ConfigShadow::getInstance().Update(id, p_cur, cur_len);
+
+      for (size_t k = first; k < last; k++) {
+        Param& param = mParams[k];
+        if (!param.read || matched[k - first] || param.id != id) continue;
+        matched[k - first] = true;
+        if (param.modify) {
+          if (param.offset >= cur_len) {
+            NXPLOG_NCIHAL_E("%s: param 0x%04x is too short", __func__, id);
+            Resolve(param, NFCSTATUS_FAILED);
+            break;
+          }
+          uint8_t bits = param.val[0];
+          param.val.assign(p_cur, p_cur + cur_len);
+          param.val[param.offset] =
+              (uint8_t)((param.val[param.offset] & ~param.mask) | bits);
+          param.write = (param.val[param.offset] != p_cur[param.offset]);
+        } else {
+          param.write = (param.val.size() != cur_len ||
+                         memcmp(param.val.data(), p_cur, cur_len) != 0);
+        }
+        if (!param.write) Resolve(param, NFCSTATUS_SUCCESS);
+        break;
+      }
+    }
+  }
+
+  for (size_t k = first; k < last; k++) {
+    Param& param = mParams[k];
+    if (!param.read || matched[k - first]) continue;
+    if (param.modify) {
+      /* Nothing to modify without the current value */
+      NXPLOG_NCIHAL_E("%s: failed to read param 0x%04x", __func__, param.id);
+      Resolve(param, NFCSTATUS_FAILED);
+    } else {
+      param.write = true;
+    }
+  }
+}
+
+void phNxpNciHal_SetConfigBatch::ReadCurrent() {
+  uint8_t cmd[NCI_MAX_DATA_LEN];
+  uint8_t rsp[NCI_MAX_DATA_LEN];
+  const uint8_t max = MaxPayload();
+  size_t k = 0;
+
+  while (k < mParams.size()) {
+    if (!mParams[k].read) {
+      k++;
+      continue;
+    }
+    /* Group reads until either the command or the expected response would
+     * not fit in one control packet */
+    size_t first = k, last = k;
+    uint16_t len = SET_CFG_HDR_LEN, rsp_payload = 2;
+    uint8_t num = 0;
+    for (; last < mParams.size(); last++) {
+      const Param& param = mParams[last];
+      if (!param.read) continue;
+      uint16_t val_len = param.modify ? max : param.val.size();
+      uint16_t next_rsp = rsp_payload + IdLen(param.id) + 1 + val_len;
+      if (num > 0 && (len - NCI_MODE_HEADER_LEN + IdLen(param.id) > max ||
+                      next_rsp > max)) {
+        break;
+      }
+      if (param.id > 0xFF) cmd[len++] = (uint8_t)(param.id >> 8);
+      cmd[len++] = (uint8_t)param.id;
+      rsp_payload = next_rsp;
+      num++;
+    }
+    cmd[0] = NCI_MT_CMD;
+    cmd[1] = NCI_MSG_CORE_GET_CONFIG;
+    cmd[2] = (uint8_t)(len - NCI_MODE_HEADER_LEN);
+    cmd[3] = num;
+
+    uint16_t rsp_len = 0;
+    NFCSTATUS status = phNxpNciHal_send_ext_cmd(len, cmd, &rsp_len, rsp);
+    if (status != NFCSTATUS_SUCCESS) {
+      NXPLOG_NCIHAL_E("%s: CORE_GET_CONFIG of %d params failed", __func__,
+                      num);
+    }
+    ApplyCurrent(rsp, rsp_len, first, last);
+    k = last;
+  }
+}
+
+void phNxpNciHal_SetConfigBatch::LookupShadow() {
+  phNxpNciHal_ConfigShadow& shadow = phNxpNciHal_ConfigShadow::getInstance();
+  std::vector<uint8_t> cur;
+  bool verified = false;
+
+  for (Param& param : mParams) {
+    /* Read-modify-writes need the current value anyway */
+    if (IdLen(param.id) != 2 || param.modify ||
+        !shadow.Lookup(param.id, cur, verified)) {
+      continue;
+    }
+    if (param.val != cur) {
+      /* Different value: written without reading it first */
+      param.read = false;
+    } else if (verified) {
+      /* Applied since the HAL started and not reset since */
+      param.read = false;
+      Resolve(param, NFCSTATUS_SUCCESS);
+    } else {
+      /* Only known from the stored shadow: read back once, written only if
+       * the NFCC lost it */
+      param.read = true;
+    }
+  }
+}
+
+void phNxpNciHal_SetConfigBatch::Write(std::vector<Param*>& frame) {
+  uint8_t cmd[NCI_MAX_DATA_LEN];
+  uint8_t rsp[NCI_MAX_DATA_LEN];
+  uint16_t len = SET_CFG_HDR_LEN;
+
+  for (Param* param : frame) {
+    if (param->id > 0xFF) cmd[len++] = (uint8_t)(param->id >> 8);
+    cmd[len++] = (uint8_t)param->id;
+    cmd[len++] = (uint8_t)param->val.size();
+    memcpy(&cmd[len], param->val.data(), param->val.size());
+    len += param->val.size();
+  }
+  cmd[0] = NCI_MT_CMD;
+  cmd[1] = NCI_MSG_CORE_SET_CONFIG;
+  cmd[2] = (uint8_t)(len - NCI_MODE_HEADER_LEN);
+  cmd[3] = (uint8_t)frame.size();
+
+  uint16_t rsp_len = 0;
+  NFCSTATUS status = phNxpNciHal_send_ext_cmd(len, cmd, &rsp_len, rsp);
+  if (rsp_len <= CFG_RSP_NUM_INDEX || rsp[0] != NCI_MT_RSP ||
+      rsp[1] != NCI_MSG_CORE_SET_CONFIG) {
+    /* No usable response, every parameter failed */
+    if (status == NFCSTATUS_SUCCESS) status = NFCSTATUS_FAILED;
+    NXPLOG_NCIHAL_E("%s: CORE_SET_CONFIG of %zu params failed", __func__,
+                    frame.size());
+    for (Param* param : frame) Resolve(*param, status);
+    return;
+  }
+
+  NFCSTATUS nci_status = rsp[CFG_RSP_STATUS_INDEX];
+  uint8_t num = rsp[CFG_RSP_NUM_INDEX];
+  if (nci_status == NFCSTATUS_SUCCESS || num == 0) {
+    for (Param* param : frame) Resolve(*param, nci_status);
+    return;
+  }
+
+  /* The NFCC applied every parameter but the listed ones */
+  std::vector<bool> failed(frame.size(), false);
+  uint16_t end = std::min<uint16_t>(rsp_len, rsp[2] + NCI_MODE_HEADER_LEN);
+  uint16_t i = CFG_RSP_PARAM_INDEX;
+  for (uint8_t n = 0; n < num && i < end; n++) {
+    uint16_t id = ParseId(&rsp[i], end - i);
+    if (id == 0xFFFF) break;
+    i += IdLen(id);
+    NXPLOG_NCIHAL_E("%s: param 0x%04x rejected, status=0x%02x", __func__, id,
+                    nci_status);
+    for (size_t k = 0; k < frame.size(); k++) {
+      if (frame[k]->id == id) failed[k] = true;
+    }
+  }
+  for (size_t k = 0; k < frame.size(); k++) {
+    Resolve(*frame[k], failed[k] ? nci_status : NFCSTATUS_SUCCESS);
+  }
+}
+
+NFCSTATUS phNxpNciHal_SetConfigBatch::Flush() {
+  const uint8_t max = MaxPayload();
+  size_t num_params = mParams.size();
+  size_t num_cmds = 0;
+
+  mStatus = NFCSTATUS_SUCCESS;
+  LookupShadow();
+  ReadCurrent();
+
+  /* Pack in queuing order. A parameter already in the frame starts a new
+   * one so that the later value still wins */
+  std::vector<Param*> frame;
+  uint16_t payload = 1;
+  for (Param& param : mParams) {
+    if (!param.write) continue;
+    uint16_t tlv_len = IdLen(param.id) + 1 + param.val.size();
+    bool dup = std::any_of(frame.begin(), frame.end(),
+                           [&param](Param* p) { return p->id == param.id; });
+    if (!frame.empty() && (dup || payload + tlv_len > max)) {
+      Write(frame);
+      num_cmds++;
+      frame.clear();
+      payload = 1;
+    }
+    frame.push_back(&param);
+    payload += tlv_len;
+  }
+  if (!frame.empty()) {
+    Write(frame);
+    num_cmds++;
+  }
+
+  NXPLOG_NCIHAL_D("%s: %zu params in %zu CORE_SET_CONFIG, status=0x%x",
+                  __func__, num_params, num_cmds, mStatus);
+  mParams.clear();
+  return mStatus;
+}
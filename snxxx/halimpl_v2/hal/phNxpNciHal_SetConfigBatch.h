@@ -0,0 +1,138 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NXPNCIHALSETCONFIGBATCH_H
+#define NXPNCIHALSETCONFIGBATCH_H
+
+#include <vector>
+
+#include "phNfcStatus.h"
+
+/* Max control packet payload used before CORE_INIT_RSP has been seen */
+#define NCI_DEFAULT_MAX_CTRL_PAYLOAD 0xFF
+
+/******************************************************************************
+ * Class         phNxpNciHal_SetConfigBatch
+ *
+ * Description   Collects CORE_SET_CONFIG parameters from several helpers and
+ *               sends them in the fewest CORE_SET_CONFIG commands fitting the
+ *               max control packet payload size reported in CORE_INIT_RSP.
+ *
+ *               Every parameter may carry a status slot owned by the caller.
+ *               It is set to NFCSTATUS_PENDING when the parameter is queued
+ *               and to the parameter status by Flush(): the status of the
+ *               response if the NFCC listed the parameter as invalid or did
+ *               not list any, NFCSTATUS_SUCCESS otherwise. Parameters sharing
+ *               a slot report the first failure.
+ *
+ *               Parameter ids are one byte for NCI parameters and two bytes
+ *               (0xA0xx, 0xA1xx ...) for NXP proprietary ones.
+ *
+ *               Must be flushed with CONCURRENCY_LOCK held, like any other
+ *               phNxpNciHal_send_ext_cmd user.
+ *
+ ******************************************************************************/
+class phNxpNciHal_SetConfigBatch {
+ public:
+  phNxpNciHal_SetConfigBatch();
+
+  /******************************************************************************
+   * Function:       Add()
+   *
+   * Description:    Queues one parameter. With onlyIfChanged the current
+   *                 value is read first, batched as well, and the parameter
+   *                 is not written if it already holds the value.
+   *
+   * Returns:        NFCSTATUS_PENDING, or NFCSTATUS_INVALID_PARAMETER.
+   ******************************************************************************/
+  NFCSTATUS Add(uint16_t id, const uint8_t* p_val, uint8_t len,
+                NFCSTATUS* p_status = nullptr, bool onlyIfChanged = false);
+
+  /******************************************************************************
+   * Function:       AddBits()
+   *
+   * Description:    Queues a read-modify-write of one byte of a parameter:
+   *                 the bits of mask are set to the ones of bits. Nothing is
+   *                 written if they already match.
+   *
+   * Returns:        NFCSTATUS_PENDING.
+   ******************************************************************************/
+  NFCSTATUS AddBits(uint16_t id, uint8_t offset, uint8_t mask, uint8_t bits,
+                    NFCSTATUS* p_status = nullptr);
+
+  /******************************************************************************
+   * Function:       AddCmd()
+   *
+   * Description:    Queues all the parameters of a complete CORE_SET_CONFIG
+   *                 command, e.g. one read from the configuration file.
+   *
+   * Returns:        NFCSTATUS_PENDING, or NFCSTATUS_INVALID_PARAMETER if the
+   *                 command is not a well formed CORE_SET_CONFIG, in which
+   *                 case nothing is queued.
+   ******************************************************************************/
+  NFCSTATUS AddCmd(const uint8_t* p_cmd, uint16_t cmd_len,
+                   NFCSTATUS* p_status = nullptr);
+
+  /******************************************************************************
+   * Function:       Flush()
+   *
+   * Description:    Reads the parameters queued with onlyIfChanged/AddBits,
+   *                 writes the ones which need it and resolves the status
+   *                 slots. The batch is empty afterwards.
+   *                 NXP proprietary parameters already holding the value
+   *                 according to phNxpNciHal_ConfigShadow are skipped when
+   *                 the value was verified since the HAL started, else read
+   *                 back once and only written if they differ, whichever way
+   *                 they were queued.
+   *
+   * Returns:        NFCSTATUS_SUCCESS if all the parameters were applied,
+   *                 else the first failing status.
+   ******************************************************************************/
+  NFCSTATUS Flush();
+
+  bool Empty() const { return mParams.empty(); }
+
+  /* Length of a parameter id and id at p, 0xFFFF if it does not fit in len */
+  static uint8_t IdLen(uint16_t id) { return (id > 0xFF) ? 2 : 1; }
+  static uint16_t ParseId(const uint8_t* p, uint16_t len);
+
+ private:
+  struct Param {
+    uint16_t id;
+    std::vector<uint8_t> val;
+    NFCSTATUS* p_status;
+    bool read;     /* current value is needed before writing */
+    bool modify;   /* val holds the new bits of val[offset] only */
+    uint8_t offset;
+    uint8_t mask;
+    bool write;    /* resolved by the read phase */
+  };
+
+  static uint8_t MaxPayload();
+
+  NFCSTATUS Queue(Param&& param);
+  void Resolve(Param& param, NFCSTATUS status);
+  void LookupShadow();
+  void ReadCurrent();
+  void ApplyCurrent(const uint8_t* p_rsp, uint16_t rsp_len, size_t first,
+                    size_t last);
+  void Write(std::vector<Param*>& frame);
+
+  std::vector<Param> mParams;
+  NFCSTATUS mStatus; /* first failure of the running Flush() */
+};
+
+#endif  // NXPNCIHALSETCONFIGBATCH_H
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "phNxpNciHal_TxClassifier.h"
+
+#include <phNfcNciConstants.h>
+
+#include <array>
+
+#define NCI_TX_MT_PBF_MASK 0xF0
+#define NCI_TX_MT_CMD_NO_PBF 0x20
+#define NCI_TX_MT_MASK 0xE0
+#define NCI_TX_MT_DATA 0x00
+#define NCI_TX_OID_RFU_MASK 0xC0
+#define NCI_TX_GID_COUNT 16
+#define NCI_TX_OID_COUNT 64
+#define NCI_TX_PROP_FELICA_BYTE 0xFF
+
+typedef struct {
+  uint8_t gid;
+  uint8_t oid;
+  tNCI_TX_CLASS txClass;
+} tNCI_TX_CMD_RULE;
+
+/* Commands with a dedicated handling on the write path */
+static constexpr tNCI_TX_CMD_RULE kTxCmdRules[] = {
+    {0x00, 0x00, NCI_TX_CORE_RESET},
+    {0x00, 0x01, NCI_TX_CORE_INIT},
+    {0x00, 0x02, NCI_TX_CORE_SET_CONFIG},
+    {0x00, 0x09, NCI_TX_CORE_SET_POWER_SUB_STATE},
+    {0x01, 0x00, NCI_TX_RF_DISCOVER_MAP},
+    {0x01, NCI_RF_DISC_COMMAND_OID, NCI_TX_RF_DISCOVER},
+    {0x01, NCI_RF_DEACTIVATE_OID, NCI_TX_RF_DEACTIVATE},
+    {0x01, 0x12, NCI_TX_RF_REMOVAL_DETECTION},
+    {0x02, 0x00, NCI_TX_NFCEE_DISCOVER},
+    {0x02, 0x01, NCI_TX_NFCEE_MODE_SET},
+    {NCI_GID_PROP, NCI_PROP_NTF_ANDROID_OID, NCI_TX_PROP_ANDROID},
+};
+
+typedef std::array<uint8_t, NCI_TX_GID_COUNT * NCI_TX_OID_COUNT> tNCI_TX_TABLE;
+
+static constexpr tNCI_TX_TABLE buildTxCmdTable() {
+  tNCI_TX_TABLE table{};
+  for (const tNCI_TX_CMD_RULE& rule : kTxCmdRules) {
+    table[rule.gid * NCI_TX_OID_COUNT + rule.oid] = rule.txClass;
+  }
+  return table;
+}
+
+/* Class of every command, indexed by GID/OID */
+static constexpr tNCI_TX_TABLE kTxCmdTable = buildTxCmdTable();
+
+/******************************************************************************
+ * Function         phNxpNciHal_classifyTx
+ *
+ * Description      Classifies an NCI packet from its header: one table
+ *                  lookup for commands. Commands with the PBF or RFU bits
+ *                  set are NCI_TX_OTHER.
+ *
+ * Returns          class of the packet, NCI_TX_OTHER if shorter than a
+ *                  header or not handled
+ *
+ ******************************************************************************/
+tNCI_TX_CLASS phNxpNciHal_classifyTx(const uint8_t* p_data,
+                                     uint16_t data_len) {
+  if (p_data == nullptr || data_len < NCI_HEADER_MIN_LEN) {
+    return NCI_TX_OTHER;
+  }
+  const uint8_t hdr0 = p_data[NCI_GID_INDEX];
+  const uint8_t hdr1 = p_data[NCI_OID_INDEX];
+
+  if ((hdr0 & NCI_TX_MT_PBF_MASK) == NCI_TX_MT_CMD_NO_PBF) {
+    if (hdr1 & NCI_TX_OID_RFU_MASK) return NCI_TX_OTHER;
+    return (tNCI_TX_CLASS)
+        kTxCmdTable[(hdr0 & ~NCI_TX_MT_PBF_MASK) * NCI_TX_OID_COUNT + hdr1];
+  }
+  if ((hdr0 & NCI_TX_MT_MASK) == NCI_TX_MT_DATA) {
+    if (hdr0 == 0x00) return NCI_TX_DATA_STATIC_RF;
+    if (hdr0 == 0x01 && hdr1 == 0x00) return NCI_TX_DATA_HCI;
+    return NCI_TX_DATA;
+  }
+  if (hdr0 == NCI_TX_PROP_FELICA_BYTE && hdr1 == NCI_TX_PROP_FELICA_BYTE &&
+      p_data[NCI_MSG_LEN_INDEX] == NCI_TX_PROP_FELICA_BYTE) {
+    return NCI_TX_PROP_FELICA_READER_MODE;
+  }
+  return NCI_TX_OTHER;
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NXPNCIHALTXCLASSIFIER_H
+#define NXPNCIHALTXCLASSIFIER_H
+
+#include <stdint.h>
+
+/*
+ * Class of an NCI packet sent to the NFCC, as handled by NfcWriter::write
+ * and phNxpNciHal_write_ext. Commands are classified by GID/OID from one
+ * table, other classes only match on the header bytes listed.
+ */
+typedef enum : uint8_t {
+  NCI_TX_OTHER = 0,
+  /* Data packets, by connection */
+  NCI_TX_DATA_STATIC_RF, /* 00 .. */
+  NCI_TX_DATA_HCI,       /* 01 00 */
+  NCI_TX_DATA,
+  /* HAL proprietary, never sent: FF FF FF <mode> */
+  NCI_TX_PROP_FELICA_READER_MODE,
+  /* Commands */
+  NCI_TX_CORE_RESET,
+  NCI_TX_CORE_INIT,
+  NCI_TX_CORE_SET_CONFIG,
+  NCI_TX_CORE_SET_POWER_SUB_STATE,
+  NCI_TX_RF_DISCOVER_MAP,
+  NCI_TX_RF_DISCOVER,
+  NCI_TX_RF_DEACTIVATE,
+  NCI_TX_RF_REMOVAL_DETECTION,
+  NCI_TX_NFCEE_DISCOVER,
+  NCI_TX_NFCEE_MODE_SET,
+  NCI_TX_PROP_ANDROID,
+} tNCI_TX_CLASS;
+
+/******************************************************************************
+ * Function         phNxpNciHal_classifyTx
+ *
+ * Description      Classifies an NCI packet from its header: one table
+ *                  lookup for commands. Commands with the PBF or RFU bits
+ *                  set are NCI_TX_OTHER.
+ *
+ * Returns          class of the packet, NCI_TX_OTHER if shorter than a
+ *                  header or not handled
+ *
+ ******************************************************************************/
+tNCI_TX_CLASS phNxpNciHal_classifyTx(const uint8_t* p_data, uint16_t data_len);
+
+#endif /* NXPNCIHALTXCLASSIFIER_H */
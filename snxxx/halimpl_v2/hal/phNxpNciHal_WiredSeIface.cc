@@ -19,10 +19,122 @@
 #include <dlfcn.h>
 #include <phNxpNciHal.h>
 
+#include <atomic>
+#include <mutex>
+
 #define TERMINAL_TYPE_ESE 0x01
 #define TERMINAL_TYPE_EUICC 0x05
 #define TERMINAL_TYPE_EUICC2 0x06
 
+#define WIREDSE_PKT_POOL_SIZE 4
+#define WIREDSE_NCI_MT_MASK 0xE0
+#define WIREDSE_NCI_MT_DATA 0x00
+#define WIREDSE_NCI_PBF_MASK 0x10
+#define WIREDSE_NCI_ID_MASK 0x0F
+#define WIREDSE_NCI_CONN_STATIC_HCI 0x01
+#define WIREDSE_HCP_HDR_INDEX 3
+#define WIREDSE_HCP_PIPE_MASK 0x7F
+
+/* Packet buffer of the pool, borrowed through a shared_ptr to its NfcPkt */
+typedef struct WiredSePktSlot {
+  NfcPkt pkt;
+  uint8_t buf[NCI_MAX_DATA_LEN];
+  // Not owned by the NfcPkt, which would free it
+  ~WiredSePktSlot() { pkt.data = NULL; }
+} WiredSePktSlot;
+
+/*
+ * Fixed pool of packet buffers. A slot is borrowed by handing out a
+ * shared_ptr aliasing the pool reference, so no allocation is done per
+ * packet; it is free again once the pool holds the only reference.
+ */
+class WiredSePktPool {
+ public:
+  WiredSePktPool() {
+    for (auto& slot : mSlots) slot = std::make_shared<WiredSePktSlot>();
+  }
+
+  std::shared_ptr<NfcPkt> borrow(const uint8_t* p_data, uint16_t data_len) {
+    if (data_len <= NCI_MAX_DATA_LEN) {
+      std::lock_guard<std::mutex> lock(mLock);
+      for (auto& slot : mSlots) {
+        if (slot.use_count() != 1) continue;
+        // Pairs with the release of the last borrowed reference
+        std::atomic_thread_fence(std::memory_order_acquire);
+        memcpy(slot->buf, p_data, data_len);
+        slot->pkt.data = slot->buf;
+        slot->pkt.len = data_len;
+        return std::shared_ptr<NfcPkt>(slot, &slot->pkt);
+      }
+    }
+    NXPLOG_NCIHAL_D("%s: no pooled buffer, allocating %d bytes", __func__,
+                    data_len);
+    return std::make_shared<NfcPkt>((uint8_t*)p_data, data_len);
+  }
+
+ private:
+  std::mutex mLock;
+  std::shared_ptr<WiredSePktSlot> mSlots[WIREDSE_PKT_POOL_SIZE];
+};
+
+/* HCI connection packet with PBF set, continued by the next packets */
+static bool sHciSegmentPending = false;
+static bool sHciSegmentMatched = false;
+
+/*******************************************************************************
+**
+** Function         phNxpNciHal_WiredSeSetDefaultPktFilter()
+**
+** Description      Filter used when the service does not declare its own:
+**                  all received packets, as before filters were declared.
+**
+** Returns          None
+*******************************************************************************/
+static void phNxpNciHal_WiredSeSetDefaultPktFilter(
+    WiredSePktFilter* pktFilter) {
+  pktFilter->ctrlGidMask = (uint16_t)~0;
+  pktFilter->dataConnMask = (uint16_t)~0;
+  pktFilter->hciPipeMask[0] = ~0ULL;
+  pktFilter->hciPipeMask[1] = ~0ULL;
+}
+
+/*******************************************************************************
+**
+** Function         phNxpNciHal_WiredSeIsPktOfInterest()
+**
+** Description      Checks a received packet against the packet filter of
+**                  the service.
+**
+** Returns          true if the packet is to be dispatched, false otherwise
+*******************************************************************************/
+static bool phNxpNciHal_WiredSeIsPktOfInterest(const WiredSePktFilter& filter,
+                                               const uint8_t* p_data,
+                                               uint16_t data_len) {
+  if (data_len == 0) return false;
+  const uint8_t hdr = p_data[0];
+  const uint8_t id = hdr & WIREDSE_NCI_ID_MASK;
+  if ((hdr & WIREDSE_NCI_MT_MASK) != WIREDSE_NCI_MT_DATA) {
+    return (filter.ctrlGidMask >> id) & 0x01;
+  }
+  if (!((filter.dataConnMask >> id) & 0x01)) return false;
+  if (id != WIREDSE_NCI_CONN_STATIC_HCI) return true;
+
+  bool matched;
+  if (sHciSegmentPending) {
+    // Continuation of an NCI segmented HCP packet
+    matched = sHciSegmentMatched;
+  } else if (data_len > WIREDSE_HCP_HDR_INDEX) {
+    const uint8_t pipe =
+        p_data[WIREDSE_HCP_HDR_INDEX] & WIREDSE_HCP_PIPE_MASK;
+    matched = (filter.hciPipeMask[pipe >> 6] >> (pipe & 0x3F)) & 0x01;
+  } else {
+    matched = true;
+  }
+  sHciSegmentPending = (hdr & WIREDSE_NCI_PBF_MASK) != 0;
+  sHciSegmentMatched = matched;
+  return matched;
+}
+
 /*******************************************************************************
 **
 ** Function         phNxpNciHal_WiredSeStart()
@@ -77,6 +189,14 @@ WiredSeHandle* phNxpNciHal_WiredSeStart() {
     free(outHandle);
     return NULL;
   }
+  WiredSeGetPktFilterFunc_t getPktFilter = (WiredSeGetPktFilterFunc_t)dlsym(
+      outHandle->dlHandle, "WiredSeService_GetPktFilter");
+  if (getPktFilter == NULL ||
+      getPktFilter(outHandle->pWiredSeService, &outHandle->pktFilter) !=
+          NFCSTATUS_SUCCESS) {
+    NXPLOG_NCIHAL_D("WiredSe packet filter not declared, using default");
+    phNxpNciHal_WiredSeSetDefaultPktFilter(&outHandle->pktFilter);
+  }
   return outHandle;
 }
 
@@ -102,3 +222,34 @@ NFCSTATUS phNxpNciHal_WiredSeDispatchEvent(WiredSeHandle* inHandle,
   event.event = evtType;
   return inHandle->dispatchEvent(inHandle->pWiredSeService, event);
 }
+
+/*******************************************************************************
+**
+** Function         phNxpNciHal_WiredSeDispatchPkt()
+**
+** Description      Dispatch a packet event to wired-se subsystem. Received
+**                  packets not matching the filter of the service are not
+**                  dispatched. The packet is copied to a pooled buffer,
+**                  given back once wired-se releases the event data.
+**
+** Parameters       inHandle - WiredSe Handle
+** Returns          NFCSTATUS_SUCCESS if the packet is consumed by wired-se.
+**                  NFCSTATUS_FAILED otherwise
+*******************************************************************************/
+NFCSTATUS phNxpNciHal_WiredSeDispatchPkt(WiredSeHandle* inHandle,
+                                         WiredSeEvtType evtType,
+                                         const uint8_t* p_data,
+                                         uint16_t data_len) {
+  static WiredSePktPool sPktPool;
+  if (inHandle == NULL || inHandle->dispatchEvent == NULL ||
+      inHandle->pWiredSeService == NULL || p_data == NULL) {
+    return NFCSTATUS_FAILED;
+  }
+  if (evtType == NFC_PKT_RECEIVED &&
+      !phNxpNciHal_WiredSeIsPktOfInterest(inHandle->pktFilter, p_data,
+                                          data_len)) {
+    return NFCSTATUS_FAILED;
+  }
+  return phNxpNciHal_WiredSeDispatchEvent(
+      inHandle, evtType, WiredSeEvtData(sPktPool.borrow(p_data, data_len)));
+}
@@ -26,6 +26,8 @@
 typedef int32_t (*WiredSeStartFunc_t)(WiredSeService** pWiredSeService);
 typedef int32_t (*WiredSeDispatchEventFunc_t)(WiredSeService* pWiredSeService,
                                               WiredSeEvt event);
+typedef int32_t (*WiredSeGetPktFilterFunc_t)(WiredSeService* pWiredSeService,
+                                             WiredSePktFilter* pktFilter);
 
 /**
  * Handle to the Power Tracker stack implementation.
@@ -37,6 +39,8 @@ typedef struct {
   WiredSeDispatchEventFunc_t dispatchEvent;
   // WiredSeService instance
   WiredSeService* pWiredSeService;
+  // Received packets dispatched to wired-se.
+  WiredSePktFilter pktFilter;
   // WiredSe.so dynamic library handle.
   void* dlHandle;
 } WiredSeHandle;
@@ -95,3 +99,21 @@ WiredSeHandle* phNxpNciHal_WiredSeStart();
 NFCSTATUS phNxpNciHal_WiredSeDispatchEvent(
     WiredSeHandle* inHandle, WiredSeEvtType evtType,
     WiredSeEvtData evtData = WiredSeEvtData());
+
+/*******************************************************************************
+**
+** Function         phNxpNciHal_WiredSeDispatchPkt()
+**
+** Description      Dispatch a packet event to wired-se subsystem. Received
+**                  packets not matching the filter of the service are not
+**                  dispatched. The packet is copied to a pooled buffer,
+**                  given back once wired-se releases the event data.
+**
+** Parameters       inHandle - WiredSe Handle
+** Returns          NFCSTATUS_SUCCESS if the packet is consumed by wired-se.
+**                  NFCSTATUS_FAILED otherwise
+*******************************************************************************/
+NFCSTATUS phNxpNciHal_WiredSeDispatchPkt(WiredSeHandle* inHandle,
+                                         WiredSeEvtType evtType,
+                                         const uint8_t* p_data,
+                                         uint16_t data_len);
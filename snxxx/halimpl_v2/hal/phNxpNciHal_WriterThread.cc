@@ -20,6 +20,7 @@
 #include <phNxpNciHal_ext.h>
 
 #include "NfcExtension.h"
+#include "phNxpNciHal_ConnCredits.h"
 
 phNxpNciHal_WriterThread::phNxpNciHal_WriterThread() : thread_running(false) {
   writer_thread = 0;
@@ -127,6 +128,11 @@ void phNxpNciHal_WriterThread::Run() {
         }
         break;
       }
+      case NCI_HAL_TML_WRITE_DATA_MSG: {
+        phNxpNciHal_ConnCredits::getInstance().WritePosted(
+            (uint16_t)msg.Size, (uint8_t*)msg.data);
+        break;
+      }
       case HAL_CTRL_GRANTED_MSG: {
         NXPLOG_NCIHAL_D("Processing HAL_CTRL_GRANTED_MSG");
         phNxpExtn_NfcHalControlGranted();
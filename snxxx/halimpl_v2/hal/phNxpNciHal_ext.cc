@@ -32,6 +32,8 @@
 #include "phNxpNciHal_IoctlOperations.h"
 #include "phNxpNciHal_LxDebug.h"
 #include "phNxpNciHal_PowerTrackerIface.h"
+#include "phNxpNciHal_SetConfigBatch.h"
+#include "phNxpNciHal_TxClassifier.h"
 #include "phNxpNciHal_VendorProp.h"
 
 #define NXP_EN_SN110U 1
@@ -48,11 +50,12 @@
 #define NFC_NXP_MW_CUSTOMER_ID (0x00) /* MW Customer Id */
 #define NFC_NXP_MW_RC_VERSION (0x00)  /* MW RC Version */
 
-/* Timeout value to wait for response from PN548AD */
-#define HAL_EXTNS_WRITE_RSP_TIMEOUT (1000)
 #define NCI_NFC_DEP_RF_INTF 0x03
 #define NCI_STATUS_OK 0x00
 #define NCI_MODE_HEADER_LEN 3
+/* Max Control Packet Payload Size in CORE_INIT_RSP */
+#define NCI2_0_INIT_RSP_MAX_CTRL_INDEX 11
+#define NCI1_0_INIT_RSP_MAX_CTRL_INDEX(p_rsp) (12 + (p_rsp)[8])
 
 /******************* Global variables *****************************************/
 extern phNxpNciHal_Control_t nxpncihal_ctrl;
@@ -79,7 +82,6 @@ extern uint16_t wFwVer;
 static uint32_t bCoreInitRsp[40];
 static uint32_t iCoreInitRspLen;
 
-extern uint32_t timeoutTimerId;
 extern sem_t sem_reset_ntf_received;
 
 typedef struct phNxpExtRxData_Control {
@@ -96,7 +98,7 @@ static phNxpExtRxData_Control_t gExtRxDataCtrl = {
     .rx_cond = PTHREAD_COND_INITIALIZER};
 
 /************** HAL extension functions ***************************************/
-static void hal_extns_write_rsp_timeout_cb(uint32_t TimerId, void* pContext);
+static int phNxpNciHal_wait_ext_cb_data(uint32_t timeout_ms);
 
 /*Proprietary cmd sent to HAL to send reader mode flag
  * Last byte of 4 byte proprietary cmd data contains ReaderMode flag
@@ -610,6 +612,10 @@ static NFCSTATUS phNxpNciHal_ext_process_nfc_init_rsp(uint8_t* p_ntf,
              ((p_ntf[1] & NCI_OID_MASK) == NCI_MSG_CORE_INIT)) {
     if (nxpncihal_ctrl.nci_info.nci_version >= NCI_VERSION_2_0) {
       NXPLOG_NCIHAL_D("CORE_INIT_RSP NCI2.0 and above received !");
+      if (*p_len > NCI2_0_INIT_RSP_MAX_CTRL_INDEX) {
+        nxpncihal_ctrl.nci_info.max_ctrl_payload =
+            p_ntf[NCI2_0_INIT_RSP_MAX_CTRL_INDEX];
+      }
       /* Remove NFC-DEP interface support from INIT RESP */
       RemoveNfcDepIntfFromInitResp(p_ntf, p_len);
       /* If NDEF T4T is enabled, then change Max Logical Connections to 5
@@ -645,6 +651,10 @@ static NFCSTATUS phNxpNciHal_ext_process_nfc_init_rsp(uint8_t* p_ntf,
                         p_ntf[len - 2], p_ntf[len - 1], p_ntf[len]);
         status = NFCSTATUS_FAILED;
       }
+      if (*p_len > 8 && *p_len > NCI1_0_INIT_RSP_MAX_CTRL_INDEX(p_ntf)) {
+        nxpncihal_ctrl.nci_info.max_ctrl_payload =
+            p_ntf[NCI1_0_INIT_RSP_MAX_CTRL_INDEX(p_ntf)];
+      }
       iCoreInitRspLen = *p_len;
       memcpy(bCoreInitRsp, p_ntf, *p_len);
       NXPLOG_NCIHAL_D("NxpNci> FW Version: %x.%x.%x", p_ntf[len - 2],
@@ -672,6 +682,8 @@ core_reset_err:
  *
  * Description      This function process the extension command response. It
  *                  also checks the received response to expected response.
+ *                  The response and the notification, if any, are each
+ *                  waited for at most timeout_ms.
  *
  * Returns          returns NFCSTATUS_SUCCESS if response is as expected else
  *                  returns failure.
@@ -680,7 +692,8 @@ core_reset_err:
 static NFCSTATUS phNxpNciHal_process_ext_cmd_rsp(uint16_t cmd_len,
                                                  uint8_t* p_cmd,
                                                  uint16_t* rsp_len,
-                                                 uint8_t* p_rsp) {
+                                                 uint8_t* p_rsp,
+                                                 uint32_t timeout_ms) {
   NFCSTATUS status = NFCSTATUS_FAILED;
   uint16_t data_written = 0;
 
@@ -711,30 +724,10 @@ static NFCSTATUS phNxpNciHal_process_ext_cmd_rsp(uint16_t cmd_len,
     NXPLOG_NCIHAL_E("%s: Failed to set ext response buffer", __func__);
     goto clean_and_return;
   }
-  /* Start timer */
-  status = phOsalNfc_Timer_Start(timeoutTimerId, HAL_EXTNS_WRITE_RSP_TIMEOUT,
-                                 &hal_extns_write_rsp_timeout_cb, NULL);
-  if (NFCSTATUS_SUCCESS == status) {
-    NXPLOG_NCIHAL_D("Response timer started");
-  } else {
-    NXPLOG_NCIHAL_E("Response timer not started!!!");
-    status = NFCSTATUS_FAILED;
-    goto clean_and_return;
-  }
-
   /* Wait for rsp */
   NXPLOG_NCIHAL_D("Waiting after ext cmd sent");
-  if (SEM_WAIT(nxpncihal_ctrl.ext_cb_data)) {
-    NXPLOG_NCIHAL_E("p_hal_ext->ext_cb_data.sem semaphore error");
-    goto clean_and_return;
-  }
-
-  /* Stop Timer */
-  status = phOsalNfc_Timer_Stop(timeoutTimerId);
-  if (NFCSTATUS_SUCCESS == status) {
-    NXPLOG_NCIHAL_D("Response timer stopped");
-  } else {
-    NXPLOG_NCIHAL_E("Response timer stop ERROR!!!");
+  if (phNxpNciHal_wait_ext_cb_data(timeout_ms)) {
+    NXPLOG_NCIHAL_E("Ext cmd response not received, errno = %d", errno);
     status = NFCSTATUS_FAILED;
     goto clean_and_return;
   }
@@ -749,28 +742,10 @@ static NFCSTATUS phNxpNciHal_process_ext_cmd_rsp(uint16_t cmd_len,
   if (p_cmd[0] == 0x2F && p_cmd[1] == 0x1 && p_cmd[2] == 0x01) {
     nxpncihal_ctrl.nci_info.wait_for_ntf = false;
   }
-  /* Start timer to wait for NTF*/
+  /* Wait for NTF */
   if (nxpncihal_ctrl.nci_info.wait_for_ntf == true) {
-    status = phOsalNfc_Timer_Start(timeoutTimerId, HAL_EXTNS_WRITE_RSP_TIMEOUT,
-                                   &hal_extns_write_rsp_timeout_cb, NULL);
-    if (NFCSTATUS_SUCCESS == status) {
-      NXPLOG_NCIHAL_D("Response timer started");
-    } else {
-      NXPLOG_NCIHAL_E("Response timer not started!!!");
-      status = NFCSTATUS_FAILED;
-      goto clean_and_return;
-    }
-    if (SEM_WAIT(nxpncihal_ctrl.ext_cb_data)) {
-      NXPLOG_NCIHAL_E("p_hal_ext->ext_cb_data.sem semaphore error");
-      /* Stop Timer */
-      status = phOsalNfc_Timer_Stop(timeoutTimerId);
-      goto clean_and_return;
-    }
-    status = phOsalNfc_Timer_Stop(timeoutTimerId);
-    if (NFCSTATUS_SUCCESS == status) {
-      NXPLOG_NCIHAL_D("Response timer stopped");
-    } else {
-      NXPLOG_NCIHAL_E("Response timer stop ERROR!!!");
+    if (phNxpNciHal_wait_ext_cb_data(timeout_ms)) {
+      NXPLOG_NCIHAL_E("Ext cmd notification not received, errno = %d", errno);
       status = NFCSTATUS_FAILED;
       goto clean_and_return;
     }
@@ -829,10 +804,9 @@ clean_and_return:
 NFCSTATUS phNxpNciHal_write_ext(uint16_t* cmd_len, uint8_t* p_cmd_data,
                                 uint16_t* rsp_len, uint8_t* p_rsp_data) {
   NFCSTATUS status = NFCSTATUS_SUCCESS;
+  tNCI_TX_CLASS txClass = phNxpNciHal_classifyTx(p_cmd_data, *cmd_len);
 
-  if (p_cmd_data[0] == PROPRIETARY_CMD_FELICA_READER_MODE &&
-      p_cmd_data[1] == PROPRIETARY_CMD_FELICA_READER_MODE &&
-      p_cmd_data[2] == PROPRIETARY_CMD_FELICA_READER_MODE) {
+  if (txClass == NCI_TX_PROP_FELICA_READER_MODE) {
     NXPLOG_NCIHAL_D("Received proprietary command to set Felica Reader mode:%d",
                     p_cmd_data[3]);
     gFelicaReaderMode = p_cmd_data[3];
@@ -843,40 +817,22 @@ NFCSTATUS phNxpNciHal_write_ext(uint16_t* cmd_len, uint8_t* p_cmd_data,
     p_rsp_data[2] = 0x00;
     p_rsp_data[3] = 0x00;
     status = NFCSTATUS_FAILED;
-  } else if (p_cmd_data[0] == 0x20 && p_cmd_data[1] == 0x02 &&
+  } else if (txClass == NCI_TX_CORE_SET_CONFIG &&
              (p_cmd_data[2] == 0x05 || p_cmd_data[2] == 0x32) &&
              (p_cmd_data[3] == 0x01 || p_cmd_data[3] == 0x02) &&
              p_cmd_data[4] == 0xA0 && p_cmd_data[5] == 0x44 &&
-             p_cmd_data[6] == 0x01 && p_cmd_data[7] == 0x01) {
-    nxpprofile_ctrl.profile_type = EMV_CO_PROFILE;
-    NXPLOG_NCIHAL_D("EMV_CO_PROFILE mode - Enabled");
-    status = NFCSTATUS_SUCCESS;
-  } else if (p_cmd_data[0] == 0x20 && p_cmd_data[1] == 0x02 &&
-             (p_cmd_data[2] == 0x05 || p_cmd_data[2] == 0x32) &&
-             (p_cmd_data[3] == 0x01 || p_cmd_data[3] == 0x02) &&
-             p_cmd_data[4] == 0xA0 && p_cmd_data[5] == 0x44 &&
-             p_cmd_data[6] == 0x01 && p_cmd_data[7] == 0x00) {
-    NXPLOG_NCIHAL_D("NFC_FORUM_PROFILE mode - Enabled");
-    nxpprofile_ctrl.profile_type = NFC_FORUM_PROFILE;
-    status = NFCSTATUS_SUCCESS;
+             p_cmd_data[6] == 0x01) {
+    if (p_cmd_data[7] == 0x01) {
+      nxpprofile_ctrl.profile_type = EMV_CO_PROFILE;
+      NXPLOG_NCIHAL_D("EMV_CO_PROFILE mode - Enabled");
+    } else if (p_cmd_data[7] == 0x00) {
+      NXPLOG_NCIHAL_D("NFC_FORUM_PROFILE mode - Enabled");
+      nxpprofile_ctrl.profile_type = NFC_FORUM_PROFILE;
+    }
   }
 
-  if (nxpprofile_ctrl.profile_type == EMV_CO_PROFILE) {
-    if (p_cmd_data[0] == 0x21 && p_cmd_data[1] == 0x06 &&
-        p_cmd_data[2] == 0x01 && p_cmd_data[3] == 0x03) {
-#if 0
-            //Needs clarification whether to keep it or not
-            NXPLOG_NCIHAL_D ("EmvCo Poll mode - RF Deactivate discard");
-            phNxpNciHal_print_packet("SEND", p_cmd_data, *cmd_len);
-            *rsp_len = 4;
-            p_rsp_data[0] = 0x41;
-            p_rsp_data[1] = 0x06;
-            p_rsp_data[2] = 0x01;
-            p_rsp_data[3] = 0x00;
-            phNxpNciHal_print_packet("RECV", p_rsp_data, 4);
-            status = NFCSTATUS_FAILED;
-#endif
-    } else if (p_cmd_data[0] == 0x21 && p_cmd_data[1] == 0x03) {
+  if (txClass == NCI_TX_RF_DISCOVER) {
+    if (nxpprofile_ctrl.profile_type == EMV_CO_PROFILE) {
       NXPLOG_NCIHAL_D("EmvCo Poll mode - Discover map only for A and B");
       p_cmd_data[2] = 0x05;
       p_cmd_data[3] = 0x02;
@@ -886,20 +842,19 @@ NFCSTATUS phNxpNciHal_write_ext(uint16_t* cmd_len, uint8_t* p_cmd_data,
       p_cmd_data[7] = 0x01;
       *cmd_len = 8;
     }
-  }
-
-  if (mfc_mode == true && p_cmd_data[0] == 0x21 && p_cmd_data[1] == 0x03) {
-    NXPLOG_NCIHAL_D("EmvCo Poll mode - Discover map only for A");
-    p_cmd_data[2] = 0x03;
-    p_cmd_data[3] = 0x01;
-    p_cmd_data[4] = 0x00;
-    p_cmd_data[5] = 0x01;
-    *cmd_len = 6;
-    mfc_mode = false;
+    if (mfc_mode == true) {
+      NXPLOG_NCIHAL_D("EmvCo Poll mode - Discover map only for A");
+      p_cmd_data[2] = 0x03;
+      p_cmd_data[3] = 0x01;
+      p_cmd_data[4] = 0x00;
+      p_cmd_data[5] = 0x01;
+      *cmd_len = 6;
+      mfc_mode = false;
+    }
   }
 
   if (*cmd_len <= (NCI_MAX_DATA_LEN - 3) && bEnableMfcReader &&
-      (p_cmd_data[0] == 0x21 && p_cmd_data[1] == 0x00) &&
+      txClass == NCI_TX_RF_DISCOVER_MAP &&
       (nxpprofile_ctrl.profile_type == NFC_FORUM_PROFILE)) {
     if (p_cmd_data[2] == 0x04 && p_cmd_data[3] == 0x01 &&
         p_cmd_data[4] == 0x80 && p_cmd_data[5] == 0x01 &&
@@ -933,157 +888,87 @@ NFCSTATUS phNxpNciHal_write_ext(uint16_t* cmd_len, uint8_t* p_cmd_data,
       NXPLOG_NCIHAL_D("> NFC ISO_15693 Proprietary CMD ");
       p_cmd_data[3] += 0x02;
     }
-  } else if (p_cmd_data[0] == 0x21 && p_cmd_data[1] == 0x03) {
-    NXPLOG_NCIHAL_D("> Polling Loop Started");
-    icode_detected = 0;
-    if (IS_CHIP_TYPE_L(sn100u)) {
-      icode_send_eof = 0;
-    }
-  }
-  // 22000100
-  else if (p_cmd_data[0] == 0x22 && p_cmd_data[1] == 0x00 &&
-           p_cmd_data[2] == 0x01 && p_cmd_data[3] == 0x00) {
-    // ee_disc_done = 0x01;//Reader Over SWP event getting
-    *rsp_len = 0x05;
-    p_rsp_data[0] = 0x42;
-    p_rsp_data[1] = 0x00;
-    p_rsp_data[2] = 0x02;
-    p_rsp_data[3] = 0x00;
-    p_rsp_data[4] = 0x00;
-    phNxpNciHal_print_packet("RECV", p_rsp_data, 5);
-    status = NFCSTATUS_FAILED;
-  }
-  // 2002 0904 3000 3100 3200 5000
-  else if (*cmd_len <= (NCI_MAX_DATA_LEN - 1) &&
-           (p_cmd_data[0] == 0x20 && p_cmd_data[1] == 0x02) &&
-           ((p_cmd_data[2] == 0x09 && p_cmd_data[3] == 0x04) /*||
-            (p_cmd_data[2] == 0x0D && p_cmd_data[3] == 0x04)*/
-            )) {
-    *cmd_len += 0x01;
-    p_cmd_data[2] += 0x01;
-    p_cmd_data[9] = 0x01;
-    p_cmd_data[10] = 0x40;
-    p_cmd_data[11] = 0x50;
-    p_cmd_data[12] = 0x00;
-
-    NXPLOG_NCIHAL_D("> Going through workaround - Dirty Set Config ");
-    //        phNxpNciHal_print_packet("SEND", p_cmd_data, *cmd_len);
-    NXPLOG_NCIHAL_D("> Going through workaround - Dirty Set Config - End ");
-  }
-  //    20020703300031003200
-  //    2002 0301 3200
-  else if ((p_cmd_data[0] == 0x20 && p_cmd_data[1] == 0x02) &&
-           ((p_cmd_data[2] == 0x07 && p_cmd_data[3] == 0x03) ||
-            (p_cmd_data[2] == 0x03 && p_cmd_data[3] == 0x01 &&
-             p_cmd_data[4] == 0x32))) {
-    NXPLOG_NCIHAL_D("> Going through workaround - Dirty Set Config ");
-    phNxpNciHal_print_packet("SEND", p_cmd_data, *cmd_len);
-    *rsp_len = 5;
-    p_rsp_data[0] = 0x40;
-    p_rsp_data[1] = 0x02;
-    p_rsp_data[2] = 0x02;
-    p_rsp_data[3] = 0x00;
-    p_rsp_data[4] = 0x00;
-
-    phNxpNciHal_print_packet("RECV", p_rsp_data, 5);
-    status = NFCSTATUS_FAILED;
-    NXPLOG_NCIHAL_D("> Going through workaround - Dirty Set Config - End ");
-  }
-
-  // 2002 0D04 300104 310100 320100 500100
-  // 2002 0401 320100
-  else if ((p_cmd_data[0] == 0x20 && p_cmd_data[1] == 0x02) &&
-           (
-               /*(p_cmd_data[2] == 0x0D && p_cmd_data[3] == 0x04)*/
-               (p_cmd_data[2] == 0x04 && p_cmd_data[3] == 0x01 &&
-                p_cmd_data[4] == 0x32 && p_cmd_data[5] == 0x00))) {
-    //        p_cmd_data[12] = 0x40;
-
-    NXPLOG_NCIHAL_D("> Going through workaround - Dirty Set Config ");
-    phNxpNciHal_print_packet("SEND", p_cmd_data, *cmd_len);
-    p_cmd_data[6] = 0x60;
-
-    phNxpNciHal_print_packet("RECV", p_rsp_data, 5);
-    //        status = NFCSTATUS_FAILED;
-    NXPLOG_NCIHAL_D("> Going through workaround - Dirty Set Config - End ");
-  }
-#if 0
-    else if ( (p_cmd_data[0] == 0x20 && p_cmd_data[1] == 0x02 ) &&
-                 ((p_cmd_data[2] == 0x09 && p_cmd_data[3] == 0x04) ||
-                     (p_cmd_data[2] == 0x0B && p_cmd_data[3] == 0x05) ||
-                     (p_cmd_data[2] == 0x07 && p_cmd_data[3] == 0x02) ||
-                     (p_cmd_data[2] == 0x0A && p_cmd_data[3] == 0x03) ||
-                     (p_cmd_data[2] == 0x0A && p_cmd_data[3] == 0x04) ||
-                     (p_cmd_data[2] == 0x05 && p_cmd_data[3] == 0x02))
-             )
-    {
-        NXPLOG_NCIHAL_D ("> Going through workaround - Dirty Set Config ");
-        phNxpNciHal_print_packet("SEND", p_cmd_data, *cmd_len);
-        *rsp_len = 5;
-        p_rsp_data[0] = 0x40;
-        p_rsp_data[1] = 0x02;
-        p_rsp_data[2] = 0x02;
-        p_rsp_data[3] = 0x00;
-        p_rsp_data[4] = 0x00;
-
-        phNxpNciHal_print_packet("RECV", p_rsp_data, 5);
-        status = NFCSTATUS_FAILED;
-        NXPLOG_NCIHAL_D ("> Going through workaround - Dirty Set Config - End ");
-    }
-
-    else if((p_cmd_data[0] == 0x20 && p_cmd_data[1] == 0x02) &&
-           ((p_cmd_data[3] == 0x00) ||
-           ((*cmd_len >= 0x06) && (p_cmd_data[5] == 0x00)))) /*If the length of the first param id is zero don't allow*/
-    {
-        NXPLOG_NCIHAL_D ("> Going through workaround - Dirty Set Config ");
-        phNxpNciHal_print_packet("SEND", p_cmd_data, *cmd_len);
-        *rsp_len = 5;
-        p_rsp_data[0] = 0x40;
-        p_rsp_data[1] = 0x02;
-        p_rsp_data[2] = 0x02;
-        p_rsp_data[3] = 0x00;
-        p_rsp_data[4] = 0x00;
-
-        phNxpNciHal_print_packet("RECV", p_rsp_data, 5);
-        status = NFCSTATUS_FAILED;
-        NXPLOG_NCIHAL_D ("> Going through workaround - Dirty Set Config - End ");
-    }
-#endif
-  else if ((wFwVerRsp & 0x0000FFFF) == wFwVer) {
-    /* skip CORE_RESET and CORE_INIT from Brcm */
-    if (p_cmd_data[0] == 0x20 && p_cmd_data[1] == 0x00 &&
-        p_cmd_data[2] == 0x01 && p_cmd_data[3] == 0x01) {
-      //            *rsp_len = 6;
-      //
-      //            NXPLOG_NCIHAL_D("> Going - core reset optimization");
-      //
-      //            p_rsp_data[0] = 0x40;
-      //            p_rsp_data[1] = 0x00;
-      //            p_rsp_data[2] = 0x03;
-      //            p_rsp_data[3] = 0x00;
-      //            p_rsp_data[4] = 0x10;
-      //            p_rsp_data[5] = 0x01;
-      //
-      //            status = NFCSTATUS_FAILED;
-      //            NXPLOG_NCIHAL_D("> Going - core reset optimization - END");
-    }
-    /* CORE_INIT */
-    else if (p_cmd_data[0] == 0x20 && p_cmd_data[1] == 0x01 &&
-             p_cmd_data[2] == 0x00) {
-      //            NXPLOG_NCIHAL_D("> Going - core init optimization");
-      //            *rsp_len = iCoreInitRspLen;
-      //            memcpy(p_rsp_data, bCoreInitRsp, iCoreInitRspLen);
-      //            status = NFCSTATUS_FAILED;
-      //            NXPLOG_NCIHAL_D("> Going - core init optimization - END");
+  } else {
+    switch (txClass) {
+      case NCI_TX_RF_DISCOVER:
+        NXPLOG_NCIHAL_D("> Polling Loop Started");
+        icode_detected = 0;
+        if (IS_CHIP_TYPE_L(sn100u)) {
+          icode_send_eof = 0;
+        }
+        break;
+      case NCI_TX_NFCEE_DISCOVER:
+        // 22000100
+        if (p_cmd_data[2] == 0x01 && p_cmd_data[3] == 0x00) {
+          // ee_disc_done = 0x01;//Reader Over SWP event getting
+          *rsp_len = 0x05;
+          p_rsp_data[0] = 0x42;
+          p_rsp_data[1] = 0x00;
+          p_rsp_data[2] = 0x02;
+          p_rsp_data[3] = 0x00;
+          p_rsp_data[4] = 0x00;
+          phNxpNciHal_print_packet("RECV", p_rsp_data, 5);
+          status = NFCSTATUS_FAILED;
+        }
+        break;
+      case NCI_TX_CORE_SET_CONFIG:
+        // 2002 0904 3000 3100 3200 5000
+        if (*cmd_len <= (NCI_MAX_DATA_LEN - 1) && p_cmd_data[2] == 0x09 &&
+            p_cmd_data[3] == 0x04) {
+          *cmd_len += 0x01;
+          p_cmd_data[2] += 0x01;
+          p_cmd_data[9] = 0x01;
+          p_cmd_data[10] = 0x40;
+          p_cmd_data[11] = 0x50;
+          p_cmd_data[12] = 0x00;
+
+          NXPLOG_NCIHAL_D("> Going through workaround - Dirty Set Config ");
+          NXPLOG_NCIHAL_D(
+              "> Going through workaround - Dirty Set Config - End ");
+        }
+        //    20020703300031003200
+        //    2002 0301 3200
+        else if ((p_cmd_data[2] == 0x07 && p_cmd_data[3] == 0x03) ||
+                 (p_cmd_data[2] == 0x03 && p_cmd_data[3] == 0x01 &&
+                  p_cmd_data[4] == 0x32)) {
+          NXPLOG_NCIHAL_D("> Going through workaround - Dirty Set Config ");
+          phNxpNciHal_print_packet("SEND", p_cmd_data, *cmd_len);
+          *rsp_len = 5;
+          p_rsp_data[0] = 0x40;
+          p_rsp_data[1] = 0x02;
+          p_rsp_data[2] = 0x02;
+          p_rsp_data[3] = 0x00;
+          p_rsp_data[4] = 0x00;
+
+          phNxpNciHal_print_packet("RECV", p_rsp_data, 5);
+          status = NFCSTATUS_FAILED;
+          NXPLOG_NCIHAL_D(
+              "> Going through workaround - Dirty Set Config - End ");
+        }
+        // 2002 0401 320100
+        else if (p_cmd_data[2] == 0x04 && p_cmd_data[3] == 0x01 &&
+                 p_cmd_data[4] == 0x32 && p_cmd_data[5] == 0x00) {
+          NXPLOG_NCIHAL_D("> Going through workaround - Dirty Set Config ");
+          phNxpNciHal_print_packet("SEND", p_cmd_data, *cmd_len);
+          p_cmd_data[6] = 0x60;
+
+          phNxpNciHal_print_packet("RECV", p_rsp_data, 5);
+          NXPLOG_NCIHAL_D(
+              "> Going through workaround - Dirty Set Config - End ");
+        }
+        break;
+      default:
+        break;
     }
   }
   if (!phNxpTempMgr::GetInstance().IsICTempOk()) {
     NXPLOG_NCIHAL_E("> IC Temp is NOK");
     status = phNxpNciHal_process_screen_state_cmd(cmd_len, p_cmd_data, rsp_len,
                                                   p_rsp_data);
+    txClass = phNxpNciHal_classifyTx(p_cmd_data, *cmd_len);
   }
   /* CORE_SET_POWER_SUB_STATE */
-  if (p_cmd_data[0] == 0x20 && p_cmd_data[1] == 0x09 && p_cmd_data[2] == 0x01 &&
+  if (txClass == NCI_TX_CORE_SET_POWER_SUB_STATE && p_cmd_data[2] == 0x01 &&
       (p_cmd_data[3] == 0x00 || p_cmd_data[3] == 0x02)) {
     // Sync power tracker data for screen on transition.
     if (gPowerTrackerHandle.stateChange != NULL) {
@@ -1107,12 +992,31 @@ NFCSTATUS phNxpNciHal_write_ext(uint16_t* cmd_len, uint8_t* p_cmd_data,
  ******************************************************************************/
 NFCSTATUS phNxpNciHal_send_ext_cmd(uint16_t cmd_len, uint8_t* p_cmd,
                                    uint16_t* p_rsp_len, uint8_t* p_rsp) {
+  return phNxpNciHal_send_ext_cmd_timeout(cmd_len, p_cmd, p_rsp_len, p_rsp,
+                                          HAL_EXTNS_WRITE_RSP_TIMEOUT);
+}
+
+/******************************************************************************
+ * Function         phNxpNciHal_send_ext_cmd_timeout
+ *
+ * Description      Same as phNxpNciHal_send_ext_cmd with a caller provided
+ *                  timeout for the response and for the notification.
+ *
+ * Returns          Returns NFCSTATUS_SUCCESS if sending cmd is successful and
+ *                  response is received.
+ *
+ ******************************************************************************/
+NFCSTATUS phNxpNciHal_send_ext_cmd_timeout(uint16_t cmd_len, uint8_t* p_cmd,
+                                           uint16_t* p_rsp_len, uint8_t* p_rsp,
+                                           uint32_t timeout_ms) {
   NFCSTATUS status = NFCSTATUS_FAILED;
-  if (p_cmd && cmd_len > 0 && p_rsp && p_rsp_len) {
+  if (p_cmd && cmd_len > 0 && cmd_len <= NCI_MAX_DATA_LEN && p_rsp &&
+      p_rsp_len) {
     nxpncihal_ctrl.cmd_len = cmd_len;
     memcpy(nxpncihal_ctrl.p_cmd_data, p_cmd, cmd_len);
-    status = phNxpNciHal_process_ext_cmd_rsp(
-        nxpncihal_ctrl.cmd_len, nxpncihal_ctrl.p_cmd_data, p_rsp_len, p_rsp);
+    status = phNxpNciHal_process_ext_cmd_rsp(nxpncihal_ctrl.cmd_len,
+                                             nxpncihal_ctrl.p_cmd_data,
+                                             p_rsp_len, p_rsp, timeout_ms);
   } else {
     NXPLOG_NCIHAL_E("%s: invalid arguments", __func__);
   }
@@ -1120,23 +1024,40 @@ NFCSTATUS phNxpNciHal_send_ext_cmd(uint16_t cmd_len, uint8_t* p_cmd,
 }
 
 /******************************************************************************
- * Function         hal_extns_write_rsp_timeout_cb
+ * Function         phNxpNciHal_wait_ext_cb_data
  *
- * Description      Timer call back function
+ * Description      Waits for the ext command response or notification. On
+ *                  timeout the command is failed and the NCI command window
+ *                  is released, as the response timer callback used to do.
  *
- * Returns          None
+ * Returns          0 when the response arrived,
+ *                  -1 on timeout (errno ETIMEDOUT) or semaphore error.
  *
  ******************************************************************************/
-static void hal_extns_write_rsp_timeout_cb(uint32_t timerId, void* pContext) {
-  UNUSED_PROP(timerId);
-  UNUSED_PROP(pContext);
-  NXPLOG_NCIHAL_D("hal_extns_write_rsp_timeout_cb - write timeout!!!");
-  nxpncihal_ctrl.ext_cb_data.status = NFCSTATUS_FAILED;
-  usleep(1);
-  sem_post(&(nxpncihal_ctrl.syncSpiNfc));
-  SEM_POST(&(nxpncihal_ctrl.ext_cb_data));
-
-  return;
+static int phNxpNciHal_wait_ext_cb_data(uint32_t timeout_ms) {
+  struct timespec ts;
+  int s;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  ts.tv_sec += timeout_ms / 1000;
+  ts.tv_nsec += (timeout_ms % 1000) * 1000000;
+  if (ts.tv_nsec >= 1000000000) {
+    ts.tv_sec++;
+    ts.tv_nsec -= 1000000000;
+  }
+  while ((s = sem_timedwait_monotonic_np(&nxpncihal_ctrl.ext_cb_data.sem,
+                                         &ts)) == -1 &&
+         errno == EINTR) {
+    continue; /* Restart if interrupted by handler */
+  }
+  if (s == -1 && errno == ETIMEDOUT) {
+    NXPLOG_NCIHAL_D("%s - write timeout!!!", __func__);
+    nxpncihal_ctrl.ext_cb_data.status = NFCSTATUS_FAILED;
+    sem_post(&(nxpncihal_ctrl.syncSpiNfc));
+    errno = ETIMEDOUT;
+    return -1;
+  }
+  return s;
 }
 
 /*******************************************************************************
@@ -1549,38 +1470,16 @@ NFCSTATUS phNxpNciHal_enableDefaultUICC2SWPline(uint8_t uicc2_sel) {
  *
  ******************************************************************************/
 void phNxpNciHal_prop_conf_lpcd(bool enableLPCD) {
-  uint8_t cmd_get_lpcdval[] = {0x20, 0x03, 0x03, 0x01, 0xA0, 0x68};
-  vector<uint8_t> cmd_set_lpcdval{0x20, 0x02, 0x2E};
-  uint8_t rsp[PHNCI_MAX_DATA_LEN] = {0};
-  uint16_t rsp_len = 0;
-  if (NFCSTATUS_SUCCESS == phNxpNciHal_send_ext_cmd(sizeof(cmd_get_lpcdval),
-                                                    cmd_get_lpcdval, &rsp_len,
-                                                    rsp)) {
-    if (NFCSTATUS_SUCCESS == rsp[3]) {
-      if (!(rsp[17] & (1 << 7)) && enableLPCD) {
-        rsp[17] |= (1 << 7);
-        cmd_set_lpcdval.insert(cmd_set_lpcdval.end(), &rsp[4],
-                               (&rsp[4] + cmd_set_lpcdval[2]));
-        if (NFCSTATUS_SUCCESS ==
-            phNxpNciHal_send_ext_cmd(cmd_set_lpcdval.size(),
-                                     &cmd_set_lpcdval[0], &rsp_len, rsp)) {
-          return;
-        }
-      } else if (!enableLPCD && (rsp[17] & (1 << 7))) {
-        rsp[17] &= ~(1 << 7);
-        cmd_set_lpcdval.insert(cmd_set_lpcdval.end(), &rsp[4],
-                               (&rsp[4] + cmd_set_lpcdval[2]));
-        if (NFCSTATUS_SUCCESS ==
-            phNxpNciHal_send_ext_cmd(cmd_set_lpcdval.size(),
-                                     &cmd_set_lpcdval[0], &rsp_len, rsp)) {
-          return;
-        }
-      } else {
-        return;
-      }
-    }
+  /* LPCD enable is bit 7 of the 10th byte of the parameter */
+  const uint8_t LPCD_BYTE_OFFSET = 9;
+  const uint8_t LPCD_ENABLE_MASK = (1 << 7);
+  phNxpNciHal_SetConfigBatch setCfgBatch;
+
+  setCfgBatch.AddBits(NXP_PARAM_ID_LPCD, LPCD_BYTE_OFFSET, LPCD_ENABLE_MASK,
+                      enableLPCD ? LPCD_ENABLE_MASK : 0x00);
+  if (setCfgBatch.Flush() != NFCSTATUS_SUCCESS) {
+    NXPLOG_NCIHAL_E("%s: failed!!", __func__);
   }
-  NXPLOG_NCIHAL_E("%s: failed!!", __func__);
   return;
 }
 
@@ -1597,31 +1496,14 @@ void phNxpNciHal_prop_conf_rssi() {
     NXPLOG_NCIHAL_D("%s: feature is not supported", __func__);
     return;
   }
-  vector<uint8_t> cmd_get_rssival = {0x20, 0x03, 0x03, 0x01, 0xA1, 0x55};
-  vector<uint8_t> cmd_set_rssival = {0x20, 0x02, 0x06, 0x01, 0xA1,
-                                     0x55, 0x02, 0x00, 0x00};
-  uint8_t rsp[PHNCI_MAX_DATA_LEN] = {0};
-  uint16_t rsp_len = 0;
+  const uint8_t rssi_default[] = {0x00, 0x00};
+  phNxpNciHal_SetConfigBatch setCfgBatch;
 
-  if (NFCSTATUS_SUCCESS != phNxpNciHal_send_ext_cmd(cmd_get_rssival.size(),
-                                                    &cmd_get_rssival[0],
-                                                    &rsp_len, rsp)) {
-    NXPLOG_NCIHAL_E("%s: failed!! Line:%d", __func__, __LINE__);
-    return;
-  }
-  if ((rsp_len <= 9) || (NFCSTATUS_SUCCESS != rsp[3])) {
-    NXPLOG_NCIHAL_E("%s: failed!! Line:%d", __func__, __LINE__);
-    return;
+  setCfgBatch.Add(NXP_PARAM_ID_RSSI, rssi_default, sizeof(rssi_default),
+                  nullptr, true);
+  if (setCfgBatch.Flush() != NFCSTATUS_SUCCESS) {
+    NXPLOG_NCIHAL_E("%s: failed!!", __func__);
   }
-  if ((rsp[8] != 0x00) || (rsp[9] != 0x00)) {
-    if (NFCSTATUS_SUCCESS != phNxpNciHal_send_ext_cmd(cmd_set_rssival.size(),
-                                                      &cmd_set_rssival[0],
-                                                      &rsp_len, rsp)) {
-      NXPLOG_NCIHAL_E("%s: failed!! Line:%d", __func__, __LINE__);
-      return;
-    }
-  }
-
   return;
 }
 
@@ -24,6 +24,9 @@
 #define NCI_MSG_CORE_RESET 0x00
 #define NCI_MSG_CORE_INIT 0x01
 
+/* Timeout value to wait for response from PN548AD */
+#define HAL_EXTNS_WRITE_RSP_TIMEOUT (1000)
+
 /* libnfc_nci -> AIDL Mapping Support */
 #define HAL_NFC_REQUEST_CONTROL_EVT 0x04
 #define HAL_NFC_RELEASE_CONTROL_EVT 0x05
@@ -32,6 +35,12 @@
 #define NXP_NFC_SET_CONFIG_PARAM_EXT 0xA0
 #define NXP_NFC_PARAM_ID_SWP2 0xD4
 #define NXP_NFC_PARAM_ID_SWPUICC3 0xDC
+/* Full ids of NXP proprietary parameters, see phNxpNciHal_SetConfigBatch */
+#define NXP_PARAM_ID_GUARD_TIMER 0xA10B
+#define NXP_PARAM_ID_SRD_TIMEOUT 0xA117
+#define NXP_PARAM_ID_EXT_FIELD_DETECT_MODE 0xA136
+#define NXP_PARAM_ID_LPCD 0xA068
+#define NXP_PARAM_ID_RSSI 0xA155
 
 #define CORE_GENERIC_ERR_CURRENT_NTF 0xEA
 // PROTECTED_USER_AREA_AT_CRC_MISMATCH
@@ -48,6 +57,9 @@ NFCSTATUS phNxpNciHal_reset_ext_buffer();
 
 NFCSTATUS phNxpNciHal_send_ext_cmd(uint16_t cmd_len, uint8_t* p_cmd,
                                    uint16_t* rsp_len, uint8_t* p_rsp);
+NFCSTATUS phNxpNciHal_send_ext_cmd_timeout(uint16_t cmd_len, uint8_t* p_cmd,
+                                           uint16_t* rsp_len, uint8_t* p_rsp,
+                                           uint32_t timeout_ms);
 NFCSTATUS phNxpNciHal_write_ext(uint16_t* cmd_len, uint8_t* p_cmd_data,
                                 uint16_t* rsp_len, uint8_t* p_rsp_data);
 
@@ -114,20 +114,28 @@ NFCSTATUS phNxpNciHal_setAutonomousMode() {
  * Returns          NFCSTATUS_FAILED or NFCSTATUS_SUCCESS
  *
  ******************************************************************************/
-NFCSTATUS phNxpNciHal_setGuardTimer() {
+NFCSTATUS phNxpNciHal_setGuardTimer(phNxpNciHal_SetConfigBatch* batch,
+                                    NFCSTATUS* p_status) {
   phNxpNci_EEPROM_info_t mEEPROM_info = {.request_mode = 0};
   NFCSTATUS status = NFCSTATUS_FEATURE_NOT_SUPPORTED;
 
   if (IS_CHIP_TYPE_GE(sn100u)) {
     if (!config_ext.autonomous_mode) config_ext.guard_timer_value = 0x00;
 
-    mEEPROM_info.request_mode = SET_EEPROM_DATA;
-    mEEPROM_info.buffer = &config_ext.guard_timer_value;
-    mEEPROM_info.bufflen = sizeof(config_ext.guard_timer_value);
-    mEEPROM_info.request_type = EEPROM_GUARD_TIMER;
+    if (batch != nullptr) {
+      status = batch->Add(NXP_PARAM_ID_GUARD_TIMER,
+                          &config_ext.guard_timer_value,
+                          sizeof(config_ext.guard_timer_value), p_status, true);
+    } else {
+      mEEPROM_info.request_mode = SET_EEPROM_DATA;
+      mEEPROM_info.buffer = &config_ext.guard_timer_value;
+      mEEPROM_info.bufflen = sizeof(config_ext.guard_timer_value);
+      mEEPROM_info.request_type = EEPROM_GUARD_TIMER;
 
-    status = request_EEPROM(&mEEPROM_info);
+      status = request_EEPROM(&mEEPROM_info);
+    }
   }
+  if (p_status != nullptr && status != NFCSTATUS_PENDING) *p_status = status;
   return status;
 }
 
@@ -608,7 +616,8 @@ NFCSTATUS phNxpNciHal_configure_merge_sak() {
  *                  NFCSTATUS_FEATURE_NOT_SUPPORTED
  *
  ******************************************************************************/
-NFCSTATUS phNxpNciHal_setSrdtimeout() {
+NFCSTATUS phNxpNciHal_setSrdtimeout(phNxpNciHal_SetConfigBatch* batch,
+                                    NFCSTATUS* p_status) {
   long retlen = 0;
   uint8_t* buffer = nullptr;
   long bufflen = 260;
@@ -639,11 +648,16 @@ NFCSTATUS phNxpNciHal_setSrdtimeout() {
         buffer[1] = 0xFD;
       }
       memcpy(&timeout_buffer, buffer, NXP_SRD_TIMEOUT_BUF_LEN);
-      mEEPROM_info.buffer = timeout_buffer;
-      mEEPROM_info.bufflen = sizeof(timeout_buffer);
-      mEEPROM_info.request_type = EEPROM_SRD_TIMEOUT;
-      mEEPROM_info.request_mode = SET_EEPROM_DATA;
-      status = request_EEPROM(&mEEPROM_info);
+      if (batch != nullptr) {
+        status = batch->Add(NXP_PARAM_ID_SRD_TIMEOUT, timeout_buffer,
+                            sizeof(timeout_buffer), p_status, true);
+      } else {
+        mEEPROM_info.buffer = timeout_buffer;
+        mEEPROM_info.bufflen = sizeof(timeout_buffer);
+        mEEPROM_info.request_type = EEPROM_SRD_TIMEOUT;
+        mEEPROM_info.request_mode = SET_EEPROM_DATA;
+        status = request_EEPROM(&mEEPROM_info);
+      }
     }
   }
   if (buffer != NULL) {
@@ -651,6 +665,7 @@ NFCSTATUS phNxpNciHal_setSrdtimeout() {
     buffer = NULL;
   }
 
+  if (p_status != nullptr && status != NFCSTATUS_PENDING) *p_status = status;
   return status;
 }
 #endif
@@ -667,7 +682,8 @@ NFCSTATUS phNxpNciHal_setSrdtimeout() {
  *                  NFCSTATUS_FEATURE_NOT_SUPPORTED
  *
  ******************************************************************************/
-NFCSTATUS phNxpNciHal_setExtendedFieldMode() {
+NFCSTATUS phNxpNciHal_setExtendedFieldMode(phNxpNciHal_SetConfigBatch* batch,
+                                           NFCSTATUS* p_status) {
   const uint8_t enableWithOutCMAEvents = 0x01;
   const uint8_t enableWithCMAEvents = 0x03;
   const uint8_t disableEvents = 0x00;
@@ -680,15 +696,23 @@ NFCSTATUS phNxpNciHal_setExtendedFieldMode() {
     if (extended_field_mode == enableWithOutCMAEvents ||
         extended_field_mode == enableWithCMAEvents ||
         extended_field_mode == disableEvents) {
-      phNxpNci_EEPROM_info_t mEEPROM_info = {.request_mode = SET_EEPROM_DATA};
-      mEEPROM_info.buffer = &extended_field_mode;
-      mEEPROM_info.bufflen = sizeof(extended_field_mode);
-      mEEPROM_info.request_type = EEPROM_EXT_FIELD_DETECT_MODE;
-      status = request_EEPROM(&mEEPROM_info);
+      if (batch != nullptr) {
+        status = batch->Add(NXP_PARAM_ID_EXT_FIELD_DETECT_MODE,
+                            &extended_field_mode, sizeof(extended_field_mode),
+                            p_status, true);
+      } else {
+        phNxpNci_EEPROM_info_t mEEPROM_info = {.request_mode =
+                                                   SET_EEPROM_DATA};
+        mEEPROM_info.buffer = &extended_field_mode;
+        mEEPROM_info.bufflen = sizeof(extended_field_mode);
+        mEEPROM_info.request_type = EEPROM_EXT_FIELD_DETECT_MODE;
+        status = request_EEPROM(&mEEPROM_info);
+      }
     } else {
       NXPLOG_NCIHAL_E("Invalid Extended Field Mode in config");
     }
   }
+  if (p_status != nullptr && status != NFCSTATUS_PENDING) *p_status = status;
   return status;
 }
 
@@ -815,7 +839,8 @@ void phNxpNciHal_decodeGpioStatus(void) {
  *
  *****************************************************************************/
 
-void phNxpNciHal_setDCDCConfig(void) {
+void phNxpNciHal_setDCDCConfig(phNxpNciHal_SetConfigBatch* batch,
+                               NFCSTATUS* p_status) {
   uint8_t rsp[PHNCI_MAX_DATA_LEN] = {0};
   uint16_t rsp_len = 0;
 
@@ -865,10 +890,20 @@ void phNxpNciHal_setDCDCConfig(void) {
   if (!GetNxpNumValue(NAME_NXP_ENABLE_DCDC_ON, (void*)&enable,
                       sizeof(enable))) {
     NXPLOG_NCIHAL_D("NAME_NXP_ENABLE_DCDC_ON not found:");
+    if (p_status != nullptr) *p_status = NFCSTATUS_FEATURE_NOT_SUPPORTED;
     return;
   }
   NXPLOG_NCIHAL_D("Perform DCDC config");
-  if (enable == 1) {
+  if (batch != nullptr) {
+    if (enable == 1) {
+      status = batch->AddCmd(NXP_CONF_DCDC_ON, sizeof(NXP_CONF_DCDC_ON),
+                             p_status);
+    } else {
+      status = batch->AddCmd(NXP_CONF_DCDC_OFF, sizeof(NXP_CONF_DCDC_OFF),
+                             p_status);
+    }
+    if (status == NFCSTATUS_PENDING) return;
+  } else if (enable == 1) {
     // DCDC On
     status = phNxpNciHal_send_ext_cmd(sizeof(NXP_CONF_DCDC_ON),
                                       &(NXP_CONF_DCDC_ON[0]), &rsp_len, rsp);
@@ -877,6 +912,7 @@ void phNxpNciHal_setDCDCConfig(void) {
     status = phNxpNciHal_send_ext_cmd(sizeof(NXP_CONF_DCDC_OFF),
                                       &(NXP_CONF_DCDC_OFF[0]), &rsp_len, rsp);
   }
+  if (p_status != nullptr) *p_status = status;
   if (status != NFCSTATUS_SUCCESS) {
     NXPLOG_NCIHAL_E("SetConfig for DCDC failed");
   }
@@ -21,6 +21,7 @@
 #include <vector>
 
 #include "phNfcStatus.h"
+#include "phNxpNciHal_SetConfigBatch.h"
 
 #define AUTONOMOUS_SCREEN_OFF_LOCK_MASK 0x20
 #define SWITCH_OFF_MASK 0x02
@@ -91,12 +92,17 @@ NFCSTATUS phNxpNciHal_setAutonomousMode();
 /******************************************************************************
  * Function         phNxpNciHal_setGuardTimer
  *
- * Description      This function can be used to set Guard timer
+ * Description      This function can be used to set Guard timer. If batch is
+ *                  set, the parameter is queued on it and p_status receives
+ *                  its status once the batch is flushed.
  *
- * Returns          NFCSTATUS_FAILED or NFCSTATUS_SUCCESS
+ * Returns          NFCSTATUS_FAILED or NFCSTATUS_SUCCESS or
+ *                  NFCSTATUS_PENDING if queued on batch
  *
  ******************************************************************************/
-NFCSTATUS phNxpNciHal_setGuardTimer();
+NFCSTATUS phNxpNciHal_setGuardTimer(
+    phNxpNciHal_SetConfigBatch* batch = nullptr,
+    NFCSTATUS* p_status = nullptr);
 
 /*****************************************************************************
  * Function         phNxpNciHal_send_get_cfg
@@ -127,13 +133,18 @@ NFCSTATUS phNxpNciHal_configure_merge_sak();
 /******************************************************************************
  * Function         phNxpNciHal_setSrdtimeout
  *
- * Description      This function can be used to set srd SRD Timeout.
+ * Description      This function can be used to set srd SRD Timeout. If batch
+ *                  is set, the parameter is queued on it and p_status
+ *                  receives its status once the batch is flushed.
  *
  * Returns          NFCSTATUS_FAILED or NFCSTATUS_SUCCESS or
- *                  NFCSTATUS_FEATURE_NOT_SUPPORTED
+ *                  NFCSTATUS_FEATURE_NOT_SUPPORTED or
+ *                  NFCSTATUS_PENDING if queued on batch
  *
  ******************************************************************************/
-NFCSTATUS phNxpNciHal_setSrdtimeout();
+NFCSTATUS phNxpNciHal_setSrdtimeout(
+    phNxpNciHal_SetConfigBatch* batch = nullptr,
+    NFCSTATUS* p_status = nullptr);
 /******************************************************************************
  * Function         phNxpNciHal_set_uicc_hci_params
  *
@@ -167,13 +178,18 @@ phNxpNciHal_get_uicc_hci_params(vector<uint8_t>& ptr, uint8_t bufflen,
 /******************************************************************************
  * Function         phNxpNciHal_setExtendedFieldMode
  *
- * Description      This function can be used to set nfcc extended field mode
+ * Description      This function can be used to set nfcc extended field mode.
+ *                  If batch is set, the parameter is queued on it and
+ *                  p_status receives its status once the batch is flushed.
  *
  * Returns          NFCSTATUS_FAILED or NFCSTATUS_SUCCESS or
- *                  NFCSTATUS_FEATURE_NOT_SUPPORTED
+ *                  NFCSTATUS_FEATURE_NOT_SUPPORTED or
+ *                  NFCSTATUS_PENDING if queued on batch
  *
  ******************************************************************************/
-NFCSTATUS phNxpNciHal_setExtendedFieldMode();
+NFCSTATUS phNxpNciHal_setExtendedFieldMode(
+    phNxpNciHal_SetConfigBatch* batch = nullptr,
+    NFCSTATUS* p_status = nullptr);
 
 /******************************************************************************
  * Function         phNxpNciHal_getInterpolatedRssi8Am
@@ -218,10 +234,14 @@ void phNxpNciHal_decodeGpioStatus(void);
  **
  ** Function         phNxpNciHal_setDCDCConfig()
  **
- ** Description      Sets DCDC On/Off
+ ** Description      Sets DCDC On/Off. If batch is set, the parameters are
+ **                  queued on it and p_status receives their status once the
+ **                  batch is flushed, NFCSTATUS_FEATURE_NOT_SUPPORTED if
+ **                  DCDC is not configured.
  **
  *****************************************************************************/
-void phNxpNciHal_setDCDCConfig(void);
+void phNxpNciHal_setDCDCConfig(phNxpNciHal_SetConfigBatch* batch = nullptr,
+                               NFCSTATUS* p_status = nullptr);
 
 /*******************************************************************************
 **
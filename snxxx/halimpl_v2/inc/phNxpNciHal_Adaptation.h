@@ -42,4 +42,5 @@ int phNxpNciHal_ioctl(long arg, void* p_data);
 void phNxpNciHal_do_factory_reset(void);
 void phNxpNciHal_setVerboseLogging(bool enable);
 bool phNxpNciHal_getVerboseLogging();
+void phNxpNciHal_dump(int fd);
 #endif /* _PHNXPNCIHAL_ADAPTATION_H_ */
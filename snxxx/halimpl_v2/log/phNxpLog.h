@@ -77,6 +77,8 @@ extern bool nfc_debug_enabled;
 
 /* Enable/Disable Capturing SMB ntf to a file */
 #define NAME_NXP_SMBLOG_ENABLED "NXP_SMBLOG_ENABLED"
+/* Size in bytes at which SMB/DPD log files are rotated, 0 to never rotate */
+#define NAME_NXP_EVENT_LOG_MAX_SIZE "NXP_EVENT_LOG_MAX_SIZE"
 /* ################################################################################################################
  */
 /* ############################################### Component Names
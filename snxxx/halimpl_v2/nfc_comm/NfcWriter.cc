@@ -20,12 +20,17 @@
 #include <phNxpNciHal.h>
 #include <phNxpNciHal_ext.h>
 #include <phNxpTempMgr.h>
+#include <phTmlNfc_Capture.h>
 
 #include <type_traits>
 
 #include "NciDiscoveryCommandBuilder.h"
 #include "NfcExtension.h"
+#include "NxpNfcLatencyStats.h"
 #include "ObserveMode.h"
+#include "phNxpNciHal_ConfigShadow.h"
+#include "phNxpNciHal_ConnCredits.h"
+#include "phNxpNciHal_TxClassifier.h"
 #include "phNxpNciHal_WiredSeIface.h"
 #include "phNxpNciHal_extOperations.h"
 
@@ -80,18 +85,19 @@ NfcWriter& NfcWriter::getInstance() {
  *
  ******************************************************************************/
 int NfcWriter::write(uint16_t data_len, const uint8_t* p_data) {
-  if (p_data[NCI_GID_INDEX] == NCI_RF_DISC_COMMD_GID &&
-      p_data[NCI_OID_INDEX] == NCI_RF_DISC_COMMAND_OID) {
+  NfcHalLatencyStats::TxScope txLatency;
+  const tNCI_TX_CLASS txClass = phNxpNciHal_classifyTx(p_data, data_len);
+
+  if (txClass == NCI_TX_RF_DISCOVER) {
     NciDiscoveryCommandBuilderInstance.setDiscoveryCommand(data_len, p_data);
     setObserveChangeInProgress(false);
-  } else if (p_data[NCI_GID_INDEX] == NCI_RF_DISC_COMMD_GID &&
-             p_data[NCI_OID_INDEX] == NCI_RF_DEACTIVATE_OID) {
+  } else if (txClass == NCI_TX_RF_DEACTIVATE) {
     NciDiscoveryCommandBuilderInstance.setRfDiscoveryReceived(false);
   }
 
-  if (bEnableMfcExtns && p_data[NCI_GID_INDEX] == 0x00) {
+  if (bEnableMfcExtns && txClass == NCI_TX_DATA_STATIC_RF) {
     return NxpMfcReaderInstance.Write(data_len, p_data);
-  } else if (phNxpNciHal_isVndSpecificAndroidCmd(data_len, p_data)) {
+  } else if (txClass == NCI_TX_PROP_ANDROID && data_len > 3) {
     if (!(data_len >= 4 && (p_data[NCI_MSG_INDEX_FOR_FEATURE] ==
                                 NCI_ANDROID_SET_PASSIVE_OBSERVER_EXIT_FRAME ||
                             p_data[NCI_MSG_INDEX_FOR_FEATURE] ==
@@ -100,46 +106,46 @@ int NfcWriter::write(uint16_t data_len, const uint8_t* p_data) {
                                RfFwRegionDnld_handle == NULL);
     }
     return phNxpNciHal_hndlVndSpecificAndroidCmd(data_len, p_data);
-  } else if (isObserveModeEnabled() &&
-             p_data[NCI_GID_INDEX] == NCI_RF_DISC_COMMD_GID &&
-             p_data[NCI_OID_INDEX] == NCI_RF_DISC_COMMAND_OID) {
-    auto rfDiscCmd = NciDiscoveryCommandBuilderInstance.reConfigRFDiscCmd();
-    data_len = static_cast<uint16_t>(rfDiscCmd.size());
-    if (data_len > NCI_MAX_DATA_LEN) {
-      NXPLOG_NCIHAL_E("%s: rfDiscCmd exceeds max size", __func__);
+  } else if (txClass == NCI_TX_RF_DISCOVER && isObserveModeEnabled()) {
+    // Built when the command was set above
+    const uint8_t* p_rfDiscCmd =
+        NciDiscoveryCommandBuilderInstance.getDiscoveryCommand(true, &data_len);
+    if (p_rfDiscCmd == nullptr) {
+      NXPLOG_NCIHAL_E("%s: invalid rfDiscCmd", __func__);
       return NFCSTATUS_FAILED;
     }
-    uint8_t* p_data_mutable = const_cast<uint8_t*>(p_data);
-    copy(rfDiscCmd.begin(), rfDiscCmd.end(), p_data_mutable);
-    NFCSTATUS status = phNxpExtn_HandleNciMsg(&data_len, p_data);
+    NFCSTATUS status = phNxpExtn_HandleNciMsg(&data_len, p_rfDiscCmd);
     if (status != NFCSTATUS_EXTN_FEATURE_SUCCESS)
-      return this->direct_write(data_len, p_data);
+      return this->direct_write(data_len, p_rfDiscCmd);
     else
       return data_len;
-  } else if (IS_HCI_PACKET(p_data)) {
+  } else if (txClass == NCI_TX_DATA_HCI) {
     // Inform WiredSe service that HCI Pkt is sending from libnfc layer
     phNxpNciHal_WiredSeDispatchEvent(gWiredSeHandle, SENDING_HCI_PKT);
-  } else if (IS_NFCEE_DISABLE(p_data)) {
+  } else if (txClass == NCI_TX_NFCEE_MODE_SET && IS_NFCEE_DISABLE(p_data)) {
     // NFCEE_MODE_SET(DISABLE) is called. Dispatch event to WiredSe so
     // that it can close if session is ongoing on same NFCEE
-    phNxpNciHal_WiredSeDispatchEvent(
-        gWiredSeHandle, DISABLING_NFCEE,
-        createWiredSeEvtData((uint8_t*)p_data, data_len));
+    phNxpNciHal_WiredSeDispatchPkt(gWiredSeHandle, DISABLING_NFCEE, p_data,
+                                   data_len);
   } else {
     NFCSTATUS status = phNxpExtn_HandleNciMsg(&data_len, p_data);
     NXPLOG_NCIHAL_D("Vendor specific status: %d", status);
     if (status == NFCSTATUS_EXTN_FEATURE_SUCCESS) return data_len;
   }
-  long value = 0;
   /* NXP Removal Detection timeout Config */
-  if (GetNxpNumValue(NAME_NXP_REMOVAL_DETECTION_TIMEOUT, (void*)&value,
-                     sizeof(value))) {
-    // Change the timeout value as per config file
-    uint8_t* wait_time = (uint8_t*)&p_data[3];
-    if ((data_len == 0x04) && (p_data[0] == 0x21 && p_data[1] == 0x12)) {
+  if ((data_len == 0x04) && txClass == NCI_TX_RF_REMOVAL_DETECTION) {
+    long value = 0;
+    if (GetNxpNumValue(NAME_NXP_REMOVAL_DETECTION_TIMEOUT, (void*)&value,
+                       sizeof(value))) {
+      // Change the timeout value as per config file
+      uint8_t* wait_time = (uint8_t*)&p_data[3];
       *wait_time = value;
     }
   }
+  if (txClass == NCI_TX_DATA_STATIC_RF || txClass == NCI_TX_DATA_HCI ||
+      txClass == NCI_TX_DATA) {
+    return phNxpNciHal_ConnCredits::getInstance().Write(data_len, p_data);
+  }
   return this->direct_write(data_len, p_data);
 }
 
@@ -239,6 +245,11 @@ int NfcWriter::write_unlocked(uint16_t data_len, const uint8_t* p_data,
       phNxpTempMgr::GetInstance().Wait();
     }
 
+    /* Before writing, the response may be read before this returns */
+    phNxpNciHal_ConfigShadow::getInstance().OnCmdSent(p_data,
+                                                      (uint16_t)data_len);
+    phNxpNciHal_ConnCredits::getInstance().OnCmdSent(p_data,
+                                                     (uint16_t)data_len);
     status = phTmlNfc_Write((uint8_t*)p_data, (uint16_t)data_len);
     if (status == NFCSTATUS_SUCCESS) {
       if (origin == ORIG_EXTNS &&
@@ -274,6 +285,7 @@ int NfcWriter::write_unlocked(uint16_t data_len, const uint8_t* p_data,
         NXPLOG_NCIHAL_D("Doing abort which will trigger the recovery\n");
         // abort which will trigger the recovery.
         phNxpExtn_HandleHalEvent(NFCC_HAL_FATAL_ERR_CODE);
+        phTmlNfc_CaptureFlush();
         abort();
       }
       break;
@@ -327,5 +339,8 @@ int NfcWriter::check_ncicmd_write_window(uint16_t cmd_len, uint8_t* p_cmd) {
     /* cmd window check not required for writing data packet */
     status = NFCSTATUS_SUCCESS;
   }
+  if (status == NFCSTATUS_SUCCESS) {
+    NfcHalLatencyStats::getInstance().txWindow();
+  }
   return status;
 }
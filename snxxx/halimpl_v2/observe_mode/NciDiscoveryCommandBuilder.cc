@@ -17,6 +17,7 @@
 #include "NciDiscoveryCommandBuilder.h"
 
 #include <phNfcNciConstants.h>
+#include <string.h>
 
 using std::vector;
 
@@ -25,6 +26,13 @@ NciDiscoveryCommandBuilder& NciDiscoveryCommandBuilder::getInstance() {
   return msNciDiscoveryCommandBuilder;
 }
 
+NciDiscoveryCommandBuilder::NciDiscoveryCommandBuilder()
+    : mIsRfDiscoveryReceived(false) {
+  // Largest command, reused by every parse
+  mRfDiscoverConfiguration.reserve(MAX_DISCOVERY_COMMAND_LENGTH /
+                                   RF_DISC_CMD_EACH_CONFIG_LENGTH);
+}
+
 /*****************************************************************************
  *
  * Function         parse
@@ -37,23 +45,37 @@ NciDiscoveryCommandBuilder& NciDiscoveryCommandBuilder::getInstance() {
  * Returns          return true if parse is successful otherwise false
  *
  ****************************************************************************/
-bool NciDiscoveryCommandBuilder::parse(vector<uint8_t> data) {
-  if (!isDiscoveryCommand(data)) return false;
+bool NciDiscoveryCommandBuilder::parse(const vector<uint8_t>& data) {
+  return parse(data.data(), data.size());
+}
+
+/*****************************************************************************
+ *
+ * Function         parse
+ *
+ * Description      Same as above, for a command in a buffer
+ *
+ * Parameters       p_data, data_len - RF discovery command
+ *
+ * Returns          return true if parse is successful otherwise false
+ *
+ ****************************************************************************/
+bool NciDiscoveryCommandBuilder::parse(const uint8_t* p_data,
+                                       uint16_t data_len) {
+  if (!isDiscoveryCommand(p_data, data_len)) return false;
 
   mRfDiscoverConfiguration.clear();
-  int dataSize = (int)data.size();
+  int dataSize = (int)data_len;
 
-  if (dataSize <= NCI_HEADER_MIN_LEN &&
-      (dataSize < ((data[RF_DISC_CMD_NO_OF_CONFIG_INDEX] *
-                    RF_DISC_CMD_EACH_CONFIG_LENGTH) +
-                   NCI_HEADER_MIN_LEN))) {
+  // Header only, the number of configurations is missing
+  if (dataSize <= NCI_HEADER_MIN_LEN) {
     return false;
   }
 
-  for (int i = RF_DISC_CMD_CONFIG_START_INDEX; i < ((int)data.size() - 1);
+  for (int i = RF_DISC_CMD_CONFIG_START_INDEX; i < (dataSize - 1);
        i = i + RF_DISC_CMD_EACH_CONFIG_LENGTH) {
     mRfDiscoverConfiguration.push_back(
-        DiscoveryConfiguration(data[i], data[i + 1]));
+        DiscoveryConfiguration(p_data[i], p_data[i + 1]));
   }
   return true;
 }
@@ -70,9 +92,27 @@ bool NciDiscoveryCommandBuilder::parse(vector<uint8_t> data) {
  *                  otherwise false
  *
  ****************************************************************************/
-bool NciDiscoveryCommandBuilder::isDiscoveryCommand(vector<uint8_t> data) {
-  if ((int)data.size() >= 2 && data[NCI_GID_INDEX] == NCI_RF_DISC_COMMD_GID &&
-      data[NCI_OID_INDEX] == NCI_RF_DISC_COMMAND_OID) {
+bool NciDiscoveryCommandBuilder::isDiscoveryCommand(
+    const vector<uint8_t>& data) {
+  return isDiscoveryCommand(data.data(), data.size());
+}
+
+/*****************************************************************************
+ *
+ * Function         isDiscoveryCommand
+ *
+ * Description      Same as above, for a command in a buffer
+ *
+ * Parameters       p_data, data_len - Any command
+ *
+ * Returns          return true if the command is RF discovery command
+ *                  otherwise false
+ *
+ ****************************************************************************/
+bool NciDiscoveryCommandBuilder::isDiscoveryCommand(const uint8_t* p_data,
+                                                    uint16_t data_len) {
+  if (data_len >= 2 && p_data[NCI_GID_INDEX] == NCI_RF_DISC_COMMD_GID &&
+      p_data[NCI_OID_INDEX] == NCI_RF_DISC_COMMAND_OID) {
     return true;
   }
   return false;
@@ -127,49 +167,69 @@ void NciDiscoveryCommandBuilder::addObserveModeParams() {
  *
  ****************************************************************************/
 vector<uint8_t> NciDiscoveryCommandBuilder::build() {
-  vector<uint8_t> discoveryCommand;
-  discoveryCommand.push_back(NCI_RF_DISC_COMMD_GID);
-  discoveryCommand.push_back(NCI_RF_DISC_COMMAND_OID);
-  int discoveryLength = (mRfDiscoverConfiguration.size() * 2) + 1;
+  vector<uint8_t> discoveryCommand(MAX_DISCOVERY_COMMAND_LENGTH);
+  discoveryCommand.resize(
+      build(discoveryCommand.data(), discoveryCommand.size()));
+  return discoveryCommand;
+}
+
+/*****************************************************************************
+ *
+ * Function         build
+ *
+ * Description      Same as above, frames the command into p_out
+ *
+ * Parameters       p_out - output buffer
+ *                  capacity - size of the output buffer
+ *
+ * Returns          return the command length, 0 if it does not fit
+ *
+ ****************************************************************************/
+uint16_t NciDiscoveryCommandBuilder::build(uint8_t* p_out, uint16_t capacity) {
   int numberOfConfigurations = mRfDiscoverConfiguration.size();
-  discoveryCommand.push_back(discoveryLength);
-  discoveryCommand.push_back(numberOfConfigurations);
+  int discoveryLength = (numberOfConfigurations * 2) + 1;
+  if (discoveryLength > 0xFF ||
+      NCI_HEADER_MIN_LEN + discoveryLength > capacity) {
+    return 0;
+  }
+  uint16_t idx = 0;
+  p_out[idx++] = NCI_RF_DISC_COMMD_GID;
+  p_out[idx++] = NCI_RF_DISC_COMMAND_OID;
+  p_out[idx++] = discoveryLength;
+  p_out[idx++] = numberOfConfigurations;
   for (int i = 0; i < numberOfConfigurations; i++) {
-    discoveryCommand.push_back(mRfDiscoverConfiguration[i].mRfTechMode);
-    discoveryCommand.push_back(mRfDiscoverConfiguration[i].mDiscFrequency);
+    p_out[idx++] = mRfDiscoverConfiguration[i].mRfTechMode;
+    p_out[idx++] = mRfDiscoverConfiguration[i].mDiscFrequency;
   }
-  return discoveryCommand;
+  return idx;
 }
 
 /*****************************************************************************
  *
  * Function         reConfigRFDiscCmd
  *
- * Description      It parse the current discovery command and alter
- *                  the configuration to enable Observe Mode
+ * Description      It returns the current discovery command altered to
+ *                  enable Observe Mode
  *
  * Returns          return the discovery command for Observe mode
  *
  ****************************************************************************/
 vector<uint8_t> NciDiscoveryCommandBuilder::reConfigRFDiscCmd() {
-  if (size(currentDiscoveryCommand) <= 0) {
-    return vector<uint8_t>();
-  }
-  bool status = parse(currentDiscoveryCommand);
-  if (status) {
-    removeListenParams();
-    addObserveModeParams();
-    return build();
-  } else {
+  uint16_t len = 0;
+  const uint8_t* p_cmd = getDiscoveryCommand(true, &len);
+  if (p_cmd == nullptr) {
     return vector<uint8_t>();
   }
+  return vector<uint8_t>(p_cmd, p_cmd + len);
 }
 
 /*****************************************************************************
  *
  * Function         setDiscoveryCommand
  *
- * Description      It sets the current discovery command
+ * Description      It sets the current discovery command and builds its
+ *                  observe mode variant: listen modes removed, observe mode
+ *                  added. Nothing is done if the command did not change.
  *
  * Parameters       data - RF discovery command
  *
@@ -182,7 +242,29 @@ void NciDiscoveryCommandBuilder::setDiscoveryCommand(uint16_t data_len,
     return;
   }
   setRfDiscoveryReceived(true);
-  currentDiscoveryCommand = vector<uint8_t>(p_data, p_data + data_len);
+
+  DiscoveryCommandVariants* current =
+      mCurrentVariants.load(std::memory_order_acquire);
+  if (current != nullptr && current->normalLen == data_len &&
+      memcmp(current->normal, p_data, data_len) == 0) {
+    return;
+  }
+  if (data_len > MAX_DISCOVERY_COMMAND_LENGTH) {
+    mCurrentVariants.store(nullptr, std::memory_order_release);
+    return;
+  }
+
+  DiscoveryCommandVariants* next =
+      (current == &mVariants[0]) ? &mVariants[1] : &mVariants[0];
+  memcpy(next->normal, p_data, data_len);
+  next->normalLen = data_len;
+  next->observeLen = 0;
+  if (parse(p_data, data_len)) {
+    removeListenParams();
+    addObserveModeParams();
+    next->observeLen = build(next->observe, sizeof(next->observe));
+  }
+  mCurrentVariants.store(next, std::memory_order_release);
 }
 
 /*****************************************************************************
@@ -195,7 +277,40 @@ void NciDiscoveryCommandBuilder::setDiscoveryCommand(uint16_t data_len,
  *
  ****************************************************************************/
 vector<uint8_t> NciDiscoveryCommandBuilder::getDiscoveryCommand() {
-  return currentDiscoveryCommand;
+  uint16_t len = 0;
+  const uint8_t* p_cmd = getDiscoveryCommand(false, &len);
+  if (p_cmd == nullptr) {
+    return vector<uint8_t>();
+  }
+  return vector<uint8_t>(p_cmd, p_cmd + len);
+}
+
+/*****************************************************************************
+ *
+ * Function         getDiscoveryCommand
+ *
+ * Description      It returns the current discovery command, or its
+ *                  observe mode variant, without copying it
+ *
+ * Parameters       isObserveMode - true for the observe mode variant
+ *                  p_len - length of the command
+ *
+ * Returns          return the command, nullptr if there is none
+ *
+ ****************************************************************************/
+const uint8_t* NciDiscoveryCommandBuilder::getDiscoveryCommand(
+    bool isObserveMode, uint16_t* p_len) {
+  *p_len = 0;
+  const DiscoveryCommandVariants* current =
+      mCurrentVariants.load(std::memory_order_acquire);
+  if (current == nullptr) return nullptr;
+  if (isObserveMode) {
+    if (current->observeLen == 0) return nullptr;
+    *p_len = current->observeLen;
+    return current->observe;
+  }
+  *p_len = current->normalLen;
+  return current->normal;
 }
 
 /*****************************************************************************
@@ -14,6 +14,10 @@
  * limitations under the License.
  */
 
+#include <phNfcNciConstants.h>
+#include <stdint.h>
+
+#include <atomic>
 #include <vector>
 
 using std::vector;
@@ -43,10 +47,26 @@ class DiscoveryConfiguration {
  */
 class NciDiscoveryCommandBuilder {
  private:
+  /* NCI header and the longest payload */
+  static constexpr uint16_t MAX_DISCOVERY_COMMAND_LENGTH =
+      NCI_HEADER_MIN_LEN + 0xFF;
+
+  /* Discovery command set by the stack and its observe mode variant, built
+   * once when the command is set. Length 0 if there is no such command */
+  struct DiscoveryCommandVariants {
+    uint16_t normalLen;
+    uint16_t observeLen;
+    uint8_t normal[MAX_DISCOVERY_COMMAND_LENGTH];
+    uint8_t observe[MAX_DISCOVERY_COMMAND_LENGTH];
+  };
+
   uint8_t currentObserveModeTech = 0x00;
-  vector<uint8_t> currentDiscoveryCommand;
   vector<DiscoveryConfiguration> mRfDiscoverConfiguration;
   bool mIsRfDiscoveryReceived;
+  /* Readers use mCurrentVariants, a new command is built in the other one
+   * and published by swapping the pointer */
+  DiscoveryCommandVariants mVariants[2];
+  std::atomic<DiscoveryCommandVariants*> mCurrentVariants{nullptr};
 
   /*****************************************************************************
    *
@@ -60,7 +80,20 @@ class NciDiscoveryCommandBuilder {
    * Returns          return true if parse is successful otherwise false
    *
    ****************************************************************************/
-  bool parse(vector<uint8_t> data);
+  bool parse(const vector<uint8_t>& data);
+
+  /*****************************************************************************
+   *
+   * Function         parse
+   *
+   * Description      Same as above, for a command in a buffer
+   *
+   * Parameters       p_data, data_len - RF discovery command
+   *
+   * Returns          return true if parse is successful otherwise false
+   *
+   ****************************************************************************/
+  bool parse(const uint8_t* p_data, uint16_t data_len);
 
   /*****************************************************************************
    *
@@ -95,6 +128,20 @@ class NciDiscoveryCommandBuilder {
    ****************************************************************************/
   vector<uint8_t> build();
 
+  /*****************************************************************************
+   *
+   * Function         build
+   *
+   * Description      Same as above, frames the command into p_out
+   *
+   * Parameters       p_out - output buffer
+   *                  capacity - size of the output buffer
+   *
+   * Returns          return the command length, 0 if it does not fit
+   *
+   ****************************************************************************/
+  uint16_t build(uint8_t* p_out, uint16_t capacity);
+
   /*****************************************************************************
    *
    * Function         isDiscoveryCommand
@@ -107,7 +154,21 @@ class NciDiscoveryCommandBuilder {
    *                  otherwise false
    *
    ****************************************************************************/
-  bool isDiscoveryCommand(vector<uint8_t> data);
+  bool isDiscoveryCommand(const vector<uint8_t>& data);
+
+  /*****************************************************************************
+   *
+   * Function         isDiscoveryCommand
+   *
+   * Description      Same as above, for a command in a buffer
+   *
+   * Parameters       p_data, data_len - Any command
+   *
+   * Returns          return true if the command is RF discovery command
+   *                  otherwise false
+   *
+   ****************************************************************************/
+  static bool isDiscoveryCommand(const uint8_t* p_data, uint16_t data_len);
 
 #if (NXP_UNIT_TEST == TRUE)
   /*
@@ -117,11 +178,15 @@ class NciDiscoveryCommandBuilder {
   friend class NciDiscoveryCommandBuilderTest;
 #endif
  public:
+  NciDiscoveryCommandBuilder();
+
   /*****************************************************************************
    *
    * Function         setDiscoveryCommand
    *
-   * Description      It sets the current discovery command
+   * Description      It sets the current discovery command and builds its
+   *                  observe mode variant. Nothing is done if the command
+   *                  did not change.
    *
    * Parameters       data - RF discovery command
    *
@@ -141,6 +206,22 @@ class NciDiscoveryCommandBuilder {
    ****************************************************************************/
   vector<uint8_t> getDiscoveryCommand();
 
+  /*****************************************************************************
+   *
+   * Function         getDiscoveryCommand
+   *
+   * Description      It returns the current discovery command, or its
+   *                  observe mode variant, without copying it. The buffer
+   *                  stays valid until two other discovery commands are set.
+   *
+   * Parameters       isObserveMode - true for the observe mode variant
+   *                  p_len - length of the command
+   *
+   * Returns          return the command, nullptr if there is none
+   *
+   ****************************************************************************/
+  const uint8_t* getDiscoveryCommand(bool isObserveMode, uint16_t* p_len);
+
   /*****************************************************************************
    *
    * Function         reConfigRFDiscCmd
@@ -14,8 +14,12 @@
  * limitations under the License.
  */
 #include <NxpNfcThreadMutex.h>
+#include <NxpNfcTimerWheel.h>
 #include <ObserveMode.h>
+#include <phDal4Nfc_messageQueueLib.h>
 #include <phNfcNciConstants.h>
+#include <phNxpConfig.h>
+#include <phNxpNciHal.h>
 
 #include <vector>
 
@@ -26,16 +30,52 @@
 
 using std::vector;
 
+extern phNxpNciHal_Control_t nxpncihal_ctrl;
+
 bool gWaitingForDiscRsp;
 bool gWaitingForRfDeActivateRsp;
 bool bIsObserveModeEnabled;
 bool bIsObserveChangeInProgress;
 
+/* Polling frame batching, the window is 0 if disabled. Apart from
+ * setObserveModeFlag(), used on the client thread only */
+static uint32_t sPollingFrameBatchTimeMs;
+static bool sPollingFrameTimerArmed;
+static NfcHalTimerEntry_t sPollingFrameTimer;
+static phLibNfc_DeferredCall_t sPollingFrameFlushCall;
+static phLibNfc_Message_t sPollingFrameFlushMsg;
+
+static void flushPollingFramesDeferred(void* /* pParam */) {
+  sPollingFrameTimerArmed = false;
+  flushPollingFrames();
+}
+
+/*******************************************************************************
+ *
+ * Function         postPollingFrameFlush()
+ *
+ * Description      Makes the client thread send the polling frames held back
+ *                  by batching. Runs on the timer wheel thread at the end of
+ *                  the batching window, so it only posts a message.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void postPollingFrameFlush(union sigval /* value */) {
+  sPollingFrameFlushCall.pCallback = flushPollingFramesDeferred;
+  sPollingFrameFlushCall.pParameter = NULL;
+  sPollingFrameFlushMsg.eMsgType = PH_LIBNFC_DEFERREDCALL_MSG;
+  sPollingFrameFlushMsg.pMsgData = &sPollingFrameFlushCall;
+  (void)phDal4Nfc_msgsnd(nxpncihal_ctrl.gDrvCfg.nClientId,
+                         &sPollingFrameFlushMsg, 0);
+}
+
 /*******************************************************************************
  *
  * Function         setObserveModeFlag()
  *
- * Description      It sets the observe mode flag
+ * Description      It sets the observe mode flag. On enable, it configures the
+ *                  parser of the polling frames received in observe mode
  *
  * Parameters       bool - true to enable observe mode
  *                         false to disable observe mode
@@ -43,7 +83,89 @@ bool bIsObserveChangeInProgress;
  * Returns          void
  *
  ******************************************************************************/
-void setObserveModeFlag(bool flag) { bIsObserveModeEnabled = flag; }
+void setObserveModeFlag(bool flag) {
+  if (flag && !bIsObserveModeEnabled) {
+    unsigned long notificationType = 0;
+    if (!GetNxpNumValue(NAME_NXP_OBSERVE_MODE_REQ_NOTIFICATION_TYPE,
+                        &notificationType, sizeof(notificationType))) {
+      notificationType = 0;
+    }
+    ReaderPollConfigParserInstance.setNotificationType(notificationType);
+    ReaderPollConfigParserInstance.resetExtraBytesInfo();
+
+    unsigned long batchTimeMs = 0;
+    if (!GetNxpNumValue(NAME_NXP_OBSERVE_MODE_POLLING_FRAME_BATCH_TIME,
+                        &batchTimeMs, sizeof(batchTimeMs))) {
+      batchTimeMs = 0;
+    }
+    sPollingFrameBatchTimeMs = batchTimeMs;
+    ReaderPollConfigParserInstance.setBatchingEnabled(batchTimeMs != 0);
+  } else if (!flag && bIsObserveModeEnabled && sPollingFrameBatchTimeMs != 0) {
+    NfcHalTimerWheel::getInstance().cancel(&sPollingFrameTimer);
+    if (nxpncihal_ctrl.halStatus == HAL_STATUS_OPEN) {
+      // Frames received before disabling are still sent, in order
+      postPollingFrameFlush(sigval{});
+    } else {
+      // Frames of a closed session, there is no client thread
+      sPollingFrameTimerArmed = false;
+      ReaderPollConfigParserInstance.clearPendingEvents();
+    }
+  }
+  bIsObserveModeEnabled = flag;
+}
+
+/*******************************************************************************
+ *
+ * Function         handleReaderPollInfo()
+ *
+ * Description      Parses an Lx notification received in observe mode and
+ *                  sends the polling frames to the upper layer. When they are
+ *                  batched, the pending frames are sent at the latest after
+ *                  NXP_OBSERVE_MODE_POLLING_FRAME_BATCH_TIME.
+ *
+ * Parameters       p_ntf - Lx notification
+ *                  len - notification length
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void handleReaderPollInfo(uint8_t* p_ntf, uint16_t len) {
+  ReaderPollConfigParserInstance.parseAndSendReaderPollInfo(p_ntf, len);
+  if (sPollingFrameBatchTimeMs == 0) return;
+
+  if (!ReaderPollConfigParserInstance.hasPendingEvents()) {
+    if (sPollingFrameTimerArmed) {
+      NfcHalTimerWheel::getInstance().cancel(&sPollingFrameTimer);
+      sPollingFrameTimerArmed = false;
+    }
+  } else if (!sPollingFrameTimerArmed) {
+    sPollingFrameTimerArmed = NfcHalTimerWheel::getInstance().schedule(
+        &sPollingFrameTimer, sPollingFrameBatchTimeMs, postPollingFrameFlush,
+        sigval{}, true);
+    if (!sPollingFrameTimerArmed) {
+      ReaderPollConfigParserInstance.flushPendingEvents();
+    }
+  }
+}
+
+/*******************************************************************************
+ *
+ * Function         flushPollingFrames()
+ *
+ * Description      Sends the polling frames held back by batching, so that
+ *                  they reach the upper layer before the next packet
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void flushPollingFrames() {
+  if (!ReaderPollConfigParserInstance.hasPendingEvents()) return;
+  if (sPollingFrameTimerArmed) {
+    NfcHalTimerWheel::getInstance().cancel(&sPollingFrameTimer);
+    sPollingFrameTimerArmed = false;
+  }
+  ReaderPollConfigParserInstance.flushPendingEvents();
+}
 
 /*******************************************************************************
  *
@@ -133,12 +255,13 @@ NFCSTATUS sendRfDiscoveryCommand(bool isObserveModeEnable) {
   if (NciDiscoveryCommandBuilderInstance.isRfDiscoveryCommandReceived()) {
     uint8_t rsp[PHNCI_MAX_DATA_LEN] = {0};
     uint16_t rsp_len = 0;
-    vector<uint8_t> discoveryCommand =
-        isObserveModeEnable
-            ? NciDiscoveryCommandBuilderInstance.reConfigRFDiscCmd()
-            : NciDiscoveryCommandBuilderInstance.getDiscoveryCommand();
-    return phNxpNciHal_send_ext_cmd(discoveryCommand.size(),
-                                    &discoveryCommand[0], &rsp_len, rsp);
+    uint16_t cmd_len = 0;
+    const uint8_t* p_cmd =
+        NciDiscoveryCommandBuilderInstance.getDiscoveryCommand(
+            isObserveModeEnable, &cmd_len);
+    // Copied by phNxpNciHal_send_ext_cmd
+    return phNxpNciHal_send_ext_cmd(cmd_len, const_cast<uint8_t*>(p_cmd),
+                                    &rsp_len, rsp);
   } else {
     return NFCSTATUS_SUCCESS;
   }
@@ -191,11 +314,12 @@ NFCSTATUS handleObserveModeRfStateRspNtf(uint16_t dataLen, uint8_t* pData) {
       pData[NCI_OID_INDEX] == NCI_RF_DEACTIVATE_OID) {
     gWaitingForRfDeActivateRsp = false;
     gWaitingForDiscRsp = true;
-    vector<uint8_t> discoveryCommand =
-        isObserveModeEnabled()
-            ? NciDiscoveryCommandBuilderInstance.reConfigRFDiscCmd()
-            : NciDiscoveryCommandBuilderInstance.getDiscoveryCommand();
-    phNxpHal_EnqueueWrite(&discoveryCommand[0], discoveryCommand.size());
+    uint16_t cmd_len = 0;
+    const uint8_t* p_cmd =
+        NciDiscoveryCommandBuilderInstance.getDiscoveryCommand(
+            isObserveModeEnabled(), &cmd_len);
+    // Copied by the writer thread queue
+    phNxpHal_EnqueueWrite(const_cast<uint8_t*>(p_cmd), cmd_len);
 
     return NFCSTATUS_EXTN_FEATURE_SUCCESS;
   }
@@ -29,6 +29,34 @@
  ******************************************************************************/
 void setObserveModeFlag(bool flag);
 
+/*******************************************************************************
+ *
+ * Function         handleReaderPollInfo()
+ *
+ * Description      Parses an Lx notification received in observe mode and
+ *                  sends the polling frames to the upper layer, batched if
+ *                  NXP_OBSERVE_MODE_POLLING_FRAME_BATCH_TIME is set
+ *
+ * Parameters       p_ntf - Lx notification
+ *                  len - notification length
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void handleReaderPollInfo(uint8_t* p_ntf, uint16_t len);
+
+/*******************************************************************************
+ *
+ * Function         flushPollingFrames()
+ *
+ * Description      Sends the polling frames held back by batching, so that
+ *                  they reach the upper layer before the next packet
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void flushPollingFrames();
+
 /*******************************************************************************
  *
  * Function         isObserveModeEnabled()
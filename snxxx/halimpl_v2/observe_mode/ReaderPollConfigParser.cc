@@ -17,6 +17,7 @@
 #include "ReaderPollConfigParser.h"
 
 #include <phNfcNciConstants.h>
+#include <string.h>
 
 #include <algorithm>
 
@@ -36,11 +37,56 @@ void setInterpolatedRssi8Am(uint16_t rssiAt8Am, uint8_t measuredFieldStrength) {
       static_cast<double>(rssiAt8Am);
 }
 
+ReaderPollConfigParser::ReaderPollConfigParser() {
+  unknownEventTimeStamp.reserve(TIMESTAMP_LENGTH);
+  extraBytes.reserve(MAX_EXTRA_BYTES_LENGTH);
+}
+
+ReaderPollConfigParser& ReaderPollConfigParser::getInstance() {
+  static ReaderPollConfigParser instance;
+  return instance;
+}
+
 void ReaderPollConfigParser::resetLastKnownValues() {
   ReaderPollConfigParser::lastKnownGain = 0x00;
   ReaderPollConfigParser::lastKnownModEvent = 0x00;
 }
 
+/*****************************************************************************
+ *
+ * Function         writeEventData
+ *
+ * Description      Frames a reader poll info event into p_out
+ *
+ * Parameters       p_out - output buffer
+ *                  capacity - size of the output buffer
+ *                  type - event type: RF, A, B, F or Unknown
+ *                  p_timeStamp - TIMESTAMP_LENGTH bytes time stamp
+ *                  gain - RSSI value
+ *                  p_data, dataLen - data of the event
+ *
+ * Returns          Returns the event length, 0 if it does not fit
+ *
+ ****************************************************************************/
+uint16_t ReaderPollConfigParser::writeEventData(
+    uint8_t* p_out, uint16_t capacity, uint8_t type,
+    const uint8_t* p_timeStamp, uint8_t gain, const uint8_t* p_data,
+    uint16_t dataLen) {
+  const uint16_t eventLength = TIMESTAMP_LENGTH + GAIN_FIELD_LENGTH + dataLen;
+  if (eventLength > 0xFF || NCI_MESSAGE_OFFSET + eventLength > capacity) {
+    return 0;
+  }
+  uint16_t idx = 0;
+  p_out[idx++] = type;
+  p_out[idx++] = SHORT_FLAG;  // Always short frame
+  p_out[idx++] = (uint8_t)eventLength;
+  memcpy(&p_out[idx], p_timeStamp, TIMESTAMP_LENGTH);
+  idx += TIMESTAMP_LENGTH;
+  p_out[idx++] = gain;
+  if (dataLen > 0) memcpy(&p_out[idx], p_data, dataLen);
+  return idx + dataLen;
+}
+
 /*****************************************************************************
  *
  * Function         getWellKnownModEventData
@@ -125,35 +171,90 @@ vector<uint8_t> ReaderPollConfigParser::getRFEventData(
 
 /*****************************************************************************
  *
- * Function         parseCmaEvent
+ * Function         writeCmaEvent
  *
- * Description      This function parses the unknown frames
+ * Description      Same as parseCmaEvent, frames the unknown frame into
+ *                  p_out
  *
- * Parameters       p_event - Data bytes of type Unknown event
+ * Parameters       p_data, dataLen - Data bytes of type Unknown event
+ *                  p_out - output buffer
+ *                  capacity - size of the output buffer
  *
- * Returns          Filters Type-B/Type-F data frames
- *                  and converts other frame to  unknown frame
+ * Returns          Returns the event length, 0 if there is no event
  *
  ***************************************************************************/
-vector<uint8_t> ReaderPollConfigParser::parseCmaEvent(vector<uint8_t> p_event) {
-  vector<uint8_t> event_data = vector<uint8_t>();
+uint16_t ReaderPollConfigParser::writeCmaEvent(const uint8_t* p_data,
+                                               uint16_t dataLen,
+                                               uint8_t* p_out,
+                                               uint16_t capacity) {
+  uint8_t timeStamp[TIMESTAMP_LENGTH] = {0x00, 0x00, 0x00, 0x00};
+  if (unknownEventTimeStamp.size() == TIMESTAMP_LENGTH) {
+    memcpy(timeStamp, unknownEventTimeStamp.data(), TIMESTAMP_LENGTH);
+  }
   if (ReaderPollConfigParser::lastKnownModEvent == EVENT_MOD_B &&
-      p_event.size() > 0 &&
-      p_event[0] == TYPE_B_APF) {  // Type B Apf value is 0x05
+      dataLen > 0 && p_data[0] == TYPE_B_APF) {  // Type B Apf value is 0x05
     if (this->notificationType != TYPE_ONLY_MOD_EVENTS) {
-      event_data = getWellKnownModEventData(
-          TYPE_MOD_B, std::move(unknownEventTimeStamp),
-          ReaderPollConfigParser::lastKnownGain, std::move(p_event));
+      return writeEventData(p_out, capacity, TYPE_MOD_B, timeStamp,
+                            ReaderPollConfigParser::lastKnownGain, p_data,
+                            dataLen);
     }
   } else if (ReaderPollConfigParser::lastKnownModEvent == EVENT_MOD_F) {
     // Ignoring all type f related notification's
-    return event_data;
+    return 0;
   } else {
-    event_data =
-        getUnknownEvent(std::move(p_event), std::move(unknownEventTimeStamp),
-                        ReaderPollConfigParser::lastKnownGain);
+    return writeEventData(p_out, capacity, TYPE_UNKNOWN, timeStamp,
+                          ReaderPollConfigParser::lastKnownGain, p_data,
+                          dataLen);
   }
-  return event_data;
+  return 0;
+}
+
+/*****************************************************************************
+ *
+ * Function         parseCmaEvent
+ *
+ * Description      This function parses the unknown frames
+ *
+ * Parameters       p_event - Data bytes of type Unknown event
+ *
+ * Returns          Filters Type-B/Type-F data frames
+ *                  and converts other frame to  unknown frame
+ *
+ ***************************************************************************/
+vector<uint8_t> ReaderPollConfigParser::parseCmaEvent(vector<uint8_t> p_event) {
+  uint8_t event[NCI_MESSAGE_OFFSET + 0xFF];
+  uint16_t len =
+      writeCmaEvent(p_event.data(), p_event.size(), event, sizeof(event));
+  return vector<uint8_t>(event, event + len);
+}
+
+/*****************************************************************************
+ *
+ * Function         getTimestampInMicroSeconds
+ *
+ * Description      Function to convert Timestamp in microseconds and gives it
+ *                  in Big endian format
+ *
+ * Parameters       p_rawFrame, len - Lx event
+ *                  p_timeStamp - TIMESTAMP_LENGTH bytes output
+ *
+ * Returns          void
+ *
+ ****************************************************************************/
+void ReaderPollConfigParser::getTimestampInMicroSeconds(
+    const uint8_t* p_rawFrame, uint16_t len, uint8_t* p_timeStamp) {
+  if (len < TIMESTAMP_LENGTH) {
+    memset(p_timeStamp, 0x00, TIMESTAMP_LENGTH);
+    return;
+  }
+  uint32_t timeStampInMicroSeconds =
+      ((p_rawFrame[1] << 8) + p_rawFrame[0]) * 1000 +
+      ((p_rawFrame[3] << 8) + p_rawFrame[2]);
+
+  p_timeStamp[0] = (timeStampInMicroSeconds >> 24) & 0xFF;
+  p_timeStamp[1] = (timeStampInMicroSeconds >> 16) & 0xFF;
+  p_timeStamp[2] = (timeStampInMicroSeconds >> 8) & 0xFF;
+  p_timeStamp[3] = (timeStampInMicroSeconds) & 0xFF;
 }
 
 /*****************************************************************************
@@ -170,51 +271,44 @@ vector<uint8_t> ReaderPollConfigParser::parseCmaEvent(vector<uint8_t> p_event) {
  ****************************************************************************/
 vector<uint8_t> ReaderPollConfigParser::getTimestampInMicroSeconds(
     vector<uint8_t> rawFrame) {
-  if (rawFrame.size() < 4) {
-    return vector<uint8_t>{0x00, 0x00, 0x00, 0x00};
-  }
-  uint32_t timeStampInMicroSeconds =
-      ((rawFrame.at(1) << 8) + rawFrame.at(0)) * 1000 +
-      ((rawFrame.at(3) << 8) + rawFrame.at(2));
-
-  vector<uint8_t> timeStamp;
-  timeStamp.push_back((timeStampInMicroSeconds >> 24) & 0xFF);
-  timeStamp.push_back((timeStampInMicroSeconds >> 16) & 0xFF);
-  timeStamp.push_back((timeStampInMicroSeconds >> 8) & 0xFF);
-  timeStamp.push_back((timeStampInMicroSeconds) & 0xFF);
-
+  vector<uint8_t> timeStamp(TIMESTAMP_LENGTH);
+  getTimestampInMicroSeconds(rawFrame.data(), rawFrame.size(),
+                             timeStamp.data());
   return timeStamp;
 }
 
 /*****************************************************************************
  *
- * Function         getEvent
+ * Function         writeEvent
  *
- * Description      It identifies the type of event and gets the reader poll
- *                  info
- *                  notification
+ * Description      It identifies the type of event and frames the reader poll
+ *                  info event into p_out
  *
- * Parameters       p_event - Vector Lx Notification
+ * Parameters       p_event, eventLen - Lx Notification entry
  *                  cmaEventType - CMA event type
+ *                  p_out - output buffer
+ *                  capacity - size of the output buffer
  *
- * Returns          This function return reader poll info notification
+ * Returns          Returns the event length, 0 if there is no event
  *
  ****************************************************************************/
-vector<uint8_t> ReaderPollConfigParser::getEvent(vector<uint8_t> p_event,
-                                                 uint8_t cmaEventType) {
-  vector<uint8_t> event_data;
-  if ((cmaEventType == L2_EVT_TAG &&
-       (int)p_event.size() < MIN_LEN_NON_CMA_EVT) ||
-      (cmaEventType == CMA_EVT_TAG && (int)p_event.size() < MIN_LEN_CMA_EVT) ||
+uint16_t ReaderPollConfigParser::writeEvent(const uint8_t* p_event,
+                                            uint16_t eventLen,
+                                            uint8_t cmaEventType,
+                                            uint8_t* p_out,
+                                            uint16_t capacity) {
+  if ((cmaEventType == L2_EVT_TAG && eventLen < MIN_LEN_NON_CMA_EVT) ||
+      (cmaEventType == CMA_EVT_TAG && eventLen < MIN_LEN_CMA_EVT) ||
       (cmaEventType == CMA_EVT_EXTRA_DATA_TAG &&
-       (int)p_event.size() < MIN_LEN_CMA_EXTRA_DATA_EVT)) {
-    return event_data;
+       eventLen < MIN_LEN_CMA_EXTRA_DATA_EVT)) {
+    return 0;
   }
 
+  uint16_t len = 0;
   if (cmaEventType == L2_EVT_TAG) {
     // Timestamp should be in Big Endian format
-
-    vector<uint8_t> timestamp = getTimestampInMicroSeconds(p_event);
+    uint8_t timestamp[TIMESTAMP_LENGTH];
+    getTimestampInMicroSeconds(p_event, eventLen, timestamp);
 
     ReaderPollConfigParser::lastKnownGain = GAIN_NOT_SUPPORTED;
     if (gpMeasuredFieldStrength_of_gpRssiAt8Am != -1) {
@@ -238,18 +332,18 @@ vector<uint8_t> ReaderPollConfigParser::getEvent(vector<uint8_t> p_event,
           case EVENT_MOD_A:
             ReaderPollConfigParser::lastKnownModEvent = EVENT_MOD_A;
             if (this->notificationType != TYPE_ONLY_CMA_EVENTS) {
-              event_data = getWellKnownModEventData(
-                  TYPE_MOD_A, std::move(timestamp),
-                  ReaderPollConfigParser::lastKnownGain);
+              len = writeEventData(p_out, capacity, TYPE_MOD_A, timestamp,
+                                   ReaderPollConfigParser::lastKnownGain,
+                                   nullptr, 0);
             }
             break;
 
           case EVENT_MOD_B:
             ReaderPollConfigParser::lastKnownModEvent = EVENT_MOD_B;
             if (this->notificationType != TYPE_ONLY_CMA_EVENTS) {
-              event_data = getWellKnownModEventData(
-                  TYPE_MOD_B, std::move(timestamp),
-                  ReaderPollConfigParser::lastKnownGain);
+              len = writeEventData(p_out, capacity, TYPE_MOD_B, timestamp,
+                                   ReaderPollConfigParser::lastKnownGain,
+                                   nullptr, 0);
             }
             break;
 
@@ -262,16 +356,22 @@ vector<uint8_t> ReaderPollConfigParser::getEvent(vector<uint8_t> p_event,
         }
         break;
 
-      case EVENT_RF_ON:
+      case EVENT_RF_ON: {
         // External RF Field is ON
-        event_data = getRFEventData(
-            std::move(timestamp), ReaderPollConfigParser::lastKnownGain, true);
+        const uint8_t rfState = 0x01;
+        len = writeEventData(p_out, capacity, TYPE_RF_FLAG, timestamp,
+                             ReaderPollConfigParser::lastKnownGain, &rfState,
+                             RF_STATE_FIELD_LENGTH);
         break;
+      }
 
-      case EVENT_RF_OFF:
-        event_data = getRFEventData(
-            std::move(timestamp), ReaderPollConfigParser::lastKnownGain, false);
+      case EVENT_RF_OFF: {
+        const uint8_t rfState = 0x00;
+        len = writeEventData(p_out, capacity, TYPE_RF_FLAG, timestamp,
+                             ReaderPollConfigParser::lastKnownGain, &rfState,
+                             RF_STATE_FIELD_LENGTH);
         break;
+      }
 
       default:
         break;
@@ -279,25 +379,18 @@ vector<uint8_t> ReaderPollConfigParser::getEvent(vector<uint8_t> p_event,
 
   } else if (cmaEventType == CMA_EVT_TAG) {
     // Timestamp should be in Big Endian format
-    int idx = 3;
-    vector<uint8_t> timestamp = getTimestampInMicroSeconds(p_event);
+    uint8_t timestamp[TIMESTAMP_LENGTH];
+    getTimestampInMicroSeconds(p_event, eventLen, timestamp);
     switch (p_event[INDEX_OF_CMA_EVT_TYPE]) {
       // Trigger Type
       case CMA_EVENT_TRIGGER_TYPE:
         switch (p_event[INDEX_OF_CMA_EVT_DATA]) {
           case REQ_A:
-            if (this->notificationType != TYPE_ONLY_MOD_EVENTS) {
-              event_data = getWellKnownModEventData(
-                  TYPE_MOD_A, std::move(timestamp),
-                  ReaderPollConfigParser::lastKnownGain, {REQ_A});
-            }
-            break;
-
           case WUP_A:
             if (this->notificationType != TYPE_ONLY_MOD_EVENTS) {
-              event_data = getWellKnownModEventData(
-                  TYPE_MOD_A, std::move(timestamp),
-                  ReaderPollConfigParser::lastKnownGain, {WUP_A});
+              len = writeEventData(p_out, capacity, TYPE_MOD_A, timestamp,
+                                   ReaderPollConfigParser::lastKnownGain,
+                                   &p_event[INDEX_OF_CMA_EVT_DATA], 1);
             }
             break;
           default:
@@ -307,7 +400,7 @@ vector<uint8_t> ReaderPollConfigParser::getEvent(vector<uint8_t> p_event,
       case CMA_DATA_TRIGGER_TYPE: {
         readExtraBytesForUnknownEvent = true;
         extraByteLength = p_event[INDEX_OF_CMA_EVT_DATA];
-        unknownEventTimeStamp = std::move(timestamp);
+        unknownEventTimeStamp.assign(timestamp, timestamp + TIMESTAMP_LENGTH);
         break;
       }
       default:
@@ -315,51 +408,83 @@ vector<uint8_t> ReaderPollConfigParser::getEvent(vector<uint8_t> p_event,
     }
   } else if (cmaEventType == CMA_EVT_EXTRA_DATA_TAG &&
              readExtraBytesForUnknownEvent) {
-    extraBytes.insert(std::end(extraBytes), std::begin(p_event),
-                      std::end(p_event));
+    // Within the reserved capacity: at most 0xFF bytes were read before
+    extraBytes.insert(std::end(extraBytes), p_event, p_event + eventLen);
 
     // If the required bytes received from Extra Data frames, process the
     // unknown event and reset the extra data bytes
     if (extraBytes.size() >= extraByteLength) {
-      event_data = parseCmaEvent(std::move(extraBytes));
+      len = writeCmaEvent(extraBytes.data(), extraBytes.size(), p_out,
+                          capacity);
       resetExtraBytesInfo();
     }
   }
 
-  return event_data;
+  return len;
+}
+
+/*****************************************************************************
+ *
+ * Function         getEvent
+ *
+ * Description      It identifies the type of event and gets the reader poll
+ *                  info
+ *                  notification
+ *
+ * Parameters       p_event - Vector Lx Notification
+ *                  cmaEventType - CMA event type
+ *
+ * Returns          This function return reader poll info notification
+ *
+ ****************************************************************************/
+vector<uint8_t> ReaderPollConfigParser::getEvent(vector<uint8_t> p_event,
+                                                 uint8_t cmaEventType) {
+  uint8_t event[NCI_MESSAGE_OFFSET + 0xFF];
+  uint16_t len = writeEvent(p_event.data(), p_event.size(), cmaEventType,
+                            event, sizeof(event));
+  return vector<uint8_t>(event, event + len);
 }
 
 /*****************************************************************************
  *
  * Function         notifyPollingLoopInfoEvent
  *
- * Description      It sends polling info notification to upper layer
+ * Description      It sends the events framed in notification to upper layer
  *
- * Parameters       p_data - Polling loop info notification
+ * Parameters       eventsLen - length of the events
  *
  * Returns          void
  *
  ****************************************************************************/
-void ReaderPollConfigParser::notifyPollingLoopInfoEvent(
-    const std::vector<uint8_t>& p_data) {
+void ReaderPollConfigParser::notifyPollingLoopInfoEvent(uint16_t eventsLen) {
   if (callback == nullptr) return;
 
-  constexpr size_t NCI_HEADER_SIZE = 3;
-  const size_t payload_size = p_data.size() + 1;  //+1 for OBSERVEMODE_OP_CODE
-  const size_t total_size = NCI_HEADER_SIZE + payload_size;
+  const uint16_t payload_size = eventsLen + 1;  //+1 for OBSERVEMODE_OP_CODE
+  notification[0] = NCI_PROP_NTF_GID;
+  notification[1] = NCI_PROP_NTF_ANDROID_OID;
+  notification[2] = static_cast<uint8_t>(payload_size);
+  notification[3] = OBSERVE_MODE_OP_CODE;
 
-  std::vector<uint8_t> readerPollInfoNotifications(total_size);
-
-  size_t index = 0;
-  readerPollInfoNotifications[index++] = NCI_PROP_NTF_GID;
-  readerPollInfoNotifications[index++] = NCI_PROP_NTF_ANDROID_OID;
-  readerPollInfoNotifications[index++] = static_cast<uint8_t>(payload_size);
-  readerPollInfoNotifications[index++] = OBSERVE_MODE_OP_CODE;
-  // Copy payload data
-  std::copy(p_data.begin(), p_data.end(),
-            readerPollInfoNotifications.begin() + index);
+  callback(NCI_MESSAGE_OFFSET + payload_size, notification);
+}
 
-  callback(static_cast<int>(total_size), readerPollInfoNotifications.data());
+/*****************************************************************************
+ *
+ * Function         notifyPollingLoopInfoEvent
+ *
+ * Description      It sends polling info notification to upper layer
+ *
+ * Parameters       p_data - Polling loop info notification
+ *
+ * Returns          void
+ *
+ ****************************************************************************/
+void ReaderPollConfigParser::notifyPollingLoopInfoEvent(
+    const std::vector<uint8_t>& p_data) {
+  const uint16_t len = std::min<size_t>(p_data.size(), MAX_EVENTS_LENGTH);
+  std::copy(p_data.begin(), p_data.begin() + len,
+            &notification[NCI_MESSAGE_OFFSET + 1]);
+  notifyPollingLoopInfoEvent(len);
 }
 
 /*****************************************************************************
@@ -381,18 +506,21 @@ bool ReaderPollConfigParser::parseAndSendReaderPollInfo(uint8_t* p_ntf,
   if (!p_ntf || (!isLxNotification(p_ntf, p_len))) {
     return false;
   }
-  vector<uint8_t> lxNotification = vector<uint8_t>(p_ntf, p_ntf + p_len);
   uint16_t idx = NCI_MESSAGE_OFFSET;
 
-  vector<uint8_t> readerPollInfoNotifications;
+  uint8_t* p_events = &notification[NCI_MESSAGE_OFFSET + 1];
+  // Events held back by batching go first
+  uint16_t eventsLen = pendingEventsLen;
+  bool hasEvents = false;
+  uint8_t readerPollInfo[MAX_EVENTS_LENGTH];
   while (idx < p_len) {
-    uint8_t entryTag = ((lxNotification[idx] & LX_TAG_MASK) >> 4);
-    uint8_t entryLength = (lxNotification[idx] & LX_LENGTH_MASK);
+    uint8_t entryTag = ((p_ntf[idx] & LX_TAG_MASK) >> 4);
+    uint8_t entryLength = (p_ntf[idx] & LX_LENGTH_MASK);
 
     idx++;
     if ((entryTag == L2_EVT_TAG || entryTag == CMA_EVT_TAG ||
          entryTag == CMA_EVT_EXTRA_DATA_TAG) &&
-        lxNotification.size() >= (idx + entryLength)) {
+        p_len >= (idx + entryLength)) {
       /*
         Reset the extra data bytes, If it receives other events while reading
         for unknown event chained frames
@@ -401,34 +529,120 @@ bool ReaderPollConfigParser::parseAndSendReaderPollInfo(uint8_t* p_ntf,
           (entryTag == L2_EVT_TAG || entryTag == CMA_EVT_TAG)) {
         resetExtraBytesInfo();
       }
-      vector<uint8_t> readerPollInfo =
-          getEvent(vector<uint8_t>(lxNotification.begin() + idx,
-                                   lxNotification.begin() + idx + entryLength),
-                   entryTag);
-
-      if ((int)(readerPollInfoNotifications.size() + readerPollInfo.size()) >=
-          0xFF) {
-        notifyPollingLoopInfoEvent(readerPollInfoNotifications);
-        readerPollInfoNotifications.clear();
+      uint16_t len = writeEvent(&p_ntf[idx], entryLength, entryTag,
+                                readerPollInfo, sizeof(readerPollInfo));
+
+      if (eventsLen + len >= 0xFF) {
+        notifyPollingLoopInfoEvent(eventsLen);
+        eventsLen = 0;
+      }
+      memcpy(&p_events[eventsLen], readerPollInfo, len);
+      eventsLen += len;
+      hasEvents |= (len > 0);
+
+      if (batchPollingFrames && len > 0 &&
+          isBatchFlushEvent(readerPollInfo, len)) {
+        notifyPollingLoopInfoEvent(eventsLen);
+        eventsLen = 0;
       }
-      readerPollInfoNotifications.insert(readerPollInfoNotifications.end(),
-                                         readerPollInfo.begin(),
-                                         readerPollInfo.end());
     }
 
     idx += entryLength;
   }
 
-  if (readerPollInfoNotifications.size() == 0 ||
-      readerPollInfoNotifications.size() >= 0xFF) {
+  if (batchPollingFrames) {
+    pendingEventsLen = eventsLen;
+    return hasEvents;
+  }
+
+  if (eventsLen == 0) {
     return false;
   }
 
-  notifyPollingLoopInfoEvent(readerPollInfoNotifications);
+  notifyPollingLoopInfoEvent(eventsLen);
 
   return true;
 }
 
+/*****************************************************************************
+ *
+ * Function         isBatchFlushEvent
+ *
+ * Description      Checks if the batched events must be sent right after
+ *                  this one: RF field off and unknown polling frames, which
+ *                  an application may be waiting for. REQ_A/WUP_A and type
+ *                  B frames, from modulation or CMA events, are batched.
+ *
+ * Parameters       p_event, eventLen - reader poll info event
+ *
+ * Returns          true if the batched events must be sent
+ *
+ ****************************************************************************/
+bool ReaderPollConfigParser::isBatchFlushEvent(const uint8_t* p_event,
+                                               uint16_t eventLen) {
+  if (p_event[0] == TYPE_UNKNOWN) return true;
+  // RF state is the last byte of a TYPE_RF_FLAG event
+  return p_event[0] == TYPE_RF_FLAG && p_event[eventLen - 1] == 0x00;
+}
+
+/*****************************************************************************
+ *
+ * Function         setBatchingEnabled
+ *
+ * Description      Function to batch the events of consecutive Lx
+ *                  notifications in one notification. Disabling it sends
+ *                  the pending events.
+ *
+ * Parameters       enable - true to batch the events
+ *
+ * Returns          void
+ *
+ ****************************************************************************/
+void ReaderPollConfigParser::setBatchingEnabled(bool enable) {
+  if (!enable) flushPendingEvents();
+  batchPollingFrames = enable;
+}
+
+/*****************************************************************************
+ *
+ * Function         hasPendingEvents
+ *
+ * Description      Function to check if events are held back by batching
+ *
+ * Returns          true if flushPendingEvents has events to send
+ *
+ ****************************************************************************/
+bool ReaderPollConfigParser::hasPendingEvents() {
+  return pendingEventsLen > 0;
+}
+
+/*****************************************************************************
+ *
+ * Function         flushPendingEvents
+ *
+ * Description      Function to send the events held back by batching
+ *
+ * Returns          void
+ *
+ ****************************************************************************/
+void ReaderPollConfigParser::flushPendingEvents() {
+  if (pendingEventsLen == 0) return;
+  uint16_t eventsLen = pendingEventsLen;
+  pendingEventsLen = 0;
+  notifyPollingLoopInfoEvent(eventsLen);
+}
+
+/*****************************************************************************
+ *
+ * Function         clearPendingEvents
+ *
+ * Description      Function to drop the events held back by batching
+ *
+ * Returns          void
+ *
+ ****************************************************************************/
+void ReaderPollConfigParser::clearPendingEvents() { pendingEventsLen = 0; }
+
 /*****************************************************************************
  *
  * Function         parseAndSendReaderPollInfo
@@ -477,8 +691,9 @@ void ReaderPollConfigParser::setReaderPollCallBack(
 void ReaderPollConfigParser::resetExtraBytesInfo() {
   readExtraBytesForUnknownEvent = false;
   extraByteLength = 0;
-  extraBytes = vector<uint8_t>();
-  unknownEventTimeStamp = vector<uint8_t>();
+  // Keeps the reserved capacity
+  extraBytes.clear();
+  unknownEventTimeStamp.clear();
 }
 
 /*****************************************************************************
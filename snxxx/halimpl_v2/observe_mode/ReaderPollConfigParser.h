@@ -16,11 +16,16 @@
 #ifndef _PHNXPNCIHAL_READER_POLLCONFIG_PARSER_H_
 #define _PHNXPNCIHAL_READER_POLLCONFIG_PARSER_H_
 
+#include <phNfcNciConstants.h>
+#include <stdint.h>
+
 #include <vector>
 
 using std::string;
 using std::vector;
 
+#define ReaderPollConfigParserInstance (ReaderPollConfigParser::getInstance())
+
 typedef void(reader_poll_info_callback_t)(uint16_t data_len, uint8_t* p_data);
 void setInterpolatedRssi8Am(uint16_t rssiAt8Am, uint8_t measuredFieldStrength);
 
@@ -30,12 +35,117 @@ void setInterpolatedRssi8Am(uint16_t rssiAt8Am, uint8_t measuredFieldStrength);
  * Modulation event's and RF ON & OFF event's, all the other
  * notifications it considers it as Unknown event's
  *
+ * Events are framed in place into a fixed size buffer of the parser, a
+ * long-lived parser handles Lx notifications without heap allocation.
+ *
  */
 class ReaderPollConfigParser {
  private:
+  /* Timestamp of an event, in microseconds, big endian */
+  static constexpr uint8_t TIMESTAMP_LENGTH = 4;
+  /* Events of one notification: with OBSERVE_MODE_OP_CODE, the payload must
+   * fit in the NCI length field */
+  static constexpr uint16_t MAX_EVENTS_LENGTH = 0xFE;
+  /* Extra data of an unknown event: its length, plus the last chunk */
+  static constexpr uint16_t MAX_EXTRA_BYTES_LENGTH = 0xFF + LX_LENGTH_MASK;
+
   reader_poll_info_callback_t* callback = nullptr;
   static uint8_t lastKnownGain;
   static uint8_t lastKnownModEvent;
+  /* NCI header, OBSERVE_MODE_OP_CODE and the events */
+  uint8_t notification[NCI_MESSAGE_OFFSET + 1 + MAX_EVENTS_LENGTH];
+  /* Events of notification not sent yet, when batching */
+  uint16_t pendingEventsLen = 0;
+  bool batchPollingFrames = false;
+
+  /*****************************************************************************
+   *
+   * Function         writeEventData
+   *
+   * Description      Frames a reader poll info event into p_out
+   *
+   * Parameters       p_out - output buffer
+   *                  capacity - size of the output buffer
+   *                  type - event type: RF, A, B, F or Unknown
+   *                  p_timeStamp - TIMESTAMP_LENGTH bytes time stamp
+   *                  gain - RSSI value
+   *                  p_data, dataLen - data of the event
+   *
+   * Returns          Returns the event length, 0 if it does not fit
+   *
+   ****************************************************************************/
+  static uint16_t writeEventData(uint8_t* p_out, uint16_t capacity,
+                                 uint8_t type, const uint8_t* p_timeStamp,
+                                 uint8_t gain, const uint8_t* p_data,
+                                 uint16_t dataLen);
+
+  /*****************************************************************************
+   *
+   * Function         writeCmaEvent
+   *
+   * Description      Same as parseCmaEvent, frames the unknown frame into
+   *                  p_out
+   *
+   * Parameters       p_data, dataLen - Data bytes of type Unknown event
+   *                  p_out - output buffer
+   *                  capacity - size of the output buffer
+   *
+   * Returns          Returns the event length, 0 if there is no event
+   *
+   ***************************************************************************/
+  uint16_t writeCmaEvent(const uint8_t* p_data, uint16_t dataLen,
+                         uint8_t* p_out, uint16_t capacity);
+
+  /*****************************************************************************
+   *
+   * Function         writeEvent
+   *
+   * Description      Same as getEvent, frames the reader poll info event
+   *                  into p_out
+   *
+   * Parameters       p_event, eventLen - Lx Notification entry
+   *                  cmaEventType - CMA event type
+   *                  p_out - output buffer
+   *                  capacity - size of the output buffer
+   *
+   * Returns          Returns the event length, 0 if there is no event
+   *
+   ****************************************************************************/
+  uint16_t writeEvent(const uint8_t* p_event, uint16_t eventLen,
+                      uint8_t cmaEventType, uint8_t* p_out, uint16_t capacity);
+
+  /*****************************************************************************
+   *
+   * Function         notifyPollingLoopInfoEvent
+   *
+   * Description      It sends the events framed in notification to upper layer
+   *
+   * Parameters       eventsLen - length of the events
+   *
+   * Returns          void
+   *
+   ****************************************************************************/
+  void notifyPollingLoopInfoEvent(uint16_t eventsLen);
+
+  /*****************************************************************************
+   *
+   * Function         isBatchFlushEvent
+   *
+   * Description      Checks if the batched events must be sent right after
+   *                  this one: RF field off and unknown polling frames, which
+   *                  an application may be waiting for. REQ_A/WUP_A and type
+   *                  B frames, from modulation or CMA events, are batched.
+   *
+   * Parameters       p_event, eventLen - reader poll info event
+   *
+   * Returns          true if the batched events must be sent
+   *
+   ****************************************************************************/
+  static bool isBatchFlushEvent(const uint8_t* p_event, uint16_t eventLen);
+
+  /*
+    The vector based functions below allocate, they are kept for the unit tests
+  */
 
   /*****************************************************************************
    *
@@ -141,8 +251,22 @@ class ReaderPollConfigParser {
   bool readExtraBytesForUnknownEvent = false;
   uint8_t extraByteLength = 0;
   uint8_t notificationType = 0;
+  /* Capacity reserved once, never reallocated while parsing */
   vector<uint8_t> unknownEventTimeStamp;
   vector<uint8_t> extraBytes = vector<uint8_t>();
+
+  ReaderPollConfigParser();
+
+  /*****************************************************************************
+   *
+   * Function         getInstance
+   *
+   * Description      Parser of the Lx notifications received by the HAL
+   *
+   * Returns          Returns the long-lived parser instance
+   *
+   ****************************************************************************/
+  static ReaderPollConfigParser& getInstance();
   /*****************************************************************************
    *
    * Function         parseAndSendReaderPollInfo
@@ -214,6 +338,55 @@ class ReaderPollConfigParser {
    ****************************************************************************/
   void setNotificationType(uint8_t notificationType);
 
+  /*****************************************************************************
+   *
+   * Function         setBatchingEnabled
+   *
+   * Description      Function to batch the events of consecutive Lx
+   *                  notifications in one notification, sent once it is full,
+   *                  on RF field off and unknown polling frames, or by
+   *                  flushPendingEvents. Disabling it sends the pending events.
+   *
+   * Parameters       enable - true to batch the events
+   *
+   * Returns          void
+   *
+   ****************************************************************************/
+  void setBatchingEnabled(bool enable);
+
+  /*****************************************************************************
+   *
+   * Function         hasPendingEvents
+   *
+   * Description      Function to check if events are held back by batching
+   *
+   * Returns          true if flushPendingEvents has events to send
+   *
+   ****************************************************************************/
+  bool hasPendingEvents();
+
+  /*****************************************************************************
+   *
+   * Function         flushPendingEvents
+   *
+   * Description      Function to send the events held back by batching
+   *
+   * Returns          void
+   *
+   ****************************************************************************/
+  void flushPendingEvents();
+
+  /*****************************************************************************
+   *
+   * Function         clearPendingEvents
+   *
+   * Description      Function to drop the events held back by batching
+   *
+   * Returns          void
+   *
+   ****************************************************************************/
+  void clearPendingEvents();
+
   /*****************************************************************************
    *
    * Function         getTimestampInMicroSeconds
@@ -228,6 +401,21 @@ class ReaderPollConfigParser {
    ****************************************************************************/
   vector<uint8_t> getTimestampInMicroSeconds(vector<uint8_t> rawFrame);
 
+  /*****************************************************************************
+   *
+   * Function         getTimestampInMicroSeconds
+   *
+   * Description      Same as above, without allocation
+   *
+   * Parameters       p_rawFrame, len - Lx event
+   *                  p_timeStamp - TIMESTAMP_LENGTH bytes output
+   *
+   * Returns          void
+   *
+   ****************************************************************************/
+  static void getTimestampInMicroSeconds(const uint8_t* p_rawFrame,
+                                         uint16_t len, uint8_t* p_timeStamp);
+
   /*****************************************************************************
    *
    * Function         resetLastKnownValues
@@ -17,7 +17,10 @@
  ******************************************************************************/
 
 #include <NfccI2cTransport.h>
+#include <NfccReplayTransport.h>
+#include <NfccSimTransport.h>
 #include <NfccTransportFactory.h>
+#include <cutils/properties.h>
 #include <phNxpLog.h>
 
 /*******************************************************************************
@@ -56,18 +59,32 @@ NfccTransportFactory& NfccTransportFactory::getInstance() {
 ** Description      selects and returns transport channel based on the input
 **                  parameter
 **
-** Parameters       Required transport Type
+** Parameters       Required transport Type. The simulated NFCC and the
+**                  capture replay are test transports, only served on
+**                  debuggable builds: I2C is used instead on user builds.
 **
 ** Returns          Selected transport channel
 ******************************************************************************/
 spTransport NfccTransportFactory::getTransport(transportIntf transportType) {
   NXPLOG_TML_D("%s Requested transportType: %d\n", __func__, transportType);
   spTransport mspTransportInterface;
+  if ((transportType == SIM || transportType == REPLAY) &&
+      !property_get_bool("ro.debuggable", false)) {
+    NXPLOG_TML_E("%s test transport %d refused on a user build, using I2C",
+                 __func__, transportType);
+    transportType = I2C;
+  }
   switch (transportType) {
     case I2C:
     case UNKNOWN:
       mspTransportInterface = std::make_shared<NfccI2cTransport>();
       break;
+    case SIM:
+      mspTransportInterface = std::make_shared<NfccSimTransport>();
+      break;
+    case REPLAY:
+      mspTransportInterface = std::make_shared<NfccReplayTransport>();
+      break;
     default:
       mspTransportInterface = std::make_shared<NfccI2cTransport>();
       break;
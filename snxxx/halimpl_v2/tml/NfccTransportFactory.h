@@ -23,7 +23,7 @@
 
 #define transportFactory (NfccTransportFactory::getInstance())
 typedef std::shared_ptr<NfccTransport> spTransport;
-enum transportIntf : uint8_t { I2C, I3C, UNKNOWN };
+enum transportIntf : uint8_t { I2C, I3C, UNKNOWN, SIM, REPLAY };
 
 extern spTransport gpTransportObj;
 class NfccTransportFactory {
@@ -17,28 +17,164 @@
 /*
  * DAL independent message queue implementation for Android (can be used under
  * Linux too)
+ *
+ * Each queue is a bounded ring of preallocated message slots. Any number of
+ * threads may post to a queue, but exactly one thread drains it (the HAL
+ * reader thread for the client queue, the writer thread for the writer
+ * queue). Slots carry a sequence number so that producers only need a single
+ * CAS to claim a slot and the consumer needs none. The consumer sleeps on an
+ * eventfd which producers only signal when it is actually waiting.
+ *
+ * A post never fails: when the ring is full the message goes to an overflow
+ * list, and keeps going there until the consumer has drained it, so that
+ * messages of a thread stay in order. The consumer takes from the overflow
+ * list only once every slot claimed before is consumed.
  */
 
 #include <errno.h>
 #include <linux/ipc.h>
 #include <phDal4Nfc_messageQueueLib.h>
 #include <phNxpLog.h>
-#include <pthread.h>
-#include <semaphore.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <new>
+
+/* Number of slots per queue, must be a power of two */
+#define PH_DAL4NFC_MSG_QUEUE_DEPTH (128U)
+#define PH_DAL4NFC_MSG_QUEUE_MASK (PH_DAL4NFC_MSG_QUEUE_DEPTH - 1U)
 
-typedef struct phDal4Nfc_message_queue_item {
+typedef struct phDal4Nfc_message_queue_slot {
+  std::atomic<size_t> nSeq;
   phLibNfc_Message_t nMsg;
-  struct phDal4Nfc_message_queue_item* pPrev;
-  struct phDal4Nfc_message_queue_item* pNext;
-} phDal4Nfc_message_queue_item_t;
+} phDal4Nfc_message_queue_slot_t;
 
 typedef struct phDal4Nfc_message_queue {
-  phDal4Nfc_message_queue_item_t* pItems;
-  pthread_mutex_t nCriticalSectionMutex;
-  sem_t nProcessSemaphore;
-
+  phDal4Nfc_message_queue_slot_t aSlots[PH_DAL4NFC_MSG_QUEUE_DEPTH];
+  /* Producer and consumer indexes are kept on separate cache lines */
+  alignas(64) std::atomic<size_t> nEnqueuePos;
+  alignas(64) size_t nDequeuePos;
+  std::atomic<bool> bConsumerWaiting;
+  std::atomic<bool> bReleased;
+  /* Messages posted while the ring was full, in order */
+  std::mutex mOverflowLock;
+  std::deque<phLibNfc_Message_t> mOverflow;
+  std::atomic<size_t> nOverflowCount;
+  int nEventFd;
 } phDal4Nfc_message_queue_t;
 
+/*******************************************************************************
+**
+** Function         phDal4Nfc_msgCopy
+**
+** Description      Copies a message header and only the used part of its
+**                  inline data. Messages which carry their payload by
+**                  reference (Size 0) cost no data copy at all.
+**
+** Parameters       pDst - destination message
+**                  pSrc - source message
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phDal4Nfc_msgCopy(phLibNfc_Message_t* pDst,
+                              const phLibNfc_Message_t* pSrc) {
+  uint32_t dataLen = pSrc->Size;
+  if (dataLen > sizeof(pSrc->data)) dataLen = sizeof(pSrc->data);
+
+  pDst->eMsgType = pSrc->eMsgType;
+  pDst->pMsgData = pSrc->pMsgData;
+  pDst->Size = pSrc->Size;
+  pDst->w_status = pSrc->w_status;
+  memcpy(pDst->data, pSrc->data, dataLen);
+}
+
+/*******************************************************************************
+**
+** Function         phDal4Nfc_msgDequeue
+**
+** Description      Takes the oldest message from the ring, or from the
+**                  overflow list once the ring is drained, if any. Must only
+**                  be called from the single consumer thread.
+**
+** Parameters       pQueue - message queue
+**                  msg    - message to be received
+**
+** Returns          true,  if a message was copied to msg
+**                  false, if the queue is empty
+**
+*******************************************************************************/
+static bool phDal4Nfc_msgDequeue(phDal4Nfc_message_queue_t* pQueue,
+                                 phLibNfc_Message_t* msg) {
+  size_t pos = pQueue->nDequeuePos;
+  phDal4Nfc_message_queue_slot_t* pSlot =
+      &pQueue->aSlots[pos & PH_DAL4NFC_MSG_QUEUE_MASK];
+
+  if (pSlot->nSeq.load(std::memory_order_acquire) == pos + 1) {
+    phDal4Nfc_msgCopy(msg, &pSlot->nMsg);
+    pSlot->nSeq.store(pos + PH_DAL4NFC_MSG_QUEUE_DEPTH,
+                      std::memory_order_release);
+    pQueue->nDequeuePos = pos + 1;
+    return true;
+  }
+  /* A claimed slot not written yet holds an older message than the list */
+  if (pQueue->nOverflowCount.load(std::memory_order_acquire) == 0 ||
+      pQueue->nEnqueuePos.load(std::memory_order_acquire) != pos) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(pQueue->mOverflowLock);
+  phDal4Nfc_msgCopy(msg, &pQueue->mOverflow.front());
+  pQueue->mOverflow.pop_front();
+  pQueue->nOverflowCount.store(pQueue->mOverflow.size(),
+                               std::memory_order_release);
+  return true;
+}
+
+/*******************************************************************************
+**
+** Function         phDal4Nfc_msgPending
+**
+** Description      Checks if the consumer has a message to take, from the
+**                  ring or the overflow list
+**
+** Parameters       pQueue - message queue
+**
+** Returns          true,  if a message is pending
+**                  false, otherwise
+**
+*******************************************************************************/
+static bool phDal4Nfc_msgPending(phDal4Nfc_message_queue_t* pQueue) {
+  size_t pos = pQueue->nDequeuePos;
+  if (pQueue->aSlots[pos & PH_DAL4NFC_MSG_QUEUE_MASK].nSeq.load(
+          std::memory_order_acquire) == pos + 1) {
+    return true;
+  }
+  return pQueue->nOverflowCount.load(std::memory_order_acquire) != 0 &&
+         pQueue->nEnqueuePos.load(std::memory_order_acquire) == pos;
+}
+
+/*******************************************************************************
+**
+** Function         phDal4Nfc_msgWakeConsumer
+**
+** Description      Signals the eventfd the consumer thread sleeps on
+**
+** Parameters       pQueue - message queue
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phDal4Nfc_msgWakeConsumer(phDal4Nfc_message_queue_t* pQueue) {
+  uint64_t one = 1;
+  if (TEMP_FAILURE_RETRY(write(pQueue->nEventFd, &one, sizeof(one))) < 0) {
+    NXPLOG_TML_E("Failed to signal message queue errno = %d", errno);
+  }
+}
+
 /*******************************************************************************
 **
 ** Function         phDal4Nfc_msgget
@@ -48,23 +184,27 @@ typedef struct phDal4Nfc_message_queue {
 ** Parameters       Ignored, included only for Linux queue API compatibility
 **
 ** Returns          (int) value of pQueue if successful
-**                  -1, if failed to allocate memory or to init mutex
+**                  -1, if failed to allocate memory or to create eventfd
 **
 *******************************************************************************/
 intptr_t phDal4Nfc_msgget(key_t key, int msgflg) {
   phDal4Nfc_message_queue_t* pQueue;
   UNUSED_PROP(key);
   UNUSED_PROP(msgflg);
-  pQueue =
-      (phDal4Nfc_message_queue_t*)malloc(sizeof(phDal4Nfc_message_queue_t));
+  pQueue = new (std::nothrow) phDal4Nfc_message_queue_t;
   if (pQueue == NULL) return -1;
-  memset(pQueue, 0, sizeof(phDal4Nfc_message_queue_t));
-  if (pthread_mutex_init(&pQueue->nCriticalSectionMutex, NULL) != 0) {
-    free(pQueue);
-    return -1;
+  for (size_t i = 0; i < PH_DAL4NFC_MSG_QUEUE_DEPTH; i++) {
+    pQueue->aSlots[i].nSeq.store(i, std::memory_order_relaxed);
   }
-  if (sem_init(&pQueue->nProcessSemaphore, 0, 0) == -1) {
-    free(pQueue);
+  pQueue->nEnqueuePos.store(0, std::memory_order_relaxed);
+  pQueue->nDequeuePos = 0;
+  pQueue->bConsumerWaiting.store(false, std::memory_order_relaxed);
+  pQueue->bReleased.store(false, std::memory_order_relaxed);
+  pQueue->nOverflowCount.store(0, std::memory_order_relaxed);
+  pQueue->nEventFd = eventfd(0, EFD_CLOEXEC);
+  if (pQueue->nEventFd < 0) {
+    NXPLOG_TML_E("Failed to create eventfd errno = %d", errno);
+    delete pQueue;
     return -1;
   }
 
@@ -86,14 +226,12 @@ void phDal4Nfc_msgrelease(intptr_t msqid) {
   phDal4Nfc_message_queue_t* pQueue = (phDal4Nfc_message_queue_t*)msqid;
 
   if (pQueue != NULL) {
-    sem_post(&pQueue->nProcessSemaphore);
+    pQueue->bReleased.store(true, std::memory_order_seq_cst);
+    phDal4Nfc_msgWakeConsumer(pQueue);
     usleep(3000);
-    if (sem_destroy(&pQueue->nProcessSemaphore)) {
-      NXPLOG_TML_E("Failed to destroy semaphore (errno=0x%08x)", errno);
-    }
-    pthread_mutex_destroy(&pQueue->nCriticalSectionMutex);
+    close(pQueue->nEventFd);
 
-    free(pQueue);
+    delete pQueue;
   }
 
   return;
@@ -104,7 +242,10 @@ void phDal4Nfc_msgrelease(intptr_t msqid) {
 ** Function         phDal4Nfc_msgsnd
 **
 ** Description      Sends a message to the queue. The message will be added at
-**                  the end of the queue as appropriate for FIFO policy
+**                  the end of the queue as appropriate for FIFO policy. If the
+**                  ring is full the message is appended to the overflow list,
+**                  the caller never waits for the consumer, which may be the
+**                  caller itself.
 **
 ** Parameters       msqid  - message queue handle
 **                  msgp   - message to be sent
@@ -112,40 +253,55 @@ void phDal4Nfc_msgrelease(intptr_t msqid) {
 **                  msgflg - ignored
 **
 ** Returns          0,  if successful
-**                  -1, if invalid parameter passed or failed to allocate memory
+**                  -1, if invalid parameter passed
 **
 *******************************************************************************/
 intptr_t phDal4Nfc_msgsnd(intptr_t msqid, phLibNfc_Message_t* msg, int msgflg) {
   phDal4Nfc_message_queue_t* pQueue;
-  phDal4Nfc_message_queue_item_t* p;
-  phDal4Nfc_message_queue_item_t* pNew;
+  phDal4Nfc_message_queue_slot_t* pSlot = NULL;
+  size_t pos;
+  bool bClaimed = false;
   UNUSED_PROP(msgflg);
   if ((msqid == 0) || (msg == NULL)) return -1;
 
   pQueue = (phDal4Nfc_message_queue_t*)msqid;
-  pNew = (phDal4Nfc_message_queue_item_t*)malloc(
-      sizeof(phDal4Nfc_message_queue_item_t));
-  if (pNew == NULL) {
-    NXPLOG_TML_E("Failed to malloc pNew errno = %d", errno);
-    return -1;
-  }
-  memset(pNew, 0, sizeof(phDal4Nfc_message_queue_item_t));
-  memcpy(&pNew->nMsg, msg, sizeof(phLibNfc_Message_t));
-  pthread_mutex_lock(&pQueue->nCriticalSectionMutex);
-
-  if (pQueue->pItems != NULL) {
-    p = pQueue->pItems;
-    while (p->pNext != NULL) {
-      p = p->pNext;
+  pos = pQueue->nEnqueuePos.load(std::memory_order_relaxed);
+  /* Once a message overflowed, later ones follow it until it is consumed */
+  while (!bClaimed &&
+         pQueue->nOverflowCount.load(std::memory_order_acquire) == 0) {
+    pSlot = &pQueue->aSlots[pos & PH_DAL4NFC_MSG_QUEUE_MASK];
+    size_t seq = pSlot->nSeq.load(std::memory_order_acquire);
+    intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+    if (diff == 0) {
+      bClaimed = pQueue->nEnqueuePos.compare_exchange_weak(
+          pos, pos + 1, std::memory_order_relaxed);
+    } else if (diff < 0) {
+      /* Ring is full */
+      break;
+    } else {
+      pos = pQueue->nEnqueuePos.load(std::memory_order_relaxed);
     }
-    p->pNext = pNew;
-    pNew->pPrev = p;
+  }
+
+  if (bClaimed) {
+    phDal4Nfc_msgCopy(&pSlot->nMsg, msg);
+    pSlot->nSeq.store(pos + 1, std::memory_order_release);
   } else {
-    pQueue->pItems = pNew;
+    std::lock_guard<std::mutex> lock(pQueue->mOverflowLock);
+    if (pQueue->mOverflow.empty()) {
+      NXPLOG_TML_D("Message queue full, message 0x%x overflowed",
+                   msg->eMsgType);
+    }
+    pQueue->mOverflow.emplace_back();
+    phDal4Nfc_msgCopy(&pQueue->mOverflow.back(), msg);
+    pQueue->nOverflowCount.store(pQueue->mOverflow.size(),
+                                 std::memory_order_release);
   }
-  pthread_mutex_unlock(&pQueue->nCriticalSectionMutex);
 
-  sem_post(&pQueue->nProcessSemaphore);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (pQueue->bConsumerWaiting.load(std::memory_order_relaxed)) {
+    phDal4Nfc_msgWakeConsumer(pQueue);
+  }
 
   return 0;
 }
@@ -155,8 +311,9 @@ intptr_t phDal4Nfc_msgsnd(intptr_t msqid, phLibNfc_Message_t* msg, int msgflg) {
 ** Function         phDal4Nfc_msgrcv
 **
 ** Description      Gets the oldest message from the queue.
-**                  If the queue is empty the function waits (blocks on a mutex)
-**                  until a message is posted to the queue with phDal4Nfc_msgsnd
+**                  If the queue is empty the function blocks on the queue
+**                  eventfd until a message is posted to the queue with
+**                  phDal4Nfc_msgsnd or the queue is released
 **
 ** Parameters       msqid  - message queue handle
 **                  msgp   - message to be received
@@ -171,26 +328,139 @@ intptr_t phDal4Nfc_msgsnd(intptr_t msqid, phLibNfc_Message_t* msg, int msgflg) {
 int phDal4Nfc_msgrcv(intptr_t msqid, phLibNfc_Message_t* msg, long msgtyp,
                      int msgflg) {
   phDal4Nfc_message_queue_t* pQueue;
-  phDal4Nfc_message_queue_item_t* p;
+  uint64_t count;
   UNUSED_PROP(msgflg);
   UNUSED_PROP(msgtyp);
   if ((msqid == 0) || (msg == NULL)) return -1;
 
   pQueue = (phDal4Nfc_message_queue_t*)msqid;
 
-  if (-1 == sem_wait(&pQueue->nProcessSemaphore)) {
-    NXPLOG_TML_E("sem_wait didn't return success errno = %d", errno);
+  while (!phDal4Nfc_msgDequeue(pQueue, msg)) {
+    /* Publish that we are about to sleep, then re-check so that a producer
+     * which missed the flag cannot leave a message behind unsignalled. */
+    pQueue->bConsumerWaiting.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (phDal4Nfc_msgDequeue(pQueue, msg)) {
+      pQueue->bConsumerWaiting.store(false, std::memory_order_relaxed);
+      break;
+    }
+    if (pQueue->bReleased.load(std::memory_order_acquire)) {
+      pQueue->bConsumerWaiting.store(false, std::memory_order_relaxed);
+      break;
+    }
+    if (TEMP_FAILURE_RETRY(read(pQueue->nEventFd, &count, sizeof(count))) < 0) {
+      NXPLOG_TML_E("eventfd read didn't return success errno = %d", errno);
+    }
+    pQueue->bConsumerWaiting.store(false, std::memory_order_relaxed);
   }
 
-  pthread_mutex_lock(&pQueue->nCriticalSectionMutex);
+  return 0;
+}
+
+/*******************************************************************************
+**
+** Function         phDal4Nfc_msgfd
+**
+** Description      Gets the eventfd the consumer of the queue sleeps on, to be
+**                  polled by a consumer running an event loop
+**
+** Parameters       msqid - message queue handle
+**
+** Returns          eventfd of the queue, -1 if invalid parameter passed
+**
+*******************************************************************************/
+int phDal4Nfc_msgfd(intptr_t msqid) {
+  if (msqid == 0) return -1;
+  return ((phDal4Nfc_message_queue_t*)msqid)->nEventFd;
+}
+
+/*******************************************************************************
+**
+** Function         phDal4Nfc_msgtryrcv
+**
+** Description      Gets the oldest message from the queue without blocking.
+**                  Must only be called from the single consumer thread.
+**
+** Parameters       msqid  - message queue handle
+**                  msg    - message to be received
+**
+** Returns          0,  if a message was received
+**                  -1, if the queue is empty or invalid parameter passed
+**
+*******************************************************************************/
+int phDal4Nfc_msgtryrcv(intptr_t msqid, phLibNfc_Message_t* msg) {
+  if ((msqid == 0) || (msg == NULL)) return -1;
+  return phDal4Nfc_msgDequeue((phDal4Nfc_message_queue_t*)msqid, msg) ? 0
+                                                                        : -1;
+}
+
+/*******************************************************************************
+**
+** Function         phDal4Nfc_msgarm
+**
+** Description      Publishes that the consumer is about to sleep on the queue
+**                  eventfd, so that producers and phDal4Nfc_msgwake signal it.
+**                  Must be followed by phDal4Nfc_msgdisarm.
+**
+** Parameters       msqid  - message queue handle
+**
+** Returns          true,  if the consumer may sleep
+**                  false, if a message is pending or the queue is released
+**
+*******************************************************************************/
+bool phDal4Nfc_msgarm(intptr_t msqid) {
+  phDal4Nfc_message_queue_t* pQueue = (phDal4Nfc_message_queue_t*)msqid;
+  if (pQueue == NULL) return false;
+
+  pQueue->bConsumerWaiting.store(true, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (phDal4Nfc_msgPending(pQueue)) return false;
+  return !pQueue->bReleased.load(std::memory_order_acquire);
+}
+
+/*******************************************************************************
+**
+** Function         phDal4Nfc_msgdisarm
+**
+** Description      Ends a sleep started with phDal4Nfc_msgarm
+**
+** Parameters       msqid      - message queue handle
+**                  bSignalled - the queue eventfd was reported readable
+**
+** Returns          None
+**
+*******************************************************************************/
+void phDal4Nfc_msgdisarm(intptr_t msqid, bool bSignalled) {
+  phDal4Nfc_message_queue_t* pQueue = (phDal4Nfc_message_queue_t*)msqid;
+  uint64_t count;
+  if (pQueue == NULL) return;
 
-  if (pQueue->pItems != NULL) {
-    memcpy(msg, &(pQueue->pItems)->nMsg, sizeof(phLibNfc_Message_t));
-    p = pQueue->pItems->pNext;
-    free(pQueue->pItems);
-    pQueue->pItems = p;
+  pQueue->bConsumerWaiting.store(false, std::memory_order_relaxed);
+  if (bSignalled &&
+      TEMP_FAILURE_RETRY(read(pQueue->nEventFd, &count, sizeof(count))) < 0) {
+    NXPLOG_TML_E("eventfd read didn't return success errno = %d", errno);
   }
-  pthread_mutex_unlock(&pQueue->nCriticalSectionMutex);
+}
 
-  return 0;
+/*******************************************************************************
+**
+** Function         phDal4Nfc_msgwake
+**
+** Description      Wakes the consumer of the queue without posting a message,
+**                  when it sleeps. Used to make an event loop consumer
+**                  re-evaluate the other sources it waits on.
+**
+** Parameters       msqid  - message queue handle
+**
+** Returns          None
+**
+*******************************************************************************/
+void phDal4Nfc_msgwake(intptr_t msqid) {
+  phDal4Nfc_message_queue_t* pQueue = (phDal4Nfc_message_queue_t*)msqid;
+  if (pQueue == NULL) return;
+
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (pQueue->bConsumerWaiting.load(std::memory_order_relaxed)) {
+    phDal4Nfc_msgWakeConsumer(pQueue);
+  }
 }
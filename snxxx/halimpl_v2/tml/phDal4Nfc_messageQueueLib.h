@@ -29,5 +29,11 @@ void phDal4Nfc_msgrelease(intptr_t msqid);
 intptr_t phDal4Nfc_msgsnd(intptr_t msqid, phLibNfc_Message_t* msg, int msgflg);
 int phDal4Nfc_msgrcv(intptr_t msqid, phLibNfc_Message_t* msg, long msgtyp,
                      int msgflg);
+/* Event loop consumers: wait on the queue eventfd instead of phDal4Nfc_msgrcv */
+int phDal4Nfc_msgfd(intptr_t msqid);
+int phDal4Nfc_msgtryrcv(intptr_t msqid, phLibNfc_Message_t* msg);
+bool phDal4Nfc_msgarm(intptr_t msqid);
+void phDal4Nfc_msgdisarm(intptr_t msqid, bool bSignalled);
+void phDal4Nfc_msgwake(intptr_t msqid);
 
 #endif /*  PHDAL4NFC_MESSAGEQUEUE_H  */
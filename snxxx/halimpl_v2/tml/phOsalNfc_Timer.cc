@@ -25,8 +25,14 @@
 #include <phOsalNfc_Timer.h>
 #include <signal.h>
 
-#define PH_NFC_MAX_TIMER (5U)
-static phOsalNfc_TimerHandle_t apTimerInfo[PH_NFC_MAX_TIMER];
+#include <deque>
+
+/*
+ * Timer handles. A deque keeps the address of a handle stable while it grows,
+ * queued timer messages point into it. Slots are reused after delete.
+ */
+static std::deque<phOsalNfc_TimerHandle_t> apTimerInfo;
+static pthread_mutex_t sTimerInfoLock = PTHREAD_MUTEX_INITIALIZER;
 
 extern phNxpNciHal_Control_t nxpncihal_ctrl;
 
@@ -44,10 +50,19 @@ extern phNxpNciHal_Control_t nxpncihal_ctrl;
  * Invalid timer ID type. This ID used indicate timer creation is failed */
 #define PH_NFC_TIMER_ID_INVALID (0xFFFF)
 
+/*
+ * Number of timers which can exist at the same time, bounded only by the
+ * timer id range.
+ */
+#define PH_NFC_MAX_TIMER \
+  (PH_NFC_TIMER_ID_INVALID - PH_NFC_TIMER_BASE_ADDRESS - 0x01)
+
 /* Forward declarations */
 static void phOsalNfc_PostTimerMsg(phLibNfc_Message_t* pMsg);
 static void phOsalNfc_DeferredCall(void* pParams);
 static void phOsalNfc_Timer_Expired(union sigval sv);
+static uint32_t phOsalNfc_FindAvailableTimer(void);
+static phOsalNfc_TimerHandle_t* phOsalNfc_GetTimerHandle(uint32_t dwTimerId);
 
 /*
  *************************** Function Definitions ******************************
@@ -59,7 +74,7 @@ static void phOsalNfc_Timer_Expired(union sigval sv);
 **
 ** Description      Creates a timer which shall call back the specified function
 **                  when the timer expires. Fails if OSAL module is not
-**                  initialized or timers are already occupied
+**                  initialized or the timer id range is exhausted
 **
 ** Parameters       None
 **
@@ -71,36 +86,30 @@ static void phOsalNfc_Timer_Expired(union sigval sv);
 uint32_t phOsalNfc_Timer_Create(void) {
   /* dwTimerId is also used as an index at which timer object can be stored */
   uint32_t dwTimerId = PH_OSALNFC_TIMER_ID_INVALID;
-  static struct sigevent se;
   phOsalNfc_TimerHandle_t* pTimerHandle;
-  /* Timer needs to be initialized for timer usage */
 
-  se.sigev_notify = SIGEV_THREAD;
-  se.sigev_notify_function = phOsalNfc_Timer_Expired;
-  se.sigev_notify_attributes = NULL;
-  dwTimerId = phUtilNfc_CheckForAvailableTimer();
+  pthread_mutex_lock(&sTimerInfoLock);
+  dwTimerId = phOsalNfc_FindAvailableTimer();
 
   /* Check whether timers are available, if yes create a timer handle structure
    */
-  if ((PH_NFC_TIMER_ID_ZERO != dwTimerId) && (dwTimerId <= PH_NFC_MAX_TIMER)) {
-    pTimerHandle = (phOsalNfc_TimerHandle_t*)&apTimerInfo[dwTimerId - 1];
+  if (PH_NFC_TIMER_ID_ZERO != dwTimerId) {
+    if (dwTimerId > apTimerInfo.size()) {
+      apTimerInfo.emplace_back();
+    }
+    pTimerHandle = &apTimerInfo[dwTimerId - 1];
+    memset(pTimerHandle, (uint8_t)0x00, sizeof(phOsalNfc_TimerHandle_t));
     /* Build the Timer Id to be returned to Caller Function */
     dwTimerId += PH_NFC_TIMER_BASE_ADDRESS;
-    se.sigev_value.sival_int = (int)dwTimerId;
-    /* Create POSIX timer */
-    if (timer_create(CLOCK_REALTIME, &se, &(pTimerHandle->hTimerHandle)) ==
-        -1) {
-      dwTimerId = PH_NFC_TIMER_ID_INVALID;
-    } else {
-      /* Set the state to indicate timer is ready */
-      pTimerHandle->eState = eTimerIdle;
-      /* Store the Timer Id which shall act as flag during check for timer
-       * availability */
-      pTimerHandle->TimerId = dwTimerId;
-    }
+    /* Set the state to indicate timer is ready */
+    pTimerHandle->eState = eTimerIdle;
+    /* Store the Timer Id which shall act as flag during check for timer
+     * availability */
+    pTimerHandle->TimerId = dwTimerId;
   } else {
     dwTimerId = PH_NFC_TIMER_ID_INVALID;
   }
+  pthread_mutex_unlock(&sTimerInfoLock);
 
   /* Timer ID invalid can be due to Uninitialized state,Non availability of
    * Timer */
@@ -138,37 +147,34 @@ NFCSTATUS phOsalNfc_Timer_Start(uint32_t dwTimerId, uint32_t dwRegTimeCnt,
                                 pphOsalNfc_TimerCallbck_t pApplication_callback,
                                 void* pContext) {
   NFCSTATUS wStartStatus = NFCSTATUS_SUCCESS;
-
-  struct itimerspec its;
-  uint32_t dwIndex;
   phOsalNfc_TimerHandle_t* pTimerHandle;
-  /* Retrieve the index at which the timer handle structure is stored */
-  dwIndex = dwTimerId - PH_NFC_TIMER_BASE_ADDRESS - 0x01;
-  if (dwIndex >= PH_NFC_MAX_TIMER) {
+  union sigval tValue;
+
+  pthread_mutex_lock(&sTimerInfoLock);
+  /* Retrieve the timer handle structure */
+  pTimerHandle = phOsalNfc_GetTimerHandle(dwTimerId);
+  if (NULL == pTimerHandle) {
+    pthread_mutex_unlock(&sTimerInfoLock);
     return PHNFCSTVAL(CID_NFC_OSAL, NFCSTATUS_INVALID_PARAMETER);
   }
-  pTimerHandle = (phOsalNfc_TimerHandle_t*)&apTimerInfo[dwIndex];
   /* OSAL Module needs to be initialized for timer usage */
   /* Check whether the handle provided by user is valid */
   if ((0x00 != pTimerHandle->TimerId) && (NULL != pApplication_callback)) {
-    its.it_interval.tv_sec = 0;
-    its.it_interval.tv_nsec = 0;
-    its.it_value.tv_sec = dwRegTimeCnt / 1000;
-    its.it_value.tv_nsec = 1000000 * (dwRegTimeCnt % 1000);
-    if (its.it_value.tv_sec == 0 && its.it_value.tv_nsec == 0) {
-      /* This would inadvertently stop the timer*/
-      its.it_value.tv_nsec = 1;
-    }
     pTimerHandle->Application_callback = pApplication_callback;
     pTimerHandle->pContext = pContext;
     pTimerHandle->eState = eTimerRunning;
-    /* Arm the timer */
-    if ((timer_settime(pTimerHandle->hTimerHandle, 0, &its, NULL)) == -1) {
+    tValue.sival_int = (int)dwTimerId;
+    /* Arm the timer, expiry only posts a message so it runs inline */
+    if (!NfcHalTimerWheel::getInstance().schedule(
+            &pTimerHandle->tWheelEntry, dwRegTimeCnt, phOsalNfc_Timer_Expired,
+            tValue, true)) {
+      pTimerHandle->eState = eTimerIdle;
       wStartStatus = PHNFCSTVAL(CID_NFC_OSAL, PH_OSALNFC_TIMER_START_ERROR);
     }
   } else {
     wStartStatus = PHNFCSTVAL(CID_NFC_OSAL, NFCSTATUS_INVALID_PARAMETER);
   }
+  pthread_mutex_unlock(&sTimerInfoLock);
 
   return wStartStatus;
 }
@@ -194,30 +200,27 @@ NFCSTATUS phOsalNfc_Timer_Start(uint32_t dwTimerId, uint32_t dwRegTimeCnt,
 *******************************************************************************/
 NFCSTATUS phOsalNfc_Timer_Stop(uint32_t dwTimerId) {
   NFCSTATUS wStopStatus = NFCSTATUS_SUCCESS;
-  static struct itimerspec its = {{0, 0}, {0, 0}};
-
-  uint32_t dwIndex;
   phOsalNfc_TimerHandle_t* pTimerHandle;
-  dwIndex = dwTimerId - PH_NFC_TIMER_BASE_ADDRESS - 0x01;
-  if (dwIndex >= PH_NFC_MAX_TIMER) {
+
+  pthread_mutex_lock(&sTimerInfoLock);
+  pTimerHandle = phOsalNfc_GetTimerHandle(dwTimerId);
+  if (NULL == pTimerHandle) {
+    pthread_mutex_unlock(&sTimerInfoLock);
     return PHNFCSTVAL(CID_NFC_OSAL, NFCSTATUS_INVALID_PARAMETER);
   }
-  pTimerHandle = (phOsalNfc_TimerHandle_t*)&apTimerInfo[dwIndex];
   /* OSAL Module and Timer needs to be initialized for timer usage */
   /* Check whether the TimerId provided by user is valid */
   if ((0x00 != pTimerHandle->TimerId) && (pTimerHandle->eState != eTimerIdle)) {
     /* Stop the timer only if the callback has not been invoked */
     if (pTimerHandle->eState == eTimerRunning) {
-      if ((timer_settime(pTimerHandle->hTimerHandle, 0, &its, NULL)) == -1) {
-        wStopStatus = PHNFCSTVAL(CID_NFC_OSAL, PH_OSALNFC_TIMER_STOP_ERROR);
-      } else {
-        /* Change the state of timer to Stopped */
-        pTimerHandle->eState = eTimerStopped;
-      }
+      NfcHalTimerWheel::getInstance().cancel(&pTimerHandle->tWheelEntry);
+      /* Change the state of timer to Stopped */
+      pTimerHandle->eState = eTimerStopped;
     }
   } else {
     wStopStatus = PHNFCSTVAL(CID_NFC_OSAL, NFCSTATUS_INVALID_PARAMETER);
   }
+  pthread_mutex_unlock(&sTimerInfoLock);
 
   return wStopStatus;
 }
@@ -243,29 +246,26 @@ NFCSTATUS phOsalNfc_Timer_Stop(uint32_t dwTimerId) {
 *******************************************************************************/
 NFCSTATUS phOsalNfc_Timer_Delete(uint32_t dwTimerId) {
   NFCSTATUS wDeleteStatus = NFCSTATUS_SUCCESS;
-
-  uint32_t dwIndex;
   phOsalNfc_TimerHandle_t* pTimerHandle;
-  dwIndex = dwTimerId - PH_NFC_TIMER_BASE_ADDRESS - 0x01;
-  if (dwIndex >= PH_NFC_MAX_TIMER) {
+
+  pthread_mutex_lock(&sTimerInfoLock);
+  pTimerHandle = phOsalNfc_GetTimerHandle(dwTimerId);
+  if (NULL == pTimerHandle) {
+    pthread_mutex_unlock(&sTimerInfoLock);
     return PHNFCSTVAL(CID_NFC_OSAL, NFCSTATUS_INVALID_PARAMETER);
   }
-  pTimerHandle = (phOsalNfc_TimerHandle_t*)&apTimerInfo[dwIndex];
   /* OSAL Module and Timer needs to be initialized for timer usage */
 
-  /* Check whether the TimerId passed by user is valid and Deregistering of
-   * timer is successful */
-  if ((0x00 != pTimerHandle->TimerId) &&
-      (NFCSTATUS_SUCCESS == phOsalNfc_CheckTimerPresence(pTimerHandle))) {
+  /* Check whether the TimerId passed by user is valid */
+  if (0x00 != pTimerHandle->TimerId) {
     /* Cancel the timer before deleting */
-    if (timer_delete(pTimerHandle->hTimerHandle) == -1) {
-      wDeleteStatus = PHNFCSTVAL(CID_NFC_OSAL, PH_OSALNFC_TIMER_DELETE_ERROR);
-    }
+    NfcHalTimerWheel::getInstance().cancel(&pTimerHandle->tWheelEntry);
     /* Clear Timer structure used to store timer related data */
     memset(pTimerHandle, (uint8_t)0x00, sizeof(phOsalNfc_TimerHandle_t));
   } else {
     wDeleteStatus = PHNFCSTVAL(CID_NFC_OSAL, NFCSTATUS_INVALID_PARAMETER);
   }
+  pthread_mutex_unlock(&sTimerInfoLock);
   return wDeleteStatus;
 }
 
@@ -284,24 +284,17 @@ NFCSTATUS phOsalNfc_Timer_Delete(uint32_t dwTimerId) {
 *******************************************************************************/
 void phOsalNfc_Timer_Cleanup(void) {
   /* Delete all timers */
-  uint32_t dwIndex;
-  phOsalNfc_TimerHandle_t* pTimerHandle;
-  for (dwIndex = 0; dwIndex < PH_NFC_MAX_TIMER; dwIndex++) {
-    pTimerHandle = (phOsalNfc_TimerHandle_t*)&apTimerInfo[dwIndex];
+  pthread_mutex_lock(&sTimerInfoLock);
+  for (phOsalNfc_TimerHandle_t& tTimerHandle : apTimerInfo) {
     /* OSAL Module and Timer needs to be initialized for timer usage */
-
-    /* Check whether the TimerId passed by user is valid and Deregistering of
-     * timer is successful */
-    if ((0x00 != pTimerHandle->TimerId) &&
-        (NFCSTATUS_SUCCESS == phOsalNfc_CheckTimerPresence(pTimerHandle))) {
+    if (0x00 != tTimerHandle.TimerId) {
       /* Cancel the timer before deleting */
-      if (timer_delete(pTimerHandle->hTimerHandle) == -1) {
-        NXPLOG_TML_E("timer %d delete error!", dwIndex);
-      }
+      NfcHalTimerWheel::getInstance().cancel(&tTimerHandle.tWheelEntry);
       /* Clear Timer structure used to store timer related data */
-      memset(pTimerHandle, (uint8_t)0x00, sizeof(phOsalNfc_TimerHandle_t));
+      memset(&tTimerHandle, (uint8_t)0x00, sizeof(phOsalNfc_TimerHandle_t));
     }
   }
+  pthread_mutex_unlock(&sTimerInfoLock);
 
   return;
 }
@@ -321,16 +314,22 @@ void phOsalNfc_Timer_Cleanup(void) {
 *******************************************************************************/
 static void phOsalNfc_DeferredCall(void* pParams) {
   /* Retrieve the timer id from the parameter */
-  unsigned long dwIndex;
   phOsalNfc_TimerHandle_t* pTimerHandle;
+  pphOsalNfc_TimerCallbck_t pApplication_callback = NULL;
+  void* pContext = NULL;
   if (NULL != pParams) {
-    /* Retrieve the index at which the timer handle structure is stored */
-    dwIndex = (uintptr_t)pParams - PH_NFC_TIMER_BASE_ADDRESS - 0x01;
-    pTimerHandle = (phOsalNfc_TimerHandle_t*)&apTimerInfo[dwIndex];
-    if (pTimerHandle->Application_callback != NULL) {
+    pthread_mutex_lock(&sTimerInfoLock);
+    pTimerHandle = phOsalNfc_GetTimerHandle((uint32_t)(uintptr_t)pParams);
+    /* Ignore expiry of a timer deleted while the message was queued */
+    if ((NULL != pTimerHandle) &&
+        (pTimerHandle->TimerId == (uint32_t)(uintptr_t)pParams)) {
+      pApplication_callback = pTimerHandle->Application_callback;
+      pContext = pTimerHandle->pContext;
+    }
+    pthread_mutex_unlock(&sTimerInfoLock);
+    if (pApplication_callback != NULL) {
       /* Invoke the callback function with osal Timer ID */
-      pTimerHandle->Application_callback((uintptr_t)pParams,
-                                         pTimerHandle->pContext);
+      pApplication_callback((uintptr_t)pParams, pContext);
     }
   }
 
@@ -374,11 +373,15 @@ static void phOsalNfc_PostTimerMsg(phLibNfc_Message_t* pMsg) {
 **
 *******************************************************************************/
 static void phOsalNfc_Timer_Expired(union sigval sv) {
-  uint32_t dwIndex;
   phOsalNfc_TimerHandle_t* pTimerHandle;
 
-  dwIndex = ((uint32_t)(sv.sival_int)) - PH_NFC_TIMER_BASE_ADDRESS - 0x01;
-  pTimerHandle = (phOsalNfc_TimerHandle_t*)&apTimerInfo[dwIndex];
+  pthread_mutex_lock(&sTimerInfoLock);
+  pTimerHandle = phOsalNfc_GetTimerHandle((uint32_t)(sv.sival_int));
+  if ((NULL == pTimerHandle) ||
+      (pTimerHandle->TimerId != (uint32_t)(sv.sival_int))) {
+    pthread_mutex_unlock(&sTimerInfoLock);
+    return;
+  }
   /* Timer is stopped when callback function is invoked */
   pTimerHandle->eState = eTimerStopped;
 
@@ -387,6 +390,7 @@ static void phOsalNfc_Timer_Expired(union sigval sv) {
 
   pTimerHandle->tOsalMessage.eMsgType = PH_LIBNFC_DEFERREDCALL_MSG;
   pTimerHandle->tOsalMessage.pMsgData = (void*)&pTimerHandle->tDeferredCallInfo;
+  pthread_mutex_unlock(&sTimerInfoLock);
 
   /* Post a message on the queue to invoke the function */
   phOsalNfc_PostTimerMsg((phLibNfc_Message_t*)&pTimerHandle->tOsalMessage);
@@ -406,18 +410,11 @@ static void phOsalNfc_Timer_Expired(union sigval sv) {
 **
 *******************************************************************************/
 uint32_t phUtilNfc_CheckForAvailableTimer(void) {
-  /* Variable used to store the index at which the object structure details
-     can be stored. Initialize it as not available. */
-  uint32_t dwIndex = 0x00;
-  uint32_t dwRetval = 0x00;
-
-  /* Check whether Timer object can be created */
-  for (dwIndex = 0x00; ((dwIndex < PH_NFC_MAX_TIMER) && (0x00 == dwRetval));
-       dwIndex++) {
-    if (!(apTimerInfo[dwIndex].TimerId)) {
-      dwRetval = (dwIndex + 0x01);
-    }
-  }
+  uint32_t dwRetval;
+
+  pthread_mutex_lock(&sTimerInfoLock);
+  dwRetval = phOsalNfc_FindAvailableTimer();
+  pthread_mutex_unlock(&sTimerInfoLock);
 
   return (dwRetval);
 }
@@ -435,17 +432,67 @@ uint32_t phUtilNfc_CheckForAvailableTimer(void) {
 **
 *******************************************************************************/
 NFCSTATUS phOsalNfc_CheckTimerPresence(void* pObjectHandle) {
-  uint32_t dwIndex;
   NFCSTATUS wRegisterStatus = NFCSTATUS_INVALID_PARAMETER;
 
-  for (dwIndex = 0x00;
-       ((dwIndex < PH_NFC_MAX_TIMER) && (wRegisterStatus != NFCSTATUS_SUCCESS));
-       dwIndex++) {
+  pthread_mutex_lock(&sTimerInfoLock);
+  for (phOsalNfc_TimerHandle_t& tTimerHandle : apTimerInfo) {
     /* For Timer, check whether the requested handle is present or not */
-    if (((&apTimerInfo[dwIndex]) == (phOsalNfc_TimerHandle_t*)pObjectHandle) &&
-        (apTimerInfo[dwIndex].TimerId)) {
+    if ((&tTimerHandle == (phOsalNfc_TimerHandle_t*)pObjectHandle) &&
+        (tTimerHandle.TimerId)) {
       wRegisterStatus = NFCSTATUS_SUCCESS;
+      break;
     }
   }
+  pthread_mutex_unlock(&sTimerInfoLock);
   return wRegisterStatus;
 }
+
+/*******************************************************************************
+**
+** Function         phOsalNfc_FindAvailableTimer
+**
+** Description      Find a free timer slot, growing the handle storage when all
+**                  slots are in use. Called with sTimerInfoLock held.
+**
+** Parameters       void
+**
+** Returns          Available timer id (slot index + 1), 0 if the timer id
+**                  range is exhausted
+**
+*******************************************************************************/
+static uint32_t phOsalNfc_FindAvailableTimer(void) {
+  uint32_t dwIndex;
+
+  for (dwIndex = 0x00; dwIndex < apTimerInfo.size(); dwIndex++) {
+    if (!(apTimerInfo[dwIndex].TimerId)) {
+      return (dwIndex + 0x01);
+    }
+  }
+  if (dwIndex >= PH_NFC_MAX_TIMER) {
+    NXPLOG_TML_E("%s: no timer id available", __func__);
+    return 0x00;
+  }
+  /* Next slot is appended by the caller */
+  return (dwIndex + 0x01);
+}
+
+/*******************************************************************************
+**
+** Function         phOsalNfc_GetTimerHandle
+**
+** Description      Maps a timer id to its handle structure. Called with
+**                  sTimerInfoLock held.
+**
+** Parameters       dwTimerId - timer ID obtained during timer creation
+**
+** Returns          Timer handle, NULL if the id is out of range
+**
+*******************************************************************************/
+static phOsalNfc_TimerHandle_t* phOsalNfc_GetTimerHandle(uint32_t dwTimerId) {
+  uint32_t dwIndex = dwTimerId - PH_NFC_TIMER_BASE_ADDRESS - 0x01;
+
+  if (dwIndex >= apTimerInfo.size()) {
+    return NULL;
+  }
+  return &apTimerInfo[dwIndex];
+}
@@ -25,8 +25,15 @@
 #include <phNxpNciHal_utils.h>
 #include <phOsalNfc_Timer.h>
 #include <phTmlNfc.h>
+#include <phTmlNfc_Capture.h>
+#include <phTmlNfc_RxPool.h>
+#include <stdlib.h>
+#include <sys/eventfd.h>
 
+#include "NfccReplayTransport.h"
+#include "NfccSimTransport.h"
 #include "NfccTransportFactory.h"
+#include "NxpNfcLatencyStats.h"
 
 /*
  * Duration of Timer to wait after sending an Nci packet
@@ -41,16 +48,39 @@
 /* Indicates a Initial or offset value */
 #define PH_TMLNFC_VALUE_ONE (0x01)
 
+/* Event loop mode: delay before reading again when no receive buffer is
+   free. The reader thread blocks until one is released instead */
+#define PH_TMLNFC_RX_BUF_RETRY_DELAY_IN_MILLISEC (10U)
+
+/* Outcome of one read of the NFCC */
+typedef enum {
+  PH_TMLNFC_RX_PACKET,  /* packet read, its completion has to be delivered */
+  PH_TMLNFC_RX_AGAIN,   /* nothing read, read again */
+  PH_TMLNFC_RX_BACKOFF, /* nothing read, read again after a delay */
+  PH_TMLNFC_RX_IDLE,    /* no device to read from */
+} phTmlNfc_RxResult_t;
+
 spTransport gpTransportObj;
 extern bool_t gsIsFirstHalMinOpen;
 
 /* Initialize Context structure pointer used to access context structure */
 phTmlNfc_Context_t* gpphTmlNfc_Context = NULL;
+/* Event loop mode: serializes reads of the HAL event loop with shutdown */
+static pthread_mutex_t sEventLoopLock = PTHREAD_MUTEX_INITIALIZER;
+/* Event loop mode: receive buffer and retry delay kept between reads */
+static phTmlNfc_RxBuf_t* sEventLoopRxBuf = NULL;
+static uint8_t sEventLoopReadRetryDelay = 0;
 /* Local Function prototypes */
 static NFCSTATUS phTmlNfc_StartThread(void);
 static void phTmlNfc_ReadDeferredCb(void* pParams);
 static void* phTmlNfc_TmlThread(void* pParam);
+static phTmlNfc_RxResult_t phTmlNfc_ReadPacket(phTmlNfc_RxBuf_t** ppRxBuf,
+                                               uint8_t* pReadRetryDelay,
+                                               uint32_t* pBackoffMs);
 static int phTmlNfc_WaitReadInit(void);
+static int phTmlNfc_ReadAbortInit(void);
+static void phTmlNfc_WakeReader(void);
+static void phTmlNfc_ClearReaderWake(void);
 
 /* Function definitions */
 
@@ -108,6 +138,8 @@ NFCSTATUS phTmlNfc_Init(pphTmlNfc_Config_t pConfig) {
       /* Initialise all the internal TML variables */
       memset(gpphTmlNfc_Context, PH_TMLNFC_RESET_VALUE,
              sizeof(phTmlNfc_Context_t));
+      gpphTmlNfc_Context->nReadAbortFd = -1;
+      gpphTmlNfc_Context->bEventLoop = pConfig->bEventLoop;
       /* Make sure that the thread runs once it is created */
       gpphTmlNfc_Context->bThreadDone = 1;
       /* Open the device file to which data is read/written */
@@ -118,6 +150,11 @@ NFCSTATUS phTmlNfc_Init(pphTmlNfc_Config_t pConfig) {
         wInitStatus = PHNFCSTVAL(CID_NFC_TML, NFCSTATUS_INVALID_DEVICE);
         gpphTmlNfc_Context->pDevHandle = NULL;
       } else {
+        char capturePath[NXP_MAX_CONFIG_STRING_LEN];
+        if (GetNxpStrValue(NAME_NXP_TML_CAPTURE_FILE, capturePath,
+                           sizeof(capturePath))) {
+          phTmlNfc_CaptureOpen(capturePath);
+        }
         phTmlNfc_IoCtl(phTmlNfc_e_SetNfcState);
         gpphTmlNfc_Context->tReadInfo.bEnable = 0;
         gpphTmlNfc_Context->tReadInfo.bThreadBusy = false;
@@ -129,12 +166,20 @@ NFCSTATUS phTmlNfc_Init(pphTmlNfc_Config_t pConfig) {
           wInitStatus = NFCSTATUS_FAILED;
         } else if (0 != phTmlNfc_WaitReadInit()) {
           wInitStatus = NFCSTATUS_FAILED;
+        } else if (0 != phTmlNfc_ReadAbortInit()) {
+          wInitStatus = NFCSTATUS_FAILED;
         } else if (0 != sem_init(&gpphTmlNfc_Context->postMsgSemaphore, 0, 0)) {
           wInitStatus = NFCSTATUS_FAILED;
         } else {
           sem_post(&gpphTmlNfc_Context->postMsgSemaphore);
-          /* Start TML thread (to handle write and read operations) */
-          if (NFCSTATUS_SUCCESS != phTmlNfc_StartThread()) {
+          phTmlNfc_RxPoolInit();
+          /* Start TML thread (to handle write and read operations), reads
+           * are done by the HAL event loop in event loop mode */
+          if (pConfig->bEventLoop) {
+            NXPLOG_TML_D("NFCC - reads done by the HAL event loop");
+          }
+          if (!pConfig->bEventLoop &&
+              NFCSTATUS_SUCCESS != phTmlNfc_StartThread()) {
             wInitStatus = PHNFCSTVAL(CID_NFC_TML, NFCSTATUS_FAILED);
           } else {
             /* Create Timer used for Retransmission of NCI packets */
@@ -178,6 +223,13 @@ NFCSTATUS phTmlNfc_ConfigTransport() {
   if (isfound > 0) {
     transportType = value;
   }
+  if (getenv(NFCC_SIM_TRANSPORT_ENV) != NULL) {
+    NXPLOG_TML_D("%s Simulated NFCC selected by environment", __func__);
+    transportType = SIM;
+  } else if (getenv(NFCC_REPLAY_FILE_ENV) != NULL) {
+    NXPLOG_TML_D("%s Capture replay selected by environment", __func__);
+    transportType = REPLAY;
+  }
   gpTransportObj = transportFactory.getTransport((transportIntf)transportType);
   if (gpTransportObj == nullptr) {
     NXPLOG_TML_E("No Transport channel available \n");
@@ -227,16 +279,14 @@ static NFCSTATUS phTmlNfc_StartThread(void) {
 **
 *******************************************************************************/
 static void* phTmlNfc_TmlThread(void* pParam) {
-  /* Variable to fetch the actual number of bytes read */
-  int16_t dwNoBytesWrRd = PH_TMLNFC_RESET_VALUE;
   uint8_t readRetryDelay = 0;
-  /* Transaction info buffer to be passed to Callback Thread */
-  static phTmlNfc_TransactInfo_t tTransactionInfo;
-  /* Structure containing Tml callback function and parameters to be invoked
-     by the callback thread */
-  static phLibNfc_DeferredCall_t tDeferredInfo;
+  uint32_t backoffMs = 0;
+  /* Pooled buffer the next packet is read into. It carries the transaction
+     info and deferred call passed to the callback thread, so only a pointer
+     to it is posted */
+  phTmlNfc_RxBuf_t* pRxBuf = NULL;
   /* Initialize Message structure to post message onto Callback Thread */
-  static phLibNfc_Message_t tMsg;
+  phLibNfc_Message_t tMsg;
   UNUSED_PROP(pParam);
   NXPLOG_TML_D("NFCC - Tml Reader Thread Started................\n");
 
@@ -252,79 +302,220 @@ static void* phTmlNfc_TmlThread(void* pParam) {
     if (1 == gpphTmlNfc_Context->tReadInfo.bEnable) {
       pthread_mutex_unlock(&gpphTmlNfc_Context->tReadInfo.lock);
 
-      NXPLOG_TML_D("NFCC - Read requested.....\n");
-      /* Read the data from the file onto the buffer */
-      if (NULL != gpphTmlNfc_Context->pDevHandle) {
-        NXPLOG_TML_D("NFCC - Invoking Read.....\n");
-        dwNoBytesWrRd = gpTransportObj->Read(gpphTmlNfc_Context->pDevHandle,
-                                             tMsg.data, PHNCI_MAX_DATA_LEN);
-
-        if (-1 == dwNoBytesWrRd) {
-          NXPLOG_TML_E("NFCC - Error in Read.....\n");
-          if (readRetryDelay < MAX_READ_RETRY_DELAY_IN_MILLISEC) {
-            /*sleep for 30/60/90/120/150 msec between each read trial in case of
-             * read error*/
-            readRetryDelay += 30;
-          }
-          usleep(readRetryDelay * 1000);
-          sem_post(&gpphTmlNfc_Context->rxSemaphore);
-        } else if (dwNoBytesWrRd == PH_TMNFC_VBAT_LOW_ERROR) {
-          NXPLOG_TML_E(
-              "Platform VBAT Error detected by NFCC "
-              "NFC restart... : %d\n",
-              dwNoBytesWrRd);
-          abort();
-        } else if (dwNoBytesWrRd > PH_TMLNFC_MAX_READ_NCI_BUFF_LEN) {
-          NXPLOG_TML_E("Number of bytes read exceeds the limit 260.....\n");
-          readRetryDelay = 0;
-          sem_post(&gpphTmlNfc_Context->rxSemaphore);
-        } else {
-          if (gpphTmlNfc_Context->tReadInfo.pBuffer != NULL) {
-            memcpy(gpphTmlNfc_Context->tReadInfo.pBuffer, tMsg.data,
-                   dwNoBytesWrRd);
-            /* Update the actual number of bytes read including header */
-            gpphTmlNfc_Context->tReadInfo.wLength = dwNoBytesWrRd;
-          }
-          readRetryDelay = 0;
-
-          NXPLOG_TML_D("NFCC - Read successful.....\n");
-          /* This has to be reset only after a successful read */
-          pthread_mutex_lock(&gpphTmlNfc_Context->tReadInfo.lock);
-          gpphTmlNfc_Context->tReadInfo.bEnable = 0;
-          pthread_mutex_unlock(&gpphTmlNfc_Context->tReadInfo.lock);
-          phNxpNciHal_print_packet("RECV", tMsg.data, dwNoBytesWrRd);
-
-          /* Fill the Transaction info structure to be passed to Callback
-           * Function */
-          tTransactionInfo.wStatus = NFCSTATUS_SUCCESS;
-          /* Actual number of bytes read is filled in the structure */
-          tTransactionInfo.wLength = dwNoBytesWrRd;
-
-          /* Read operation completed successfully. Post a Message onto Callback
-           * Thread*/
-          /* Prepare the message to be posted on User thread */
-          tDeferredInfo.pCallback = &phTmlNfc_ReadDeferredCb;
-          tDeferredInfo.pParameter = &tTransactionInfo;
+      if (pRxBuf == NULL) {
+        /* Blocks while all buffers are still held upstream */
+        pRxBuf = phTmlNfc_RxBufAcquireWait();
+        if (pRxBuf == NULL) {
+          NXPLOG_TML_D("NFCC - RX buffer wait aborted");
+          continue;
+        }
+      }
+      switch (phTmlNfc_ReadPacket(&pRxBuf, &readRetryDelay, &backoffMs)) {
+        case PH_TMLNFC_RX_PACKET:
+          /* Read operation completed successfully. Post a Message onto
+           * Callback Thread. The payload stays in the pooled buffer, so no
+           * data is attached to the message */
           tMsg.eMsgType = PH_LIBNFC_DEFERREDCALL_MSG;
-          tMsg.pMsgData = &tDeferredInfo;
-          tMsg.Size = dwNoBytesWrRd;
-          tMsg.w_status = tTransactionInfo.wStatus;
+          tMsg.pMsgData = &pRxBuf->tDeferredInfo;
+          tMsg.Size = 0;
+          tMsg.w_status = pRxBuf->tTransactionInfo.wStatus;
           NXPLOG_TML_D("NFCC - Posting read message.....\n");
+          pRxBuf->qwPostNs = NfcHalLatencyStats::nowNs();
           phTmlNfc_DeferredCall(gpphTmlNfc_Context->dwCallbackThreadId, &tMsg);
-        }
-      } else {
-        NXPLOG_TML_D("NFCC -gpphTmlNfc_Context->pDevHandle is NULL");
+          /* Reference is now owned by phTmlNfc_ReadDeferredCb */
+          pRxBuf = NULL;
+          break;
+        case PH_TMLNFC_RX_BACKOFF:
+          usleep(backoffMs * 1000);
+          [[fallthrough]];
+        case PH_TMLNFC_RX_AGAIN:
+          sem_post(&gpphTmlNfc_Context->rxSemaphore);
+          break;
+        case PH_TMLNFC_RX_IDLE:
+          break;
       }
     } else {
       pthread_mutex_unlock(&gpphTmlNfc_Context->tReadInfo.lock);
       NXPLOG_TML_D("NFCC - read request NOT enabled");
-      usleep(10 * 1000);
     }
   } /* End of While loop */
 
+  phTmlNfc_RxBufRelease(pRxBuf);
   return NULL;
 }
 
+/*******************************************************************************
+**
+** Function         phTmlNfc_ReadPacket
+**
+** Description      Reads one packet from the NFCC into a pooled buffer and
+**                  prepares its completion. Called by the reader thread, or
+**                  by the HAL event loop in event loop mode.
+**
+** Parameters       ppRxBuf         - buffer to read into, acquired if NULL
+**                  pReadRetryDelay - delay increased on each read error
+**                  pBackoffMs      - delay before reading again, for
+**                                    PH_TMLNFC_RX_BACKOFF
+**
+** Returns          outcome of the read
+**
+*******************************************************************************/
+static phTmlNfc_RxResult_t phTmlNfc_ReadPacket(phTmlNfc_RxBuf_t** ppRxBuf,
+                                               uint8_t* pReadRetryDelay,
+                                               uint32_t* pBackoffMs) {
+  /* Variable to fetch the actual number of bytes read */
+  int16_t dwNoBytesWrRd = PH_TMLNFC_RESET_VALUE;
+  phTmlNfc_RxBuf_t* pRxBuf = *ppRxBuf;
+
+  if (pRxBuf == NULL) {
+    pRxBuf = phTmlNfc_RxBufAcquire();
+    if (pRxBuf == NULL) {
+      /* All buffers are still held upstream. Only the event loop gets here,
+         which releases them itself and so cannot block: retry shortly */
+      *pBackoffMs = PH_TMLNFC_RX_BUF_RETRY_DELAY_IN_MILLISEC;
+      return PH_TMLNFC_RX_BACKOFF;
+    }
+    *ppRxBuf = pRxBuf;
+  }
+
+  NXPLOG_TML_D("NFCC - Read requested.....\n");
+  /* Read the data from the file onto the buffer */
+  if (NULL == gpphTmlNfc_Context->pDevHandle) {
+    NXPLOG_TML_D("NFCC -gpphTmlNfc_Context->pDevHandle is NULL");
+    return PH_TMLNFC_RX_IDLE;
+  }
+  NXPLOG_TML_D("NFCC - Invoking Read.....\n");
+  dwNoBytesWrRd = gpTransportObj->Read(gpphTmlNfc_Context->pDevHandle,
+                                       pRxBuf->aData, PHNCI_MAX_DATA_LEN);
+  pRxBuf->qwReadNs = NfcHalLatencyStats::nowNs();
+
+  if (-1 == dwNoBytesWrRd) {
+    NXPLOG_TML_E("NFCC - Error in Read.....\n");
+    if (*pReadRetryDelay < MAX_READ_RETRY_DELAY_IN_MILLISEC) {
+      /*sleep for 30/60/90/120/150 msec between each read trial in case of
+       * read error*/
+      *pReadRetryDelay += 30;
+    }
+    *pBackoffMs = *pReadRetryDelay;
+    return PH_TMLNFC_RX_BACKOFF;
+  } else if (dwNoBytesWrRd == PH_TMLNFC_READ_ABORTED) {
+    /* Woken up through the control eventfd, re-evaluate thread and read
+     * state before blocking again */
+    NXPLOG_TML_D("NFCC - Read aborted.....\n");
+    phTmlNfc_ClearReaderWake();
+    return PH_TMLNFC_RX_AGAIN;
+  } else if (dwNoBytesWrRd == PH_TMNFC_VBAT_LOW_ERROR) {
+    NXPLOG_TML_E(
+        "Platform VBAT Error detected by NFCC "
+        "NFC restart... : %d\n",
+        dwNoBytesWrRd);
+    phTmlNfc_CaptureFlush();
+    abort();
+  } else if (dwNoBytesWrRd > PH_TMLNFC_MAX_READ_NCI_BUFF_LEN) {
+    NXPLOG_TML_E("Number of bytes read exceeds the limit 260.....\n");
+    *pReadRetryDelay = 0;
+    return PH_TMLNFC_RX_AGAIN;
+  }
+
+  if (gpphTmlNfc_Context->tReadInfo.pBuffer != NULL) {
+    memcpy(gpphTmlNfc_Context->tReadInfo.pBuffer, pRxBuf->aData,
+           dwNoBytesWrRd);
+    /* Update the actual number of bytes read including header */
+    gpphTmlNfc_Context->tReadInfo.wLength = dwNoBytesWrRd;
+  }
+  *pReadRetryDelay = 0;
+
+  NXPLOG_TML_D("NFCC - Read successful.....\n");
+  /* This has to be reset only after a successful read */
+  pthread_mutex_lock(&gpphTmlNfc_Context->tReadInfo.lock);
+  gpphTmlNfc_Context->tReadInfo.bEnable = 0;
+  pthread_mutex_unlock(&gpphTmlNfc_Context->tReadInfo.lock);
+  phTmlNfc_CaptureFrame(phTmlNfc_IsFwDnldModeEnabled()
+                            ? (PH_TMLNFC_CAPTURE_DIR_RX |
+                               PH_TMLNFC_CAPTURE_FW_DNLD)
+                            : PH_TMLNFC_CAPTURE_DIR_RX,
+                        pRxBuf->aData, dwNoBytesWrRd);
+  phNxpNciHal_print_packet("RECV", pRxBuf->aData, dwNoBytesWrRd);
+
+  /* Fill the Transaction info structure to be passed to Callback Function */
+  pRxBuf->tTransactionInfo.wStatus = NFCSTATUS_SUCCESS;
+  /* Actual number of bytes read is filled in the structure */
+  pRxBuf->tTransactionInfo.wLength = dwNoBytesWrRd;
+  pRxBuf->tDeferredInfo.pCallback = &phTmlNfc_ReadDeferredCb;
+  return PH_TMLNFC_RX_PACKET;
+}
+
+/*******************************************************************************
+**
+** Function         phTmlNfc_EventLoopGetReadFd
+**
+** Description      Gets the fd the HAL event loop has to poll for the pending
+**                  read, if any
+**
+** Parameters       None
+**
+** Returns          fd to poll, -1 if not in event loop mode or no read is
+**                  pending
+**
+*******************************************************************************/
+int phTmlNfc_EventLoopGetReadFd(void) {
+  int fd = -1;
+
+  pthread_mutex_lock(&sEventLoopLock);
+  if ((NULL != gpphTmlNfc_Context) && gpphTmlNfc_Context->bEventLoop &&
+      gpphTmlNfc_Context->bThreadDone &&
+      (NULL != gpphTmlNfc_Context->pDevHandle)) {
+    pthread_mutex_lock(&gpphTmlNfc_Context->tReadInfo.lock);
+    if (1 == gpphTmlNfc_Context->tReadInfo.bEnable) {
+      fd = gpTransportObj->GetPollFd(gpphTmlNfc_Context->pDevHandle);
+    }
+    pthread_mutex_unlock(&gpphTmlNfc_Context->tReadInfo.lock);
+  }
+  pthread_mutex_unlock(&sEventLoopLock);
+  return fd;
+}
+
+/*******************************************************************************
+**
+** Function         phTmlNfc_EventLoopRead
+**
+** Description      Reads one packet in the HAL event loop, once the fd of
+**                  phTmlNfc_EventLoopGetReadFd is readable. The completion is
+**                  returned to be invoked in place, as the client thread
+**                  invokes a posted PH_LIBNFC_DEFERREDCALL_MSG.
+**
+** Parameters       pBackoffMs - delay before polling the read fd again,
+**                               0 if it can be polled right away
+**
+** Returns          deferred call of the read completion, NULL if nothing
+**                  was read
+**
+*******************************************************************************/
+phLibNfc_DeferredCall_t* phTmlNfc_EventLoopRead(uint32_t* pBackoffMs) {
+  phLibNfc_DeferredCall_t* pDeferCall = NULL;
+  bool bReadEnabled = false;
+  *pBackoffMs = 0;
+
+  pthread_mutex_lock(&sEventLoopLock);
+  if ((NULL != gpphTmlNfc_Context) && gpphTmlNfc_Context->bEventLoop &&
+      gpphTmlNfc_Context->bThreadDone) {
+    pthread_mutex_lock(&gpphTmlNfc_Context->tReadInfo.lock);
+    bReadEnabled = (1 == gpphTmlNfc_Context->tReadInfo.bEnable);
+    pthread_mutex_unlock(&gpphTmlNfc_Context->tReadInfo.lock);
+  }
+  if (bReadEnabled &&
+      phTmlNfc_ReadPacket(&sEventLoopRxBuf, &sEventLoopReadRetryDelay,
+                          pBackoffMs) == PH_TMLNFC_RX_PACKET) {
+    /* Handed to the event loop in place of the post */
+    sEventLoopRxBuf->qwPostNs = NfcHalLatencyStats::nowNs();
+    pDeferCall = &sEventLoopRxBuf->tDeferredInfo;
+    /* Reference is now owned by phTmlNfc_ReadDeferredCb */
+    sEventLoopRxBuf = NULL;
+  }
+  pthread_mutex_unlock(&sEventLoopLock);
+  return pDeferCall;
+}
+
 /*******************************************************************************
 **
 ** Function         phTmlNfc_CleanUp
@@ -340,14 +531,21 @@ void phTmlNfc_CleanUp(void) {
   if (NULL == gpphTmlNfc_Context) {
     return;
   }
+  pthread_mutex_lock(&sEventLoopLock);
   sem_destroy(&gpphTmlNfc_Context->rxSemaphore);
   sem_destroy(&gpphTmlNfc_Context->postMsgSemaphore);
   pthread_mutex_destroy(&gpphTmlNfc_Context->wait_busy_lock);
+  if (gpphTmlNfc_Context->nReadAbortFd >= 0) {
+    if (gpTransportObj != NULL) gpTransportObj->SetReadAbortFd(-1);
+    close(gpphTmlNfc_Context->nReadAbortFd);
+    gpphTmlNfc_Context->nReadAbortFd = -1;
+  }
   gpTransportObj = NULL;
   /* Clear memory allocated for storing Context variables */
   free((void*)gpphTmlNfc_Context);
   /* Set the pointer to NULL to indicate De-Initialization */
   gpphTmlNfc_Context = NULL;
+  pthread_mutex_unlock(&sEventLoopLock);
 
   return;
 }
@@ -375,26 +573,34 @@ NFCSTATUS phTmlNfc_Shutdown(void) {
   if (NULL != gpphTmlNfc_Context) {
     /* Reset thread variable to terminate the thread */
     gpphTmlNfc_Context->bThreadDone = 0;
-    usleep(1000);
-    /* Clear All the resources allocated during initialization */
+    /* Wake the reader thread wherever it is blocked: in the transport read,
+       waiting for a read request, for a receive buffer or to post a
+       message */
+    phTmlNfc_WakeReader();
+    phTmlNfc_RxPoolAbortWait();
     sem_post(&gpphTmlNfc_Context->rxSemaphore);
-    usleep(1000);
     sem_post(&gpphTmlNfc_Context->postMsgSemaphore);
-    usleep(1000);
     sem_post(&gpphTmlNfc_Context->postMsgSemaphore);
-    usleep(1000);
 
     if (IS_CHIP_TYPE_L(sn100u)) {
       (void)gpTransportObj->NfccReset(gpphTmlNfc_Context->pDevHandle,
                                       MODE_POWER_OFF);
     }
     phTmlNfc_IoCtl(phTmlNfc_e_ResetNfcState);
+    /* Wait for a read of the HAL event loop to return */
+    pthread_mutex_lock(&sEventLoopLock);
     gpTransportObj->Close(gpphTmlNfc_Context->pDevHandle);
     gpphTmlNfc_Context->pDevHandle = NULL;
-    if (0 != pthread_join(gpphTmlNfc_Context->readerThread, (void**)NULL)) {
+    phTmlNfc_RxBufRelease(sEventLoopRxBuf);
+    sEventLoopRxBuf = NULL;
+    sEventLoopReadRetryDelay = 0;
+    pthread_mutex_unlock(&sEventLoopLock);
+    if (!gpphTmlNfc_Context->bEventLoop &&
+        0 != pthread_join(gpphTmlNfc_Context->readerThread, (void**)NULL)) {
       NXPLOG_TML_E("Fail to kill reader thread!");
     }
     NXPLOG_TML_D("bThreadDone == 0");
+    phTmlNfc_CaptureFlush();
 
   } else {
     wShutdownStatus = PHNFCSTVAL(CID_NFC_TML, NFCSTATUS_NOT_INITIALISED);
@@ -456,7 +662,14 @@ NFCSTATUS phTmlNfc_Write(uint8_t* pBuffer, uint16_t wLength) {
             break;
           }
         } else {
+          phTmlNfc_CaptureFrame(gpTransportObj->IsFwDnldModeEnabled()
+                                    ? PH_TMLNFC_CAPTURE_FW_DNLD
+                                    : 0x00,
+                                pBuffer, wLength);
           phNxpNciHal_print_packet("SEND", pBuffer, wLength);
+          if (!gpTransportObj->IsFwDnldModeEnabled()) {
+            NfcHalLatencyStats::getInstance().txWritten(pBuffer, wLength);
+          }
           retry_cnt = 0;
           NXPLOG_TML_D("NFCC - Write successful.....\n");
           break;
@@ -524,15 +737,20 @@ NFCSTATUS phTmlNfc_Read(uint8_t* pBuffer, uint16_t wLength,
         gpphTmlNfc_Context->tReadInfo.bEnable = 1;
         pthread_mutex_unlock(&gpphTmlNfc_Context->tReadInfo.lock);
 
-        ret = sem_getvalue(&gpphTmlNfc_Context->rxSemaphore, &rxSemVal);
-        /* Post rxSemaphore either if sem_getvalue() is failed or rxSemVal is 0
-         */
-        if (ret || !rxSemVal) {
-          sem_post(&gpphTmlNfc_Context->rxSemaphore);
+        if (gpphTmlNfc_Context->bEventLoop) {
+          /* Make the HAL event loop poll the device */
+          phDal4Nfc_msgwake(gpphTmlNfc_Context->dwCallbackThreadId);
         } else {
-          NXPLOG_TML_D(
-              "%s: skip reader thread scheduling, ret=%x, rxSemaVal=%x",
-              __func__, ret, rxSemVal);
+          ret = sem_getvalue(&gpphTmlNfc_Context->rxSemaphore, &rxSemVal);
+          /* Post rxSemaphore either if sem_getvalue() is failed or rxSemVal
+           * is 0 */
+          if (ret || !rxSemVal) {
+            sem_post(&gpphTmlNfc_Context->rxSemaphore);
+          } else {
+            NXPLOG_TML_D(
+                "%s: skip reader thread scheduling, ret=%x, rxSemaVal=%x",
+                __func__, ret, rxSemVal);
+          }
         }
       } else {
         wReadStatus = PHNFCSTVAL(CID_NFC_TML, NFCSTATUS_BUSY);
@@ -570,6 +788,7 @@ NFCSTATUS phTmlNfc_ReadAbort(void) {
   pthread_mutex_lock(&gpphTmlNfc_Context->tReadInfo.lock);
   gpphTmlNfc_Context->tReadInfo.bEnable = 0;
   pthread_mutex_unlock(&gpphTmlNfc_Context->tReadInfo.lock);
+  phTmlNfc_WakeReader();
 
   /*Reset the flag to accept another Read Request */
   gpphTmlNfc_Context->tReadInfo.bThreadBusy = false;
@@ -740,6 +959,8 @@ NFCSTATUS phTmlNfc_IoCtl(phTmlNfc_ControlCode_t eControlCode) {
     }
     if (read_flag && (gpphTmlNfc_Context->tReadInfo.bEnable == 0x00)) {
       gpphTmlNfc_Context->tReadInfo.bEnable = 1;
+      /* Restart a read already blocked on the old mode */
+      phTmlNfc_WakeReader();
       sem_post(&gpphTmlNfc_Context->rxSemaphore);
     }
     pthread_mutex_unlock(&gpphTmlNfc_Context->tReadInfo.lock);
@@ -786,17 +1007,32 @@ void phTmlNfc_DeferredCall(uintptr_t dwThreadId,
 static void phTmlNfc_ReadDeferredCb(void* pParams) {
   /* Transaction info buffer to be passed to Callback Function */
   phTmlNfc_TransactInfo_t* pTransactionInfo = (phTmlNfc_TransactInfo_t*)pParams;
+  phTmlNfc_RxBuf_t* pRxBuf = phTmlNfc_RxBufFromInfo(pTransactionInfo);
+  /* FW download frames are not NCI packets */
+  bool bFwDnld = phTmlNfc_IsFwDnldModeEnabled();
+  bool bStamped = !bFwDnld && (pRxBuf != NULL);
 
   /* Reset the flag to accept another Read Request */
   gpphTmlNfc_Context->tReadInfo.bThreadBusy = false;
 
   /* Read again because read must be pending always except FWDNLD.*/
-  if (!phTmlNfc_IsFwDnldModeEnabled()) {
+  if (!bFwDnld) {
     phNxpNciHal_enableTmlRead();
   }
 
+  if (bStamped) {
+    NfcHalLatencyStats::getInstance().rxBegin(
+        pTransactionInfo->pBuff, pTransactionInfo->wLength, pRxBuf->qwReadNs,
+        pRxBuf->qwPostNs);
+  }
   gpphTmlNfc_Context->tReadInfo.pThread_Callback(
       gpphTmlNfc_Context->tReadInfo.pContext, pTransactionInfo);
+  if (bStamped) {
+    NfcHalLatencyStats::getInstance().rxEnd();
+  }
+
+  /* Hand the receive buffer back to the pool */
+  phTmlNfc_RxBufRelease(pRxBuf);
 
   return;
 }
@@ -828,6 +1064,75 @@ static int phTmlNfc_WaitReadInit(void) {
   return ret;
 }
 
+/*******************************************************************************
+**
+** Function         phTmlNfc_ReadAbortInit
+**
+** Description      Creates the control eventfd used to wake the reader thread
+**                  out of a blocking transport read and registers it with the
+**                  transport
+**
+** Parameters       None
+**
+** Returns          0 on success, -1 otherwise
+**
+*******************************************************************************/
+static int phTmlNfc_ReadAbortInit(void) {
+  gpphTmlNfc_Context->nReadAbortFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (gpphTmlNfc_Context->nReadAbortFd < 0) {
+    NXPLOG_TML_E(" eventfd failed, errno = 0x%X", errno);
+    return -1;
+  }
+  gpTransportObj->SetReadAbortFd(gpphTmlNfc_Context->nReadAbortFd);
+  return 0;
+}
+
+/*******************************************************************************
+**
+** Function         phTmlNfc_WakeReader
+**
+** Description      Signals the control eventfd so that a blocked transport
+**                  read returns PH_TMLNFC_READ_ABORTED immediately. In event
+**                  loop mode the HAL event loop is woken as well, to poll
+**                  the new read state.
+**
+** Parameters       None
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phTmlNfc_WakeReader(void) {
+  uint64_t one = 1;
+  if ((NULL == gpphTmlNfc_Context) || (gpphTmlNfc_Context->nReadAbortFd < 0)) {
+    return;
+  }
+  if (write(gpphTmlNfc_Context->nReadAbortFd, &one, sizeof(one)) < 0) {
+    NXPLOG_TML_E("%s: eventfd write failed, errno = 0x%X", __func__, errno);
+  }
+  if (gpphTmlNfc_Context->bEventLoop) {
+    phDal4Nfc_msgwake(gpphTmlNfc_Context->dwCallbackThreadId);
+  }
+}
+
+/*******************************************************************************
+**
+** Function         phTmlNfc_ClearReaderWake
+**
+** Description      Consumes pending wake-ups of the control eventfd. Called
+**                  by the reader thread only.
+**
+** Parameters       None
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phTmlNfc_ClearReaderWake(void) {
+  uint64_t count;
+  if (gpphTmlNfc_Context->nReadAbortFd >= 0) {
+    (void)read(gpphTmlNfc_Context->nReadAbortFd, &count, sizeof(count));
+  }
+}
+
 /*******************************************************************************
 **
 ** Function         phTmlNfc_EnableFwDnldMode
@@ -841,6 +1146,8 @@ static int phTmlNfc_WaitReadInit(void) {
 *******************************************************************************/
 void phTmlNfc_EnableFwDnldMode(bool mode) {
   gpTransportObj->EnableFwDnldMode(mode);
+  /* Pending read has to pick up the new frame header length */
+  phTmlNfc_WakeReader();
 }
 
 /*******************************************************************************
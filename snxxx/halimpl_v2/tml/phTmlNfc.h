@@ -57,6 +57,11 @@
  * Value indicates to NFCC recovery from vbat low.
  */
 #define PH_TMNFC_VBAT_LOW_ERROR (-EREMOTEIO)
+/*
+ * Value returned by transport Read when it was woken through the TML control
+ * eventfd (shutdown, read abort or download mode switch).
+ */
+#define PH_TMLNFC_READ_ABORTED (-ECANCELED)
 /*
 ***************************Globals,Structure and Enumeration ******************
 */
@@ -166,6 +171,8 @@ typedef struct phTmlNfc_Context {
                                      pushed to queue*/
   long nfc_service_pid; /*NFC Service PID to be used by driver to signal*/
   uint16_t fragment_len;
+  int nReadAbortFd; /* eventfd used to wake the reader thread out of a read */
+  bool bEventLoop;  /* reads are done by the HAL event loop, no reader thread */
 } phTmlNfc_Context_t;
 
 /*
@@ -184,6 +191,11 @@ typedef struct phTmlNfc_Config {
    * This is the thread ID on which the Reader & Writer thread posts message. */
   uintptr_t dwGetMsgThreadId;
   uint16_t fragment_len;
+  /* Event loop mode
+   *
+   * No reader thread is started, the thread of dwGetMsgThreadId polls the
+   * device and reads through phTmlNfc_EventLoopRead. */
+  bool bEventLoop;
 } phTmlNfc_Config_t, *pphTmlNfc_Config_t; /* pointer to phTmlNfc_Config_t */
 
 /*
@@ -226,4 +238,6 @@ void phTmlNfc_set_fragmentation_enabled(phTmlNfc_i2cfragmentation_t enable);
 NFCSTATUS phTmlNfc_ConfigTransport();
 void phTmlNfc_EnableFwDnldMode(bool mode);
 bool phTmlNfc_IsFwDnldModeEnabled(void);
+int phTmlNfc_EventLoopGetReadFd(void);
+phLibNfc_DeferredCall_t* phTmlNfc_EventLoopRead(uint32_t* pBackoffMs);
 #endif /*  PHTMLNFC_H  */
@@ -0,0 +1,198 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * TML frame capture implementation.
+ */
+
+#include <phNxpLog.h>
+#include <phTmlNfc_Capture.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <atomic>
+#include <mutex>
+
+/* Frames are written out by the stdio buffer, or at TML shutdown */
+#define PH_TMLNFC_CAPTURE_FILE_BUF_LEN (64 * 1024)
+
+static std::mutex sCaptureLock;
+static FILE* sCaptureFile = NULL;
+/* Read without the lock, so that no frame takes it while disabled */
+static std::atomic<bool> sCaptureEnabled{false};
+static uint64_t sCaptureLastUs = 0;
+
+/*******************************************************************************
+**
+** Function         phTmlNfc_CaptureNowUs
+**
+** Description      Gets the monotonic time the capture is timed with
+**
+** Returns          time in us
+**
+*******************************************************************************/
+uint64_t phTmlNfc_CaptureNowUs(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/*******************************************************************************
+**
+** Function         phTmlNfc_CaptureOpen
+**
+** Description      Starts capturing the TML frames to pPath. The file is
+**                  kept open until the process exits, so that one capture
+**                  covers every TML initialization of the session; does
+**                  nothing if a capture is already running.
+**
+** Parameters       pPath - capture file, truncated
+**
+** Returns          None
+**
+*******************************************************************************/
+void phTmlNfc_CaptureOpen(const char* pPath) {
+  uint8_t header[PH_TMLNFC_CAPTURE_HDR_LEN] = {0};
+  std::lock_guard<std::mutex> lock(sCaptureLock);
+
+  if (sCaptureFile != NULL || pPath == NULL || pPath[0] == '\0') return;
+  sCaptureFile = fopen(pPath, "wbe");
+  if (sCaptureFile == NULL) {
+    NXPLOG_TML_E("%s: cannot open %s", __func__, pPath);
+    return;
+  }
+  setvbuf(sCaptureFile, NULL, _IOFBF, PH_TMLNFC_CAPTURE_FILE_BUF_LEN);
+  memcpy(header, PH_TMLNFC_CAPTURE_MAGIC, 4);
+  header[4] = PH_TMLNFC_CAPTURE_VERSION;
+  if (fwrite(header, sizeof(header), 1, sCaptureFile) != 1) {
+    NXPLOG_TML_E("%s: cannot write %s", __func__, pPath);
+    fclose(sCaptureFile);
+    sCaptureFile = NULL;
+    return;
+  }
+  sCaptureLastUs = phTmlNfc_CaptureNowUs();
+  sCaptureEnabled.store(true, std::memory_order_release);
+  NXPLOG_TML_D("%s: capturing to %s", __func__, pPath);
+}
+
+/*******************************************************************************
+**
+** Function         phTmlNfc_CaptureFrame
+**
+** Description      Records a frame written to or read from the NFCC, if a
+**                  capture is running
+**
+** Parameters       bFlags  - PH_TMLNFC_CAPTURE_DIR_RX/FW_DNLD
+**                  pData   - frame
+**                  wLength - frame length
+**
+** Returns          None
+**
+*******************************************************************************/
+void phTmlNfc_CaptureFrame(uint8_t bFlags, const uint8_t* pData,
+                           uint16_t wLength) {
+  if (!sCaptureEnabled.load(std::memory_order_acquire)) return;
+  std::lock_guard<std::mutex> lock(sCaptureLock);
+  if (sCaptureFile == NULL) return;
+
+  uint64_t nowUs = phTmlNfc_CaptureNowUs();
+  uint64_t deltaUs = nowUs - sCaptureLastUs;
+  uint32_t delta = (deltaUs > UINT32_MAX) ? UINT32_MAX : (uint32_t)deltaUs;
+  uint8_t record[PH_TMLNFC_CAPTURE_REC_HDR_LEN];
+
+  record[0] = (uint8_t)delta;
+  record[1] = (uint8_t)(delta >> 8);
+  record[2] = (uint8_t)(delta >> 16);
+  record[3] = (uint8_t)(delta >> 24);
+  record[4] = bFlags;
+  record[5] = 0x00;
+  record[6] = (uint8_t)wLength;
+  record[7] = (uint8_t)(wLength >> 8);
+  sCaptureLastUs = nowUs;
+  if (fwrite(record, sizeof(record), 1, sCaptureFile) != 1 ||
+      (wLength != 0 && fwrite(pData, wLength, 1, sCaptureFile) != 1)) {
+    NXPLOG_TML_E("%s: write failed, capture stopped", __func__);
+    sCaptureEnabled.store(false, std::memory_order_release);
+    fclose(sCaptureFile);
+    sCaptureFile = NULL;
+  }
+}
+
+/*******************************************************************************
+**
+** Function         phTmlNfc_CaptureFlush
+**
+** Description      Writes the frames captured so far to the file
+**
+** Returns          None
+**
+*******************************************************************************/
+void phTmlNfc_CaptureFlush(void) {
+  std::lock_guard<std::mutex> lock(sCaptureLock);
+  if (sCaptureFile != NULL) fflush(sCaptureFile);
+}
+
+/*******************************************************************************
+**
+** Function         phTmlNfc_CaptureLoad
+**
+** Description      Reads the frames of a capture file
+**
+** Parameters       pPath  - capture file
+**                  frames - filled with the frames, in capture order
+**
+** Returns          true if the file is a capture, a truncated last record
+**                  is dropped; false otherwise
+**
+*******************************************************************************/
+bool phTmlNfc_CaptureLoad(const char* pPath,
+                          std::vector<phTmlNfc_CaptureFrame_t>& frames) {
+  uint8_t header[PH_TMLNFC_CAPTURE_HDR_LEN];
+  uint8_t record[PH_TMLNFC_CAPTURE_REC_HDR_LEN];
+  uint64_t tsUs = 0;
+  FILE* pFile = fopen(pPath, "rbe");
+
+  frames.clear();
+  if (pFile == NULL) {
+    NXPLOG_TML_E("%s: cannot open %s", __func__, pPath);
+    return false;
+  }
+  if (fread(header, sizeof(header), 1, pFile) != 1 ||
+      memcmp(header, PH_TMLNFC_CAPTURE_MAGIC, 4) != 0 ||
+      header[4] != PH_TMLNFC_CAPTURE_VERSION) {
+    NXPLOG_TML_E("%s: %s is not a TML capture", __func__, pPath);
+    fclose(pFile);
+    return false;
+  }
+  while (fread(record, sizeof(record), 1, pFile) == 1) {
+    phTmlNfc_CaptureFrame_t frame;
+    tsUs += (uint32_t)record[0] | ((uint32_t)record[1] << 8) |
+            ((uint32_t)record[2] << 16) | ((uint32_t)record[3] << 24);
+    frame.tsUs = tsUs;
+    frame.bFlags = record[4];
+    frame.data.resize((uint16_t)(record[6] | (record[7] << 8)));
+    if (!frame.data.empty() &&
+        fread(frame.data.data(), frame.data.size(), 1, pFile) != 1) {
+      NXPLOG_TML_W("%s: truncated record dropped", __func__);
+      break;
+    }
+    frames.push_back(std::move(frame));
+  }
+  fclose(pFile);
+  NXPLOG_TML_D("%s: %zu frames loaded", __func__, frames.size());
+  return true;
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Capture of the frames written and read by the TML, replayed by
+ * NfccReplayTransport.
+ *
+ * File format, little endian:
+ *   header: "NTMC", version (1 byte), 3 reserved bytes
+ *   then one record per frame:
+ *     time since the previous record in us (4 bytes, saturated),
+ *     flags (1 byte), reserved (1 byte), frame length (2 bytes),
+ *     frame
+ * The first record time is counted from the start of the capture.
+ */
+
+#ifndef PHTMLNFC_CAPTURE_H
+#define PHTMLNFC_CAPTURE_H
+
+#include <stdint.h>
+
+#include <vector>
+
+#define PH_TMLNFC_CAPTURE_MAGIC "NTMC"
+#define PH_TMLNFC_CAPTURE_VERSION 0x01
+#define PH_TMLNFC_CAPTURE_HDR_LEN 8
+#define PH_TMLNFC_CAPTURE_REC_HDR_LEN 8
+
+/* Record flags */
+#define PH_TMLNFC_CAPTURE_DIR_RX 0x01 /* read from the NFCC, written else */
+#define PH_TMLNFC_CAPTURE_FW_DNLD 0x02 /* FW download mode, NCI else */
+
+typedef struct phTmlNfc_CaptureFrame {
+  uint64_t tsUs; /* time since the start of the capture */
+  uint8_t bFlags;
+  std::vector<uint8_t> data;
+} phTmlNfc_CaptureFrame_t;
+
+void phTmlNfc_CaptureOpen(const char* pPath);
+void phTmlNfc_CaptureFrame(uint8_t bFlags, const uint8_t* pData,
+                           uint16_t wLength);
+void phTmlNfc_CaptureFlush(void);
+bool phTmlNfc_CaptureLoad(const char* pPath,
+                          std::vector<phTmlNfc_CaptureFrame_t>& frames);
+uint64_t phTmlNfc_CaptureNowUs(void);
+
+#endif /* PHTMLNFC_CAPTURE_H */
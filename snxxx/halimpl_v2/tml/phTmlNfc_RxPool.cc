@@ -0,0 +1,204 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * TML receive buffer pool implementation.
+ */
+
+#include <phNxpLog.h>
+#include <phTmlNfc_RxPool.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+static_assert(PH_TMLNFC_RX_POOL_SIZE <= 32,
+              "free mask only tracks up to 32 buffers");
+
+static phTmlNfc_RxBuf_t gRxPool[PH_TMLNFC_RX_POOL_SIZE];
+/* Bit n set means gRxPool[n] is free */
+static std::atomic<uint32_t> gRxPoolFreeMask{0};
+/* Reader thread waiting for a free buffer: released buffers are signalled
+   through gRxPoolFreed while gRxPoolWaiters is nonzero */
+static std::mutex gRxPoolLock;
+static std::condition_variable gRxPoolFreed;
+static std::atomic<uint32_t> gRxPoolWaiters{0};
+static bool gRxPoolWaitAborted = false;
+
+/* Takes a free buffer, NULL if none is free */
+static phTmlNfc_RxBuf_t* phTmlNfc_RxBufTryAcquire(void) {
+  uint32_t mask = gRxPoolFreeMask.load(std::memory_order_acquire);
+  while (mask != 0) {
+    uint32_t bit = mask & (~mask + 1U);
+    if (gRxPoolFreeMask.compare_exchange_weak(mask, mask & ~bit,
+                                              std::memory_order_acquire)) {
+      phTmlNfc_RxBuf_t* pBuf = &gRxPool[__builtin_ctz(bit)];
+      pBuf->nRefCount.store(1, std::memory_order_relaxed);
+      return pBuf;
+    }
+  }
+  return NULL;
+}
+
+/*******************************************************************************
+**
+** Function         phTmlNfc_RxPoolInit
+**
+** Description      Marks every buffer of the pool as free. Must only be called
+**                  while no buffer is in use, i.e. before the TML reader thread
+**                  is started.
+**
+** Returns          None
+**
+*******************************************************************************/
+void phTmlNfc_RxPoolInit(void) {
+  for (uint8_t i = 0; i < PH_TMLNFC_RX_POOL_SIZE; i++) {
+    gRxPool[i].nRefCount.store(0, std::memory_order_relaxed);
+    gRxPool[i].bIndex = i;
+    gRxPool[i].tDeferredInfo.pCallback = NULL;
+    gRxPool[i].tDeferredInfo.pParameter = &gRxPool[i].tTransactionInfo;
+    gRxPool[i].tTransactionInfo.pBuff = gRxPool[i].aData;
+  }
+  gRxPoolFreeMask.store((PH_TMLNFC_RX_POOL_SIZE == 32)
+                            ? 0xFFFFFFFFU
+                            : ((1U << PH_TMLNFC_RX_POOL_SIZE) - 1U),
+                        std::memory_order_release);
+  std::lock_guard<std::mutex> lock(gRxPoolLock);
+  gRxPoolWaitAborted = false;
+}
+
+/*******************************************************************************
+**
+** Function         phTmlNfc_RxBufAcquire
+**
+** Description      Takes a free buffer from the pool. The returned buffer holds
+**                  one reference owned by the caller.
+**
+** Returns          Pointer to the buffer, NULL if the pool is exhausted
+**
+*******************************************************************************/
+phTmlNfc_RxBuf_t* phTmlNfc_RxBufAcquire(void) {
+  phTmlNfc_RxBuf_t* pBuf = phTmlNfc_RxBufTryAcquire();
+  if (pBuf == NULL) {
+    NXPLOG_TML_E("%s: RX buffer pool exhausted", __func__);
+  }
+  return pBuf;
+}
+
+/*******************************************************************************
+**
+** Function         phTmlNfc_RxBufAcquireWait
+**
+** Description      Takes a free buffer from the pool, blocking until one is
+**                  released if the pool is exhausted. Must not be called from
+**                  the thread which releases the buffers.
+**
+** Returns          Pointer to the buffer, NULL if the wait was aborted by
+**                  phTmlNfc_RxPoolAbortWait
+**
+*******************************************************************************/
+phTmlNfc_RxBuf_t* phTmlNfc_RxBufAcquireWait(void) {
+  phTmlNfc_RxBuf_t* pBuf = phTmlNfc_RxBufTryAcquire();
+  if (pBuf != NULL) return pBuf;
+
+  NXPLOG_TML_D("%s: RX buffer pool exhausted, waiting", __func__);
+  std::unique_lock<std::mutex> lock(gRxPoolLock);
+  /* Announced before trying again, so that a release racing with the try
+     sees the waiter and signals it */
+  gRxPoolWaiters.fetch_add(1, std::memory_order_seq_cst);
+  gRxPoolFreed.wait(lock, [&pBuf] {
+    pBuf = phTmlNfc_RxBufTryAcquire();
+    return (pBuf != NULL) || gRxPoolWaitAborted;
+  });
+  gRxPoolWaiters.fetch_sub(1, std::memory_order_relaxed);
+  return pBuf;
+}
+
+/*******************************************************************************
+**
+** Function         phTmlNfc_RxPoolAbortWait
+**
+** Description      Wakes up phTmlNfc_RxBufAcquireWait without a buffer, on
+**                  shutdown. Cleared by phTmlNfc_RxPoolInit.
+**
+** Returns          None
+**
+*******************************************************************************/
+void phTmlNfc_RxPoolAbortWait(void) {
+  {
+    std::lock_guard<std::mutex> lock(gRxPoolLock);
+    gRxPoolWaitAborted = true;
+  }
+  gRxPoolFreed.notify_all();
+}
+
+/*******************************************************************************
+**
+** Function         phTmlNfc_RxBufRef
+**
+** Description      Takes an additional reference on a buffer, for consumers
+**                  which need the payload after their callback returns
+**
+** Returns          None
+**
+*******************************************************************************/
+void phTmlNfc_RxBufRef(phTmlNfc_RxBuf_t* pBuf) {
+  if (pBuf == NULL) return;
+  pBuf->nRefCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+/*******************************************************************************
+**
+** Function         phTmlNfc_RxBufRelease
+**
+** Description      Drops a reference and returns the buffer to the pool when
+**                  it was the last one
+**
+** Returns          None
+**
+*******************************************************************************/
+void phTmlNfc_RxBufRelease(phTmlNfc_RxBuf_t* pBuf) {
+  if (pBuf == NULL) return;
+  if (pBuf->nRefCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    gRxPoolFreeMask.fetch_or(1U << pBuf->bIndex, std::memory_order_seq_cst);
+    if (gRxPoolWaiters.load(std::memory_order_seq_cst) != 0) {
+      /* Taking the lock orders the signal after the waiter's last try */
+      { std::lock_guard<std::mutex> lock(gRxPoolLock); }
+      gRxPoolFreed.notify_one();
+    }
+  }
+}
+
+/*******************************************************************************
+**
+** Function         phTmlNfc_RxBufFromInfo
+**
+** Description      Maps transaction info passed to a read completion callback
+**                  back to the pooled buffer it belongs to
+**
+** Returns          Pointer to the buffer, NULL if pInfo is not part of the pool
+**
+*******************************************************************************/
+phTmlNfc_RxBuf_t* phTmlNfc_RxBufFromInfo(phTmlNfc_TransactInfo_t* pInfo) {
+  uintptr_t addr = (uintptr_t)pInfo;
+  uintptr_t base = (uintptr_t)&gRxPool[0];
+  if (addr < base || addr >= (uintptr_t)&gRxPool[PH_TMLNFC_RX_POOL_SIZE]) {
+    return NULL;
+  }
+  size_t index = (addr - base) / sizeof(phTmlNfc_RxBuf_t);
+  if (pInfo != &gRxPool[index].tTransactionInfo) return NULL;
+  return &gRxPool[index];
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Preallocated receive buffer pool used by the TML reader thread.
+ *
+ * The transport reads directly into a pooled buffer. Only a pointer to the
+ * buffer's deferred call descriptor travels through the client message queue,
+ * and the buffer returns to the pool once the last reference is dropped.
+ */
+
+#ifndef PHTMLNFC_RXPOOL_H
+#define PHTMLNFC_RXPOOL_H
+
+#include <phTmlNfc.h>
+
+#include <atomic>
+
+/*
+ * Number of receive buffers in the pool. At most one read is outstanding at a
+ * time, so this only has to cover packets still being processed upstream.
+ */
+#define PH_TMLNFC_RX_POOL_SIZE (8U)
+
+typedef struct phTmlNfc_RxBuf {
+  std::atomic<uint32_t> nRefCount;
+  uint8_t bIndex;
+  /* Deferred call descriptor posted to the HAL reader thread */
+  phLibNfc_DeferredCall_t tDeferredInfo;
+  /* Transaction info handed to the read completion callback */
+  phTmlNfc_TransactInfo_t tTransactionInfo;
+  /* CLOCK_MONOTONIC stamps of the transport read and of the post */
+  uint64_t qwReadNs;
+  uint64_t qwPostNs;
+  uint8_t aData[PHNCI_MAX_DATA_LEN];
+} phTmlNfc_RxBuf_t;
+
+void phTmlNfc_RxPoolInit(void);
+phTmlNfc_RxBuf_t* phTmlNfc_RxBufAcquire(void);
+phTmlNfc_RxBuf_t* phTmlNfc_RxBufAcquireWait(void);
+void phTmlNfc_RxPoolAbortWait(void);
+void phTmlNfc_RxBufRef(phTmlNfc_RxBuf_t* pBuf);
+void phTmlNfc_RxBufRelease(phTmlNfc_RxBuf_t* pBuf);
+phTmlNfc_RxBuf_t* phTmlNfc_RxBufFromInfo(phTmlNfc_TransactInfo_t* pInfo);
+
+#endif /* PHTMLNFC_RXPOOL_H */
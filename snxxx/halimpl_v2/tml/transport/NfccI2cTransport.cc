@@ -26,11 +26,12 @@
 #include <fcntl.h>
 #include <hardware/nfc.h>
 #include <phNfcStatus.h>
+#include <phNxpConfig.h>
 #include <phNxpLog.h>
+#include <poll.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/ioctl.h>
-#include <sys/select.h>
 #include <termios.h>
 #include <unistd.h>
 
@@ -86,6 +87,16 @@ NFCSTATUS NfccI2cTransport::OpenAndConfigure(pphTmlNfc_Config_t pConfig,
       NXPLOG_TML_E("%s Failed: reason sem_init : retval %x", __func__, nHandle);
       status = NFCSTATUS_FAILED;
     }
+    unsigned long framedRead = 0;
+    if (GetNxpNumValue(NAME_NXP_I2C_FRAMED_READ, &framedRead,
+                       sizeof(framedRead)) &&
+        framedRead == 0x01) {
+      mReadMode = I2C_READ_MODE_FRAMED_PROBE;
+    } else {
+      mReadMode = I2C_READ_MODE_SPLIT;
+    }
+    mCarryLen = 0;
+    NXPLOG_TML_D("%s read mode %u", __func__, mReadMode);
   }
   return status;
 }
@@ -184,39 +195,56 @@ bool NfccI2cTransport::Flushdata(pphTmlNfc_Config_t pConfig) {
 int NfccI2cTransport::Read(void* pDevHandle, uint8_t* pBuffer,
                            int nNbBytesToRead) {
   int ret_Read;
-  int ret_Select;
+  int ret_Poll;
   int numRead = 0;
-  struct timeval tv;
-  fd_set rfds;
+  struct pollfd fds[2];
+  nfds_t nfds = 1;
   uint16_t totalBytesToRead = 0;
 
-  UNUSED_PROP(nNbBytesToRead);
   if (NULL == pDevHandle) {
     return -1;
   }
 
+  if ((bFwDnldFlag == false) && (mCarryLen > 0)) {
+    /* The previous framed read already fetched the start of this packet */
+    return ReadCarried((int)(intptr_t)pDevHandle, pBuffer, nNbBytesToRead);
+  }
+
   if (bFwDnldFlag == false) {
     totalBytesToRead = NORMAL_MODE_HEADER_LEN;
   } else {
     totalBytesToRead = FW_DNLD_HEADER_LEN;
   }
 
-  /* Read with 2 second timeout, so that the read thread can be aborted
-     when the NFCC does not respond and we need to switch to FW download
-     mode. This should be done via a control socket instead. */
-  FD_ZERO(&rfds);
-  FD_SET((int)(intptr_t)pDevHandle, &rfds);
-  tv.tv_sec = 2;
-  tv.tv_usec = 1;
+  /* Block until the NFCC has data or the TML control eventfd is signalled for
+     shutdown, read abort or a download mode switch. Without a control fd fall
+     back to a 2 second timeout so that the read thread can still be aborted */
+  fds[0].fd = (int)(intptr_t)pDevHandle;
+  fds[0].events = POLLIN;
+  fds[0].revents = 0;
+  if (mReadAbortFd >= 0) {
+    fds[1].fd = mReadAbortFd;
+    fds[1].events = POLLIN;
+    fds[1].revents = 0;
+    nfds = 2;
+  }
 
-  ret_Select =
-      select((int)((intptr_t)pDevHandle + (int)1), &rfds, NULL, NULL, &tv);
-  if (ret_Select < 0) {
+  ret_Poll = TEMP_FAILURE_RETRY(
+      poll(fds, nfds, (nfds == 2) ? -1 : READ_POLL_TIMEOUT_MS));
+  if (ret_Poll < 0) {
     NXPLOG_TML_D("%s errno : %x", __func__, errno);
     return -1;
-  } else if (ret_Select == 0) {
+  } else if (ret_Poll == 0) {
     NXPLOG_TML_D("%s Timeout", __func__);
     return -1;
+  } else if ((nfds == 2) && (fds[1].revents & POLLIN)) {
+    NXPLOG_TML_D("%s aborted", __func__);
+    return PH_TMLNFC_READ_ABORTED;
+  } else if (fds[0].revents & (POLLERR | POLLNVAL)) {
+    NXPLOG_TML_E("%s poll revents : %x", __func__, fds[0].revents);
+    return -1;
+  } else if ((bFwDnldFlag == false) && (mReadMode != I2C_READ_MODE_SPLIT)) {
+    return ReadFramed((int)(intptr_t)pDevHandle, pBuffer, nNbBytesToRead);
   } else {
     ret_Read =
         read((int)(intptr_t)pDevHandle, pBuffer, totalBytesToRead - numRead);
@@ -288,6 +316,166 @@ int NfccI2cTransport::Read(void* pDevHandle, uint8_t* pBuffer,
   return numRead;
 }
 
+/*******************************************************************************
+**
+** Function         ReadFramed
+**
+** Description      Reads one NCI packet with a single read() of the maximum
+**                  packet size and parses the header in userspace. Falls back
+**                  to split reads if the driver turns out not to return whole
+**                  frames.
+**
+** Parameters       nHandle          - device fd
+**                  pBuffer          - buffer for read data
+**                  nNbBytesToRead   - size of pBuffer
+**
+** Returns          numRead   - number of successfully read bytes
+**                  -1        - read operation failure
+**
+*******************************************************************************/
+int NfccI2cTransport::ReadFramed(int nHandle, uint8_t* pBuffer,
+                                 int nNbBytesToRead) {
+  int ret_Read;
+  int numRead;
+  int frameLen;
+  int maxLen = NORMAL_MODE_HEADER_LEN + NCI_MAX_PAYLOAD_LEN;
+
+  if (nNbBytesToRead < maxLen) {
+    maxLen = nNbBytesToRead;
+  }
+
+  ret_Read = read(nHandle, pBuffer, maxLen);
+  if (ret_Read == 0) {
+    NXPLOG_TML_E("%s [frame] EOF", __func__);
+    return -1;
+#ifdef NXP_NFC_VBAT_MONITOR
+  } else if (ret_Read < 0 && errno == EREMOTEIO) {
+    NXPLOG_TML_E("%s [frame] errno : %x", __func__, errno);
+    return -EREMOTEIO;
+#endif
+  } else if (ret_Read < 0) {
+    NXPLOG_TML_E("%s [frame] errno : %x", __func__, errno);
+    return -1;
+  } else if (ret_Read >= 2 && pBuffer[0] == 0xFF && pBuffer[1] == 0xFF) {
+    NXPLOG_TML_E(" %s pBuffer[0] = %x pBuffer[1]= %x", __func__, pBuffer[0],
+                 pBuffer[1]);
+    return -1;
+  }
+  numRead = ret_Read;
+
+  /* Complete a short header, the length byte is needed to size the frame */
+  if (numRead < NORMAL_MODE_HEADER_LEN) {
+    ret_Read =
+        read(nHandle, pBuffer + numRead, NORMAL_MODE_HEADER_LEN - numRead);
+    if (ret_Read != NORMAL_MODE_HEADER_LEN - numRead) {
+      NXPLOG_TML_E("%s [hdr] errno : %x", __func__, errno);
+      return -1;
+    }
+    numRead += ret_Read;
+  }
+
+  frameLen = pBuffer[NORMAL_MODE_LEN_OFFSET] + NORMAL_MODE_HEADER_LEN;
+  if (frameLen > maxLen) {
+    NXPLOG_TML_E("%s frame length %d exceeds buffer", __func__, frameLen);
+    return -1;
+  }
+
+  if (numRead > frameLen) {
+    /* The driver returned more than one frame worth of bytes, so it does not
+       frame reads. The extra bytes are the start of the next packet: keep
+       them for the next read and stop using framed reads. */
+    NXPLOG_TML_E(
+        "%s driver does not return whole frames (%d > %d), using split reads",
+        __func__, numRead, frameLen);
+    mReadMode = I2C_READ_MODE_SPLIT;
+    mCarryLen = numRead - frameLen;
+    memcpy(mCarry, pBuffer + frameLen, mCarryLen);
+    return frameLen;
+  }
+
+  if (numRead < frameLen) {
+    if (mReadMode == I2C_READ_MODE_FRAMED_PROBE) {
+      NXPLOG_TML_D("%s short frame read, using split reads", __func__);
+      mReadMode = I2C_READ_MODE_SPLIT;
+    }
+    ret_Read = read(nHandle, pBuffer + numRead, frameLen - numRead);
+    if (ret_Read <= 0) {
+      NXPLOG_TML_E("%s [pyld] errno : %x", __func__, errno);
+      return -1;
+    }
+    numRead += ret_Read;
+  } else if (mReadMode == I2C_READ_MODE_FRAMED_PROBE) {
+    NXPLOG_TML_D("%s driver returns whole frames", __func__);
+    mReadMode = I2C_READ_MODE_FRAMED;
+  }
+
+  return numRead;
+}
+
+/*******************************************************************************
+**
+** Function         ReadCarried
+**
+** Description      Returns the packet which starts with the bytes kept by
+**                  ReadFramed, completing it from the device if needed. Bytes
+**                  left past its end are kept for the next read.
+**
+** Parameters       nHandle          - device fd
+**                  pBuffer          - buffer for read data
+**                  nNbBytesToRead   - size of pBuffer
+**
+** Returns          numRead   - number of successfully read bytes
+**                  -1        - read operation failure
+**
+*******************************************************************************/
+int NfccI2cTransport::ReadCarried(int nHandle, uint8_t* pBuffer,
+                                  int nNbBytesToRead) {
+  int ret_Read;
+  int numRead = mCarryLen;
+  int frameLen;
+
+  mCarryLen = 0;
+  if (numRead > nNbBytesToRead) {
+    NXPLOG_TML_E("%s %d carried bytes exceed buffer", __func__, numRead);
+    return -1;
+  }
+  memcpy(pBuffer, mCarry, numRead);
+
+  if (numRead < NORMAL_MODE_HEADER_LEN) {
+    ret_Read =
+        read(nHandle, pBuffer + numRead, NORMAL_MODE_HEADER_LEN - numRead);
+    if (ret_Read != NORMAL_MODE_HEADER_LEN - numRead) {
+      NXPLOG_TML_E("%s [hdr] errno : %x", __func__, errno);
+      return -1;
+    }
+    numRead += ret_Read;
+  }
+
+  frameLen = pBuffer[NORMAL_MODE_LEN_OFFSET] + NORMAL_MODE_HEADER_LEN;
+  if (frameLen > nNbBytesToRead) {
+    NXPLOG_TML_E("%s frame length %d exceeds buffer", __func__, frameLen);
+    return -1;
+  }
+
+  if (numRead > frameLen) {
+    /* Several packets were carried, keep the next ones */
+    mCarryLen = numRead - frameLen;
+    memcpy(mCarry, pBuffer + frameLen, mCarryLen);
+    return frameLen;
+  }
+
+  while (numRead < frameLen) {
+    ret_Read = read(nHandle, pBuffer + numRead, frameLen - numRead);
+    if (ret_Read <= 0) {
+      NXPLOG_TML_E("%s [pyld] errno : %x", __func__, errno);
+      return -1;
+    }
+    numRead += ret_Read;
+  }
+
+  return numRead;
+}
+
 /*******************************************************************************
 **
 ** Function         Write
@@ -471,7 +659,11 @@ int NfccI2cTransport::EseReset(void* pDevHandle, EseResetType eType) {
 **
 ** Returns          None
 *******************************************************************************/
-void NfccI2cTransport::EnableFwDnldMode(bool mode) { bFwDnldFlag = mode; }
+void NfccI2cTransport::EnableFwDnldMode(bool mode) {
+  bFwDnldFlag = mode;
+  /* Carried NCI bytes do not survive the switch to download mode */
+  if (mode) mCarryLen = 0;
+}
 
 /*******************************************************************************
 **
@@ -59,15 +59,69 @@
 #define NORMAL_MODE_LEN_OFFSET 2
 #define FLUSH_BUFFER_SIZE 0xFF
 #define FLUSH_READ_TIMEOUT_MS 10
+#define READ_POLL_TIMEOUT_MS 2000
+#define NCI_MAX_PAYLOAD_LEN 0xFF
 // To enable the VBAT monitor feature.
 //  #define NXP_NFC_VBAT_MONITOR
 extern phTmlNfc_Context_t* gpphTmlNfc_Context;
 extern phTmlNfc_i2cfragmentation_t fragmentation_enabled;
 
+/*
+ * Read strategy for NCI mode. Framed reads fetch a whole packet with a single
+ * read() and need driver support, so they are only enabled through
+ * NXP_I2C_FRAMED_READ and verified on the first packet.
+ */
+enum I2cReadMode : uint8_t {
+  I2C_READ_MODE_SPLIT = 0x00, /* header, then payload */
+  I2C_READ_MODE_FRAMED_PROBE, /* framed read requested, not yet verified */
+  I2C_READ_MODE_FRAMED        /* driver confirmed to return one frame */
+};
+
 class NfccI2cTransport : public NfccTransport {
  private:
   bool_t bFwDnldFlag = false;
   sem_t mTxRxSemaphore;
+  I2cReadMode mReadMode = I2C_READ_MODE_SPLIT;
+  /* Bytes read past the end of a frame, start of the next packet */
+  uint8_t mCarry[NORMAL_MODE_HEADER_LEN + NCI_MAX_PAYLOAD_LEN];
+  int mCarryLen = 0;
+
+  /*****************************************************************************
+   **
+   ** Function         ReadFramed
+   **
+   ** Description      Reads one NCI packet with a single read() of the maximum
+   **                  packet size and parses the header in userspace. Falls
+   **                  back to split reads if the driver turns out not to
+   **                  return whole frames.
+   **
+   ** Parameters       nHandle          - device fd
+   **                  pBuffer          - buffer for read data
+   **                  nNbBytesToRead   - size of pBuffer
+   **
+   ** Returns          numRead   - number of successfully read bytes
+   **                  -1        - read operation failure
+   **
+   ****************************************************************************/
+  int ReadFramed(int nHandle, uint8_t* pBuffer, int nNbBytesToRead);
+
+  /*****************************************************************************
+   **
+   ** Function         ReadCarried
+   **
+   ** Description      Returns the packet which starts with the bytes kept by
+   **                  ReadFramed, completing it from the device if needed.
+   **                  Bytes left past its end are kept for the next read.
+   **
+   ** Parameters       nHandle          - device fd
+   **                  pBuffer          - buffer for read data
+   **                  nNbBytesToRead   - size of pBuffer
+   **
+   ** Returns          numRead   - number of successfully read bytes
+   **                  -1        - read operation failure
+   **
+   ****************************************************************************/
+  int ReadCarried(int nHandle, uint8_t* pBuffer, int nNbBytesToRead);
 
  public:
   /*****************************************************************************
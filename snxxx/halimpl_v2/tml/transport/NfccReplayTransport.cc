@@ -0,0 +1,326 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <NfccReplayTransport.h>
+#include <errno.h>
+#include <phNxpLog.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+NfccReplayTransport::ReplayState& NfccReplayTransport::getReplayState() {
+  /* Outlives the transport instances, see NfccReplayTransport. Never
+   * destroyed: the reader may still be replaying while exiting */
+  static ReplayState* sReplay = new ReplayState();
+  return *sReplay;
+}
+
+/*******************************************************************************
+**
+** Function         Close
+**
+** Description      Stops the replay, the position in the capture is kept
+**
+** Parameters       pDevHandle - device handle
+**
+** Returns          None
+**
+*******************************************************************************/
+void NfccReplayTransport::Close(void* pDevHandle) {
+  std::lock_guard<std::mutex> lock(mReplay.lock);
+  (void)pDevHandle;
+  if (mTimerFd >= 0) {
+    close(mTimerFd);
+    mTimerFd = -1;
+  }
+  NXPLOG_TML_D("%s %zu/%zu frames replayed, %u host frames mismatched",
+               __func__, std::max(mReplay.nextRx, mReplay.nextTx),
+               mReplay.frames.size(), mReplay.mismatches);
+}
+
+/*******************************************************************************
+**
+** Function         OpenAndConfigure
+**
+** Description      Loads the capture of NXP_NFC_REPLAY_FILE the first time,
+**                  and starts or resumes its replay
+**
+** Parameters       pConfig     - hardware information
+**                  pLinkHandle - device handle
+**
+** Returns          NFC status:
+**                  NFCSTATUS_SUCCESS - open_and_configure operation success
+**                  NFCSTATUS_INVALID_DEVICE - device open operation failure
+**
+*******************************************************************************/
+NFCSTATUS NfccReplayTransport::OpenAndConfigure(pphTmlNfc_Config_t pConfig,
+                                                void** pLinkHandle) {
+  std::lock_guard<std::mutex> lock(mReplay.lock);
+  (void)pConfig;
+  *pLinkHandle = NULL;
+
+  if (!mReplay.loaded) {
+    const char* path = getenv(NFCC_REPLAY_FILE_ENV);
+    int gate = -1;
+    if (path == NULL || !phTmlNfc_CaptureLoad(path, mReplay.frames)) {
+      NXPLOG_TML_E("%s No capture to replay", __func__);
+      return NFCSTATUS_INVALID_DEVICE;
+    }
+    mReplay.gate.resize(mReplay.frames.size());
+    mReplay.writtenUs.assign(mReplay.frames.size(), 0);
+    for (size_t i = 0; i < mReplay.frames.size(); i++) {
+      mReplay.gate[i] = gate;
+      if (!(mReplay.frames[i].bFlags & PH_TMLNFC_CAPTURE_DIR_RX)) gate = (int)i;
+    }
+    mReplay.maxSpeed = (getenv(NFCC_REPLAY_MAX_SPEED_ENV) != NULL);
+    mReplay.startUs = phTmlNfc_CaptureNowUs();
+    mReplay.loaded = true;
+  }
+  if (mTimerFd < 0) {
+    mTimerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (mTimerFd < 0) {
+      NXPLOG_TML_E("%s timerfd_create failed: %d", __func__, errno);
+      return NFCSTATUS_INVALID_DEVICE;
+    }
+  }
+  Arm();
+  *pLinkHandle = (void*)((intptr_t)mTimerFd);
+  return NFCSTATUS_SUCCESS;
+}
+
+/*******************************************************************************
+**
+** Function         Read
+**
+** Description      Reads the next captured NFCC frame, blocking until it is
+**                  due or the read is aborted
+**
+** Parameters       pDevHandle       - valid device handle
+**                  pBuffer          - buffer for read data
+**                  nNbBytesToRead   - number of bytes requested to be read
+**
+** Returns          numRead   - number of successfully read bytes
+**                  -1        - read operation failure
+**
+*******************************************************************************/
+int NfccReplayTransport::Read(void* pDevHandle, uint8_t* pBuffer,
+                              int nNbBytesToRead) {
+  struct pollfd fds[2];
+  nfds_t nfds = 1;
+
+  if (NULL == pDevHandle) {
+    return -1;
+  }
+  fds[0].fd = (int)(intptr_t)pDevHandle;
+  fds[0].events = POLLIN;
+  fds[0].revents = 0;
+  if (mReadAbortFd >= 0) {
+    fds[1].fd = mReadAbortFd;
+    fds[1].events = POLLIN;
+    fds[1].revents = 0;
+    nfds = 2;
+  }
+
+  for (;;) {
+    uint64_t expirations;
+    uint64_t dueUs;
+    int ret_Poll = TEMP_FAILURE_RETRY(poll(fds, nfds, -1));
+    if (ret_Poll < 0) {
+      NXPLOG_TML_D("%s errno : %x", __func__, errno);
+      return -1;
+    } else if ((nfds == 2) && (fds[1].revents & POLLIN)) {
+      NXPLOG_TML_D("%s aborted", __func__);
+      return PH_TMLNFC_READ_ABORTED;
+    } else if (fds[0].revents & (POLLERR | POLLNVAL)) {
+      NXPLOG_TML_E("%s poll revents : %x", __func__, fds[0].revents);
+      return -1;
+    }
+    (void)read(fds[0].fd, &expirations, sizeof(expirations));
+
+    std::lock_guard<std::mutex> lock(mReplay.lock);
+    /* The timer may have been armed again since it expired */
+    if (NextRxDue(&dueUs) &&
+        (mReplay.maxSpeed || dueUs <= phTmlNfc_CaptureNowUs())) {
+      const std::vector<uint8_t>& data = mReplay.frames[mReplay.nextRx++].data;
+      Arm();
+      if ((int)data.size() > nNbBytesToRead) {
+        NXPLOG_TML_E("%s frame of %zu bytes dropped", __func__, data.size());
+        return -1;
+      }
+      memcpy(pBuffer, data.data(), data.size());
+      return (int)data.size();
+    }
+    Arm();
+  }
+}
+
+/*******************************************************************************
+**
+** Function         Write
+**
+** Description      Checks a host frame against the next captured one
+**
+** Parameters       pDevHandle       - valid device handle
+**                  pBuffer          - buffer for read data
+**                  nNbBytesToWrite  - number of bytes requested to be written
+**
+** Returns          numWrote   - number of successfully written bytes
+**                  -1         - write operation failure
+**
+*******************************************************************************/
+int NfccReplayTransport::Write(void* pDevHandle, uint8_t* pBuffer,
+                               int nNbBytesToWrite) {
+  std::lock_guard<std::mutex> lock(mReplay.lock);
+  if (NULL == pDevHandle) {
+    return -1;
+  }
+  while (mReplay.nextTx < mReplay.frames.size() &&
+         (mReplay.frames[mReplay.nextTx].bFlags & PH_TMLNFC_CAPTURE_DIR_RX)) {
+    mReplay.nextTx++;
+  }
+  if (mReplay.nextTx >= mReplay.frames.size()) {
+    NXPLOG_TML_W("%s host frame beyond the capture", __func__);
+    mReplay.mismatches++;
+    return nNbBytesToWrite;
+  }
+  const phTmlNfc_CaptureFrame_t& frame = mReplay.frames[mReplay.nextTx];
+  if (frame.data.size() != (size_t)nNbBytesToWrite ||
+      memcmp(frame.data.data(), pBuffer, nNbBytesToWrite) != 0 ||
+      !(frame.bFlags & PH_TMLNFC_CAPTURE_FW_DNLD) != !bFwDnldFlag) {
+    NXPLOG_TML_W("%s host frame %zu differs from the capture", __func__,
+                 mReplay.nextTx);
+    mReplay.mismatches++;
+  }
+  mReplay.writtenUs[mReplay.nextTx++] = phTmlNfc_CaptureNowUs();
+  Arm();
+  return nNbBytesToWrite;
+}
+
+/*******************************************************************************
+**
+** Function         NfccReset
+**
+** Description      Tracks the FW download mode, nothing else to reset
+**
+** Parameters       pDevHandle     - valid device handle
+**                  eType          - reset level
+**
+** Returns           0   - reset operation success
+**
+*******************************************************************************/
+int NfccReplayTransport::NfccReset(void* pDevHandle, NfccResetType eType) {
+  (void)pDevHandle;
+  NXPLOG_TML_D("%s, VEN eType %u", __func__, eType);
+  if (eType == MODE_FW_DWNLD_WITH_VEN || eType == MODE_FW_DWND_HIGH) {
+    bFwDnldFlag = true;
+  } else if (eType == MODE_POWER_ON || eType == MODE_FW_GPIO_LOW) {
+    bFwDnldFlag = false;
+  }
+  return 0;
+}
+
+/*******************************************************************************
+**
+** Function         EnableFwDnldMode
+**
+** Description      updates the state to Download mode
+**
+** Parameters       True/False
+**
+** Returns          None
+*******************************************************************************/
+void NfccReplayTransport::EnableFwDnldMode(bool mode) { bFwDnldFlag = mode; }
+
+/*******************************************************************************
+**
+** Function         IsFwDnldModeEnabled
+**
+** Description      Returns the current mode
+**
+** Parameters       none
+**
+** Returns          Current mode download/NCI
+*******************************************************************************/
+bool_t NfccReplayTransport::IsFwDnldModeEnabled(void) { return bFwDnldFlag; }
+
+/*******************************************************************************
+**
+** Function         NextRxDue
+**
+** Description      Finds the next captured NFCC frame, and when it is due:
+**                  after the last host frame before it was written, with the
+**                  delay it had in the capture. Called with mReplay.lock held.
+**
+** Parameters       pDueUs - due time, in phTmlNfc_CaptureNowUs() time
+**
+** Returns          false if there is no such frame, or if host frames before
+**                  it are not written yet
+**
+*******************************************************************************/
+bool NfccReplayTransport::NextRxDue(uint64_t* pDueUs) {
+  while (mReplay.nextRx < mReplay.frames.size() &&
+         !(mReplay.frames[mReplay.nextRx].bFlags & PH_TMLNFC_CAPTURE_DIR_RX)) {
+    mReplay.nextRx++;
+  }
+  if (mReplay.nextRx >= mReplay.frames.size()) return false;
+
+  int gate = mReplay.gate[mReplay.nextRx];
+  if (gate >= 0 && mReplay.nextTx <= (size_t)gate) return false;
+  if (gate < 0) {
+    *pDueUs = mReplay.startUs + mReplay.frames[mReplay.nextRx].tsUs;
+  } else {
+    *pDueUs = mReplay.writtenUs[gate] +
+              (mReplay.frames[mReplay.nextRx].tsUs - mReplay.frames[gate].tsUs);
+  }
+  return true;
+}
+
+/*******************************************************************************
+**
+** Function         Arm
+**
+** Description      Makes the device handle readable when the next captured
+**                  NFCC frame is due, or never if none can be read yet.
+**                  Called with mReplay.lock held.
+**
+** Returns          None
+**
+*******************************************************************************/
+void NfccReplayTransport::Arm(void) {
+  struct itimerspec spec;
+  uint64_t dueUs;
+  int flags = 0;
+
+  if (mTimerFd < 0) return;
+  memset(&spec, 0, sizeof(spec));
+  if (NextRxDue(&dueUs)) {
+    if (mReplay.maxSpeed) {
+      /* As soon as possible, a zero value would disarm the timer */
+      spec.it_value.tv_nsec = 1;
+    } else {
+      spec.it_value.tv_sec = dueUs / 1000000;
+      spec.it_value.tv_nsec = (dueUs % 1000000) * 1000;
+      flags = TFD_TIMER_ABSTIME;
+    }
+  }
+  if (timerfd_settime(mTimerFd, flags, &spec, NULL) != 0) {
+    NXPLOG_TML_E("%s timerfd_settime failed: %d", __func__, errno);
+  }
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+#include <NfccTransport.h>
+#include <phTmlNfc_Capture.h>
+
+#include <mutex>
+#include <vector>
+
+/* Capture replayed, selects the replay transport whatever NXP_TRANSPORT is */
+#define NFCC_REPLAY_FILE_ENV "NXP_NFC_REPLAY_FILE"
+/* When set, frames are read as soon as the host frames before them are
+ * written, instead of with their captured timing */
+#define NFCC_REPLAY_MAX_SPEED_ENV "NXP_NFC_REPLAY_MAX_SPEED"
+
+/*
+ * Transport replaying a capture of phTmlNfc_Capture: the frames read from
+ * the NFCC are read again once the host frames captured before them are
+ * written, each after the delay it had from the last of them. Host frames
+ * differing from the capture are logged and counted, and the replay goes
+ * on.
+ * The device handle is a timerfd readable when the next frame is due, so
+ * the HAL event loop can poll it.
+ * The capture covers every TML initialization of the process, and TML
+ * creates a new transport on each of them, so the replay position is kept
+ * by the process wide ReplayState: an NFC off/on cycle or a reopen for FW
+ * download resumes the replay where the previous transport left it.
+ */
+class NfccReplayTransport : public NfccTransport {
+ private:
+  struct ReplayState {
+    std::mutex lock;
+    std::vector<phTmlNfc_CaptureFrame_t> frames;
+    /* Index of the last host frame before each frame, -1 if none */
+    std::vector<int> gate;
+    /* Time each host frame was written in the replay */
+    std::vector<uint64_t> writtenUs;
+    size_t nextRx = 0;
+    size_t nextTx = 0;
+    uint64_t startUs = 0;
+    uint32_t mismatches = 0;
+    bool loaded = false;
+    bool maxSpeed = false;
+  };
+
+  static ReplayState& getReplayState();
+
+  ReplayState& mReplay = getReplayState();
+  int mTimerFd = -1;
+  bool_t bFwDnldFlag = false;
+
+  bool NextRxDue(uint64_t* pDueUs);
+  void Arm(void);
+
+ public:
+  /*****************************************************************************
+  **
+  ** Function         Close
+  **
+  ** Description      Stops the replay, the position in the capture is kept
+  **
+  ** Parameters       pDevHandle - device handle
+  **
+  ** Returns          None
+  **
+  *****************************************************************************/
+  void Close(void* pDevHandle);
+
+  /*****************************************************************************
+   **
+   ** Function         OpenAndConfigure
+   **
+   ** Description      Loads the capture of NXP_NFC_REPLAY_FILE the first
+   **                  time, and starts or resumes its replay
+   **
+   ** Parameters       pConfig     - hardware information
+   **                  pLinkHandle - device handle
+   **
+   ** Returns          NFC status:
+   **                  NFCSTATUS_SUCCESS - open_and_configure operation success
+   **                  NFCSTATUS_INVALID_DEVICE - device open operation failure
+   **
+   ****************************************************************************/
+  NFCSTATUS OpenAndConfigure(pphTmlNfc_Config_t pConfig, void** pLinkHandle);
+
+  /*****************************************************************************
+   **
+   ** Function         Read
+   **
+   ** Description      Reads the next captured NFCC frame, blocking until it
+   **                  is due or the read is aborted
+   **
+   ** Parameters       pDevHandle       - valid device handle
+   **                  pBuffer          - buffer for read data
+   **                  nNbBytesToRead   - number of bytes requested to be read
+   **
+   ** Returns          numRead   - number of successfully read bytes
+   **                  -1        - read operation failure
+   **
+   ****************************************************************************/
+  int Read(void* pDevHandle, uint8_t* pBuffer, int nNbBytesToRead);
+
+  /*****************************************************************************
+   **
+   ** Function         Write
+   **
+   ** Description      Checks a host frame against the next captured one
+   **
+   ** Parameters       pDevHandle       - valid device handle
+   **                  pBuffer          - buffer for read data
+   **                  nNbBytesToWrite  - number of bytes requested to be
+   **                                     written
+   **
+   ** Returns          numWrote   - number of successfully written bytes
+   **                  -1         - write operation failure
+   **
+   ****************************************************************************/
+  int Write(void* pDevHandle, uint8_t* pBuffer, int nNbBytesToWrite);
+
+  /*****************************************************************************
+   **
+   ** Function         NfccReset
+   **
+   ** Description      Tracks the FW download mode, nothing else to reset
+   **
+   ** Parameters       pDevHandle     - valid device handle
+   **                  eType          - reset level
+   **
+   ** Returns           0   - reset operation success
+   **
+   ****************************************************************************/
+  int NfccReset(void* pDevHandle, NfccResetType eType);
+
+  /*****************************************************************************
+   **
+   ** Function         EnableFwDnldMode
+   **
+   ** Description      updates the state to Download mode
+   **
+   ** Parameters       True/False
+   **
+   ** Returns          None
+   ****************************************************************************/
+  void EnableFwDnldMode(bool mode);
+
+  /*****************************************************************************
+   **
+   ** Function         IsFwDnldModeEnabled
+   **
+   ** Description      Returns the current mode
+   **
+   ** Parameters       none
+   **
+   ** Returns          Current mode download/NCI
+   ****************************************************************************/
+  bool_t IsFwDnldModeEnabled(void);
+};
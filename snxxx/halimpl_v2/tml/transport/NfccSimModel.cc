@@ -0,0 +1,379 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "NfccSimModel.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "NxpNfcHexCodec.h"
+
+#define NCI_SIM_MT_MASK 0xE0
+#define NCI_SIM_MT_DATA 0x00
+#define NCI_SIM_MT_CMD 0x20
+#define NCI_SIM_MT_RSP 0x40
+#define NCI_SIM_GID_MASK 0x0F
+#define NCI_SIM_OID_MASK 0x3F
+#define NCI_SIM_HDR_LEN 3
+#define NCI_SIM_STATUS_OK 0x00
+#define NCI_SIM_MAX_PAYLOAD_LEN 0xFF
+#define NCI_SIM_DEACTIVATE_REASON_DH_REQUEST 0x00
+
+/* CORE_RESET_NTF: reset by command, NCI 2.0, SN220 FW 01.01.33 */
+static const std::vector<uint8_t> kDefaultResetNtf = {
+    0x60, 0x00, 0x09, 0x02, 0x00, 0x20, 0x04, 0x04, 0x51, 0x01, 0x01, 0x33};
+/* CORE_INIT_RSP NCI 2.0: one logical connection, 255 bytes control and
+ * static HCI payload, one static HCI credit, four RF interfaces */
+static const std::vector<uint8_t> kDefaultInitRsp = {
+    0x40, 0x01, 0x16, 0x00, 0x1A, 0x7E, 0x06, 0x02, 0x01,
+    0xD0, 0x02, 0xFF, 0xFF, 0x01, 0x00, 0x01, 0x04, 0x00,
+    0x00, 0x01, 0x00, 0x02, 0x00, 0x03, 0x00};
+
+static bool isTwoByteTag(uint8_t tag) { return tag == 0xA0 || tag == 0xA1; }
+
+static bool parseHex(const std::string& token, std::vector<uint8_t>& out) {
+  if (token.empty() || (token.size() % 2) != 0) return false;
+  out.resize(token.size() / 2);
+  return phNxpNciHal_hexDecode(token.c_str(), token.size(), out.data()) ==
+         out.size();
+}
+
+static bool parseUs(const std::string& token, uint32_t& out) {
+  char* end = nullptr;
+  unsigned long value = strtoul(token.c_str(), &end, 0);
+  if (token.empty() || *end != '\0' || value > UINT32_MAX) return false;
+  out = (uint32_t)value;
+  return true;
+}
+
+NfccSimModel::NfccSimModel()
+    : mRunning(false),
+      mReadFd(-1),
+      mRspLatencyUs(NFCC_SIM_DEFAULT_RSP_LATENCY_US),
+      mNtfLatencyUs(NFCC_SIM_DEFAULT_NTF_LATENCY_US),
+      mWriteCount(0),
+      mResetNtf(kDefaultResetNtf),
+      mInitRsp(kDefaultInitRsp) {}
+
+NfccSimModel::~NfccSimModel() { Stop(); }
+
+NfccSimModel& NfccSimModel::getInstance() {
+  static NfccSimModel instance;
+  return instance;
+}
+
+int NfccSimModel::Start() {
+  std::lock_guard<std::mutex> lock(mLock);
+  if (mRunning) return mReadFd;
+
+  mReadFd = eventfd(0, EFD_SEMAPHORE | EFD_NONBLOCK | EFD_CLOEXEC);
+  if (mReadFd < 0) return -1;
+  mRunning = true;
+  mThread = std::thread(&NfccSimModel::Run, this);
+  return mReadFd;
+}
+
+void NfccSimModel::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mLock);
+    if (!mRunning) return;
+    mRunning = false;
+    mScheduled.clear();
+    mReady.clear();
+  }
+  mCond.notify_all();
+  if (mThread.joinable()) mThread.join();
+  /* Read and Flush use the fd under the lock */
+  std::lock_guard<std::mutex> lock(mLock);
+  close(mReadFd);
+  mReadFd = -1;
+}
+
+void NfccSimModel::Flush() {
+  std::lock_guard<std::mutex> lock(mLock);
+  uint64_t count;
+  if (!mRunning) return;
+  mScheduled.clear();
+  mReady.clear();
+  /* Semaphore fd: one read per packet counted */
+  while (read(mReadFd, &count, sizeof(count)) == sizeof(count)) {
+  }
+}
+
+void NfccSimModel::Write(const uint8_t* p_data, uint16_t data_len) {
+  std::lock_guard<std::mutex> lock(mLock);
+  mWriteCount++;
+  if (!mRunning || p_data == nullptr || data_len < NCI_SIM_HDR_LEN) return;
+
+  switch (p_data[0] & NCI_SIM_MT_MASK) {
+    case NCI_SIM_MT_CMD:
+      AnswerCmd(p_data, data_len);
+      break;
+    case NCI_SIM_MT_DATA:
+      /* One credit back per data packet */
+      Schedule({0x60, 0x06, 0x03, 0x01,
+                (uint8_t)(p_data[0] & NCI_SIM_GID_MASK), 0x01},
+               mRspLatencyUs);
+      break;
+    default:
+      break;
+  }
+}
+
+int NfccSimModel::Read(uint8_t* p_buff, uint16_t max_len) {
+  std::lock_guard<std::mutex> lock(mLock);
+  uint64_t count;
+  if (mReady.empty()) return 0;
+
+  std::vector<uint8_t>& packet = mReady.front();
+  if (packet.size() > max_len) return -1;
+  int len = (int)packet.size();
+  memcpy(p_buff, packet.data(), len);
+  mReady.pop_front();
+  (void)read(mReadFd, &count, sizeof(count));
+  return len;
+}
+
+void NfccSimModel::Inject(const std::vector<uint8_t>& packet,
+                          uint32_t delayUs) {
+  std::lock_guard<std::mutex> lock(mLock);
+  if (mRunning) Schedule(packet, delayUs);
+}
+
+void NfccSimModel::AddRule(
+    const std::vector<uint8_t>& cmdPrefix, const std::vector<uint8_t>& rsp,
+    const std::vector<std::pair<uint32_t, std::vector<uint8_t>>>& ntfs) {
+  std::lock_guard<std::mutex> lock(mLock);
+  mRules[cmdPrefix] = {rsp, ntfs};
+}
+
+bool NfccSimModel::LoadScript(const char* path) {
+  std::ifstream file(path);
+  std::string line;
+  if (!file.is_open()) return false;
+
+  while (std::getline(file, line)) {
+    std::istringstream tokens(line.substr(0, line.find('#')));
+    std::string directive, arg1, arg2, arg3;
+    std::vector<uint8_t> prefix, packet;
+    uint32_t us = 0, us2 = 0;
+    if (!(tokens >> directive)) continue;
+    tokens >> arg1 >> arg2 >> arg3;
+
+    if (directive == "LATENCY" && parseUs(arg1, us) && parseUs(arg2, us2)) {
+      SetLatency(us, us2);
+    } else if (directive == "RSP" && parseHex(arg1, prefix) &&
+               parseHex(arg2, packet)) {
+      AddRule(prefix, packet);
+    } else if (directive == "NTF" && parseHex(arg1, prefix) &&
+               parseUs(arg2, us) && parseHex(arg3, packet)) {
+      std::lock_guard<std::mutex> lock(mLock);
+      mRules[prefix].ntfs.push_back({us, packet});
+    } else if (directive == "RESET_NTF" && parseHex(arg1, packet)) {
+      std::lock_guard<std::mutex> lock(mLock);
+      mResetNtf = packet;
+    } else if (directive == "INIT_RSP" && parseHex(arg1, packet)) {
+      std::lock_guard<std::mutex> lock(mLock);
+      mInitRsp = packet;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+void NfccSimModel::ClearRules() {
+  std::lock_guard<std::mutex> lock(mLock);
+  mRules.clear();
+  mConfig.clear();
+  mResetNtf = kDefaultResetNtf;
+  mInitRsp = kDefaultInitRsp;
+  mRspLatencyUs = NFCC_SIM_DEFAULT_RSP_LATENCY_US;
+  mNtfLatencyUs = NFCC_SIM_DEFAULT_NTF_LATENCY_US;
+  mWriteCount = 0;
+}
+
+void NfccSimModel::SetLatency(uint32_t rspUs, uint32_t ntfUs) {
+  std::lock_guard<std::mutex> lock(mLock);
+  mRspLatencyUs = rspUs;
+  mNtfLatencyUs = ntfUs;
+}
+
+uint32_t NfccSimModel::GetWriteCount() {
+  std::lock_guard<std::mutex> lock(mLock);
+  return mWriteCount;
+}
+
+/******************************************************************************
+ * Function:       Run()
+ *
+ * Description:    Moves scheduled packets to the read queue once due, and
+ *                 counts them on the read fd.
+ *
+ * Returns:        void
+ ******************************************************************************/
+void NfccSimModel::Run() {
+  std::unique_lock<std::mutex> lock(mLock);
+  while (mRunning) {
+    if (mScheduled.empty()) {
+      mCond.wait(lock);
+      continue;
+    }
+    auto now = std::chrono::steady_clock::now();
+    uint64_t due = 0;
+    while (!mScheduled.empty() && mScheduled.begin()->first <= now) {
+      mReady.push_back(std::move(mScheduled.begin()->second));
+      mScheduled.erase(mScheduled.begin());
+      due++;
+    }
+    if (due != 0) {
+      (void)write(mReadFd, &due, sizeof(due));
+    } else {
+      mCond.wait_until(lock, mScheduled.begin()->first);
+    }
+  }
+}
+
+/* Called with mLock held */
+void NfccSimModel::Schedule(std::vector<uint8_t> packet, uint32_t delayUs) {
+  mScheduled.emplace(
+      std::chrono::steady_clock::now() + std::chrono::microseconds(delayUs),
+      std::move(packet));
+  mCond.notify_one();
+}
+
+/* Called with mLock held */
+const NfccSimModel::tRule* NfccSimModel::FindRule(const uint8_t* p_cmd,
+                                                  uint16_t cmd_len) const {
+  const tRule* rule = nullptr;
+  size_t matchLen = 0;
+  for (const auto& [prefix, candidate] : mRules) {
+    if (prefix.size() <= cmd_len && prefix.size() >= matchLen &&
+        memcmp(prefix.data(), p_cmd, prefix.size()) == 0) {
+      rule = &candidate;
+      matchLen = prefix.size();
+    }
+  }
+  return rule;
+}
+
+/* Called with mLock held */
+void NfccSimModel::AnswerCmd(const uint8_t* p_cmd, uint16_t cmd_len) {
+  const uint8_t gid = p_cmd[0] & NCI_SIM_GID_MASK;
+  const uint8_t oid = p_cmd[1] & NCI_SIM_OID_MASK;
+  const tRule* rule = FindRule(p_cmd, cmd_len);
+  /* Notifications, with their delay after the response */
+  std::vector<std::pair<uint32_t, std::vector<uint8_t>>> ntfs;
+  std::vector<uint8_t> rsp = {(uint8_t)(NCI_SIM_MT_RSP | gid), oid, 0x01,
+                              NCI_SIM_STATUS_OK};
+
+  switch ((gid << 8) | oid) {
+    case 0x0000: /* CORE_RESET */
+      ntfs.push_back({mNtfLatencyUs, mResetNtf});
+      break;
+    case 0x0001: /* CORE_INIT */
+      rsp = mInitRsp;
+      break;
+    case 0x0002: /* CORE_SET_CONFIG */
+      SetConfig(p_cmd, cmd_len);
+      rsp = {0x40, 0x02, 0x02, NCI_SIM_STATUS_OK, 0x00};
+      break;
+    case 0x0003: /* CORE_GET_CONFIG */
+      rsp = GetConfigRsp(p_cmd, cmd_len);
+      break;
+    case 0x0106: /* RF_DEACTIVATE */
+      if (cmd_len > NCI_SIM_HDR_LEN) {
+        ntfs.push_back({mNtfLatencyUs,
+                        {0x61, 0x06, 0x02, p_cmd[3],
+                         NCI_SIM_DEACTIVATE_REASON_DH_REQUEST}});
+      }
+      break;
+    case 0x0200: /* NFCEE_DISCOVER, no NFCEE */
+      rsp = {0x42, 0x00, 0x02, NCI_SIM_STATUS_OK, 0x00};
+      break;
+    default:
+      break;
+  }
+  if (rule != nullptr) {
+    /* A rule without response only adds notifications */
+    if (!rule->rsp.empty()) {
+      rsp = rule->rsp;
+      ntfs.clear();
+    }
+    ntfs.insert(ntfs.end(), rule->ntfs.begin(), rule->ntfs.end());
+  }
+
+  /* Scheduled in order, so that nothing overtakes the response */
+  Schedule(rsp, mRspLatencyUs);
+  for (auto& [delayUs, ntf] : ntfs) {
+    Schedule(std::move(ntf), mRspLatencyUs + delayUs);
+  }
+}
+
+/* Called with mLock held */
+void NfccSimModel::SetConfig(const uint8_t* p_cmd, uint16_t cmd_len) {
+  uint16_t pos = NCI_SIM_HDR_LEN + 1;
+  if (cmd_len <= NCI_SIM_HDR_LEN) return;
+
+  for (uint8_t i = 0; i < p_cmd[NCI_SIM_HDR_LEN] && pos < cmd_len; i++) {
+    uint16_t tag = p_cmd[pos++];
+    if (isTwoByteTag((uint8_t)tag) && pos < cmd_len) {
+      tag = (tag << 8) | p_cmd[pos++];
+    }
+    if (pos >= cmd_len || pos + 1 + p_cmd[pos] > cmd_len) return;
+    uint8_t len = p_cmd[pos++];
+    mConfig[tag].assign(p_cmd + pos, p_cmd + pos + len);
+    pos += len;
+  }
+}
+
+/* Called with mLock held */
+std::vector<uint8_t> NfccSimModel::GetConfigRsp(const uint8_t* p_cmd,
+                                                uint16_t cmd_len) {
+  std::vector<uint8_t> rsp = {0x40, 0x03, 0x00, NCI_SIM_STATUS_OK, 0x00};
+  uint16_t pos = NCI_SIM_HDR_LEN + 1;
+  uint8_t count = 0;
+  if (cmd_len <= NCI_SIM_HDR_LEN) return rsp;
+
+  for (uint8_t i = 0; i < p_cmd[NCI_SIM_HDR_LEN] && pos < cmd_len; i++) {
+    uint16_t tag = p_cmd[pos++];
+    bool twoBytes = isTwoByteTag((uint8_t)tag) && pos < cmd_len;
+    if (twoBytes) tag = (tag << 8) | p_cmd[pos++];
+
+    auto it = mConfig.find(tag);
+    size_t valueLen = (it != mConfig.end()) ? it->second.size() : 0;
+    if (rsp.size() - NCI_SIM_HDR_LEN + (twoBytes ? 3 : 2) + valueLen >
+        NCI_SIM_MAX_PAYLOAD_LEN) {
+      break;
+    }
+    if (twoBytes) rsp.push_back((uint8_t)(tag >> 8));
+    rsp.push_back((uint8_t)tag);
+    rsp.push_back((uint8_t)valueLen);
+    if (valueLen != 0) {
+      rsp.insert(rsp.end(), it->second.begin(), it->second.end());
+    }
+    count++;
+  }
+  rsp[4] = count;
+  rsp[2] = (uint8_t)(rsp.size() - NCI_SIM_HDR_LEN);
+  return rsp;
+}
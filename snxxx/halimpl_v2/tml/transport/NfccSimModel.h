@@ -0,0 +1,190 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* Latencies used until the script or the test sets others */
+#define NFCC_SIM_DEFAULT_RSP_LATENCY_US 200
+#define NFCC_SIM_DEFAULT_NTF_LATENCY_US 1000
+
+/******************************************************************************
+ * Class         NfccSimModel
+ *
+ * Description   Virtual NFCC behind NfccSimTransport. Every NCI command is
+ *               answered after the response latency:
+ *               - CORE_RESET with a CORE_RESET_NTF (SN220 FW by default),
+ *               - CORE_INIT with a NCI 2.0 CORE_INIT_RSP,
+ *               - CORE_SET_CONFIG/GET_CONFIG from a parameter store,
+ *               - RF_DEACTIVATE with the RF_DEACTIVATE_NTF,
+ *               - NFCEE_DISCOVER with no NFCEE,
+ *               - data packets with a CORE_CONN_CREDITS_NTF,
+ *               - any other command (RF_DISCOVER, proprietary...) with a
+ *                 STATUS_OK response.
+ *               Rules added by script or by AddRule() take precedence and
+ *               may add notifications, sent after their own latency.
+ *               Packets can be injected at any time, e.g. an
+ *               RF_INTF_ACTIVATED_NTF after RF_DISCOVER.
+ *
+ *               Script lines, hex without separators, '#' for comments:
+ *                 LATENCY <rsp us> <ntf us>
+ *                 RSP <cmd prefix> <rsp>
+ *                 NTF <cmd prefix> <delay us> <ntf>
+ *                 RESET_NTF <ntf>
+ *                 INIT_RSP <rsp>
+ *
+ ******************************************************************************/
+class NfccSimModel {
+ public:
+  static NfccSimModel& getInstance();
+
+  NfccSimModel(const NfccSimModel&) = delete;
+  NfccSimModel& operator=(const NfccSimModel&) = delete;
+
+  /******************************************************************************
+   * Function:       Start()
+   *
+   * Description:    Powers the virtual NFCC on: creates the fd signalling
+   *                 packets to read and starts delivering them.
+   *
+   * Returns:        fd readable while a packet is ready, -1 on failure.
+   ******************************************************************************/
+  int Start();
+
+  /******************************************************************************
+   * Function:       Stop()
+   *
+   * Description:    Powers the virtual NFCC off and drops every packet not
+   *                 read yet. Rules and latencies are kept.
+   *
+   * Returns:        void
+   ******************************************************************************/
+  void Stop();
+
+  /******************************************************************************
+   * Function:       Flush()
+   *
+   * Description:    Drops every packet not read yet, as a power cycle of the
+   *                 virtual NFCC would. The read fd stays valid.
+   *
+   * Returns:        void
+   ******************************************************************************/
+  void Flush();
+
+  /******************************************************************************
+   * Function:       Write()
+   *
+   * Description:    Takes an NCI packet written by the host and schedules
+   *                 the answers to it.
+   *
+   * Returns:        void
+   ******************************************************************************/
+  void Write(const uint8_t* p_data, uint16_t data_len);
+
+  /******************************************************************************
+   * Function:       Read()
+   *
+   * Description:    Takes the oldest packet ready to be read, without
+   *                 blocking.
+   *
+   * Returns:        length of the packet, 0 if none is ready, -1 if
+   *                 max_len is too small.
+   ******************************************************************************/
+  int Read(uint8_t* p_buff, uint16_t max_len);
+
+  /******************************************************************************
+   * Function:       Inject()
+   *
+   * Description:    Sends a packet to the host after delayUs.
+   *
+   * Returns:        void
+   ******************************************************************************/
+  void Inject(const std::vector<uint8_t>& packet, uint32_t delayUs);
+
+  /******************************************************************************
+   * Function:       AddRule()
+   *
+   * Description:    Answers commands starting with cmdPrefix with rsp, then
+   *                 with ntfs, each after its own delay from the response.
+   *                 The last rule added for a prefix wins.
+   *
+   * Returns:        void
+   ******************************************************************************/
+  void AddRule(const std::vector<uint8_t>& cmdPrefix,
+               const std::vector<uint8_t>& rsp,
+               const std::vector<std::pair<uint32_t, std::vector<uint8_t>>>&
+                   ntfs = {});
+
+  /******************************************************************************
+   * Function:       LoadScript()
+   *
+   * Description:    Adds the rules and settings of a script file.
+   *
+   * Returns:        bool: false if the file cannot be read or a line is
+   *                 invalid, lines before it are applied.
+   ******************************************************************************/
+  bool LoadScript(const char* path);
+
+  /* Resets rules, parameters and latencies to their defaults */
+  void ClearRules();
+  void SetLatency(uint32_t rspUs, uint32_t ntfUs);
+
+  /* Number of packets written by the host since the last ClearRules() */
+  uint32_t GetWriteCount();
+
+ private:
+  typedef struct {
+    std::vector<uint8_t> rsp;
+    std::vector<std::pair<uint32_t, std::vector<uint8_t>>> ntfs;
+  } tRule;
+
+  NfccSimModel();
+  ~NfccSimModel();
+
+  void Run();
+  void Schedule(std::vector<uint8_t> packet, uint32_t delayUs);
+  void AnswerCmd(const uint8_t* p_cmd, uint16_t cmd_len);
+  std::vector<uint8_t> GetConfigRsp(const uint8_t* p_cmd, uint16_t cmd_len);
+  void SetConfig(const uint8_t* p_cmd, uint16_t cmd_len);
+  const tRule* FindRule(const uint8_t* p_cmd, uint16_t cmd_len) const;
+
+  std::mutex mLock;
+  std::condition_variable mCond;
+  std::thread mThread;
+  bool mRunning;
+  int mReadFd;
+  uint32_t mRspLatencyUs;
+  uint32_t mNtfLatencyUs;
+  uint32_t mWriteCount;
+  /* Packets ordered by due time, then packets ready to be read */
+  std::multimap<std::chrono::steady_clock::time_point, std::vector<uint8_t>>
+      mScheduled;
+  std::deque<std::vector<uint8_t>> mReady;
+  std::map<std::vector<uint8_t>, tRule> mRules;
+  std::vector<uint8_t> mResetNtf;
+  std::vector<uint8_t> mInitRsp;
+  /* CORE_SET_CONFIG parameters by tag, 0xA0xx/0xA1xx tags are two bytes */
+  std::map<uint16_t, std::vector<uint8_t>> mConfig;
+};
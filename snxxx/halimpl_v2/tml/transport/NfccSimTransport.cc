@@ -0,0 +1,203 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <NfccSimModel.h>
+#include <NfccSimTransport.h>
+#include <errno.h>
+#include <phNxpLog.h>
+#include <poll.h>
+#include <stdlib.h>
+
+/*******************************************************************************
+**
+** Function         Close
+**
+** Description      Powers the virtual NFCC off
+**
+** Parameters       pDevHandle - device handle
+**
+** Returns          None
+**
+*******************************************************************************/
+void NfccSimTransport::Close(void* pDevHandle) {
+  (void)pDevHandle;
+  NfccSimModel::getInstance().Stop();
+}
+
+/*******************************************************************************
+**
+** Function         OpenAndConfigure
+**
+** Description      Powers the virtual NFCC on and loads the script of
+**                  NXP_NFC_SIM_SCRIPT, if any
+**
+** Parameters       pConfig     - hardware information
+**                  pLinkHandle - device handle
+**
+** Returns          NFC status:
+**                  NFCSTATUS_SUCCESS - open_and_configure operation success
+**                  NFCSTATUS_INVALID_DEVICE - device open operation failure
+**
+*******************************************************************************/
+NFCSTATUS NfccSimTransport::OpenAndConfigure(pphTmlNfc_Config_t pConfig,
+                                             void** pLinkHandle) {
+  NfccSimModel& model = NfccSimModel::getInstance();
+  const char* script = getenv(NFCC_SIM_SCRIPT_ENV);
+  (void)pConfig;
+
+  if (script != NULL && script[0] != '\0' && !model.LoadScript(script)) {
+    NXPLOG_TML_E("%s Invalid NFCC sim script %s", __func__, script);
+  }
+  int nHandle = model.Start();
+  if (nHandle < 0) {
+    NXPLOG_TML_E("%s Virtual NFCC start failed", __func__);
+    *pLinkHandle = NULL;
+    return NFCSTATUS_INVALID_DEVICE;
+  }
+  NXPLOG_TML_D("%s Virtual NFCC started", __func__);
+  *pLinkHandle = (void*)((intptr_t)nHandle);
+  return NFCSTATUS_SUCCESS;
+}
+
+/*******************************************************************************
+**
+** Function         Read
+**
+** Description      Reads the next packet of the virtual NFCC, blocking until
+**                  one is ready or the read is aborted
+**
+** Parameters       pDevHandle       - valid device handle
+**                  pBuffer          - buffer for read data
+**                  nNbBytesToRead   - number of bytes requested to be read
+**
+** Returns          numRead   - number of successfully read bytes
+**                  -1        - read operation failure
+**
+*******************************************************************************/
+int NfccSimTransport::Read(void* pDevHandle, uint8_t* pBuffer,
+                           int nNbBytesToRead) {
+  struct pollfd fds[2];
+  nfds_t nfds = 1;
+
+  if (NULL == pDevHandle) {
+    return -1;
+  }
+  fds[0].fd = (int)(intptr_t)pDevHandle;
+  fds[0].events = POLLIN;
+  fds[0].revents = 0;
+  if (mReadAbortFd >= 0) {
+    fds[1].fd = mReadAbortFd;
+    fds[1].events = POLLIN;
+    fds[1].revents = 0;
+    nfds = 2;
+  }
+
+  for (;;) {
+    int ret_Poll = TEMP_FAILURE_RETRY(poll(fds, nfds, -1));
+    if (ret_Poll < 0) {
+      NXPLOG_TML_D("%s errno : %x", __func__, errno);
+      return -1;
+    } else if ((nfds == 2) && (fds[1].revents & POLLIN)) {
+      NXPLOG_TML_D("%s aborted", __func__);
+      return PH_TMLNFC_READ_ABORTED;
+    } else if (fds[0].revents & (POLLERR | POLLNVAL)) {
+      NXPLOG_TML_E("%s poll revents : %x", __func__, fds[0].revents);
+      return -1;
+    }
+    int numRead = NfccSimModel::getInstance().Read(
+        pBuffer, (uint16_t)((nNbBytesToRead > UINT16_MAX) ? UINT16_MAX
+                                                          : nNbBytesToRead));
+    /* 0 when the packet was dropped by a power off meanwhile */
+    if (numRead != 0) return numRead;
+  }
+}
+
+/*******************************************************************************
+**
+** Function         Write
+**
+** Description      Writes a packet to the virtual NFCC
+**
+** Parameters       pDevHandle       - valid device handle
+**                  pBuffer          - buffer for read data
+**                  nNbBytesToWrite  - number of bytes requested to be written
+**
+** Returns          numWrote   - number of successfully written bytes
+**                  -1         - write operation failure
+**
+*******************************************************************************/
+int NfccSimTransport::Write(void* pDevHandle, uint8_t* pBuffer,
+                            int nNbBytesToWrite) {
+  if (NULL == pDevHandle || nNbBytesToWrite > UINT16_MAX) {
+    return -1;
+  }
+  if (bFwDnldFlag) {
+    NXPLOG_TML_D("%s FW download frame not answered", __func__);
+    return nNbBytesToWrite;
+  }
+  NfccSimModel::getInstance().Write(pBuffer, (uint16_t)nNbBytesToWrite);
+  return nNbBytesToWrite;
+}
+
+/*******************************************************************************
+**
+** Function         NfccReset
+**
+** Description      Power off drops the packets not read yet, other modes are
+**                  accepted as is
+**
+** Parameters       pDevHandle     - valid device handle
+**                  eType          - reset level
+**
+** Returns           0   - reset operation success
+**
+*******************************************************************************/
+int NfccSimTransport::NfccReset(void* pDevHandle, NfccResetType eType) {
+  NXPLOG_TML_D("%s, VEN eType %u", __func__, eType);
+  if (NULL != pDevHandle && eType == MODE_POWER_OFF) {
+    NfccSimModel::getInstance().Flush();
+  }
+  if (eType == MODE_FW_DWNLD_WITH_VEN || eType == MODE_FW_DWND_HIGH) {
+    bFwDnldFlag = true;
+  } else if (eType == MODE_POWER_ON || eType == MODE_FW_GPIO_LOW) {
+    bFwDnldFlag = false;
+  }
+  return 0;
+}
+
+/*******************************************************************************
+**
+** Function         EnableFwDnldMode
+**
+** Description      updates the state to Download mode
+**
+** Parameters       True/False
+**
+** Returns          None
+*******************************************************************************/
+void NfccSimTransport::EnableFwDnldMode(bool mode) { bFwDnldFlag = mode; }
+
+/*******************************************************************************
+**
+** Function         IsFwDnldModeEnabled
+**
+** Description      Returns the current mode
+**
+** Parameters       none
+**
+** Returns          Current mode download/NCI
+*******************************************************************************/
+bool_t NfccSimTransport::IsFwDnldModeEnabled(void) { return bFwDnldFlag; }
@@ -0,0 +1,139 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+#include <NfccTransport.h>
+
+/* Selects the simulated transport whatever NXP_TRANSPORT is, when set */
+#define NFCC_SIM_TRANSPORT_ENV "NXP_NFC_SIM_TRANSPORT"
+/* Optional NfccSimModel script loaded when the transport is opened */
+#define NFCC_SIM_SCRIPT_ENV "NXP_NFC_SIM_SCRIPT"
+
+/*
+ * Transport to the virtual NFCC of NfccSimModel, for the HAL to run on a
+ * host without NFC hardware. The device handle is the model fd signalling
+ * packets to read, so the HAL event loop can poll it.
+ * FW download mode is not modelled: frames written in that mode are not
+ * answered.
+ */
+class NfccSimTransport : public NfccTransport {
+ private:
+  bool_t bFwDnldFlag = false;
+
+ public:
+  /*****************************************************************************
+  **
+  ** Function         Close
+  **
+  ** Description      Powers the virtual NFCC off
+  **
+  ** Parameters       pDevHandle - device handle
+  **
+  ** Returns          None
+  **
+  *****************************************************************************/
+  void Close(void* pDevHandle);
+
+  /*****************************************************************************
+   **
+   ** Function         OpenAndConfigure
+   **
+   ** Description      Powers the virtual NFCC on and loads the script of
+   **                  NXP_NFC_SIM_SCRIPT, if any
+   **
+   ** Parameters       pConfig     - hardware information
+   **                  pLinkHandle - device handle
+   **
+   ** Returns          NFC status:
+   **                  NFCSTATUS_SUCCESS - open_and_configure operation success
+   **                  NFCSTATUS_INVALID_DEVICE - device open operation failure
+   **
+   ****************************************************************************/
+  NFCSTATUS OpenAndConfigure(pphTmlNfc_Config_t pConfig, void** pLinkHandle);
+
+  /*****************************************************************************
+   **
+   ** Function         Read
+   **
+   ** Description      Reads the next packet of the virtual NFCC, blocking
+   **                  until one is ready or the read is aborted
+   **
+   ** Parameters       pDevHandle       - valid device handle
+   **                  pBuffer          - buffer for read data
+   **                  nNbBytesToRead   - number of bytes requested to be read
+   **
+   ** Returns          numRead   - number of successfully read bytes
+   **                  -1        - read operation failure
+   **
+   ****************************************************************************/
+  int Read(void* pDevHandle, uint8_t* pBuffer, int nNbBytesToRead);
+
+  /*****************************************************************************
+   **
+   ** Function         Write
+   **
+   ** Description      Writes a packet to the virtual NFCC
+   **
+   ** Parameters       pDevHandle       - valid device handle
+   **                  pBuffer          - buffer for read data
+   **                  nNbBytesToWrite  - number of bytes requested to be
+   **                                     written
+   **
+   ** Returns          numWrote   - number of successfully written bytes
+   **                  -1         - write operation failure
+   **
+   ****************************************************************************/
+  int Write(void* pDevHandle, uint8_t* pBuffer, int nNbBytesToWrite);
+
+  /*****************************************************************************
+   **
+   ** Function         NfccReset
+   **
+   ** Description      Power off drops the packets not read yet, other modes
+   **                  are accepted as is
+   **
+   ** Parameters       pDevHandle     - valid device handle
+   **                  eType          - reset level
+   **
+   ** Returns           0   - reset operation success
+   **
+   ****************************************************************************/
+  int NfccReset(void* pDevHandle, NfccResetType eType);
+
+  /*****************************************************************************
+   **
+   ** Function         EnableFwDnldMode
+   **
+   ** Description      updates the state to Download mode
+   **
+   ** Parameters       True/False
+   **
+   ** Returns          None
+   ****************************************************************************/
+  void EnableFwDnldMode(bool mode);
+
+  /*****************************************************************************
+   **
+   ** Function         IsFwDnldModeEnabled
+   **
+   ** Description      Returns the current mode
+   **
+   ** Parameters       none
+   **
+   ** Returns          Current mode download/NCI
+   ****************************************************************************/
+  bool_t IsFwDnldModeEnabled(void);
+};
@@ -238,6 +238,34 @@ class NfccTransport {
   *******************************************************************************/
   virtual bool Flushdata(pphTmlNfc_Config_t pConfig);
 
+  /*****************************************************************************
+   **
+   ** Function         SetReadAbortFd
+   **
+   ** Description      Registers the TML control eventfd. A blocking Read
+   **                  returns PH_TMLNFC_READ_ABORTED as soon as it becomes
+   **                  readable.
+   **
+   ** Parameters       fd - eventfd to watch, -1 to detach
+   **
+   ** Returns          None
+   ****************************************************************************/
+  void SetReadAbortFd(int fd) { mReadAbortFd = fd; }
+
+  /*****************************************************************************
+   **
+   ** Function         GetPollFd
+   **
+   ** Description      Gets the fd which becomes readable when a Read would not
+   **                  block, for the HAL event loop. The device handle is
+   **                  the device fd by default.
+   **
+   ** Parameters       pDevHandle - valid device handle
+   **
+   ** Returns          fd to poll, -1 if the transport cannot be polled
+   ****************************************************************************/
+  virtual int GetPollFd(void* pDevHandle) { return (int)(intptr_t)pDevHandle; }
+
   /*****************************************************************************
    **
    ** Function         ~NfccTransport
@@ -249,4 +277,7 @@ class NfccTransport {
    ** Returns          None
    ****************************************************************************/
   virtual ~NfccTransport() {};
+
+ protected:
+  int mReadAbortFd = -1;
 };
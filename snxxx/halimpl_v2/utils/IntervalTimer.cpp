@@ -44,10 +44,11 @@
 
 using android::base::StringPrintf;
 
-IntervalTimer::IntervalTimer() : mTimerId(0), mCb(nullptr) {}
+IntervalTimer::IntervalTimer()
+    : mEntry(), mCreated(false), mPtr(nullptr), mCb(nullptr) {}
 
 bool IntervalTimer::set(int ms, void* ptr, TIMER_FUNC cb) {
-  if (mTimerId == 0) {
+  if (!mCreated) {
     if (cb == NULL) return false;
 
     if (!create(ptr, cb)) return false;
@@ -57,45 +58,38 @@ bool IntervalTimer::set(int ms, void* ptr, TIMER_FUNC cb) {
     if (!create(ptr, cb)) return false;
   }
 
-  int stat = 0;
-  struct itimerspec ts;
-  ts.it_value.tv_sec = ms / 1000;
-  ts.it_value.tv_nsec = (ms % 1000) * 1000000;
-
-  ts.it_interval.tv_sec = 0;
-  ts.it_interval.tv_nsec = 0;
-
-  stat = timer_settime(mTimerId, 0, &ts, 0);
-  if (stat == -1) LOG(ERROR) << StringPrintf("fail set timer");
-  return stat == 0;
+  union sigval value;
+  value.sival_ptr = mPtr;
+  /*
+   * Callbacks may block (e.g. waiting for an NCI response), so they are run
+   * on a timer wheel callback thread rather than on the wheel thread. One is
+   * started when none is idle: a blocked callback holds back no other timer.
+   */
+  bool stat = NfcHalTimerWheel::getInstance().schedule(
+      &mEntry, ms < 0 ? 0 : (uint32_t)ms, mCb, value, false);
+  if (!stat) LOG(ERROR) << StringPrintf("fail set timer");
+  return stat;
 }
 
 IntervalTimer::~IntervalTimer() { kill(); }
 
 void IntervalTimer::kill() {
-  if (mTimerId == 0) return;
+  if (!mCreated) return;
 
-  timer_delete(mTimerId);
-  mTimerId = 0;
+  /* Does not wait for a running callback, which may be the caller itself */
+  NfcHalTimerWheel::getInstance().cancel(&mEntry);
+  mCreated = false;
+  mPtr = nullptr;
   mCb = NULL;
 }
 
 bool IntervalTimer::create(void* ptr, TIMER_FUNC cb) {
-  struct sigevent se;
-  int stat = 0;
-
-  /*
-   * Set the sigevent structure to cause the signal to be
-   * delivered by creating a new thread.
-   */
-  se.sigev_notify = SIGEV_THREAD;
-  // se.sigev_value.sival_ptr = &mTimerId;
-  se.sigev_value.sival_ptr = ptr;
-  se.sigev_notify_function = cb;
-  se.sigev_notify_attributes = NULL;
-  se.sigev_signo = 0;
+  if (cb == NULL) {
+    LOG(ERROR) << StringPrintf("fail create timer");
+    return false;
+  }
+  mPtr = ptr;
   mCb = cb;
-  stat = timer_create(CLOCK_MONOTONIC, &se, &mTimerId);
-  if (stat == -1) LOG(ERROR) << StringPrintf("fail create timer");
-  return stat == 0;
+  mCreated = true;
+  return true;
 }
@@ -39,6 +39,7 @@
  *  Asynchronous interval timer.
  */
 
+#include <NxpNfcTimerWheel.h>
 #include <time.h>
 
 class IntervalTimer {
@@ -51,7 +52,9 @@ class IntervalTimer {
   bool create(void* ptr, TIMER_FUNC);
 
  private:
-  timer_t mTimerId;
+  NfcHalTimerEntry_t mEntry;
+  bool mCreated;
+  void* mPtr;
   TIMER_FUNC mCb;
 };
 #endif  // __INTERVALTIMER_H__
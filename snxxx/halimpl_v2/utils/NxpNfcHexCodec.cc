@@ -0,0 +1,321 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "NxpNfcHexCodec.h"
+
+#include <string.h>
+
+#include <atomic>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#define HEX_CODEC_NEON
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HEX_CODEC_X86
+#endif
+
+namespace {
+
+static const char kHexDigits[] = "0123456789ABCDEF";
+
+/* Both digits of every byte, and the value of every digit (0xFF: invalid) */
+struct HexTables {
+  char encode[256][2];
+  uint8_t decode[256];
+
+  constexpr HexTables() : encode(), decode() {
+    for (int i = 0; i < 256; i++) {
+      encode[i][0] = kHexDigits[i >> 4];
+      encode[i][1] = kHexDigits[i & 0x0F];
+      decode[i] = (i >= '0' && i <= '9')   ? (uint8_t)(i - '0')
+                  : (i >= 'A' && i <= 'F') ? (uint8_t)(i - 'A' + 10)
+                  : (i >= 'a' && i <= 'f') ? (uint8_t)(i - 'a' + 10)
+                                           : 0xFF;
+    }
+  }
+};
+
+constexpr HexTables kTables;
+
+void encodeScalar(const uint8_t* p_data, size_t len, char* p_hex) {
+  for (size_t i = 0; i < len; i++) {
+    memcpy(&p_hex[2 * i], kTables.encode[p_data[i]], 2);
+  }
+}
+
+size_t decodeScalar(const char* p_hex, size_t len, uint8_t* p_data) {
+  size_t i;
+  for (i = 0; i < len / 2; i++) {
+    uint8_t hi = kTables.decode[(uint8_t)p_hex[2 * i]];
+    uint8_t lo = kTables.decode[(uint8_t)p_hex[2 * i + 1]];
+    if ((hi | lo) & 0xF0) break;
+    p_data[i] = (uint8_t)((hi << 4) | lo);
+  }
+  return i;
+}
+
+#if defined(HEX_CODEC_NEON)
+
+void encodeNeon(const uint8_t* p_data, size_t len, char* p_hex) {
+  const uint8x16_t lut = vld1q_u8((const uint8_t*)kHexDigits);
+  const uint8x16_t mask = vdupq_n_u8(0x0F);
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    uint8x16_t v = vld1q_u8(&p_data[i]);
+    uint8x16x2_t digits;
+    digits.val[0] = vqtbl1q_u8(lut, vshrq_n_u8(v, 4));
+    digits.val[1] = vqtbl1q_u8(lut, vandq_u8(v, mask));
+    vst2q_u8((uint8_t*)&p_hex[2 * i], digits);
+  }
+  encodeScalar(&p_data[i], len - i, &p_hex[2 * i]);
+}
+
+/* Digit values, valid is 0xFF for each hex digit */
+inline uint8x16_t neonDigits(uint8x16_t c, uint8x16_t& valid) {
+  uint8x16_t d = vsubq_u8(c, vdupq_n_u8('0'));
+  uint8x16_t l = vsubq_u8(vorrq_u8(c, vdupq_n_u8(0x20)), vdupq_n_u8('a'));
+  uint8x16_t isDigit = vcleq_u8(d, vdupq_n_u8(9));
+  uint8x16_t isLetter = vcleq_u8(l, vdupq_n_u8(5));
+  valid = vorrq_u8(isDigit, isLetter);
+  return vbslq_u8(isDigit, d, vaddq_u8(l, vdupq_n_u8(10)));
+}
+
+size_t decodeNeon(const char* p_hex, size_t len, uint8_t* p_data) {
+  size_t i = 0;
+  for (; i + 16 <= len / 2; i += 16) {
+    uint8x16x2_t c = vld2q_u8((const uint8_t*)&p_hex[2 * i]);
+    uint8x16_t validHi, validLo;
+    uint8x16_t hi = neonDigits(c.val[0], validHi);
+    uint8x16_t lo = neonDigits(c.val[1], validLo);
+    if (vminvq_u8(vandq_u8(validHi, validLo)) != 0xFF) break;
+    vst1q_u8(&p_data[i], vorrq_u8(vshlq_n_u8(hi, 4), lo));
+  }
+  return i + decodeScalar(&p_hex[2 * i], len - 2 * i, &p_data[i]);
+}
+
+#elif defined(HEX_CODEC_X86)
+
+__attribute__((target("ssse3"))) void encodeSsse3(const uint8_t* p_data,
+                                                  size_t len, char* p_hex) {
+  const __m128i lut = _mm_loadu_si128((const __m128i*)kHexDigits);
+  const __m128i mask = _mm_set1_epi8(0x0F);
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i*)&p_data[i]);
+    __m128i hi =
+        _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(v, 4), mask));
+    __m128i lo = _mm_shuffle_epi8(lut, _mm_and_si128(v, mask));
+    _mm_storeu_si128((__m128i*)&p_hex[2 * i], _mm_unpacklo_epi8(hi, lo));
+    _mm_storeu_si128((__m128i*)&p_hex[2 * i + 16],
+                     _mm_unpackhi_epi8(hi, lo));
+  }
+  encodeScalar(&p_data[i], len - i, &p_hex[2 * i]);
+}
+
+/* Digit values, valid is 0xFF for each hex digit */
+__attribute__((target("ssse3"))) inline __m128i sseDigits(__m128i c,
+                                                          __m128i& valid) {
+  __m128i d = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+  __m128i l = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)),
+                           _mm_set1_epi8('a'));
+  __m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(9)), d);
+  __m128i isLetter = _mm_cmpeq_epi8(_mm_min_epu8(l, _mm_set1_epi8(5)), l);
+  valid = _mm_or_si128(isDigit, isLetter);
+  return _mm_or_si128(
+      _mm_and_si128(isDigit, d),
+      _mm_and_si128(isLetter, _mm_add_epi8(l, _mm_set1_epi8(10))));
+}
+
+__attribute__((target("ssse3"))) size_t decodeSsse3(const char* p_hex,
+                                                    size_t len,
+                                                    uint8_t* p_data) {
+  /* hi * 16 + lo for each pair of digits */
+  const __m128i weights = _mm_set1_epi16(0x0110);
+  size_t i = 0;
+  for (; i + 16 <= len / 2; i += 16) {
+    __m128i valid0, valid1;
+    __m128i v0 = sseDigits(
+        _mm_loadu_si128((const __m128i*)&p_hex[2 * i]), valid0);
+    __m128i v1 = sseDigits(
+        _mm_loadu_si128((const __m128i*)&p_hex[2 * i + 16]), valid1);
+    if (_mm_movemask_epi8(_mm_and_si128(valid0, valid1)) != 0xFFFF) break;
+    __m128i w0 = _mm_maddubs_epi16(v0, weights);
+    __m128i w1 = _mm_maddubs_epi16(v1, weights);
+    _mm_storeu_si128((__m128i*)&p_data[i], _mm_packus_epi16(w0, w1));
+  }
+  return i + decodeScalar(&p_hex[2 * i], len - 2 * i, &p_data[i]);
+}
+
+__attribute__((target("avx2"))) void encodeAvx2(const uint8_t* p_data,
+                                                size_t len, char* p_hex) {
+  const __m256i lut = _mm256_broadcastsi128_si256(
+      _mm_loadu_si128((const __m128i*)kHexDigits));
+  const __m256i mask = _mm256_set1_epi8(0x0F);
+  size_t i = 0;
+  for (; i + 32 <= len; i += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i*)&p_data[i]);
+    __m256i hi = _mm256_shuffle_epi8(
+        lut, _mm256_and_si256(_mm256_srli_epi16(v, 4), mask));
+    __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(v, mask));
+    /* Interleaving works per 128 bit lane: bytes 0-7 | 16-23, 8-15 | 24-31 */
+    __m256i a = _mm256_unpacklo_epi8(hi, lo);
+    __m256i b = _mm256_unpackhi_epi8(hi, lo);
+    _mm256_storeu_si256((__m256i*)&p_hex[2 * i],
+                        _mm256_permute2x128_si256(a, b, 0x20));
+    _mm256_storeu_si256((__m256i*)&p_hex[2 * i + 32],
+                        _mm256_permute2x128_si256(a, b, 0x31));
+  }
+  encodeSsse3(&p_data[i], len - i, &p_hex[2 * i]);
+}
+
+__attribute__((target("avx2"))) inline __m256i avxDigits(__m256i c,
+                                                         __m256i& valid) {
+  __m256i d = _mm256_sub_epi8(c, _mm256_set1_epi8('0'));
+  __m256i l = _mm256_sub_epi8(_mm256_or_si256(c, _mm256_set1_epi8(0x20)),
+                              _mm256_set1_epi8('a'));
+  __m256i isDigit =
+      _mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(9)), d);
+  __m256i isLetter =
+      _mm256_cmpeq_epi8(_mm256_min_epu8(l, _mm256_set1_epi8(5)), l);
+  valid = _mm256_or_si256(isDigit, isLetter);
+  return _mm256_or_si256(
+      _mm256_and_si256(isDigit, d),
+      _mm256_and_si256(isLetter, _mm256_add_epi8(l, _mm256_set1_epi8(10))));
+}
+
+__attribute__((target("avx2"))) size_t decodeAvx2(const char* p_hex,
+                                                  size_t len, uint8_t* p_data) {
+  const __m256i weights = _mm256_set1_epi16(0x0110);
+  size_t i = 0;
+  for (; i + 32 <= len / 2; i += 32) {
+    __m256i valid0, valid1;
+    __m256i v0 = avxDigits(
+        _mm256_loadu_si256((const __m256i*)&p_hex[2 * i]), valid0);
+    __m256i v1 = avxDigits(
+        _mm256_loadu_si256((const __m256i*)&p_hex[2 * i + 32]), valid1);
+    if (_mm256_movemask_epi8(_mm256_and_si256(valid0, valid1)) != -1) break;
+    /* Packing works per 128 bit lane too */
+    __m256i packed = _mm256_packus_epi16(_mm256_maddubs_epi16(v0, weights),
+                                         _mm256_maddubs_epi16(v1, weights));
+    _mm256_storeu_si256((__m256i*)&p_data[i],
+                        _mm256_permute4x64_epi64(packed, 0xD8));
+  }
+  return i + decodeSsse3(&p_hex[2 * i], len - 2 * i, &p_data[i]);
+}
+
+#endif
+
+struct HexKernelOps {
+  tNFC_hexKernel kernel;
+  void (*encode)(const uint8_t*, size_t, char*);
+  size_t (*decode)(const char*, size_t, uint8_t*);
+};
+
+const HexKernelOps kScalarOps = {HEX_KERNEL_SCALAR, encodeScalar,
+                                 decodeScalar};
+#if defined(HEX_CODEC_NEON)
+const HexKernelOps kNeonOps = {HEX_KERNEL_NEON, encodeNeon, decodeNeon};
+#elif defined(HEX_CODEC_X86)
+const HexKernelOps kSsse3Ops = {HEX_KERNEL_SSSE3, encodeSsse3, decodeSsse3};
+const HexKernelOps kAvx2Ops = {HEX_KERNEL_AVX2, encodeAvx2, decodeAvx2};
+#endif
+
+const HexKernelOps* supportedOps(tNFC_hexKernel kernel) {
+  switch (kernel) {
+    case HEX_KERNEL_SCALAR:
+      return &kScalarOps;
+#if defined(HEX_CODEC_NEON)
+    case HEX_KERNEL_NEON:
+      /* Mandatory on arm64 */
+      return &kNeonOps;
+#elif defined(HEX_CODEC_X86)
+    case HEX_KERNEL_SSSE3:
+      return __builtin_cpu_supports("ssse3") ? &kSsse3Ops : nullptr;
+    case HEX_KERNEL_AVX2:
+      /* Its tails are handled by the SSSE3 kernel */
+      return (__builtin_cpu_supports("avx2") &&
+              __builtin_cpu_supports("ssse3"))
+                 ? &kAvx2Ops
+                 : nullptr;
+#endif
+    default:
+      return nullptr;
+  }
+}
+
+const HexKernelOps* selectOps() {
+  static const tNFC_hexKernel kPreferred[] = {HEX_KERNEL_NEON, HEX_KERNEL_AVX2,
+                                              HEX_KERNEL_SSSE3};
+  for (tNFC_hexKernel kernel : kPreferred) {
+    const HexKernelOps* pOps = supportedOps(kernel);
+    if (pOps != nullptr) return pOps;
+  }
+  return &kScalarOps;
+}
+
+std::atomic<const HexKernelOps*> sOps{nullptr};
+
+inline const HexKernelOps* ops() {
+  const HexKernelOps* pOps = sOps.load(std::memory_order_relaxed);
+  if (pOps == nullptr) {
+    /* Racing threads select the same kernel */
+    pOps = selectOps();
+    sOps.store(pOps, std::memory_order_relaxed);
+  }
+  return pOps;
+}
+
+}  // namespace
+
+/*******************************************************************************
+**
+** Function         phNxpNciHal_hexEncode
+**
+** Description      Converts len bytes to upper case hex digits
+**
+** Returns          None
+**
+*******************************************************************************/
+void phNxpNciHal_hexEncode(const uint8_t* p_data, size_t len, char* p_hex) {
+  if (p_hex == NULL) return;
+  if (p_data != NULL && len > 0) ops()->encode(p_data, len, p_hex);
+  p_hex[(p_data != NULL) ? 2 * len : 0] = '\0';
+}
+
+/*******************************************************************************
+**
+** Function         phNxpNciHal_hexDecode
+**
+** Description      Converts pairs of hex digits to bytes, up to the first
+**                  invalid digit
+**
+** Returns          number of bytes written to p_data
+**
+*******************************************************************************/
+size_t phNxpNciHal_hexDecode(const char* p_hex, size_t len, uint8_t* p_data) {
+  if (p_hex == NULL || p_data == NULL) return 0;
+  return ops()->decode(p_hex, len, p_data);
+}
+
+tNFC_hexKernel phNxpNciHal_hexKernel(void) { return ops()->kernel; }
+
+bool phNxpNciHal_hexSetKernel(tNFC_hexKernel kernel) {
+  const HexKernelOps* pOps = supportedOps(kernel);
+  if (pOps == nullptr) return false;
+  sOps.store(pOps, std::memory_order_relaxed);
+  return true;
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Hex codec shared by the packet logs, the config and the event logger.
+ * Upper case digits, no separator. The SIMD kernel is selected at first use
+ * from the CPU features: NEON on arm64, AVX2 or SSSE3 on x86.
+ */
+typedef enum {
+  HEX_KERNEL_SCALAR = 0,
+  HEX_KERNEL_SSSE3,
+  HEX_KERNEL_AVX2,
+  HEX_KERNEL_NEON,
+} tNFC_hexKernel;
+
+/* Writes 2 * len digits and a terminating null to p_hex */
+void phNxpNciHal_hexEncode(const uint8_t* p_data, size_t len, char* p_hex);
+
+/*
+ * Converts len / 2 digit pairs (either case) from p_hex to p_data, stopping
+ * at the first pair which is not valid hex.
+ * Returns the number of bytes written.
+ */
+size_t phNxpNciHal_hexDecode(const char* p_hex, size_t len, uint8_t* p_data);
+
+tNFC_hexKernel phNxpNciHal_hexKernel(void);
+/* Forces a kernel, for benchmarks. false if the CPU does not support it */
+bool phNxpNciHal_hexSetKernel(tNFC_hexKernel kernel);
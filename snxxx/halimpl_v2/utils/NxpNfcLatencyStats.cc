@@ -0,0 +1,339 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "NxpNfcLatencyStats.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <new>
+
+#define NS_PER_SEC (1000000000ULL)
+#define NS_PER_USEC (1000ULL)
+
+/* Stamps of the packet handled by the thread, 0 when not taken */
+typedef struct {
+  int cls;
+  uint64_t readNs;
+  uint64_t postNs;
+  uint64_t dequeueNs;
+  uint64_t completeNs;
+  uint64_t deliveredNs;
+} tRxStamps;
+
+typedef struct {
+  uint64_t beginNs;
+  uint64_t windowNs;
+} tTxStamps;
+
+static thread_local uint64_t sDequeueNs = 0;
+static thread_local tRxStamps sRx = {-1, 0, 0, 0, 0, 0};
+static thread_local tTxStamps sTx = {0, 0};
+
+NfcHalLatencyStats::NfcHalLatencyStats() : mCmdWrittenNs(0) {
+  for (auto& cls : mClasses) {
+    cls.store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+NfcHalLatencyStats& NfcHalLatencyStats::getInstance() {
+  /* Never destroyed: packets may still be recorded while exiting */
+  static NfcHalLatencyStats* sInstance = new NfcHalLatencyStats();
+  return *sInstance;
+}
+
+uint64_t NfcHalLatencyStats::nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * NS_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+/******************************************************************************
+ * Function:       classOf()
+ *
+ * Description:    Index of the message class of an NCI packet: message type
+ *                 and GID, DATA packets all in one class.
+ *
+ * Returns:        class index, -1 if the packet is not an NCI packet.
+ ******************************************************************************/
+int NfcHalLatencyStats::classOf(const uint8_t* pPkt, uint16_t len) {
+  if (pPkt == nullptr || len < 3) return -1;
+  uint8_t mt = (pPkt[0] >> 5) & 0x07;
+  if (mt >= MT_COUNT) return -1;
+  return (mt == MT_DATA) ? 0 : (int)(mt * 16 + (pPkt[0] & 0x0F));
+}
+
+NfcHalLatencyStats::ClassStats* NfcHalLatencyStats::classStats(int cls) {
+  ClassStats* pStats = mClasses[cls].load(std::memory_order_acquire);
+  if (pStats != nullptr) return pStats;
+
+  ClassStats* pNew = new (std::nothrow) ClassStats();
+  if (pNew == nullptr) return nullptr;
+  if (!mClasses[cls].compare_exchange_strong(pStats, pNew,
+                                             std::memory_order_acq_rel)) {
+    /* Allocated by another thread meanwhile */
+    delete pNew;
+    return pStats;
+  }
+  return pNew;
+}
+
+uint32_t NfcHalLatencyStats::bucketOf(uint64_t us) {
+  if (us < kSubBuckets) return (uint32_t)us;
+  uint32_t shift = 63 - __builtin_clzll(us) - kSubBucketBits;
+  if (shift >= kMaxShift) return kBuckets - 1;
+  return (shift + 1) * kSubBuckets +
+         (uint32_t)((us >> shift) & (kSubBuckets - 1));
+}
+
+uint64_t NfcHalLatencyStats::bucketUpperUs(uint32_t bucket) {
+  if (bucket < kSubBuckets) return bucket;
+  uint32_t shift = bucket / kSubBuckets - 1;
+  uint64_t lower = (uint64_t)(kSubBuckets + bucket % kSubBuckets) << shift;
+  return lower + (1ULL << shift) - 1;
+}
+
+uint64_t NfcHalLatencyStats::percentileUs(const Histogram& hist,
+                                          uint32_t permille) {
+  if (hist.qwCount == 0) return 0;
+  uint64_t rank = (hist.qwCount * permille + 999) / 1000;
+  uint64_t seen = 0;
+  for (uint32_t i = 0; i < kBuckets; i++) {
+    seen += hist.aBuckets[i];
+    if (seen >= rank && seen != 0) {
+      /* The last bucket has no upper bound */
+      return (i == kBuckets - 1) ? hist.qwMaxUs
+                                 : std::min(bucketUpperUs(i), hist.qwMaxUs);
+    }
+  }
+  return hist.qwMaxUs;
+}
+
+void NfcHalLatencyStats::record(int cls, Stage stage, uint64_t fromNs,
+                                uint64_t toNs) {
+  if (cls < 0 || fromNs == 0 || toNs < fromNs) return;
+  ClassStats* pStats = classStats(cls);
+  if (pStats == nullptr) return;
+
+  AtomicHistogram& hist = pStats->aStages[stage];
+  uint64_t us = (toNs - fromNs) / NS_PER_USEC;
+  hist.aBuckets[bucketOf(us)].fetch_add(1, std::memory_order_relaxed);
+  hist.qwSumUs.fetch_add(us, std::memory_order_relaxed);
+  uint64_t max = hist.qwMaxUs.load(std::memory_order_relaxed);
+  while (us > max && !hist.qwMaxUs.compare_exchange_weak(
+                         max, us, std::memory_order_relaxed)) {
+  }
+  hist.qwCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+/******************************************************************************
+ * Function:       markDequeue()
+ *
+ * Description:    Stamps the dequeue of a deferred call by the HAL reader
+ *                 thread, taken by rxBegin() if the call completes a read.
+ *
+ * Returns:        void
+ ******************************************************************************/
+void NfcHalLatencyStats::markDequeue() { sDequeueNs = nowNs(); }
+
+/******************************************************************************
+ * Function:       rxBegin()
+ *
+ * Description:    Starts the RX stamps of a packet about to be handed to the
+ *                 read completion. Records the stages up to the dequeue.
+ *
+ * Returns:        void
+ ******************************************************************************/
+void NfcHalLatencyStats::rxBegin(const uint8_t* pPkt, uint16_t len,
+                                 uint64_t readNs, uint64_t postNs) {
+  uint64_t now = nowNs();
+  sRx.cls = classOf(pPkt, len);
+  sRx.readNs = readNs;
+  sRx.postNs = postNs;
+  sRx.dequeueNs = (sDequeueNs != 0) ? sDequeueNs : now;
+  sRx.completeNs = 0;
+  sRx.deliveredNs = 0;
+  sDequeueNs = 0;
+  if (sRx.cls < 0) return;
+
+  if ((sRx.cls / 16) == MT_RSP) {
+    uint64_t cmdNs = mCmdWrittenNs.exchange(0, std::memory_order_relaxed);
+    record(sRx.cls, RX_NFCC, cmdNs, readNs);
+  }
+  record(sRx.cls, RX_TML, readNs, postNs);
+  record(sRx.cls, RX_QUEUE, postNs, sRx.dequeueNs);
+}
+
+void NfcHalLatencyStats::rxComplete() {
+  if (sRx.cls >= 0 && sRx.completeNs == 0) sRx.completeNs = nowNs();
+}
+
+void NfcHalLatencyStats::rxDelivered() {
+  if (sRx.cls >= 0 && sRx.completeNs != 0 && sRx.deliveredNs == 0) {
+    sRx.deliveredNs = nowNs();
+  }
+}
+
+/******************************************************************************
+ * Function:       rxEnd()
+ *
+ * Description:    Ends the RX stamps once the read completion returned and
+ *                 records the remaining stages.
+ *
+ * Returns:        void
+ ******************************************************************************/
+void NfcHalLatencyStats::rxEnd() {
+  if (sRx.cls >= 0 && sRx.completeNs != 0) {
+    uint64_t endNs = (sRx.deliveredNs != 0) ? sRx.deliveredNs : nowNs();
+    record(sRx.cls, RX_LOCK, sRx.dequeueNs, sRx.completeNs);
+    record(sRx.cls, RX_HAL, sRx.completeNs, endNs);
+    record(sRx.cls, RX_TOTAL, sRx.readNs, endNs);
+  }
+  sRx.cls = -1;
+}
+
+void NfcHalLatencyStats::txBegin() {
+  sTx.beginNs = nowNs();
+  sTx.windowNs = 0;
+}
+
+void NfcHalLatencyStats::txWindow() {
+  if (sTx.beginNs != 0 && sTx.windowNs == 0) sTx.windowNs = nowNs();
+}
+
+/******************************************************************************
+ * Function:       txWritten()
+ *
+ * Description:    Stamps the completion of phTmlNfc_Write for the packet
+ *                 written and records its TX stages. Writes not started by
+ *                 NfcWriter::write, e.g. HAL internal commands, only update
+ *                 the RX_NFCC start.
+ *
+ * Returns:        void
+ ******************************************************************************/
+void NfcHalLatencyStats::txWritten(const uint8_t* pPkt, uint16_t len) {
+  uint64_t now = nowNs();
+  int cls = classOf(pPkt, len);
+  if (cls < 0) return;
+
+  if ((cls / 16) == MT_CMD) {
+    mCmdWrittenNs.store(now, std::memory_order_relaxed);
+  }
+  if (sTx.beginNs != 0 && sTx.windowNs != 0) {
+    record(cls, TX_WINDOW, sTx.beginNs, sTx.windowNs);
+    record(cls, TX_WRITE, sTx.windowNs, now);
+    record(cls, TX_TOTAL, sTx.beginNs, now);
+  }
+  /* Further writes of the same call are not from the caller */
+  sTx.beginNs = 0;
+  sTx.windowNs = 0;
+}
+
+void NfcHalLatencyStats::txEnd() {
+  sTx.beginNs = 0;
+  sTx.windowNs = 0;
+}
+
+bool NfcHalLatencyStats::getHistogram(MsgType mt, uint8_t gid, Stage stage,
+                                      Histogram& hist) {
+  memset(&hist, 0, sizeof(hist));
+  if (mt >= MT_COUNT || stage >= STAGE_COUNT) return false;
+  int cls = (mt == MT_DATA) ? 0 : (int)(mt * 16 + (gid & 0x0F));
+  ClassStats* pStats = mClasses[cls].load(std::memory_order_acquire);
+  if (pStats == nullptr) return false;
+
+  AtomicHistogram& src = pStats->aStages[stage];
+  /* Count read first: buckets are at least as recent */
+  hist.qwCount = src.qwCount.load(std::memory_order_relaxed);
+  hist.qwSumUs = src.qwSumUs.load(std::memory_order_relaxed);
+  hist.qwMaxUs = src.qwMaxUs.load(std::memory_order_relaxed);
+  for (uint32_t i = 0; i < kBuckets; i++) {
+    hist.aBuckets[i] = src.aBuckets[i].load(std::memory_order_relaxed);
+  }
+  return true;
+}
+
+void NfcHalLatencyStats::reset() {
+  for (auto& cls : mClasses) {
+    ClassStats* pStats = cls.load(std::memory_order_acquire);
+    if (pStats == nullptr) continue;
+    for (AtomicHistogram& hist : pStats->aStages) {
+      hist.qwCount.store(0, std::memory_order_relaxed);
+      hist.qwSumUs.store(0, std::memory_order_relaxed);
+      hist.qwMaxUs.store(0, std::memory_order_relaxed);
+      for (auto& bucket : hist.aBuckets) {
+        bucket.store(0, std::memory_order_relaxed);
+      }
+    }
+  }
+}
+
+const char* NfcHalLatencyStats::stageName(Stage stage) {
+  switch (stage) {
+    case RX_NFCC:
+      return "RX_NFCC";
+    case RX_TML:
+      return "RX_TML";
+    case RX_QUEUE:
+      return "RX_QUEUE";
+    case RX_LOCK:
+      return "RX_LOCK";
+    case RX_HAL:
+      return "RX_HAL";
+    case RX_TOTAL:
+      return "RX_TOTAL";
+    case TX_WINDOW:
+      return "TX_WINDOW";
+    case TX_WRITE:
+      return "TX_WRITE";
+    case TX_TOTAL:
+      return "TX_TOTAL";
+    default:
+      return "UNKNOWN";
+  }
+}
+
+void NfcHalLatencyStats::dump(int fd) {
+  static const char* const kMtNames[MT_COUNT] = {"DATA", "CMD", "RSP", "NTF"};
+  Histogram hist;
+
+  dprintf(fd, "Packet latency (us): count mean p50 p90 p99 max\n");
+  for (uint32_t cls = 0; cls < kClasses; cls++) {
+    MsgType mt = (MsgType)(cls / 16);
+    uint8_t gid = cls % 16;
+    if (mt == MT_DATA && gid != 0) continue;
+    for (uint8_t stage = 0; stage < STAGE_COUNT; stage++) {
+      if (!getHistogram(mt, gid, (Stage)stage, hist) || hist.qwCount == 0) {
+        continue;
+      }
+      char name[16];
+      if (mt == MT_DATA) {
+        snprintf(name, sizeof(name), "%s", kMtNames[mt]);
+      } else {
+        snprintf(name, sizeof(name), "%s GID %X", kMtNames[mt], gid);
+      }
+      dprintf(fd, "  %-10s %-9s %8llu %7llu %7llu %7llu %7llu %8llu\n", name,
+              stageName((Stage)stage), (unsigned long long)hist.qwCount,
+              (unsigned long long)(hist.qwSumUs / hist.qwCount),
+              (unsigned long long)percentileUs(hist, 500),
+              (unsigned long long)percentileUs(hist, 900),
+              (unsigned long long)percentileUs(hist, 990),
+              (unsigned long long)hist.qwMaxUs);
+    }
+  }
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+
+/*
+ * Latency of the NCI packets through the HAL, stage by stage.
+ *
+ * Each packet is timestamped (CLOCK_MONOTONIC) at every stage it goes
+ * through:
+ *   RX: transport Read() return, post to the client queue, dequeue by the
+ *       HAL reader thread, phNxpNciHal_read_complete() entry, return of the
+ *       stack data callback.
+ *   TX: NfcWriter::write() entry, write window (syncSpiNfc) acquired,
+ *       phTmlNfc_Write() completion.
+ * The time between two stamps is added to a histogram of the stage, one set
+ * of histograms per message class: RSP, NTF and CMD by GID, DATA.
+ *
+ * Histograms are log-linear in microseconds: exact up to 8 us, then 8
+ * buckets per power of two, so a bucket is at most 12.5% wide. Counters are
+ * atomics, recording never locks. The stamps of a packet in flight are kept
+ * by the thread handling it, the RX ones from the dequeue on, the TX ones
+ * until phTmlNfc_Write() returns.
+ *
+ * FW download frames are not NCI packets and are not recorded.
+ */
+class NfcHalLatencyStats {
+ public:
+  enum Stage : uint8_t {
+    RX_NFCC,   /* command written -> its response read, RSP only */
+    RX_TML,    /* transport read -> posted to the client queue */
+    RX_QUEUE,  /* posted -> dequeued by the HAL reader thread */
+    RX_LOCK,   /* dequeued -> read completion, REENTRANCE_LOCK included */
+    RX_HAL,    /* read completion -> stack callback return, or read
+                  completion return for packets kept by the HAL */
+    RX_TOTAL,  /* transport read -> end of RX_HAL */
+    TX_WINDOW, /* NfcWriter::write -> write window acquired */
+    TX_WRITE,  /* write window -> phTmlNfc_Write completion */
+    TX_TOTAL,  /* NfcWriter::write -> phTmlNfc_Write completion */
+    STAGE_COUNT
+  };
+
+  /* NCI message type, bits 7-5 of the first header byte shifted down */
+  enum MsgType : uint8_t {
+    MT_DATA = 0,
+    MT_CMD,
+    MT_RSP,
+    MT_NTF,
+    MT_COUNT
+  };
+
+  static constexpr uint32_t kSubBucketBits = 3;
+  static constexpr uint32_t kSubBuckets = 1U << kSubBucketBits;
+  /* Up to 2^24 us (16.7 s), longer latencies go to the last bucket */
+  static constexpr uint32_t kMaxShift = 24 - kSubBucketBits;
+  static constexpr uint32_t kBuckets = (kMaxShift + 1) * kSubBuckets;
+
+  /* Copy of a histogram */
+  struct Histogram {
+    uint64_t qwCount;
+    uint64_t qwSumUs;
+    uint64_t qwMaxUs;
+    uint32_t aBuckets[kBuckets];
+  };
+
+  static NfcHalLatencyStats& getInstance();
+
+  static uint64_t nowNs();
+
+  /* RX stamps, transport read and post are carried by the RX buffer */
+  void markDequeue();
+  void rxBegin(const uint8_t* pPkt, uint16_t len, uint64_t readNs,
+               uint64_t postNs);
+  void rxComplete();
+  void rxDelivered();
+  void rxEnd();
+
+  /* TX stamps */
+  void txBegin();
+  void txWindow();
+  void txWritten(const uint8_t* pPkt, uint16_t len);
+  void txEnd();
+
+  /* Stamps NfcWriter::write entry, forgets the stamps on return */
+  class TxScope {
+   public:
+    TxScope() { NfcHalLatencyStats::getInstance().txBegin(); }
+    ~TxScope() { NfcHalLatencyStats::getInstance().txEnd(); }
+    TxScope(const TxScope&) = delete;
+    TxScope& operator=(const TxScope&) = delete;
+  };
+
+  /******************************************************************************
+   * Function:       getHistogram()
+   *
+   * Description:    Copies the histogram of a stage for a message class. gid
+   *                 is ignored for MT_DATA.
+   *
+   * Returns:        bool: false if no packet of the class was recorded.
+   ******************************************************************************/
+  bool getHistogram(MsgType mt, uint8_t gid, Stage stage, Histogram& hist);
+
+  /* Latency below which permille of the histogram falls, bucket upper
+   * bound */
+  static uint64_t percentileUs(const Histogram& hist, uint32_t permille);
+  static uint32_t bucketOf(uint64_t us);
+  static uint64_t bucketUpperUs(uint32_t bucket);
+
+  /* Clears every histogram */
+  void reset();
+  /* Writes the count, mean, percentiles and max of the stages recorded */
+  void dump(int fd);
+
+  static const char* stageName(Stage stage);
+
+ private:
+  struct AtomicHistogram {
+    std::atomic<uint64_t> qwCount;
+    std::atomic<uint64_t> qwSumUs;
+    std::atomic<uint64_t> qwMaxUs;
+    std::atomic<uint32_t> aBuckets[kBuckets];
+  };
+
+  struct ClassStats {
+    AtomicHistogram aStages[STAGE_COUNT];
+  };
+
+  static constexpr uint32_t kClasses = MT_COUNT * 16;
+
+  NfcHalLatencyStats();
+  ~NfcHalLatencyStats() = delete;
+  NfcHalLatencyStats(const NfcHalLatencyStats&) = delete;
+  NfcHalLatencyStats& operator=(const NfcHalLatencyStats&) = delete;
+
+  static int classOf(const uint8_t* pPkt, uint16_t len);
+  ClassStats* classStats(int cls);
+  void record(int cls, Stage stage, uint64_t fromNs, uint64_t toNs);
+
+  /* Allocated on the first packet of the class, never freed */
+  std::atomic<ClassStats*> mClasses[kClasses];
+  /* Last command written, for RX_NFCC */
+  std::atomic<uint64_t> mCmdWrittenNs;
+};
@@ -0,0 +1,184 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "NxpNfcLockStats.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#define NS_PER_SEC (1000000000ULL)
+#define NS_PER_USEC (1000ULL)
+
+std::atomic<bool> NfcHalLockStats::sEnabled(false);
+
+static uint64_t monotonicNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * NS_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+NfcHalLockStats::NfcHalLockStats(const char* name)
+    : mName(name), mHoldStartNs(0) {
+  setSite(mHolder, nullptr, 0);
+  reset();
+}
+
+NfcHalLockStats& NfcHalLockStats::getInstance(tNFC_HAL_LOCK_ID id) {
+  /* Never destroyed: the locks may still be taken while exiting */
+  static NfcHalLockStats* sLocks[NFC_HAL_LOCK_COUNT] = {
+      new NfcHalLockStats("REENTRANCE_LOCK"),
+      new NfcHalLockStats("CONCURRENCY_LOCK"),
+  };
+  return *sLocks[(id < NFC_HAL_LOCK_COUNT) ? id : NFC_HAL_LOCK_REENTRANCE];
+}
+
+void NfcHalLockStats::setEnabled(bool enabled) {
+  sEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+void NfcHalLockStats::setSite(Site& dst, const char* func, int line) {
+  dst.func.store(func, std::memory_order_relaxed);
+  dst.line.store(line, std::memory_order_relaxed);
+}
+
+void NfcHalLockStats::copySite(Site& dst, const Site& src) {
+  setSite(dst, src.func.load(std::memory_order_relaxed),
+          src.line.load(std::memory_order_relaxed));
+}
+
+/******************************************************************************
+ * Function:       lockInstrumented()
+ *
+ * Description:    Takes the mutex, timing the wait if it is held. The call
+ *                 site of the holder is read when the wait starts, it is
+ *                 only a hint if the lock changes hands meanwhile.
+ *
+ * Returns:        void
+ ******************************************************************************/
+void NfcHalLockStats::lockInstrumented(pthread_mutex_t* pMutex,
+                                       const char* func, int line) {
+  uint64_t waitNs = 0;
+  bool contended = false;
+  const char* blockerFunc = nullptr;
+  int blockerLine = 0;
+
+  if (pthread_mutex_trylock(pMutex) != 0) {
+    contended = true;
+    uint64_t startNs = monotonicNs();
+    blockerFunc = mHolder.func.load(std::memory_order_relaxed);
+    blockerLine = mHolder.line.load(std::memory_order_relaxed);
+    pthread_mutex_lock(pMutex);
+    waitNs = monotonicNs() - startNs;
+  }
+
+  /* Held from here on, statistics are only updated under the lock */
+  mHoldStartNs.store(monotonicNs(), std::memory_order_relaxed);
+  setSite(mHolder, func, line);
+  mAcquired.fetch_add(1, std::memory_order_relaxed);
+  if (contended) {
+    mContended.fetch_add(1, std::memory_order_relaxed);
+    mWaitTotalNs.fetch_add(waitNs, std::memory_order_relaxed);
+    if (waitNs > mWaitMaxNs.load(std::memory_order_relaxed)) {
+      mWaitMaxNs.store(waitNs, std::memory_order_relaxed);
+      setSite(mWaitMaxSite, func, line);
+      setSite(mWaitMaxBlocker, blockerFunc, blockerLine);
+    }
+  }
+}
+
+void NfcHalLockStats::unlockInstrumented(pthread_mutex_t* pMutex) {
+  uint64_t holdNs =
+      monotonicNs() - mHoldStartNs.load(std::memory_order_relaxed);
+
+  mHoldTotalNs.fetch_add(holdNs, std::memory_order_relaxed);
+  if (holdNs > mHoldMaxNs.load(std::memory_order_relaxed)) {
+    mHoldMaxNs.store(holdNs, std::memory_order_relaxed);
+    copySite(mHoldMaxSite, mHolder);
+  }
+  setSite(mHolder, nullptr, 0);
+  mHoldStartNs.store(0, std::memory_order_relaxed);
+  pthread_mutex_unlock(pMutex);
+}
+
+void NfcHalLockStats::reset() {
+  mAcquired.store(0, std::memory_order_relaxed);
+  mContended.store(0, std::memory_order_relaxed);
+  mWaitTotalNs.store(0, std::memory_order_relaxed);
+  mWaitMaxNs.store(0, std::memory_order_relaxed);
+  setSite(mWaitMaxSite, nullptr, 0);
+  setSite(mWaitMaxBlocker, nullptr, 0);
+  mHoldTotalNs.store(0, std::memory_order_relaxed);
+  mHoldMaxNs.store(0, std::memory_order_relaxed);
+  setSite(mHoldMaxSite, nullptr, 0);
+}
+
+void NfcHalLockStats::resetAll() {
+  for (int id = 0; id < NFC_HAL_LOCK_COUNT; id++) {
+    getInstance((tNFC_HAL_LOCK_ID)id).reset();
+  }
+}
+
+void NfcHalLockStats::dump(int fd) {
+  uint64_t acquired = mAcquired.load(std::memory_order_relaxed);
+  uint64_t holdTotalNs = mHoldTotalNs.load(std::memory_order_relaxed);
+  const char* waitFunc = mWaitMaxSite.func.load(std::memory_order_relaxed);
+  const char* blockerFunc =
+      mWaitMaxBlocker.func.load(std::memory_order_relaxed);
+  const char* holdFunc = mHoldMaxSite.func.load(std::memory_order_relaxed);
+
+  dprintf(fd,
+          "  %s: acquired %llu, contended %llu, wait total %llu us max "
+          "%llu us, hold total %llu us mean %llu us max %llu us\n",
+          mName, (unsigned long long)acquired,
+          (unsigned long long)mContended.load(std::memory_order_relaxed),
+          (unsigned long long)(mWaitTotalNs.load(std::memory_order_relaxed) /
+                               NS_PER_USEC),
+          (unsigned long long)(mWaitMaxNs.load(std::memory_order_relaxed) /
+                               NS_PER_USEC),
+          (unsigned long long)(holdTotalNs / NS_PER_USEC),
+          (unsigned long long)(acquired ? holdTotalNs / acquired / NS_PER_USEC
+                                        : 0),
+          (unsigned long long)(mHoldMaxNs.load(std::memory_order_relaxed) /
+                               NS_PER_USEC));
+  if (holdFunc != nullptr) {
+    dprintf(fd, "    longest hold: %s:%d\n", holdFunc,
+            mHoldMaxSite.line.load(std::memory_order_relaxed));
+  }
+  if (waitFunc != nullptr) {
+    dprintf(fd, "    longest wait: %s:%d, held by %s:%d\n", waitFunc,
+            mWaitMaxSite.line.load(std::memory_order_relaxed),
+            (blockerFunc != nullptr) ? blockerFunc : "unknown",
+            mWaitMaxBlocker.line.load(std::memory_order_relaxed));
+  }
+}
+
+/******************************************************************************
+ * Function:       dumpAll()
+ *
+ * Description:    Writes the statistics of every named lock to fd.
+ *
+ * Returns:        void
+ ******************************************************************************/
+void NfcHalLockStats::dumpAll(int fd) {
+  if (!isEnabled()) {
+    dprintf(fd, "Lock statistics disabled, see NXP_LOCK_STATS\n");
+    return;
+  }
+  dprintf(fd, "Lock statistics:\n");
+  for (int id = 0; id < NFC_HAL_LOCK_COUNT; id++) {
+    getInstance((tNFC_HAL_LOCK_ID)id).dump(fd);
+  }
+}
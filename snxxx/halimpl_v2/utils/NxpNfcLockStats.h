@@ -0,0 +1,106 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include <atomic>
+
+/* Named HAL locks */
+typedef enum {
+  NFC_HAL_LOCK_REENTRANCE = 0,
+  NFC_HAL_LOCK_CONCURRENCY,
+  NFC_HAL_LOCK_COUNT
+} tNFC_HAL_LOCK_ID;
+
+/*
+ * Contention and hold time of a named HAL lock, enabled by NXP_LOCK_STATS.
+ *
+ * lock() and unlock() wrap the pthread mutex of the lock. When enabled, they
+ * record per lock:
+ *   - acquisitions, and those which had to wait for another holder,
+ *   - total and longest wait, with the call site which waited longest and
+ *     the call site holding the lock meanwhile,
+ *   - total and longest hold, with the call site which held it longest.
+ * Statistics are updated by the holder only, under the lock itself.
+ * Disabled, they cost a relaxed atomic load over the plain mutex.
+ */
+class NfcHalLockStats {
+ public:
+  static NfcHalLockStats& getInstance(tNFC_HAL_LOCK_ID id);
+
+  static void setEnabled(bool enabled);
+  static bool isEnabled() { return sEnabled.load(std::memory_order_relaxed); }
+
+  void lock(pthread_mutex_t* pMutex, const char* func, int line) {
+    if (!isEnabled()) {
+      pthread_mutex_lock(pMutex);
+      return;
+    }
+    lockInstrumented(pMutex, func, line);
+  }
+
+  void unlock(pthread_mutex_t* pMutex) {
+    /* Acquisitions made while disabled are not timed */
+    if (mHoldStartNs.load(std::memory_order_relaxed) == 0) {
+      pthread_mutex_unlock(pMutex);
+      return;
+    }
+    unlockInstrumented(pMutex);
+  }
+
+  /* Writes the statistics of every named lock to fd */
+  static void dumpAll(int fd);
+  /* Clears the statistics of every named lock */
+  static void resetAll();
+
+ private:
+  /* Call site, func points to a string literal */
+  struct Site {
+    std::atomic<const char*> func;
+    std::atomic<int> line;
+  };
+
+  explicit NfcHalLockStats(const char* name);
+  ~NfcHalLockStats() = delete;
+  NfcHalLockStats(const NfcHalLockStats&) = delete;
+  NfcHalLockStats& operator=(const NfcHalLockStats&) = delete;
+
+  void lockInstrumented(pthread_mutex_t* pMutex, const char* func, int line);
+  void unlockInstrumented(pthread_mutex_t* pMutex);
+  void dump(int fd);
+  void reset();
+  static void copySite(Site& dst, const Site& src);
+  static void setSite(Site& dst, const char* func, int line);
+
+  static std::atomic<bool> sEnabled;
+
+  const char* mName;
+  /* Current holder, 0 if its acquisition was not timed */
+  std::atomic<uint64_t> mHoldStartNs;
+  Site mHolder;
+
+  std::atomic<uint64_t> mAcquired;
+  std::atomic<uint64_t> mContended;
+  std::atomic<uint64_t> mWaitTotalNs;
+  std::atomic<uint64_t> mWaitMaxNs;
+  Site mWaitMaxSite;
+  Site mWaitMaxBlocker;
+  std::atomic<uint64_t> mHoldTotalNs;
+  std::atomic<uint64_t> mHoldMaxNs;
+  Site mHoldMaxSite;
+};
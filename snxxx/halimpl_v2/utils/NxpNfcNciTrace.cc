@@ -0,0 +1,343 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "NxpNfcNciTrace.h"
+
+#include <android-base/threads.h>
+#include <errno.h>
+#include <phNxpLog.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <new>
+#include <vector>
+
+#include "NxpNfcHexCodec.h"
+
+#define NS_PER_SEC (1000000000ULL)
+#define NS_PER_USEC (1000ULL)
+
+#define TRACE_HEX_LEN (NfcHalNciTrace::kMaxData * 2 + 1)
+
+static uint64_t monotonicNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * NS_PER_SEC + ts.tv_nsec;
+}
+
+/*******************************************************************************
+**
+** Function:    NfcHalNciTrace::getInstance()
+**
+** Description: Returns the process wide trace. Never destroyed, packets may
+**              be printed from static destructors.
+**
+** Returns:     trace instance
+**
+*******************************************************************************/
+NfcHalNciTrace& NfcHalNciTrace::getInstance() {
+  static NfcHalNciTrace* sInstance = new NfcHalNciTrace();
+  return *sInstance;
+}
+
+/*******************************************************************************
+**
+** Function:    NfcHalNciTrace::NfcHalNciTrace()
+**
+** Description: class constructor, starts the formatter thread. Packets are
+**              printed inline if it cannot be started.
+**
+** Returns:     none
+**
+*******************************************************************************/
+NfcHalNciTrace::NfcHalNciTrace()
+    : mThread(),
+      mEventFd(-1),
+      mStarted(false),
+      mWakePending(false),
+      mRings(nullptr),
+      mDropped(0) {
+  pthread_mutex_init(&mLock, NULL);
+  if (pthread_key_create(&mRingKey, releaseRing) != 0) {
+    NXPLOG_NCIHAL_E("%s: pthread_key_create failed", __func__);
+    return;
+  }
+  mEventFd = eventfd(0, EFD_CLOEXEC);
+  if (mEventFd < 0) {
+    NXPLOG_NCIHAL_E("%s: eventfd failed, errno=%d", __func__, errno);
+    return;
+  }
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+  if (pthread_create(&mThread, &attr, formatterThread, this) != 0) {
+    NXPLOG_NCIHAL_E("%s: pthread_create failed", __func__);
+    close(mEventFd);
+    mEventFd = -1;
+  } else {
+    pthread_setname_np(mThread, "NfcHalNciTrace");
+    mStarted = true;
+  }
+  pthread_attr_destroy(&attr);
+}
+
+/*******************************************************************************
+**
+** Function:    NfcHalNciTrace::threadRing()
+**
+** Description: Returns the ring of the calling thread. On first use, takes
+**              over the ring of an exited thread, or creates one.
+**
+** Returns:     ring, nullptr if out of memory
+**
+*******************************************************************************/
+NfcHalNciTrace::Ring* NfcHalNciTrace::threadRing() {
+  Ring* pRing = static_cast<Ring*>(pthread_getspecific(mRingKey));
+  if (pRing != nullptr) return pRing;
+
+  pthread_mutex_lock(&mLock);
+  for (pRing = mRings; pRing != nullptr; pRing = pRing->pNext) {
+    /* Keeps its position and packets, the formatter carries on */
+    if (pRing->bOrphan.exchange(false, std::memory_order_acq_rel)) break;
+  }
+  if (pRing == nullptr) {
+    pRing = new (std::nothrow) Ring();
+    if (pRing != nullptr) {
+      for (uint32_t i = 0; i < kSlots; i++) pRing->aSlots[i].qwSeq.store(0);
+      pRing->qwHead.store(0);
+      pRing->qwLogged = 0;
+      pRing->bOrphan.store(false);
+      pRing->pNext = mRings;
+      mRings = pRing;
+    }
+  }
+  pthread_mutex_unlock(&mLock);
+  if (pRing == nullptr) return nullptr;
+
+  pRing->tid = (pid_t)android::base::GetThreadId();
+  pthread_setspecific(mRingKey, pRing);
+  return pRing;
+}
+
+/* Thread exit: the ring is handed over to the next new thread */
+void NfcHalNciTrace::releaseRing(void* arg) {
+  static_cast<Ring*>(arg)->bOrphan.store(true, std::memory_order_release);
+}
+
+/*******************************************************************************
+**
+** Function:    NfcHalNciTrace::record()
+**
+** Description: Copies a packet to the ring of the calling thread. Lock free,
+**              the formatter thread is only woken if it is idle.
+**
+** Returns:     true if recorded, false if it must be printed inline
+**
+*******************************************************************************/
+bool NfcHalNciTrace::record(tNFC_printType type, const uint8_t* pData,
+                            uint16_t len, bool isNxpAvcNciPrint) {
+  if (!mStarted || pData == nullptr || len > kMaxData) return false;
+  Ring* pRing = threadRing();
+  if (pRing == nullptr) return false;
+
+  uint64_t pos = pRing->qwHead.load(std::memory_order_relaxed);
+  Slot& slot = pRing->aSlots[pos % kSlots];
+  slot.qwSeq.store(2 * pos + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.qwTimeNs = monotonicNs();
+  slot.wLen = len;
+  slot.eType = type;
+  slot.bAvc = isNxpAvcNciPrint;
+  slot.tid = pRing->tid;
+  memcpy(slot.aData, pData, len);
+  slot.qwSeq.store(2 * pos + 2, std::memory_order_release);
+  pRing->qwHead.store(pos + 1, std::memory_order_release);
+
+  if (!mWakePending.exchange(true, std::memory_order_acq_rel)) {
+    uint64_t one = 1;
+    if (write(mEventFd, &one, sizeof(one)) < 0) {
+      mWakePending.store(false);
+    }
+  }
+  return true;
+}
+
+/*******************************************************************************
+**
+** Function:    NfcHalNciTrace::read()
+**
+** Description: Copies the packet recorded at pos, seqlock style: the copy is
+**              discarded if the owner thread overwrote the slot meanwhile.
+**
+** Returns:     true if entry holds the packet
+**
+*******************************************************************************/
+bool NfcHalNciTrace::read(const Ring* pRing, uint64_t pos, Entry& entry) {
+  const Slot& slot = pRing->aSlots[pos % kSlots];
+  uint64_t seq = slot.qwSeq.load(std::memory_order_acquire);
+  if (seq != 2 * pos + 2) return false;
+  entry.qwTimeNs = slot.qwTimeNs;
+  entry.wLen = std::min(slot.wLen, kMaxData);
+  entry.eType = slot.eType;
+  entry.bAvc = slot.bAvc;
+  entry.tid = slot.tid;
+  memcpy(entry.aData, slot.aData, entry.wLen);
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return slot.qwSeq.load(std::memory_order_relaxed) == seq;
+}
+
+void NfcHalNciTrace::log(const Entry& entry) {
+  char hex[TRACE_HEX_LEN];
+  phNxpNciHal_hexEncode(entry.aData, entry.wLen, hex);
+  phNxpNciHal_log_packet(entry.eType, entry.aData, entry.wLen, hex,
+                         entry.bAvc);
+}
+
+/*******************************************************************************
+**
+** Function:    NfcHalNciTrace::drainLocked()
+**
+** Description: Logs the packets recorded since the last call, oldest first
+**              across all rings. mLock must be held.
+**
+** Returns:     none
+**
+*******************************************************************************/
+void NfcHalNciTrace::drainLocked() {
+  Entry entry, next;
+  for (;;) {
+    Ring* pOldest = nullptr;
+    for (Ring* pRing = mRings; pRing != nullptr; pRing = pRing->pNext) {
+      uint64_t head = pRing->qwHead.load(std::memory_order_acquire);
+      while (pRing->qwLogged < head) {
+        if (head - pRing->qwLogged > kSlots) {
+          mDropped += head - kSlots - pRing->qwLogged;
+          pRing->qwLogged = head - kSlots;
+        }
+        if (read(pRing, pRing->qwLogged, next)) break;
+        /* Overwritten while reading */
+        mDropped++;
+        pRing->qwLogged++;
+      }
+      if (pRing->qwLogged == head) continue;
+      if (pOldest == nullptr || next.qwTimeNs < entry.qwTimeNs) {
+        pOldest = pRing;
+        entry = next;
+      }
+    }
+    if (pOldest == nullptr) break;
+
+    if (mDropped > 0) {
+      NXPLOG_NCIHAL_W("%s: %llu packets not logged", __func__,
+                      (unsigned long long)mDropped);
+      mDropped = 0;
+    }
+    log(entry);
+    pOldest->qwLogged++;
+  }
+}
+
+/*******************************************************************************
+**
+** Function:    NfcHalNciTrace::flush()
+**
+** Description: Logs every packet recorded so far, e.g. before aborting.
+**
+** Returns:     none
+**
+*******************************************************************************/
+void NfcHalNciTrace::flush() {
+  if (!mStarted) return;
+  pthread_mutex_lock(&mLock);
+  drainLocked();
+  pthread_mutex_unlock(&mLock);
+}
+
+/*******************************************************************************
+**
+** Function:    NfcHalNciTrace::dump()
+**
+** Description: Writes the packets still held by the rings to fd, oldest
+**              first, with the wall clock time they were recorded at.
+**
+** Returns:     none
+**
+*******************************************************************************/
+void NfcHalNciTrace::dump(int fd) {
+  if (!mStarted) return;
+  struct timespec real;
+  clock_gettime(CLOCK_REALTIME, &real);
+  const int64_t offsetNs =
+      (int64_t)((uint64_t)real.tv_sec * NS_PER_SEC + real.tv_nsec) -
+      (int64_t)monotonicNs();
+
+  std::vector<Entry> entries;
+  pthread_mutex_lock(&mLock);
+  for (Ring* pRing = mRings; pRing != nullptr; pRing = pRing->pNext) {
+    uint64_t head = pRing->qwHead.load(std::memory_order_acquire);
+    uint64_t pos = (head > kSlots) ? head - kSlots : 0;
+    for (; pos < head; pos++) {
+      entries.emplace_back();
+      if (!read(pRing, pos, entries.back())) entries.pop_back();
+    }
+  }
+  pthread_mutex_unlock(&mLock);
+
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry& a, const Entry& b) {
+              return a.qwTimeNs < b.qwTimeNs;
+            });
+  dprintf(fd, "NCI trace, last %u packets per thread:\n", kSlots);
+  char hex[TRACE_HEX_LEN];
+  for (const Entry& entry : entries) {
+    uint64_t realNs = entry.qwTimeNs + offsetNs;
+    time_t sec = (time_t)(realNs / NS_PER_SEC);
+    struct tm tm;
+    char date[32];
+    localtime_r(&sec, &tm);
+    strftime(date, sizeof(date), "%m-%d %H:%M:%S", &tm);
+    phNxpNciHal_hexEncode(entry.aData, entry.wLen, hex);
+    dprintf(fd, "%s.%06llu %5d %s len = %3d > %s\n", date,
+            (unsigned long long)((realNs % NS_PER_SEC) / NS_PER_USEC),
+            entry.tid,
+            entry.eType == PRINT_SEND   ? "SEND"
+            : entry.eType == PRINT_RECV ? "RECV"
+                                        : "DEBUG",
+            entry.wLen, hex);
+  }
+}
+
+void NfcHalNciTrace::formatterLoop() {
+  for (;;) {
+    uint64_t count;
+    if (::read(mEventFd, &count, sizeof(count)) < 0 && errno != EINTR) {
+      NXPLOG_NCIHAL_E("%s: eventfd read failed, errno=%d", __func__, errno);
+      return;
+    }
+    /* Packets recorded from now on wake the thread again */
+    mWakePending.store(false, std::memory_order_release);
+    flush();
+  }
+}
+
+void* NfcHalNciTrace::formatterThread(void* arg) {
+  static_cast<NfcHalNciTrace*>(arg)->formatterLoop();
+  return NULL;
+}
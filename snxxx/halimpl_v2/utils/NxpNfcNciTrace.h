@@ -0,0 +1,107 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <pthread.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <atomic>
+
+#include "phNxpNciHal_utils.h"
+
+/*
+ * Binary trace of the NCI packets printed by phNxpNciHal_print_packet().
+ *
+ * Every thread records its packets (timestamp, print type and raw bytes) in
+ * its own ring, without locking nor formatting. A formatter thread turns
+ * them into the usual "len = .. > HEX" log lines, merged in timestamp order.
+ * The rings keep the last kSlots packets of each thread, already logged or
+ * not, so that dump() can print them with their real timestamps.
+ *
+ * When the formatter falls more than kSlots packets behind a thread, the
+ * oldest ones are overwritten and reported as dropped in the log. The ring
+ * of an exited thread is handed over to the next new thread.
+ */
+class NfcHalNciTrace {
+ public:
+  static constexpr uint32_t kSlots = 64;
+  static constexpr uint16_t kMaxData = 264;
+
+  static NfcHalNciTrace& getInstance();
+
+  /* false if the packet must be printed inline: no formatter thread, or
+   * longer than kMaxData */
+  bool record(tNFC_printType type, const uint8_t* pData, uint16_t len,
+              bool isNxpAvcNciPrint);
+  /* Logs every recorded packet before returning */
+  void flush();
+  /* Writes the packets still held by the rings to fd */
+  void dump(int fd);
+
+ private:
+  struct Slot {
+    std::atomic<uint64_t> qwSeq; /* 2 * pos + 1 while written, + 2 once done */
+    uint64_t qwTimeNs;           /* CLOCK_MONOTONIC */
+    uint16_t wLen;
+    tNFC_printType eType;
+    bool bAvc;
+    pid_t tid;
+    uint8_t aData[kMaxData];
+  };
+
+  /* Single producer: written by its thread only */
+  struct Ring {
+    Slot aSlots[kSlots];
+    std::atomic<uint64_t> qwHead; /* next position to write */
+    uint64_t qwLogged;            /* next position to log, formatter only */
+    std::atomic<bool> bOrphan;    /* owner thread exited, can be reused */
+    pid_t tid;                    /* owner thread */
+    Ring* pNext;
+  };
+
+  /* Copy of one slot */
+  struct Entry {
+    uint64_t qwTimeNs;
+    uint16_t wLen;
+    tNFC_printType eType;
+    bool bAvc;
+    pid_t tid;
+    uint8_t aData[kMaxData];
+  };
+
+  NfcHalNciTrace();
+  ~NfcHalNciTrace() = delete;
+  NfcHalNciTrace(const NfcHalNciTrace&) = delete;
+  NfcHalNciTrace& operator=(const NfcHalNciTrace&) = delete;
+
+  Ring* threadRing();
+  static bool read(const Ring* pRing, uint64_t pos, Entry& entry);
+  void drainLocked();
+  void log(const Entry& entry);
+  void formatterLoop();
+  static void* formatterThread(void* arg);
+  static void releaseRing(void* arg);
+
+  pthread_mutex_t mLock; /* ring list, formatting */
+  pthread_key_t mRingKey;
+  pthread_t mThread;
+  int mEventFd;
+  bool mStarted;
+  std::atomic<bool> mWakePending;
+  Ring* mRings;
+  uint64_t mDropped;
+};
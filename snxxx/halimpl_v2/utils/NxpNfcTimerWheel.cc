@@ -0,0 +1,548 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#define LOG_TAG "NxpNfcTimerWheel"
+
+#include "NxpNfcTimerWheel.h"
+
+#include <android-base/logging.h>
+#include <android-base/stringprintf.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+using android::base::StringPrintf;
+
+#define NS_PER_MS (1000000ULL)
+#define NS_PER_SEC (1000000000ULL)
+
+/*******************************************************************************
+**
+** Function:    NfcHalTimerWheel::getInstance()
+**
+** Description: Returns the process wide timer wheel. The instance is never
+**              destroyed so that timers can still be cancelled from static
+**              destructors.
+**
+** Returns:     timer wheel instance
+**
+*******************************************************************************/
+NfcHalTimerWheel& NfcHalTimerWheel::getInstance() {
+  static NfcHalTimerWheel* sInstance = new NfcHalTimerWheel();
+  return *sInstance;
+}
+
+/*******************************************************************************
+**
+** Function:    NfcHalTimerWheel::NfcHalTimerWheel()
+**
+** Description: class constructor. Threads and timerfd are created on first
+**              use by start().
+**
+** Returns:     none
+**
+*******************************************************************************/
+NfcHalTimerWheel::NfcHalTimerWheel()
+    : mTimerFd(-1),
+      mStarted(false),
+      mWheelThread(),
+      mCallbackThreads(0),
+      mCallbackIdle(0),
+      mCallbackQueued(0),
+      mEpochNs(0),
+      mTick(0),
+      mArmedTick(0),
+      mPending(0) {
+  pthread_mutex_init(&mLock, NULL);
+  pthread_cond_init(&mCallbackCond, NULL);
+  memset(mLevelCount, 0, sizeof(mLevelCount));
+  for (uint32_t level = 0; level < kLevels; level++) {
+    for (uint32_t slot = 0; slot < kSlots; slot++) {
+      mSlots[level][slot].pPrev = &mSlots[level][slot];
+      mSlots[level][slot].pNext = &mSlots[level][slot];
+    }
+  }
+  mOverflow.pPrev = mOverflow.pNext = &mOverflow;
+  mCallbackQueue.pPrev = mCallbackQueue.pNext = &mCallbackQueue;
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  mEpochNs = (uint64_t)ts.tv_sec * NS_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+/*******************************************************************************
+**
+** Function:    NfcHalTimerWheel::start()
+**
+** Description: Creates the timerfd, the wheel thread and a first callback
+**              thread if not done yet. Called with mLock held.
+**
+** Returns:     true if the wheel is running
+**
+*******************************************************************************/
+bool NfcHalTimerWheel::start() {
+  if (mStarted) return true;
+
+  if (mTimerFd < 0) {
+    mTimerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (mTimerFd < 0) {
+      LOG(ERROR) << StringPrintf("%s: timerfd_create failed, errno=%d",
+                                 __func__, errno);
+      return false;
+    }
+  }
+  if (mCallbackThreads == 0 && !startCallbackThread()) return false;
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+  if (pthread_create(&mWheelThread, &attr, wheelThread, this) != 0) {
+    LOG(ERROR) << StringPrintf("%s: wheel thread creation failed", __func__);
+    pthread_attr_destroy(&attr);
+    return false;
+  }
+  pthread_attr_destroy(&attr);
+  mStarted = true;
+  return true;
+}
+
+/*******************************************************************************
+**
+** Function:    NfcHalTimerWheel::startCallbackThread()
+**
+** Description: Starts one more detached callback thread. Called with mLock
+**              held.
+**
+** Returns:     true if the thread is started
+**
+*******************************************************************************/
+bool NfcHalTimerWheel::startCallbackThread() {
+  pthread_t thread;
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+  int ret = pthread_create(&thread, &attr, callbackThread, this);
+  pthread_attr_destroy(&attr);
+  if (ret != 0) {
+    LOG(ERROR) << StringPrintf("%s: callback thread creation failed, err=%d",
+                               __func__, ret);
+    return false;
+  }
+  mCallbackThreads++;
+  return true;
+}
+
+/*******************************************************************************
+**
+** Function:    NfcHalTimerWheel::nowTicks()
+**
+** Description: Reads CLOCK_MONOTONIC and converts it to wheel ticks.
+**
+** Parameters:  roundUp - round a partial tick up instead of down
+**
+** Returns:     current tick
+**
+*******************************************************************************/
+uint64_t NfcHalTimerWheel::nowTicks(bool roundUp) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  uint64_t ns = (uint64_t)ts.tv_sec * NS_PER_SEC + (uint64_t)ts.tv_nsec;
+  ns -= mEpochNs;
+  return roundUp ? (ns + NS_PER_MS - 1) / NS_PER_MS : ns / NS_PER_MS;
+}
+
+/*******************************************************************************
+**
+** Function:    NfcHalTimerWheel::link()
+**
+** Description: Appends an entry to the list headed by pHead.
+**
+** Returns:     none
+**
+*******************************************************************************/
+void NfcHalTimerWheel::link(NfcHalTimerEntry_t* pHead,
+                            NfcHalTimerEntry_t* pEntry, uint8_t list) {
+  pEntry->pPrev = pHead->pPrev;
+  pEntry->pNext = pHead;
+  pHead->pPrev->pNext = pEntry;
+  pHead->pPrev = pEntry;
+  pEntry->bList = list;
+}
+
+/*******************************************************************************
+**
+** Function:    NfcHalTimerWheel::unlink()
+**
+** Description: Removes an entry from whichever list it is on and updates the
+**              wheel occupancy counters.
+**
+** Returns:     none
+**
+*******************************************************************************/
+void NfcHalTimerWheel::unlink(NfcHalTimerEntry_t* pEntry) {
+  if (pEntry->bList == kListNone) return;
+
+  pEntry->pPrev->pNext = pEntry->pNext;
+  pEntry->pNext->pPrev = pEntry->pPrev;
+  if (pEntry->bList <= kLevels) {
+    mLevelCount[pEntry->bList - 1]--;
+    mPending--;
+  } else if (pEntry->bList == kListOverflow) {
+    mPending--;
+  } else if (pEntry->bList == kListCallback) {
+    mCallbackQueued--;
+  }
+  pEntry->pPrev = pEntry->pNext = NULL;
+  pEntry->bList = kListNone;
+}
+
+/*******************************************************************************
+**
+** Function:    NfcHalTimerWheel::insert()
+**
+** Description: Places an entry in the slot matching its distance from the
+**              current tick. An entry lands on level n only if it is at least
+**              64^n ticks away, so its slot is always cascaded before expiry.
+**
+** Returns:     none
+**
+*******************************************************************************/
+void NfcHalTimerWheel::insert(NfcHalTimerEntry_t* pEntry) {
+  uint64_t delta = pEntry->qwExpiry - mTick;
+
+  mPending++;
+  for (uint32_t level = 0; level < kLevels; level++) {
+    if (delta < (1ULL << (kSlotBits * (level + 1)))) {
+      uint32_t slot = (pEntry->qwExpiry >> (kSlotBits * level)) & kSlotMask;
+      link(&mSlots[level][slot], pEntry, level + 1);
+      mLevelCount[level]++;
+      return;
+    }
+  }
+  link(&mOverflow, pEntry, kListOverflow);
+}
+
+/*******************************************************************************
+**
+** Function:    NfcHalTimerWheel::rehash()
+**
+** Description: Re-inserts every entry of a list relative to the current tick.
+**              Used to cascade a higher level slot and to drain the overflow
+**              list when the top level wraps.
+**
+** Returns:     none
+**
+*******************************************************************************/
+void NfcHalTimerWheel::rehash(NfcHalTimerEntry_t* pHead) {
+  /* Detach the list first; overflow entries may be appended back to it */
+  NfcHalTimerEntry_t tList;
+  if (pHead->pNext == pHead) return;
+  tList.pNext = pHead->pNext;
+  tList.pPrev = pHead->pPrev;
+  tList.pNext->pPrev = &tList;
+  tList.pPrev->pNext = &tList;
+  pHead->pNext = pHead->pPrev = pHead;
+
+  while (tList.pNext != &tList) {
+    NfcHalTimerEntry_t* pEntry = tList.pNext;
+    unlink(pEntry);
+    insert(pEntry);
+  }
+}
+
+/*******************************************************************************
+**
+** Function:    NfcHalTimerWheel::advance()
+**
+** Description: Processes all ticks up to now: cascades higher levels on slot
+**              boundaries and expires the level 0 slot of each tick. Runs of
+**              empty level 0 slots are skipped. Called with mLock held.
+**
+** Parameters:  now - current tick
+**
+** Returns:     none
+**
+*******************************************************************************/
+void NfcHalTimerWheel::advance(uint64_t now) {
+  while (mTick < now) {
+    if (mPending == 0) {
+      mTick = now;
+      break;
+    }
+    if (mLevelCount[0] == 0) {
+      /* Nothing can expire before the next cascade */
+      uint64_t boundary = mTick | kSlotMask;
+      if (boundary >= now) {
+        mTick = now;
+        break;
+      }
+      mTick = boundary;
+    }
+    mTick++;
+
+    uint32_t index = mTick & kSlotMask;
+    if (index == 0) {
+      uint32_t level;
+      for (level = 1; level < kLevels; level++) {
+        uint32_t slot = (mTick >> (kSlotBits * level)) & kSlotMask;
+        rehash(&mSlots[level][slot]);
+        if (slot != 0) break;
+      }
+      if (level == kLevels) rehash(&mOverflow);
+    }
+
+    NfcHalTimerEntry_t* pHead = &mSlots[0][index];
+    while (pHead->pNext != pHead) {
+      NfcHalTimerEntry_t* pEntry = pHead->pNext;
+      unlink(pEntry);
+      expire(pEntry);
+    }
+  }
+}
+
+/*******************************************************************************
+**
+** Function:    NfcHalTimerWheel::expire()
+**
+** Description: Runs an inline callback with mLock released, or queues the
+**              entry for an idle callback thread. Without one, another
+**              thread is started; if that fails, the entry waits for a busy
+**              thread to be done.
+**
+** Returns:     none
+**
+*******************************************************************************/
+void NfcHalTimerWheel::expire(NfcHalTimerEntry_t* pEntry) {
+  if (pEntry->bInline) {
+    NfcHalTimerCb_t cb = pEntry->pCb;
+    union sigval value = pEntry->tValue;
+    pthread_mutex_unlock(&mLock);
+    cb(value);
+    pthread_mutex_lock(&mLock);
+  } else {
+    link(&mCallbackQueue, pEntry, kListCallback);
+    mCallbackQueued++;
+    if (mCallbackIdle >= mCallbackQueued) {
+      pthread_cond_signal(&mCallbackCond);
+    } else {
+      (void)startCallbackThread();
+    }
+  }
+}
+
+/*******************************************************************************
+**
+** Function:    NfcHalTimerWheel::nextDeadline()
+**
+** Description: Computes the next tick at which the wheel has work to do: the
+**              first occupied level 0 slot, or the next cascade of an occupied
+**              higher level slot, so that long timeouts do not cause periodic
+**              wakeups.
+**
+** Returns:     next tick, 0 if no timer is pending
+**
+*******************************************************************************/
+uint64_t NfcHalTimerWheel::nextDeadline() {
+  if (mPending == 0) return 0;
+
+  uint64_t next = UINT64_MAX;
+  if (mLevelCount[0] != 0) {
+    for (uint64_t tick = mTick + 1; tick <= mTick + kSlots; tick++) {
+      NfcHalTimerEntry_t* pHead = &mSlots[0][tick & kSlotMask];
+      if (pHead->pNext != pHead) {
+        next = tick;
+        break;
+      }
+    }
+  }
+  for (uint32_t level = 1; level < kLevels; level++) {
+    if (mLevelCount[level] == 0) continue;
+    uint64_t base = mTick >> (kSlotBits * level);
+    for (uint64_t k = 1; k <= kSlots; k++) {
+      NfcHalTimerEntry_t* pHead = &mSlots[level][(base + k) & kSlotMask];
+      if (pHead->pNext != pHead) {
+        uint64_t tick = (base + k) << (kSlotBits * level);
+        if (tick < next) next = tick;
+        break;
+      }
+    }
+  }
+  if (mOverflow.pNext != &mOverflow) {
+    uint64_t tick = ((mTick >> (kSlotBits * kLevels)) + 1)
+                    << (kSlotBits * kLevels);
+    if (tick < next) next = tick;
+  }
+  return next;
+}
+
+/*******************************************************************************
+**
+** Function:    NfcHalTimerWheel::arm()
+**
+** Description: Arms the timerfd for an absolute tick, or disarms it.
+**
+** Parameters:  tick - tick to wake up at, 0 to disarm
+**
+** Returns:     none
+**
+*******************************************************************************/
+void NfcHalTimerWheel::arm(uint64_t tick) {
+  struct itimerspec its;
+  memset(&its, 0, sizeof(its));
+  if (tick != 0) {
+    uint64_t ns = mEpochNs + tick * NS_PER_MS;
+    its.it_value.tv_sec = ns / NS_PER_SEC;
+    its.it_value.tv_nsec = ns % NS_PER_SEC;
+  }
+  if (timerfd_settime(mTimerFd, TFD_TIMER_ABSTIME, &its, NULL) != 0) {
+    LOG(ERROR) << StringPrintf("%s: timerfd_settime failed, errno=%d",
+                               __func__, errno);
+    return;
+  }
+  mArmedTick = tick;
+}
+
+/*******************************************************************************
+**
+** Function:    NfcHalTimerWheel::schedule()
+**
+** Description: Starts or restarts a one-shot timer. A pending entry is moved
+**              to its new expiry.
+**
+** Parameters:  pEntry - caller owned entry
+**              timeoutMs - timeout in milliseconds
+**              cb - callback invoked on expiry
+**              value - value passed to the callback
+**              runInline - run cb on the wheel thread, cb must not block
+**
+** Returns:     true if the timer is scheduled
+**
+*******************************************************************************/
+bool NfcHalTimerWheel::schedule(NfcHalTimerEntry_t* pEntry, uint32_t timeoutMs,
+                                NfcHalTimerCb_t cb, union sigval value,
+                                bool runInline) {
+  if (pEntry == NULL || cb == NULL) return false;
+
+  pthread_mutex_lock(&mLock);
+  if (!start()) {
+    pthread_mutex_unlock(&mLock);
+    return false;
+  }
+  unlink(pEntry);
+  pEntry->pCb = cb;
+  pEntry->tValue = value;
+  pEntry->bInline = runInline;
+  pEntry->qwExpiry = nowTicks(true) + timeoutMs;
+  if (pEntry->qwExpiry <= mTick) pEntry->qwExpiry = mTick + 1;
+  insert(pEntry);
+  if (mArmedTick == 0 || pEntry->qwExpiry < mArmedTick) arm(pEntry->qwExpiry);
+  pthread_mutex_unlock(&mLock);
+  return true;
+}
+
+/*******************************************************************************
+**
+** Function:    NfcHalTimerWheel::cancel()
+**
+** Description: Stops a pending timer, including one already expired but not
+**              yet picked up by the callback thread. A callback which is
+**              already running is not waited for, so a callback may cancel
+**              its own timer.
+**
+** Parameters:  pEntry - caller owned entry
+**
+** Returns:     true if a pending expiry was cancelled
+**
+*******************************************************************************/
+bool NfcHalTimerWheel::cancel(NfcHalTimerEntry_t* pEntry) {
+  if (pEntry == NULL) return false;
+
+  pthread_mutex_lock(&mLock);
+  bool wasPending = (pEntry->bList != kListNone);
+  unlink(pEntry);
+  pthread_mutex_unlock(&mLock);
+  return wasPending;
+}
+
+/*******************************************************************************
+**
+** Function:    NfcHalTimerWheel::wheelLoop()
+**
+** Description: Wheel thread body. Sleeps on the timerfd, advances the wheel
+**              and re-arms the timerfd for the next deadline.
+**
+** Returns:     none
+**
+*******************************************************************************/
+void NfcHalTimerWheel::wheelLoop() {
+  for (;;) {
+    uint64_t expirations;
+    ssize_t ret = read(mTimerFd, &expirations, sizeof(expirations));
+    if (ret < 0 && errno != EINTR && errno != EAGAIN) {
+      LOG(ERROR) << StringPrintf("%s: timerfd read failed, errno=%d", __func__,
+                                 errno);
+      return;
+    }
+    pthread_mutex_lock(&mLock);
+    mArmedTick = 0;
+    advance(nowTicks(false));
+    arm(nextDeadline());
+    pthread_mutex_unlock(&mLock);
+  }
+}
+
+/*******************************************************************************
+**
+** Function:    NfcHalTimerWheel::callbackLoop()
+**
+** Description: Callback thread body. Runs the callbacks of expired entries
+**              which were not scheduled inline. The thread exits when it
+**              runs out of entries while another one is idle.
+**
+** Returns:     none
+**
+*******************************************************************************/
+void NfcHalTimerWheel::callbackLoop() {
+  pthread_mutex_lock(&mLock);
+  for (;;) {
+    while (mCallbackQueue.pNext == &mCallbackQueue) {
+      if (mCallbackIdle != 0) {
+        mCallbackThreads--;
+        pthread_mutex_unlock(&mLock);
+        return;
+      }
+      mCallbackIdle++;
+      pthread_cond_wait(&mCallbackCond, &mLock);
+      mCallbackIdle--;
+    }
+    NfcHalTimerEntry_t* pEntry = mCallbackQueue.pNext;
+    unlink(pEntry);
+    NfcHalTimerCb_t cb = pEntry->pCb;
+    union sigval value = pEntry->tValue;
+    pthread_mutex_unlock(&mLock);
+    cb(value);
+    pthread_mutex_lock(&mLock);
+  }
+}
+
+void* NfcHalTimerWheel::wheelThread(void* arg) {
+  ((NfcHalTimerWheel*)arg)->wheelLoop();
+  return NULL;
+}
+
+void* NfcHalTimerWheel::callbackThread(void* arg) {
+  ((NfcHalTimerWheel*)arg)->callbackLoop();
+  return NULL;
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+
+/*
+ * Timer expiry callback. Same signature as a SIGEV_THREAD notify function so
+ * that existing POSIX timer callbacks can be scheduled unchanged.
+ */
+typedef void (*NfcHalTimerCb_t)(union sigval);
+
+/*
+ * Timer entry owned by the caller and linked intrusively into the wheel.
+ * Kept as a plain structure so that it can be embedded in C-style handles
+ * which are cleared with memset. An all-zero entry is an idle entry.
+ */
+typedef struct NfcHalTimerEntry {
+  struct NfcHalTimerEntry* pPrev;
+  struct NfcHalTimerEntry* pNext;
+  uint64_t qwExpiry;    /* absolute expiry in wheel ticks (ms) */
+  uint8_t bList;        /* list holding the entry, see NfcHalTimerWheel */
+  uint8_t bInline;      /* run callback on the wheel thread itself */
+  NfcHalTimerCb_t pCb;  /* callback invoked on expiry */
+  union sigval tValue;  /* value passed to the callback */
+} NfcHalTimerEntry_t;
+
+/*
+ * Single-thread hierarchical timer wheel driven by one timerfd on
+ * CLOCK_MONOTONIC. One tick is one millisecond; four levels of 64 slots cover
+ * ~4.6 hours, longer timeouts are parked on an overflow list and re-inserted
+ * when the top level wraps.
+ *
+ * Inline entries are expired on the wheel thread and must not block (the OSAL
+ * timers only post a message). Other entries are handed over to callback
+ * threads, so a callback waiting for an NCI response cannot hold back the
+ * expiry of the command timeout it is waiting on. A callback thread is
+ * started whenever an entry expires while none is idle, so a blocked callback
+ * does not hold back the others either; one idle thread is kept.
+ */
+class NfcHalTimerWheel {
+ public:
+  static NfcHalTimerWheel& getInstance();
+
+  bool schedule(NfcHalTimerEntry_t* pEntry, uint32_t timeoutMs,
+                NfcHalTimerCb_t cb, union sigval value, bool runInline);
+  bool cancel(NfcHalTimerEntry_t* pEntry);
+
+ private:
+  static constexpr uint32_t kSlotBits = 6;
+  static constexpr uint32_t kSlots = 1 << kSlotBits;
+  static constexpr uint32_t kSlotMask = kSlots - 1;
+  static constexpr uint32_t kLevels = 4;
+  /* bList values, 0 means the entry is not linked anywhere */
+  static constexpr uint8_t kListNone = 0;
+  static constexpr uint8_t kListOverflow = kLevels + 1;
+  static constexpr uint8_t kListCallback = kLevels + 2;
+
+  NfcHalTimerWheel();
+  ~NfcHalTimerWheel() = delete;
+  NfcHalTimerWheel(const NfcHalTimerWheel&) = delete;
+  NfcHalTimerWheel& operator=(const NfcHalTimerWheel&) = delete;
+
+  bool start();
+  bool startCallbackThread();
+  uint64_t nowTicks(bool roundUp);
+  void link(NfcHalTimerEntry_t* pHead, NfcHalTimerEntry_t* pEntry,
+            uint8_t list);
+  void unlink(NfcHalTimerEntry_t* pEntry);
+  void insert(NfcHalTimerEntry_t* pEntry);
+  void rehash(NfcHalTimerEntry_t* pHead);
+  void advance(uint64_t now);
+  void expire(NfcHalTimerEntry_t* pEntry);
+  uint64_t nextDeadline();
+  void arm(uint64_t tick);
+  void wheelLoop();
+  void callbackLoop();
+  static void* wheelThread(void* arg);
+  static void* callbackThread(void* arg);
+
+  pthread_mutex_t mLock;
+  pthread_cond_t mCallbackCond;
+  int mTimerFd;
+  bool mStarted;
+  pthread_t mWheelThread;
+  uint32_t mCallbackThreads; /* callback threads running */
+  uint32_t mCallbackIdle;    /* callback threads waiting for an entry */
+  uint32_t mCallbackQueued;  /* entries on the callback queue */
+  uint64_t mEpochNs;     /* CLOCK_MONOTONIC time of tick 0 */
+  uint64_t mTick;        /* last processed tick */
+  uint64_t mArmedTick;   /* tick the timerfd is armed for, 0 if disarmed */
+  uint32_t mPending;     /* entries in the wheel and on the overflow list */
+  uint32_t mLevelCount[kLevels];
+  NfcHalTimerEntry_t mSlots[kLevels][kSlots];
+  NfcHalTimerEntry_t mOverflow;
+  NfcHalTimerEntry_t mCallbackQueue;
+};
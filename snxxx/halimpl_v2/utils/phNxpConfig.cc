@@ -53,6 +53,7 @@
 #include <string>
 #include <vector>
 
+#include "phNxpConfigCache.h"
 #include "sparse_crc32.h"
 
 using std::list;
@@ -170,6 +171,25 @@ class CNfcParam : public string {
   unsigned long m_numValue;
 };
 
+/* Immutable, hash-indexed copy of the settings, swapped as a whole */
+class CNfcConfigIndex {
+ public:
+  explicit CNfcConfigIndex(const vector<const CNfcParam*>& params);
+
+  const CNfcParam* find(const char* p_name) const;
+
+ private:
+  static uint32_t hash(const char* p_name);
+
+  static constexpr uint16_t kEmptySlot = 0xFFFF;
+
+  vector<CNfcParam> m_params;
+  vector<uint32_t> m_hashes;
+  /* Open addressing, linear probing; indexes in m_params */
+  vector<uint16_t> m_slots;
+  uint32_t m_mask;
+};
+
 class CNfcConfig : public vector<const CNfcParam*> {
  public:
   static CNfcConfig& GetInstance();
@@ -178,11 +198,12 @@ class CNfcConfig : public vector<const CNfcParam*> {
 
   bool isModified(tNXP_CONF_FILE aType);
   void resetModified(tNXP_CONF_FILE aType);
+  uint32_t getConfigCrc32();
   bool getValue(const char* name, char* pValue, size_t len) const;
   bool getValue(const char* name, unsigned long& rValue) const;
   bool getValue(const char* name, unsigned short& rValue) const;
   bool getValue(const char* name, char* pValue, long len, long* readlen) const;
-  const CNfcParam* find(const char* p_name) const;
+  static std::shared_ptr<const CNfcConfigIndex> index();
   void readNciUpdateConfig(const char* fileName) const;
   void readNxpRFConfig(const char* fileName) const;
   void clean();
@@ -199,6 +220,7 @@ class CNfcConfig : public vector<const CNfcParam*> {
   void add(const CNfcParam* pParam);
   void dump();
   bool isAllowed(const char* name);
+  void publish();
 
   list<const CNfcParam*> m_list;
   mutable std::recursive_mutex m_config_mutex;
@@ -208,6 +230,8 @@ class CNfcConfig : public vector<const CNfcParam*> {
   // Use atomic flag for initialization check to avoid repeated work
   static std::mutex initialization_mutex;
   static std::atomic<bool> is_initialized;
+  // Settings seen by lookups, replaced on every (re)load
+  static std::shared_ptr<const CNfcConfigIndex> s_index;
 
   bool mValidFile;
   uint32_t config_crc32_;
@@ -225,6 +249,7 @@ class CNfcConfig : public vector<const CNfcParam*> {
 CNfcConfig* CNfcConfig::theInstance = nullptr;
 std::mutex CNfcConfig::initialization_mutex;
 std::atomic<bool> CNfcConfig::is_initialized{false};
+std::shared_ptr<const CNfcConfigIndex> CNfcConfig::s_index;
 
 /*******************************************************************************
 **
@@ -356,12 +381,14 @@ bool CNfcConfig::readConfig(const char* name, bool bResetContent) {
   state = BEGIN_LINE;
 
   ALOGD("readConfig; filename is %s", name);
+  const uint32_t crc32 =
+      sparse_crc32(0, (const void*)p_config, (int)config_size);
   if (strcmp(name, nxp_rf_config_path) == 0) {
-    config_rf_crc32_ = sparse_crc32(0, (const void*)p_config, (int)config_size);
+    config_rf_crc32_ = crc32;
   } else if (strcmp(name, nci_update_config_path) == 0) {
-    config_tr_crc32_ = sparse_crc32(0, (const void*)p_config, (int)config_size);
+    config_tr_crc32_ = crc32;
   } else {
-    config_crc32_ = sparse_crc32(0, (const void*)p_config, (int)config_size);
+    config_crc32_ = crc32;
   }
 
   mValidFile = true;
@@ -374,6 +401,24 @@ bool CNfcConfig::readConfig(const char* name, bool bResetContent) {
       moveToList();
   }
 
+  CNfcConfigCache& cache = CNfcConfigCache::getInstance();
+  if (cache.lookup(name, crc32, [this](const NfcConfigCacheParam_t& param) {
+        string paramName(param.pName, param.bNameLen);
+        if (param.pValue != nullptr) {
+          add(new CNfcParam(paramName.c_str(),
+                            string((const char*)param.pValue,
+                                   param.wValueLen)));
+        } else {
+          add(new CNfcParam(paramName.c_str(),
+                            (unsigned long)param.qwNumValue));
+        }
+      })) {
+    ALOGD("readConfig; %s loaded from cache", name);
+    moveFromList();
+    return size() > 0;
+  }
+
+  cache.beginFile(name, crc32);
   for (size_t offset = 0; offset != config_size; ++offset) {
     c = p_config[offset];
     switch (state & 0xff) {
@@ -481,6 +526,7 @@ bool CNfcConfig::readConfig(const char* name, bool bResetContent) {
           } else {
             pParam = new CNfcParam(token.c_str(), numValue);
           }
+          cache.addParam(token.c_str(), strValue, numValue);
           add(pParam);
           pParam = NULL;
           strValue.clear();
@@ -493,6 +539,7 @@ bool CNfcConfig::readConfig(const char* name, bool bResetContent) {
           strValue.push_back('\0');
           state = END_LINE;
           pParam = new CNfcParam(token.c_str(), strValue);
+          cache.addParam(token.c_str(), strValue, 0);
           add(pParam);
           pParam = NULL;
         } else if (isPrintable(c)) {
@@ -508,6 +555,7 @@ bool CNfcConfig::readConfig(const char* name, bool bResetContent) {
         break;
     }
   }
+  cache.endFile();
 
   moveFromList();
   return size() > 0;
@@ -562,12 +610,16 @@ CNfcConfig& CNfcConfig::GetInstance() {
       }
 
       if (theInstance->size() == 0 && theInstance->mValidFile) {
+        CNfcConfigCache& cache = CNfcConfigCache::getInstance();
+        cache.open();
         string strPath;
         if (alternative_config_path[0] != '\0') {
           strPath.assign(alternative_config_path);
           strPath += config_name;
           theInstance->readConfig(strPath.c_str(), true);
           if (!theInstance->empty()) {
+            cache.commit();
+            theInstance->publish();
             is_initialized.store(true);
             return *theInstance;
           }
@@ -592,7 +644,10 @@ CNfcConfig& CNfcConfig::GetInstance() {
         theInstance->readConfig(strPath.c_str(), true);
         theInstance->readNxpRFConfig(nxp_rf_config_path);
         theInstance->readNciUpdateConfig(nci_update_config_path);
+        cache.commit();
       }
+      // Lookups only ever see a completely loaded configuration
+      theInstance->publish();
       is_initialized.store(true);  // Mark as initialized
     }
   }
@@ -605,6 +660,7 @@ void CNfcConfig::DestroyCNfcConfig() {
     delete theInstance;
     theInstance = nullptr;
   }
+  std::atomic_store(&s_index, std::shared_ptr<const CNfcConfigIndex>());
   is_initialized.store(false);
 }
 /*******************************************************************************
@@ -618,15 +674,14 @@ void CNfcConfig::DestroyCNfcConfig() {
 **
 *******************************************************************************/
 bool CNfcConfig::getValue(const char* name, char* pValue, size_t len) const {
-  std::lock_guard<std::recursive_mutex> lock(m_config_mutex);
-
   if (!name || !pValue || len == 0) {
     ALOGE("%s Invalid parameters: name=%p, pValue=%p, len=%zu", __func__, name,
           pValue, len);
     return false;
   }
 
-  const CNfcParam* pParam = find(name);
+  std::shared_ptr<const CNfcConfigIndex> snapshot = index();
+  const CNfcParam* pParam = snapshot ? snapshot->find(name) : NULL;
   if (pParam == NULL) {
     ALOGE("%s Parameter %s not found", __func__, name);
     return false;
@@ -644,8 +699,6 @@ bool CNfcConfig::getValue(const char* name, char* pValue, size_t len) const {
 
 bool CNfcConfig::getValue(const char* name, char* pValue, long len,
                           long* readlen) const {
-  std::lock_guard<std::recursive_mutex> lock(m_config_mutex);
-
   if (!name || !pValue || !readlen || len <= 0) {
     ALOGE("%s Invalid parameters: name=%p, pValue=%p, readlen=%p, len=%ld",
           __func__, name, pValue, readlen, len);
@@ -653,7 +706,8 @@ bool CNfcConfig::getValue(const char* name, char* pValue, long len,
     return false;
   }
 
-  const CNfcParam* pParam = find(name);
+  std::shared_ptr<const CNfcConfigIndex> snapshot = index();
+  const CNfcParam* pParam = snapshot ? snapshot->find(name) : NULL;
   if (pParam == NULL) {
     *readlen = -1;
     return false;
@@ -684,13 +738,12 @@ bool CNfcConfig::getValue(const char* name, char* pValue, long len,
 **
 *******************************************************************************/
 bool CNfcConfig::getValue(const char* name, unsigned long& rValue) const {
-  std::lock_guard<std::recursive_mutex> lock(m_config_mutex);
-
   if (!name) {
     ALOGE("%s Invalid parameter: name is null", __func__);
     return false;
   }
-  const CNfcParam* pParam = find(name);
+  std::shared_ptr<const CNfcConfigIndex> snapshot = index();
+  const CNfcParam* pParam = snapshot ? snapshot->find(name) : NULL;
   if (pParam == NULL) return false;
 
   if (pParam->str_len() == 0) {
@@ -711,14 +764,13 @@ bool CNfcConfig::getValue(const char* name, unsigned long& rValue) const {
 **
 *******************************************************************************/
 bool CNfcConfig::getValue(const char* name, unsigned short& rValue) const {
-  std::lock_guard<std::recursive_mutex> lock(m_config_mutex);
-
   if (!name) {
     ALOGE("%s Invalid parameter: name is null", __func__);
     return false;
   }
 
-  const CNfcParam* pParam = find(name);
+  std::shared_ptr<const CNfcConfigIndex> snapshot = index();
+  const CNfcParam* pParam = snapshot ? snapshot->find(name) : NULL;
   if (pParam == NULL) return false;
 
   if (pParam->str_len() == 0) {
@@ -738,45 +790,115 @@ bool CNfcConfig::getValue(const char* name, unsigned short& rValue) const {
 
 /*******************************************************************************
 **
-** Function:    CNfcConfig::find()
+** Function:    CNfcConfig::index()
 **
-** Description: search if a setting exist in the setting array
+** Description: get the settings loaded last, lock free. The snapshot keeps
+**              its settings valid for as long as the caller holds it.
 **
-** Returns:     pointer to the setting object
+** Returns:     snapshot of the settings, null if none is loaded
+**
+*******************************************************************************/
+std::shared_ptr<const CNfcConfigIndex> CNfcConfig::index() {
+  std::shared_ptr<const CNfcConfigIndex> snapshot = std::atomic_load(&s_index);
+  if (!snapshot) {
+    /* Not loaded yet, or reset by resetNxpConfig() */
+    GetInstance();
+    snapshot = std::atomic_load(&s_index);
+  }
+  return snapshot;
+}
+
+/*******************************************************************************
+**
+** Function:    CNfcConfig::publish()
+**
+** Description: index the setting array and make it visible to lookups
+**
+** Returns:     none
 **
 *******************************************************************************/
-const CNfcParam* CNfcConfig::find(const char* p_name) const {
+void CNfcConfig::publish() {
   std::lock_guard<std::recursive_mutex> lock(m_config_mutex);
 
+  std::shared_ptr<const CNfcConfigIndex> snapshot =
+      std::make_shared<const CNfcConfigIndex>(*this);
+  std::atomic_store(&s_index, snapshot);
+}
+
+/*******************************************************************************
+**
+** Function:    CNfcConfigIndex::CNfcConfigIndex()
+**
+** Description: class constructor, copies and indexes the settings
+**
+** Returns:     none
+**
+*******************************************************************************/
+CNfcConfigIndex::CNfcConfigIndex(const vector<const CNfcParam*>& params)
+    : m_mask(0) {
+  m_params.reserve(params.size());
+  for (const CNfcParam* pParam : params) {
+    if (pParam && m_params.size() < kEmptySlot) m_params.push_back(*pParam);
+  }
+
+  /* At most half full, so that probes stay short */
+  size_t slots = 8;
+  while (slots < 2 * m_params.size()) slots <<= 1;
+  m_slots.assign(slots, kEmptySlot);
+  m_mask = (uint32_t)(slots - 1);
+  m_hashes.reserve(m_params.size());
+  for (size_t i = 0; i < m_params.size(); i++) {
+    uint32_t h = hash(m_params[i].c_str());
+    m_hashes.push_back(h);
+    uint32_t slot = h & m_mask;
+    while (m_slots[slot] != kEmptySlot) slot = (slot + 1) & m_mask;
+    m_slots[slot] = (uint16_t)i;
+  }
+}
+
+/*******************************************************************************
+**
+** Function:    CNfcConfigIndex::hash()
+**
+** Description: FNV-1a hash of a setting name
+**
+** Returns:     32 bit hash
+**
+*******************************************************************************/
+uint32_t CNfcConfigIndex::hash(const char* p_name) {
+  uint32_t h = 2166136261u;
+  while (*p_name) {
+    h ^= (uint8_t)*p_name++;
+    h *= 16777619u;
+  }
+  return h;
+}
+
+/*******************************************************************************
+**
+** Function:    CNfcConfigIndex::find()
+**
+** Description: search if a setting exist in the snapshot
+**
+** Returns:     pointer to the setting object
+**
+*******************************************************************************/
+const CNfcParam* CNfcConfigIndex::find(const char* p_name) const {
   if (!p_name) {
     ALOGE("%s Invalid parameter: p_name is null", __func__);
     return NULL;
   }
-
-  if (size() == 0) {
+  if (m_params.empty()) {
     ALOGE("%s No parameters loaded", __func__);
     return NULL;
   }
 
-  for (const_iterator it = begin(), itEnd = end(); it != itEnd; ++it) {
-    if (!*it) continue;
-
-    const char* param_name = (*it)->c_str();
-    if (!param_name) continue;
-
-    int cmp = strcmp(param_name, p_name);
-    if (cmp < 0) {
-      continue;
-    } else if (cmp == 0) {
-      if ((*it)->str_len() > 0) {
-        NXPLOG_NCIHAL_D("%s found %s=%s", __func__, p_name, (*it)->str_value());
-      } else {
-        NXPLOG_NCIHAL_D("%s found %s=(0x%lx)", __func__, p_name,
-                        (*it)->numValue());
-      }
-      return *it;
-    } else {
-      break;
+  uint32_t h = hash(p_name);
+  for (uint32_t slot = h & m_mask; m_slots[slot] != kEmptySlot;
+       slot = (slot + 1) & m_mask) {
+    uint16_t i = m_slots[slot];
+    if (m_hashes[i] == h && strcmp(m_params[i].c_str(), p_name) == 0) {
+      return &m_params[i];
     }
   }
   return NULL;
@@ -1063,6 +1185,12 @@ bool CNfcConfig::isModified(tNXP_CONF_FILE aType) {
   return (stored_crc32 != current_crc32);
 }
 
+uint32_t CNfcConfig::getConfigCrc32() {
+  std::lock_guard<std::recursive_mutex> lock(m_config_mutex);
+  const uint32_t crcs[] = {config_crc32_, config_rf_crc32_, config_tr_crc32_};
+  return sparse_crc32(0, (const void*)crcs, (int)sizeof(crcs));
+}
+
 void CNfcConfig::resetModified(tNXP_CONF_FILE aType) {
   std::lock_guard<std::recursive_mutex> lock(m_config_mutex);
 
@@ -1198,7 +1326,8 @@ void readOptionalConfig(const char* extra) {
     findConfigFilePathFromTransportConfigPaths(configName, strPath);
   }
 
-  CNfcConfig::GetInstance().readConfig(strPath.c_str(), false);
+  CNfcConfig& rConfig = CNfcConfig::GetInstance();
+  if (rConfig.readConfig(strPath.c_str(), false)) rConfig.publish();
 }
 
 /*******************************************************************************
@@ -1257,7 +1386,8 @@ extern "C" int GetNxpNumValue(const char* name, void* pValue,
     return 0;
   }
 
-  const CNfcParam* pParam = CNfcConfig::GetInstance().find(name);
+  std::shared_ptr<const CNfcConfigIndex> snapshot = CNfcConfig::index();
+  const CNfcParam* pParam = snapshot ? snapshot->find(name) : NULL;
   if (pParam == NULL) return 0;
 
   unsigned long v = pParam->numValue();
@@ -1402,6 +1532,19 @@ extern "C" int isNxpRFConfigModified() {
 
   return ret;
 }
+/*******************************************************************************
+**
+** Function:    getNxpConfigCrc32()
+**
+** Description: get a checksum of the NXP, RF and transit config files
+**
+** Returns:     combined crc32 of the loaded config files
+**
+*******************************************************************************/
+extern "C" uint32_t getNxpConfigCrc32() {
+  return CNfcConfig::GetInstance().getConfigCrc32();
+}
+
 /*******************************************************************************
 **
 ** Function:    updateNxpConfigTimestamp()
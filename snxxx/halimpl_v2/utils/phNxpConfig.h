@@ -39,6 +39,8 @@
 #ifndef __CONFIG_H
 #define __CONFIG_H
 
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -52,6 +54,7 @@ int isNxpRFConfigModified();
 int isNxpConfigModified();
 int updateNxpConfigTimestamp();
 int updateNxpRfConfigTimestamp();
+uint32_t getNxpConfigCrc32();
 void setNxpRfConfigPath(const char* name);
 void setNxpFwConfigPath();
 
@@ -157,6 +160,7 @@ extern char Fw_Lib_Path[256];
 #define NAME_NXP_ENABLE_DISABLE_LOGS "NXP_ENABLE_DISABLE_LOGS"
 #define NAME_NXP_RDR_DISABLE_ENABLE_LPCD "NXP_RDR_DISABLE_ENABLE_LPCD"
 #define NAME_NXP_TRANSPORT "NXP_TRANSPORT"
+#define NAME_NXP_I2C_FRAMED_READ "NXP_I2C_FRAMED_READ"
 #define NAME_NXP_GET_HW_INFO_LOG "NXP_GET_HW_INFO_LOG"
 #define NAME_NXP_ISO_DEP_MERGE_SAK "NXP_ISO_DEP_MERGE_SAK"
 #define NAME_NXP_T4T_NDEF_NFCEE_AID "NXP_T4T_NDEF_NFCEE_AID"
@@ -175,6 +179,8 @@ extern char Fw_Lib_Path[256];
   "NXP_NUMBER_OF_EXIT_FRAMES_SUPPORTED"
 #define NAME_NXP_OBSERVE_MODE_REQ_NOTIFICATION_TYPE \
   "NXP_OBSERVE_MODE_REQ_NOTIFICATION_TYPE"
+#define NAME_NXP_OBSERVE_MODE_POLLING_FRAME_BATCH_TIME \
+  "NXP_OBSERVE_MODE_POLLING_FRAME_BATCH_TIME"
 #define NAME_NXP_MIFARE_NACK_TO_RATS_ENABLE "NXP_MIFARE_NACK_TO_RATS_ENABLE"
 #define NAME_CONF_GPIO_CONTROL "CONF_GPIO_CONTROL"
 #define NAME_NXP_DEFAULT_ULPDET_MODE "NXP_DEFAULT_ULPDET_MODE"
@@ -186,6 +192,10 @@ extern char Fw_Lib_Path[256];
 #define default_storage_location "/data/vendor/nfc"
 #define NAME_NXP_AUTH_TIMEOUT_CFG "NXP_AUTH_TIMEOUT_CFG"
 #define NAME_NXP_REMOVAL_DETECTION_TIMEOUT "NXP_REMOVAL_DETECTION_TIMEOUT"
+#define NAME_NXP_CONN_CREDIT_FLOW_CONTROL "NXP_CONN_CREDIT_FLOW_CONTROL"
+#define NAME_NXP_HAL_EVENT_LOOP "NXP_HAL_EVENT_LOOP"
+#define NAME_NXP_TML_CAPTURE_FILE "NXP_TML_CAPTURE_FILE"
+#define NAME_NXP_LOCK_STATS "NXP_LOCK_STATS"
 #define NAME_NXP_CE_SUPPORT_IN_NFC_OFF_PHONE_OFF \
   "NXP_CE_SUPPORT_IN_NFC_OFF_PHONE_OFF"
 #define NAME_NXP_4K_FWDNLD_SUPPORT "NXP_4K_FWDNLD_SUPPORT"
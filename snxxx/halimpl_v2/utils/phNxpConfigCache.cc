@@ -0,0 +1,321 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "phNxpConfigCache.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <log/log.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "sparse_crc32.h"
+
+static const char config_cache_path[] =
+    "/data/vendor/nfc/libnfc-nxpConfigCache.bin";
+static const char config_cache_tmp_path[] =
+    "/data/vendor/nfc/libnfc-nxpConfigCache.tmp";
+
+#define CONFIG_CACHE_MAGIC 0x4746434E /* "NCFG" */
+#define CONFIG_CACHE_VERSION 1
+#define CONFIG_CACHE_MAX_SIZE (256 * 1024)
+
+/*
+ * Layout, native endianness:
+ *   header   magic, version, num sections, data length, data crc32 (u32)
+ *   section  path length (u16), path, file crc32 (u32), num params (u32),
+ *            params length (u32), params
+ *   param    name length (u8), name, is string (u8),
+ *            string: length (u16), bytes / number: value (u64)
+ */
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t numSections;
+  uint32_t dataLen;
+  uint32_t dataCrc;
+} CNfcConfigCacheHdr_t;
+
+namespace {
+template <typename T>
+bool get(const uint8_t* p, size_t len, size_t& i, T& v) {
+  if (i > len || len - i < sizeof(T)) return false;
+  memcpy(&v, p + i, sizeof(T));
+  i += sizeof(T);
+  return true;
+}
+
+template <typename T>
+void put(std::string& s, T v) {
+  s.append(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+}  // namespace
+
+CNfcConfigCache::CNfcConfigCache()
+    : mpMap(nullptr),
+      mMapLen(0),
+      mOpen(false),
+      mDirty(false),
+      mCurCount(0) {}
+
+CNfcConfigCache& CNfcConfigCache::getInstance() {
+  static CNfcConfigCache* sInstance = new CNfcConfigCache();
+  return *sInstance;
+}
+
+/*******************************************************************************
+**
+** Function:    CNfcConfigCache::open()
+**
+** Description: map the cache written by the previous load, if any
+**
+** Returns:     none
+**
+*******************************************************************************/
+void CNfcConfigCache::open() {
+  close();
+  mOpen = true;
+
+  int fd = ::open(config_cache_path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    ALOGD("%s no config cache", __func__);
+    return;
+  }
+  struct stat st;
+  if (fstat(fd, &st) == 0 && st.st_size > (off_t)sizeof(CNfcConfigCacheHdr_t) &&
+      st.st_size <= CONFIG_CACHE_MAX_SIZE) {
+    void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p != MAP_FAILED) {
+      mpMap = static_cast<const uint8_t*>(p);
+      mMapLen = st.st_size;
+    }
+  }
+  ::close(fd);
+
+  if (mpMap != nullptr && !validate()) {
+    ALOGE("%s config cache is corrupted", __func__);
+    munmap(const_cast<uint8_t*>(mpMap), mMapLen);
+    mpMap = nullptr;
+    mMapLen = 0;
+  }
+}
+
+bool CNfcConfigCache::validate() {
+  CNfcConfigCacheHdr_t hdr;
+  memcpy(&hdr, mpMap, sizeof(hdr));
+  if (hdr.magic != CONFIG_CACHE_MAGIC || hdr.version != CONFIG_CACHE_VERSION ||
+      hdr.dataLen != mMapLen - sizeof(hdr)) {
+    return false;
+  }
+  return sparse_crc32(0, mpMap + sizeof(hdr), (int)hdr.dataLen) == hdr.dataCrc;
+}
+
+/*******************************************************************************
+**
+** Function:    CNfcConfigCache::lookup()
+**
+** Description: replay the settings of a file from the cache
+**
+** Returns:     true if the file is cached with the same crc32
+**
+*******************************************************************************/
+bool CNfcConfigCache::lookup(
+    const char* path, uint32_t crc,
+    const std::function<void(const NfcConfigCacheParam_t&)>& onParam) {
+  if (!mOpen || mpMap == nullptr) return false;
+
+  const size_t pathLen = strlen(path);
+  size_t i = sizeof(CNfcConfigCacheHdr_t);
+  while (i < mMapLen) {
+    const size_t start = i;
+    uint16_t secPathLen;
+    uint32_t secCrc, count, paramsLen;
+    if (!get(mpMap, mMapLen, i, secPathLen) || mMapLen - i < secPathLen) {
+      return false;
+    }
+    const uint8_t* secPath = mpMap + i;
+    i += secPathLen;
+    if (!get(mpMap, mMapLen, i, secCrc) || !get(mpMap, mMapLen, i, count) ||
+        !get(mpMap, mMapLen, i, paramsLen) || mMapLen - i < paramsLen) {
+      return false;
+    }
+    const size_t end = i + paramsLen;
+    if (secPathLen != pathLen || memcmp(secPath, path, pathLen) != 0) {
+      i = end;
+      continue;
+    }
+    if (secCrc != crc) return false;
+
+    /* Walk the whole section before replaying any of it */
+    size_t j = i;
+    for (uint32_t n = 0; n < count; n++) {
+      uint8_t nameLen, isString;
+      uint16_t valueLen;
+      if (!get(mpMap, end, j, nameLen) || end - j < nameLen) return false;
+      j += nameLen;
+      if (!get(mpMap, end, j, isString)) return false;
+      if (isString) {
+        if (!get(mpMap, end, j, valueLen) || end - j < valueLen) return false;
+        j += valueLen;
+      } else if (end - j < sizeof(uint64_t)) {
+        return false;
+      } else {
+        j += sizeof(uint64_t);
+      }
+    }
+    if (j != end) return false;
+
+    for (uint32_t n = 0; n < count; n++) {
+      NfcConfigCacheParam_t param = {};
+      uint8_t isString;
+      get(mpMap, end, i, param.bNameLen);
+      param.pName = reinterpret_cast<const char*>(mpMap + i);
+      i += param.bNameLen;
+      get(mpMap, end, i, isString);
+      if (isString) {
+        get(mpMap, end, i, param.wValueLen);
+        param.pValue = mpMap + i;
+        i += param.wValueLen;
+      } else {
+        get(mpMap, end, i, param.qwNumValue);
+      }
+      onParam(param);
+    }
+    mHits[std::string(path)] = std::make_pair(start, end - start);
+    return true;
+  }
+  return false;
+}
+
+/*******************************************************************************
+**
+** Function:    CNfcConfigCache::beginFile()
+**
+** Description: start recording the settings of a parsed file
+**
+** Returns:     none
+**
+*******************************************************************************/
+void CNfcConfigCache::beginFile(const char* path, uint32_t crc) {
+  mCurSection.clear();
+  mCurCount = 0;
+  if (!mOpen) {
+    mCurPath.clear();
+    return;
+  }
+  mCurPath = path;
+  put<uint16_t>(mCurSection, (uint16_t)mCurPath.size());
+  mCurSection.append(mCurPath);
+  put<uint32_t>(mCurSection, crc);
+}
+
+void CNfcConfigCache::addParam(const char* name, const std::string& strValue,
+                               unsigned long numValue) {
+  if (mCurPath.empty()) return;
+  size_t nameLen = strlen(name);
+  if (nameLen > UINT8_MAX || strValue.size() > UINT16_MAX) {
+    /* Not representable, the file will be parsed every time */
+    mCurPath.clear();
+    return;
+  }
+  put<uint8_t>(mCurSection, (uint8_t)nameLen);
+  mCurSection.append(name, nameLen);
+  put<uint8_t>(mCurSection, strValue.empty() ? 0 : 1);
+  if (strValue.empty()) {
+    put<uint64_t>(mCurSection, numValue);
+  } else {
+    put<uint16_t>(mCurSection, (uint16_t)strValue.size());
+    mCurSection.append(strValue);
+  }
+  mCurCount++;
+}
+
+void CNfcConfigCache::endFile() {
+  if (!mCurPath.empty()) {
+    const size_t hdrLen = sizeof(uint16_t) + mCurPath.size() + sizeof(uint32_t);
+    std::string section = mCurSection.substr(0, hdrLen);
+    put<uint32_t>(section, mCurCount);
+    put<uint32_t>(section, (uint32_t)(mCurSection.size() - hdrLen));
+    section.append(mCurSection, hdrLen, std::string::npos);
+    mHits.erase(mCurPath);
+    mSections[mCurPath] = std::move(section);
+    mDirty = true;
+  }
+  mCurPath.clear();
+  mCurSection.clear();
+}
+
+/*******************************************************************************
+**
+** Function:    CNfcConfigCache::commit()
+**
+** Description: store the cache if a file had to be parsed, then unmap it
+**
+** Returns:     none
+**
+*******************************************************************************/
+void CNfcConfigCache::commit() {
+  if (mOpen && mDirty) {
+    /* mHits and mSections never hold the same path */
+    std::string data;
+    for (const auto& hit : mHits) {
+      data.append(reinterpret_cast<const char*>(mpMap) + hit.second.first,
+                  hit.second.second);
+    }
+    for (const auto& section : mSections) data.append(section.second);
+
+    CNfcConfigCacheHdr_t hdr = {
+        .magic = CONFIG_CACHE_MAGIC,
+        .version = CONFIG_CACHE_VERSION,
+        .numSections = (uint32_t)(mHits.size() + mSections.size()),
+        .dataLen = (uint32_t)data.size(),
+        .dataCrc = sparse_crc32(0, data.data(), (int)data.size())};
+
+    FILE* fd = fopen(config_cache_tmp_path, "wb");
+    if (fd == nullptr) {
+      ALOGE("%s Unable to open %s (errno=%d: %s)", __func__,
+            config_cache_tmp_path, errno, strerror(errno));
+    } else {
+      bool written = fwrite(&hdr, sizeof(hdr), 1, fd) == 1 &&
+                     fwrite(data.data(), data.size(), 1, fd) == 1 &&
+                     fflush(fd) == 0 && fsync(fileno(fd)) == 0;
+      fclose(fd);
+      if (!written || rename(config_cache_tmp_path, config_cache_path) != 0) {
+        ALOGE("%s Failed to store config cache (errno=%d: %s)", __func__,
+              errno, strerror(errno));
+        unlink(config_cache_tmp_path);
+      } else {
+        ALOGD("%s stored %u files", __func__, hdr.numSections);
+      }
+    }
+  }
+  close();
+}
+
+void CNfcConfigCache::close() {
+  if (mpMap != nullptr) munmap(const_cast<uint8_t*>(mpMap), mMapLen);
+  mpMap = nullptr;
+  mMapLen = 0;
+  mOpen = false;
+  mDirty = false;
+  mSections.clear();
+  mHits.clear();
+  mCurPath.clear();
+  mCurSection.clear();
+}
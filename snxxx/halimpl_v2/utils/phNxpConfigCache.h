@@ -0,0 +1,83 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+#include <map>
+#include <string>
+
+/*
+ * One setting as parsed from a config file. Only valid during the
+ * CNfcConfigCache::lookup() callback when read from the cache.
+ */
+typedef struct {
+  const char* pName;
+  uint8_t bNameLen;
+  const uint8_t* pValue; /* string/byte array value, null for numbers */
+  uint16_t wValueLen;
+  uint64_t qwNumValue;
+} NfcConfigCacheParam_t;
+
+/*
+ * Parsed settings of every config file, stored in /data/vendor/nfc so that
+ * a config file whose path and crc32 did not change since it was last parsed
+ * is replayed from the cache instead of being parsed again.
+ *
+ * The cache is mapped between open() and commit(), which rewrites it only if
+ * a file had to be parsed. Settings are replayed in file order, so that the
+ * caller merges them exactly as when parsing.
+ */
+class CNfcConfigCache {
+ public:
+  static CNfcConfigCache& getInstance();
+
+  void open();
+  void commit();
+
+  /* Calls onParam for each setting of the cached file, false if none */
+  bool lookup(const char* path, uint32_t crc,
+              const std::function<void(const NfcConfigCacheParam_t&)>& onParam);
+
+  /* Records the settings of a file parsed because lookup() failed */
+  void beginFile(const char* path, uint32_t crc);
+  void addParam(const char* name, const std::string& strValue,
+                unsigned long numValue);
+  void endFile();
+
+ private:
+  CNfcConfigCache();
+  ~CNfcConfigCache() = delete;
+  CNfcConfigCache(const CNfcConfigCache&) = delete;
+  CNfcConfigCache& operator=(const CNfcConfigCache&) = delete;
+
+  bool validate();
+  void close();
+
+  const uint8_t* mpMap;
+  size_t mMapLen;
+  bool mOpen;
+  bool mDirty;
+  /* Sections to write on commit(), by path: parsed ones, and mapped ones
+   * (offset, length) which were looked up */
+  std::map<std::string, std::string> mSections;
+  std::map<std::string, std::pair<size_t, size_t>> mHits;
+  std::string mCurPath;
+  std::string mCurSection;
+  uint32_t mCurCount;
+};
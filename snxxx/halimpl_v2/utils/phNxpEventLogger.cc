@@ -11,57 +11,77 @@
  ** See the License for the specific language governing permissions and
  ** limitations under the License.
  **
- ** Copyright 2022-2024 NXP
+ ** Copyright 2022-2025 NXP
  **
  */
 #include "phNxpEventLogger.h"
 
 #include <errno.h>
+#include <fcntl.h>
 #include <phNxpConfig.h>
 #include <phNxpLog.h>
+#include <stdio.h>
+#include <string.h>
 #include <sys/stat.h>
-#include <sys/time.h>
 #include <unistd.h>
 
-#include <fstream>
-#include <iomanip>
+#include "NxpNfcHexCodec.h"
 
 #define TIMESTAMP_BUFFER_SIZE 64
+#define ROTATED_LOG_SUFFIX ".1"
+
+static const char kSMBLogFilePath[] = "/data/vendor/nfc/NxpNfcSmbLogDump.txt";
+static const char kDPDEventFilePath[] = "/data/vendor/nfc/debug/DPD_debug.txt";
+
+PhNxpEventLogger::PhNxpEventLogger()
+    : logging_enabled_(false),
+      max_file_size_(kDefaultMaxFileSize),
+      smb_log_{kSMBLogFilePath, false, -1, 0, std::string()},
+      dpd_log_{kDPDEventFilePath, false, -1, 0, std::string()},
+      running_(false),
+      stop_(false),
+      head_(0),
+      tail_(0),
+      dropped_(0),
+      cached_sec_(-1),
+      cached_time_() {}
 
-PhNxpEventLogger::PhNxpEventLogger() { logging_enabled_ = false; }
 PhNxpEventLogger& PhNxpEventLogger::GetInstance() {
   static PhNxpEventLogger nxp_event_logger_;
   return nxp_event_logger_;
 }
 
-// Helper function to get current timestamp of the
-// device in [MM:DD HH:MIN:SEC:MSEC] format
-
-static void GetCurrentTimestamp(char* timestamp) {
-  struct timespec tv;
-  clock_gettime(CLOCK_REALTIME, &tv);
-  time_t rawtime = tv.tv_sec;
-  struct tm* timeinfo;
-  char buffer[TIMESTAMP_BUFFER_SIZE];
-
-  timeinfo = localtime(&rawtime);
-  // Need to calculate milliseconds separately as timeinfo doesn't
-  // have milliseconds field
-  int milliseconds = tv.tv_nsec / 1000000;
+bool PhNxpEventLogger::OpenFile(LogFile& file, bool truncate) {
+  int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (truncate ? O_TRUNC : O_APPEND);
+  file.fd = open(file.path, flags, 0666);
+  if (file.fd < 0) {
+    NXPLOG_NCIHAL_D("EventLogger: Log file %s couldn't be opened! errno: %d",
+                    file.path, errno);
+    return false;
+  }
+  struct stat st;
+  file.size = (fstat(file.fd, &st) == 0) ? st.st_size : 0;
+  return true;
+}
 
-  strftime(buffer, sizeof(buffer), "%m-%d %H:%M:%S", timeinfo);
-  sprintf(timestamp, "[%s.%03d]:", buffer, milliseconds);
+void PhNxpEventLogger::CloseFile(LogFile& file) {
+  if (file.fd >= 0) close(file.fd);
+  file.fd = -1;
+  file.size = 0;
+  file.batch.clear();
 }
 
 void PhNxpEventLogger::Initialize() {
   NXPLOG_NCIHAL_D("EventLogger: init");
-  dpd_logFile_.open(kDPDEventFilePath, std::ofstream::out |
-                                           std::ofstream::binary |
-                                           std::ofstream::app);
-  if (dpd_logFile_.fail()) {
-    NXPLOG_NCIHAL_D("EventLogger: Log file %s couldn't be opened! %d",
-                    kDPDEventFilePath, errno);
-  } else {
+  Finalize();
+
+  unsigned long value = 0;
+  max_file_size_ = kDefaultMaxFileSize;
+  if (GetNxpNumValue(NAME_NXP_EVENT_LOG_MAX_SIZE, &value, sizeof(value))) {
+    max_file_size_ = value;  // 0: no rotation
+  }
+
+  if (OpenFile(dpd_log_, false)) {
     mode_t permissions = 0744;  // rwxr--r--
     if (chmod(kDPDEventFilePath, permissions) == -1) {
       NXPLOG_NCIHAL_D("EventLogger: chmod failed on %s errno: %d",
@@ -69,63 +89,157 @@ void PhNxpEventLogger::Initialize() {
     }
   }
 
-  unsigned long value = 0;
+  value = 0;
+  logging_enabled_ = false;
   if (GetNxpNumValue(NAME_NXP_SMBLOG_ENABLED, &value, sizeof(value))) {
     logging_enabled_ = (value == 1) ? true : false;
   }
-  if (!logging_enabled_) return;
+  if (logging_enabled_) OpenFile(smb_log_, false);
 
-  smb_logFile_.open(kSMBLogFilePath, std::ofstream::out |
-                                         std::ofstream::binary |
-                                         std::ofstream::app);
-  if (smb_logFile_.fail()) {
-    NXPLOG_NCIHAL_D("EventLogger: Log file %s couldn't be opened! errno: %d",
-                    kSMBLogFilePath, errno);
-  }
+  if (dpd_log_.fd < 0 && smb_log_.fd < 0) return;
+  std::lock_guard<std::mutex> lock(lock_);
+  dpd_log_.opened = (dpd_log_.fd >= 0);
+  smb_log_.opened = (smb_log_.fd >= 0);
+  stop_ = false;
+  running_ = true;
+  writer_ = std::thread(&PhNxpEventLogger::WriterLoop, this);
 }
+
 void PhNxpEventLogger::Log(uint8_t* p_ntf, uint16_t p_len, LogEventType event) {
   NXPLOG_NCIHAL_D("EventLogger: event is %d", static_cast<int>(event));
+  LogFile* p_file;
   switch (event) {
     case LogEventType::kLogSMBEvent:
       if (!logging_enabled_) return;
-      if (smb_logFile_.is_open()) {
-        while (p_len) {
-          smb_logFile_ << std::setfill('0') << std::hex << std::uppercase
-                       << std::setw(2) << (0xFF & *p_ntf);
-          ++p_ntf;
-          --p_len;
-        }
-        smb_logFile_ << std::endl;
-      } else {
-        NXPLOG_NCIHAL_D("EventLogger: Log file %s is not opened",
-                        kSMBLogFilePath);
-      }
+      p_file = &smb_log_;
       break;
     case LogEventType::kLogDPDEvent:
-      if (dpd_logFile_.is_open()) {
-        char timestamp[TIMESTAMP_BUFFER_SIZE];
-        memset(timestamp, 0, TIMESTAMP_BUFFER_SIZE);
-        GetCurrentTimestamp(timestamp);
-        dpd_logFile_ << timestamp;
-        while (p_len) {
-          dpd_logFile_ << std::setfill('0') << std::hex << std::uppercase
-                       << std::setw(2) << (0xFF & *p_ntf);
-          ++p_ntf;
-          --p_len;
-        }
-        dpd_logFile_ << std::endl;
-      } else {
-        NXPLOG_NCIHAL_D("EventLogger: Log file %s is not opened",
-                        kDPDEventFilePath);
-      }
+      p_file = &dpd_log_;
       break;
     default:
       NXPLOG_NCIHAL_D("EventLogger: Invalid destination");
+      return;
+  }
+
+  bool wake;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    if (!running_ || !p_file->opened) {
+      NXPLOG_NCIHAL_D("EventLogger: Log file %s is not opened", p_file->path);
+      return;
+    }
+    if (head_ - tail_ == kQueueSize) {
+      dropped_++;
+      return;
+    }
+    Event& entry = queue_[head_ % kQueueSize];
+    entry.type = event;
+    entry.len = (p_len < kMaxEventLen) ? p_len : kMaxEventLen;
+    clock_gettime(CLOCK_REALTIME, &entry.time);
+    memcpy(entry.data, p_ntf, entry.len);
+    // Otherwise the writer thread is busy and checks again before waiting
+    wake = (head_++ == tail_);
+  }
+  if (wake) cond_.notify_one();
+}
+
+// Appends the event to the batch of its file, DPD events are prefixed with
+// the time in [MM-DD HH:MIN:SEC.MSEC]: format
+void PhNxpEventLogger::Format(const Event& event) {
+  LogFile& file =
+      (event.type == LogEventType::kLogSMBEvent) ? smb_log_ : dpd_log_;
+  if (event.type == LogEventType::kLogDPDEvent) {
+    if (event.time.tv_sec != cached_sec_) {
+      struct tm timeinfo;
+      time_t rawtime = event.time.tv_sec;
+      localtime_r(&rawtime, &timeinfo);
+      strftime(cached_time_, sizeof(cached_time_), "%m-%d %H:%M:%S",
+               &timeinfo);
+      cached_sec_ = event.time.tv_sec;
+    }
+    // Need to calculate milliseconds separately as timeinfo doesn't
+    // have milliseconds field
+    char timestamp[TIMESTAMP_BUFFER_SIZE];
+    int len = snprintf(timestamp, sizeof(timestamp), "[%s.%03d]:",
+                       cached_time_, (int)(event.time.tv_nsec / 1000000));
+    file.batch.append(timestamp, len);
+  }
+  size_t pos = file.batch.size();
+  file.batch.resize(pos + event.len * 2 + 1);
+  phNxpNciHal_hexEncode(event.data, event.len, &file.batch[pos]);
+  file.batch[pos + event.len * 2] = '\n';
+}
+
+void PhNxpEventLogger::WriteBatch(LogFile& file) {
+  if (file.batch.empty() || file.fd < 0) return;
+
+  if (max_file_size_ > 0 && file.size > 0 &&
+      file.size + file.batch.size() > max_file_size_) {
+    std::string rotated = std::string(file.path) + ROTATED_LOG_SUFFIX;
+    close(file.fd);
+    if (rename(file.path, rotated.c_str()) != 0) {
+      NXPLOG_NCIHAL_E("EventLogger: rotation of %s failed errno: %d",
+                      file.path, errno);
+    }
+    if (!OpenFile(file, true)) {
+      file.batch.clear();
+      return;
+    }
+  }
+
+  size_t done = 0;
+  while (done < file.batch.size()) {
+    ssize_t ret = write(file.fd, file.batch.data() + done,
+                        file.batch.size() - done);
+    if (ret < 0 && errno == EINTR) continue;
+    if (ret <= 0) {
+      NXPLOG_NCIHAL_E("EventLogger: write to %s failed errno: %d", file.path,
+                      errno);
+      break;
+    }
+    done += ret;
+  }
+  file.size += done;
+  file.batch.clear();
+}
+
+void PhNxpEventLogger::WriterLoop() {
+  std::unique_lock<std::mutex> lock(lock_);
+  for (;;) {
+    cond_.wait(lock, [this] { return stop_ || head_ != tail_; });
+    if (head_ == tail_) break;  // stop_ and drained
+
+    // Producers only fill slots outside [tail_, head_)
+    const size_t head = head_;
+    const size_t dropped = dropped_;
+    dropped_ = 0;
+    lock.unlock();
+
+    for (size_t i = tail_; i != head; i++) Format(queue_[i % kQueueSize]);
+    if (dropped > 0) {
+      NXPLOG_NCIHAL_W("EventLogger: %zu events dropped, queue full", dropped);
+    }
+    WriteBatch(smb_log_);
+    WriteBatch(dpd_log_);
+
+    lock.lock();
+    tail_ = head;
   }
 }
 
 void PhNxpEventLogger::Finalize() {
   NXPLOG_NCIHAL_D("EventLogger: closing the Log file");
-  if (dpd_logFile_.is_open()) dpd_logFile_.close();
-  if (smb_logFile_.is_open()) smb_logFile_.close();
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    stop_ = true;
+    running_ = false;
+    dpd_log_.opened = false;
+    smb_log_.opened = false;
+  }
+  if (writer_.joinable()) {
+    cond_.notify_one();
+    writer_.join();
+  }
+  CloseFile(dpd_log_);
+  CloseFile(smb_log_);
 }
@@ -16,7 +16,14 @@
  */
 #pragma once
 
-#include <fstream>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
 
 #define ESE_CONNECTIVITY_PACKET 0x96
 #define EUICC_CONNECTIVITY_PACKET 0xAB
@@ -27,6 +34,11 @@ enum class LogEventType : uint8_t { kLogSMBEvent = 0, kLogDPDEvent };
 // Store NTF/Event to filesystem under /data
 // Currently being used to store SMB debug ntf and eSE DPD
 // monitor events
+//
+// Log() only copies the event to a preallocated queue, a writer thread
+// formats the queued events and appends them with one write() per file.
+// A file reaching NXP_EVENT_LOG_MAX_SIZE bytes is renamed with a ".1"
+// suffix, replacing the previous one, and a new file is started.
 
 class PhNxpEventLogger {
  public:
@@ -36,22 +48,62 @@ class PhNxpEventLogger {
   // Get singleton instance of EventLogger.
   static PhNxpEventLogger& GetInstance();
 
-  // Open  output file(s) for logging.
+  // Open  output file(s) for logging and start the writer thread.
   void Initialize();
 
-  // Write ntf/event to respective logfile.
+  // Queue ntf/event for its respective logfile.
   //   Event Type SMB: write SMB ntf to SMB logfile
   //   Event Type DPD: write DPD events DPD logfile
+  // Events are dropped, and counted, while the queue is full.
   void Log(uint8_t* p_ntf, uint16_t p_len, LogEventType event);
 
-  // Close opened file(s).
+  // Write the queued events, stop the writer thread and close opened file(s).
   void Finalize();
 
  private:
+  static constexpr size_t kQueueSize = 64;
+  static constexpr uint16_t kMaxEventLen = 300;
+  static constexpr size_t kDefaultMaxFileSize = 1024 * 1024;
+
+  struct Event {
+    LogEventType type;
+    uint16_t len;
+    struct timespec time;  // CLOCK_REALTIME
+    uint8_t data[kMaxEventLen];
+  };
+
+  struct LogFile {
+    const char* path;
+    bool opened;  // accepts events, guarded by lock_
+    int fd;
+    size_t size;
+    std::string batch;  // writer thread only
+  };
+
   PhNxpEventLogger();
+  bool OpenFile(LogFile& file, bool truncate);
+  void CloseFile(LogFile& file);
+  void WriteBatch(LogFile& file);
+  void Format(const Event& event);
+  void WriterLoop();
+
   bool logging_enabled_;
-  std::ofstream smb_logFile_;
-  std::ofstream dpd_logFile_;
-  const char* kSMBLogFilePath = "/data/vendor/nfc/NxpNfcSmbLogDump.txt";
-  const char* kDPDEventFilePath = "/data/vendor/nfc/debug/DPD_debug.txt";
+  size_t max_file_size_;
+  LogFile smb_log_;
+  LogFile dpd_log_;
+
+  std::mutex lock_;
+  std::condition_variable cond_;
+  std::thread writer_;
+  bool running_;
+  bool stop_;
+  // Events [tail_, head_) are queued, modulo kQueueSize
+  Event queue_[kQueueSize];
+  size_t head_;
+  size_t tail_;
+  size_t dropped_;
+
+  // Timestamp prefix of the last formatted second, writer thread only
+  time_t cached_sec_;
+  char cached_time_[32];
 };
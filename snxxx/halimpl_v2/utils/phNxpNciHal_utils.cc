@@ -21,18 +21,17 @@
 #include <phNxpLog.h>
 #include <phNxpNciHal.h>
 #include <phNxpNciHal_utils.h>
+#include <phTmlNfc_Capture.h>
 #include <pthread.h>
 
-#include <iomanip>
-#include <sstream>
+#include <string>
 
 #include "NfcExtension.h"
+#include "NxpNfcHexCodec.h"
+#include "NxpNfcNciTrace.h"
 #include "ObserveMode.h"
 #include "phNxpNciHal_extOperations.h"
 
-#define ASCII_OFFSET_NUM 48
-#define ASCII_OFFSET_CHAR 55
-
 extern phNxpNciHal_Control_t nxpncihal_ctrl;
 extern bool_t phNxpLog_isLxLoggingEnabled();
 /*********************** Link list functions **********************************/
@@ -455,7 +454,9 @@ void phNxpNciHal_releaseall_cb_data(void) {
 **
 ** Function         phNxpNciHal_print_packet
 **
-** Description      Print packet
+** Description      Print packet. Recorded in the NCI trace of the calling
+**                  thread and logged by its formatter thread, or formatted
+**                  and logged inline if the trace is not available.
 **
 ** Returns          None
 **
@@ -464,55 +465,73 @@ void phNxpNciHal_print_packet(const char* pString, const uint8_t* p_data,
                               uint16_t len, bool isNxpAvcNciPrint) {
   tNFC_printType printType = getPrintType(pString);
   if (printType == PRINT_UNKNOWN) return;  // logging is disabled
-  uint32_t i;
-  char* print_buffer = (char*)calloc((len * 3 + 1), sizeof(char));
+  if (NfcHalNciTrace::getInstance().record(printType, p_data, len,
+                                           isNxpAvcNciPrint)) {
+    return;
+  }
+  char* print_buffer = (char*)calloc((len * 2 + 1), sizeof(char));
   if (NULL != print_buffer) {
-    for (i = 0; i < len; i++) {
-      snprintf(&print_buffer[i * 2], 3, "%02X", p_data[i]);
-    }
-    switch (printType) {
-      case PRINT_SEND: {
-        if (isNxpAvcNciPrint) {
-          NXPAVCLOG_NCIX_I("len = %3d > %s", len, print_buffer);
-        } else {
-          NXPLOG_NCIX_I("len = %3d > %s", len, print_buffer);
-        }
-        break;
+    phNxpNciHal_hexEncode(p_data, len, print_buffer);
+    phNxpNciHal_log_packet(printType, p_data, len, print_buffer,
+                           isNxpAvcNciPrint);
+    free(print_buffer);
+  } else {
+    NXPLOG_NCIX_E("\nphNxpNciHal_print_packet:Failed to Allocate memory\n");
+  }
+  return;
+}
+
+/*******************************************************************************
+**
+** Function         phNxpNciHal_log_packet
+**
+** Description      Log a packet already formatted as hex string
+**
+** Returns          None
+**
+*******************************************************************************/
+void phNxpNciHal_log_packet(tNFC_printType printType, const uint8_t* p_data,
+                            uint16_t len, const char* print_buffer,
+                            bool isNxpAvcNciPrint) {
+  switch (printType) {
+    case PRINT_SEND: {
+      if (isNxpAvcNciPrint) {
+        NXPAVCLOG_NCIX_I("len = %3d > %s", len, print_buffer);
+      } else {
+        NXPLOG_NCIX_I("len = %3d > %s", len, print_buffer);
       }
-      case PRINT_RECV: {
+      break;
+    }
+    case PRINT_RECV: {
 #if (NXP_DEBUG_LOG == TRUE)
-        if (isNxpAvcNciPrint) {
-          NXPAVCLOG_NCIR_I("len = %3d > %s", len, print_buffer);
-        } else {
-          NXPLOG_NCIR_I("len = %3d > %s", len, print_buffer);
-        }
-        break;
+      (void)p_data;
+      if (isNxpAvcNciPrint) {
+        NXPAVCLOG_NCIR_I("len = %3d > %s", len, print_buffer);
+      } else {
+        NXPLOG_NCIR_I("len = %3d > %s", len, print_buffer);
+      }
+      break;
 #else
-        if (!phNxpLog_isLxLoggingEnabled() && len >= NCI_MSG_LEN_INDEX &&
-            p_data[NCI_GID_INDEX] == NCI_PROP_NTF_GID &&
-            p_data[NCI_OID_INDEX] == NCI_PROP_LX_NTF_OID) {
-          break;
-        }
-        if (isNxpAvcNciPrint) {
-          NXPAVCLOG_NCIR_I("len = %3d > %s", len, print_buffer);
-        } else {
-          NXPLOG_NCIR_I("len = %3d > %s", len, print_buffer);
-        }
+      if (!phNxpLog_isLxLoggingEnabled() && len >= NCI_MSG_LEN_INDEX &&
+          p_data[NCI_GID_INDEX] == NCI_PROP_NTF_GID &&
+          p_data[NCI_OID_INDEX] == NCI_PROP_LX_NTF_OID) {
         break;
-#endif
       }
-      case PRINT_DEBUG:
-        NXPLOG_NCIHAL_D(" Debug Info > len = %3d > %s", len, print_buffer);
-        break;
-      default:
-        // Nothing to do
-        break;
+      if (isNxpAvcNciPrint) {
+        NXPAVCLOG_NCIR_I("len = %3d > %s", len, print_buffer);
+      } else {
+        NXPLOG_NCIR_I("len = %3d > %s", len, print_buffer);
+      }
+      break;
+#endif
     }
-    free(print_buffer);
-  } else {
-    NXPLOG_NCIX_E("\nphNxpNciHal_print_packet:Failed to Allocate memory\n");
+    case PRINT_DEBUG:
+      NXPLOG_NCIHAL_D(" Debug Info > len = %3d > %s", len, print_buffer);
+      break;
+    default:
+      // Nothing to do
+      break;
   }
-  return;
 }
 
 /******************************************************************************
@@ -532,27 +551,8 @@ void phNxpNciHal_StringToHex(const char* str, size_t len, char* hex) {
     return;
   }
   memset(hex, 0, (len / 2));
-  // Convert from string to hexadecimal format
-  for (size_t i = 0; i < len; i += 2) {
-    uint8_t temp = 0x00;
-    // 1st Nibble of byte
-    if (str[i] >= '0' && str[i] <= '9') {
-      temp = (char(str[i]) - ASCII_OFFSET_NUM) << 4;
-    } else if (toupper(str[i]) >= 'A' && toupper(str[i]) <= 'F') {
-      temp = (char(toupper(str[i])) - ASCII_OFFSET_CHAR) << 4;
-    } else {
-      return;
-    }
-    // 2nd Nibble of byte
-    if (str[i + 1] >= '0' && str[i + 1] <= '9') {
-      temp = temp | (char(str[i + 1]) - ASCII_OFFSET_NUM);
-    } else if (toupper(str[i + 1]) >= 'A' && toupper(str[i + 1]) <= 'F') {
-      temp = temp | (char(toupper(str[i + 1])) - ASCII_OFFSET_CHAR);
-    } else {
-      return;
-    }
-    hex[i / 2] = temp;
-  }
+  // Convert from string to hexadecimal format, up to the first invalid digit
+  phNxpNciHal_hexDecode(str, len, (uint8_t*)hex);
   return;
 }
 
@@ -568,13 +568,11 @@ void phNxpNciHal_StringToHex(const char* str, size_t len, char* hex) {
  *
  ******************************************************************************/
 std::string phNxpNciHal_HexToString(const uint8_t* hex, size_t len) {
-  std::stringstream ss;
   // Convert to character
-  for (size_t i = 0; i < len; i++) {
-    ss << std::setfill('0') << std::hex << std::uppercase << std::setw(2)
-       << (0xFF & hex[i]);
-  }
-  return ss.str();
+  std::string str(len * 2 + 1, '\0');
+  phNxpNciHal_hexEncode(hex, len, &str[0]);
+  str.resize(len * 2);
+  return str;
 }
 
 /*******************************************************************************
@@ -626,12 +624,16 @@ void phNxpNciHal_emergency_recovery(uint8_t status) {
       phNxpNciHal_decodeGpioStatus();
       NXPLOG_NCIHAL_E("abort()");
       phNxpExtn_HandleHalEvent(NFCC_HAL_FATAL_ERR_CODE);
+      NfcHalNciTrace::getInstance().flush();
+      phTmlNfc_CaptureFlush();
       abort();
     }
     case CORE_RESET_TRIGGER_TYPE_FW_ASSERT: {
       phNxpExtn_HandleHalEvent(NFCC_HAL_ASSERT_ERR_CODE);
       phNxpNciHal_decodeGpioStatus();
       NXPLOG_NCIHAL_E("abort()");
+      NfcHalNciTrace::getInstance().flush();
+      phTmlNfc_CaptureFlush();
       abort();
     } break;
     case CORE_RESET_TRIGGER_TYPE_POWERED_ON: {
@@ -640,6 +642,8 @@ void phNxpNciHal_emergency_recovery(uint8_t status) {
         phNxpNciHal_decodeGpioStatus();
         NXPLOG_NCIHAL_E("abort()");
         phNxpExtn_HandleHalEvent(NFCC_HAL_FATAL_ERR_CODE);
+        NfcHalNciTrace::getInstance().flush();
+        phTmlNfc_CaptureFlush();
         abort();
       }
     } break;
@@ -25,6 +25,8 @@
 #include <pthread.h>
 #include <semaphore.h>
 
+#include "NxpNfcLockStats.h"
+
 /********************* Definitions and structures *****************************/
 
 /* List structures */
@@ -100,6 +102,9 @@ void phNxpNciHal_cleanup_cb_data(phNxpNciHal_Sem_t* pCallbackData);
 void phNxpNciHal_releaseall_cb_data(void);
 void phNxpNciHal_print_packet(const char* pString, const uint8_t* p_data,
                               uint16_t len, bool isNxpAvcNciPrint = false);
+void phNxpNciHal_log_packet(tNFC_printType printType, const uint8_t* p_data,
+                            uint16_t len, const char* print_buffer,
+                            bool isNxpAvcNciPrint);
 void phNxpNciHal_emergency_recovery(uint8_t status);
 tNFC_printType getPrintType(const char* pString);
 void phNxpNciHal_Memcpy(void* pDest, size_t destSize, const void* pSrc,
@@ -110,17 +115,24 @@ void phNxpNciHal_StringToHex(const char* str, size_t len, char* hex);
 
 /* Lock unlock helper macros */
 /* Lock unlock helper macros */
-#define REENTRANCE_LOCK()        \
-  if (phNxpNciHal_get_monitor()) \
-  pthread_mutex_lock(&phNxpNciHal_get_monitor()->reentrance_mutex)
-#define REENTRANCE_UNLOCK()      \
-  if (phNxpNciHal_get_monitor()) \
-  pthread_mutex_unlock(&phNxpNciHal_get_monitor()->reentrance_mutex)
-#define CONCURRENCY_LOCK()       \
-  if (phNxpNciHal_get_monitor()) \
-  pthread_mutex_lock(&phNxpNciHal_get_monitor()->concurrency_mutex)
-#define CONCURRENCY_UNLOCK()     \
-  if (phNxpNciHal_get_monitor()) \
-  pthread_mutex_unlock(&phNxpNciHal_get_monitor()->concurrency_mutex)
+/* Wait and hold times are recorded by NfcHalLockStats if enabled */
+#define REENTRANCE_LOCK()                                         \
+  if (phNxpNciHal_get_monitor())                                  \
+  NfcHalLockStats::getInstance(NFC_HAL_LOCK_REENTRANCE)           \
+      .lock(&phNxpNciHal_get_monitor()->reentrance_mutex, __func__, \
+            __LINE__)
+#define REENTRANCE_UNLOCK()                             \
+  if (phNxpNciHal_get_monitor())                        \
+  NfcHalLockStats::getInstance(NFC_HAL_LOCK_REENTRANCE) \
+      .unlock(&phNxpNciHal_get_monitor()->reentrance_mutex)
+#define CONCURRENCY_LOCK()                                         \
+  if (phNxpNciHal_get_monitor())                                   \
+  NfcHalLockStats::getInstance(NFC_HAL_LOCK_CONCURRENCY)           \
+      .lock(&phNxpNciHal_get_monitor()->concurrency_mutex, __func__, \
+            __LINE__)
+#define CONCURRENCY_UNLOCK()                             \
+  if (phNxpNciHal_get_monitor())                         \
+  NfcHalLockStats::getInstance(NFC_HAL_LOCK_CONCURRENCY) \
+      .unlock(&phNxpNciHal_get_monitor()->concurrency_mutex)
 
 #endif /* _PHNXPNCIHAL_UTILS_H_ */
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <android-base/file.h>
+#include <benchmark/benchmark.h>
+#include <ftw.h>
+#include <phNxpConfig.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+/* Directory searched for the gen-config files instead of the benchmark
+ * directory, e.g. the source tree */
+#define CONF_DIR_ENV "NXP_NFC_BENCHMARK_CONF_DIR"
+
+/* Shipped libnfc-nxp gen-config files, installed with the benchmark */
+static std::vector<std::string> sConfFiles;
+
+static int collectConfFile(const char* path, const struct stat* /* sb */,
+                           int type, struct FTW* ftw) {
+  std::string file(path);
+  if (type == FTW_F && file.find("/gen-config-files/") != std::string::npos &&
+      file.compare(ftw->base, 10, "libnfc-nxp") == 0 &&
+      file.size() > 5 && file.compare(file.size() - 5, 5, ".conf") == 0) {
+    sConfFiles.push_back(file);
+  }
+  return 0;
+}
+
+/*
+ * Full load of a config file: the file is read as RF config, the other
+ * config files do not exist on a host. The config cache cannot be written
+ * on a host either, so every load parses the file.
+ */
+static void BM_ConfigRead(benchmark::State& state, const std::string& path) {
+  unsigned long value = 0;
+  setNxpRfConfigPath(path.c_str());
+  for (auto _ : state) {
+    state.PauseTiming();
+    resetNxpConfig();
+    state.ResumeTiming();
+    /* The first lookup loads the config */
+    benchmark::DoNotOptimize(GetNxpNumValue(NAME_NXP_SET_CONFIG_ALWAYS, &value,
+                                            sizeof(value)));
+  }
+  resetNxpConfig();
+}
+
+/* {setting found} */
+static void BM_GetNxpNumValue(benchmark::State& state) {
+  const char* name =
+      state.range(0) ? NAME_NXP_SET_CONFIG_ALWAYS : "NXP_NOT_A_SETTING";
+  unsigned long value = 0;
+  if (sConfFiles.empty()) {
+    state.SkipWithError("no gen-config file");
+    return;
+  }
+  setNxpRfConfigPath(sConfFiles[0].c_str());
+  resetNxpConfig();
+  if (GetNxpNumValue(name, &value, sizeof(value)) != state.range(0)) {
+    state.SkipWithError("unexpected lookup result");
+    return;
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(GetNxpNumValue(name, &value, sizeof(value)));
+  }
+  resetNxpConfig();
+}
+BENCHMARK(BM_GetNxpNumValue)->Arg(0)->Arg(1);
+
+static void BM_GetNxpStrValue(benchmark::State& state) {
+  char value[256];
+  if (sConfFiles.empty()) {
+    state.SkipWithError("no gen-config file");
+    return;
+  }
+  setNxpRfConfigPath(sConfFiles[0].c_str());
+  resetNxpConfig();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        GetNxpStrValue(NAME_NXP_NFC_DEV_NODE, value, sizeof(value)));
+  }
+  resetNxpConfig();
+}
+BENCHMARK(BM_GetNxpStrValue);
+
+static const bool sConfBenchmarksRegistered = [] {
+  const char* dir = getenv(CONF_DIR_ENV);
+  std::string root = dir ? dir : android::base::GetExecutableDirectory();
+  nftw(root.c_str(), collectConfFile, 16, FTW_PHYS);
+  std::sort(sConfFiles.begin(), sConfFiles.end());
+  for (const std::string& path : sConfFiles) {
+    /* Chip directory and file name, several chips ship the same name */
+    size_t genDir = path.find("/gen-config-files/");
+    size_t chipDir = path.find_last_of('/', genDir - 1) + 1;
+    std::string name = "BM_ConfigRead/" +
+                       path.substr(chipDir, genDir - chipDir) + "/" +
+                       path.substr(path.find_last_of('/') + 1);
+    benchmark::RegisterBenchmark(name.c_str(), BM_ConfigRead, path);
+  }
+  return true;
+}();
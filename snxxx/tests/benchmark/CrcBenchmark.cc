@@ -0,0 +1,49 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <phDnldNfc_Utils.h>
+
+#include <vector>
+
+#include "sparse_crc32.h"
+
+static std::vector<uint8_t> buffer(size_t len) {
+  std::vector<uint8_t> data(len);
+  for (size_t i = 0; i < len; i++) data[i] = (uint8_t)(i * 31 + 7);
+  return data;
+}
+
+/* Config files and config cache sections */
+static void BM_SparseCrc32(benchmark::State& state) {
+  std::vector<uint8_t> data = buffer(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(sparse_crc32(0, data.data(), (int)data.size()));
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_SparseCrc32)->RangeMultiplier(16)->Range(256, 64 * 1024);
+
+/* FW download frames, computed on every frame sent and received */
+static void BM_DnldCrc16(benchmark::State& state) {
+  std::vector<uint8_t> data = buffer(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        phDnldNfc_CalcCrc16(data.data(), (uint16_t)data.size()));
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_DnldCrc16)->Arg(16)->Arg(256)->Arg(1024)->Arg(4096);
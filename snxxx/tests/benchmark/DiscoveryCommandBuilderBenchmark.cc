@@ -0,0 +1,64 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "NciDiscoveryCommandBuilder.h"
+
+/* RF_DISCOVER_CMD polling A, B, F, V and listening A, B, F */
+static const std::vector<uint8_t> kDiscoverCmd = {
+    0x21, 0x03, 0x0F, 0x07, 0x00, 0x01, 0x01, 0x01, 0x02,
+    0x01, 0x06, 0x01, 0x80, 0x01, 0x81, 0x01, 0x82, 0x01};
+/* Same without V polling, as when the reader mode changes */
+static const std::vector<uint8_t> kDiscoverCmdNoV = {
+    0x21, 0x03, 0x0D, 0x06, 0x00, 0x01, 0x01, 0x01, 0x02,
+    0x01, 0x80, 0x01, 0x81, 0x01, 0x82, 0x01};
+
+/* Observe mode command of an unchanged RF_DISCOVER_CMD */
+static void BM_ReConfigRFDiscCmd(benchmark::State& state) {
+  NciDiscoveryCommandBuilder& builder = NciDiscoveryCommandBuilderInstance;
+  builder.setDiscoveryCommand(kDiscoverCmd.size(), kDiscoverCmd.data());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(builder.reConfigRFDiscCmd());
+  }
+}
+BENCHMARK(BM_ReConfigRFDiscCmd);
+
+/* Same, without the vector copy */
+static void BM_GetObserveDiscoveryCommand(benchmark::State& state) {
+  NciDiscoveryCommandBuilder& builder = NciDiscoveryCommandBuilderInstance;
+  uint16_t len = 0;
+  builder.setDiscoveryCommand(kDiscoverCmd.size(), kDiscoverCmd.data());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(builder.getDiscoveryCommand(true, &len));
+  }
+}
+BENCHMARK(BM_GetObserveDiscoveryCommand);
+
+/* RF_DISCOVER_CMD changing before every observe mode command */
+static void BM_ReConfigRFDiscCmdChanged(benchmark::State& state) {
+  NciDiscoveryCommandBuilder& builder = NciDiscoveryCommandBuilderInstance;
+  bool toggle = false;
+  for (auto _ : state) {
+    const std::vector<uint8_t>& cmd = toggle ? kDiscoverCmd : kDiscoverCmdNoV;
+    toggle = !toggle;
+    builder.setDiscoveryCommand(cmd.size(), cmd.data());
+    benchmark::DoNotOptimize(builder.reConfigRFDiscCmd());
+  }
+}
+BENCHMARK(BM_ReConfigRFDiscCmdChanged);
@@ -0,0 +1,44 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * HAL globals and entry points referenced by the HAL sources built into the
+ * benchmark, and a log sink so that HAL logs do not end up in the results.
+ */
+
+#include <NfcExtension.h>
+#include <android/log.h>
+#include <phNxpLog.h>
+#include <phNxpNciHal.h>
+#include <phNxpNciHal_extOperations.h>
+
+bool nfc_debug_enabled = false;
+tNfc_featureList nfcFL;
+phNxpNciHal_Control_t nxpncihal_ctrl;
+
+NFCSTATUS phNxpExtn_HandleHalEvent(uint8_t /* event */) {
+  return NFCSTATUS_SUCCESS;
+}
+
+void phNxpNciHal_decodeGpioStatus(void) {}
+
+/* Logs are still formatted, only their output is dropped */
+static void dropLog(const struct __android_log_message* /* log_message */) {}
+
+static const bool sLogDropped = [] {
+  __android_log_set_logger(dropLog);
+  return true;
+}();
@@ -0,0 +1,211 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <ctype.h>
+#include <stdio.h>
+
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "NxpNfcHexCodec.h"
+#include "phNxpNciHal_utils.h"
+
+/* NCI packet sizes: header only up to the longest data packet, and more */
+static const std::vector<int64_t> kPacketSizes = {3, 8, 16, 34, 64, 128, 258,
+                                                  300};
+static const std::vector<int64_t> kKernels = {HEX_KERNEL_SCALAR,
+                                              HEX_KERNEL_SSSE3, HEX_KERNEL_AVX2,
+                                              HEX_KERNEL_NEON};
+
+static std::vector<uint8_t> packet(size_t len) {
+  std::vector<uint8_t> data(len);
+  for (size_t i = 0; i < len; i++) data[i] = (uint8_t)(i * 37 + 0x60);
+  return data;
+}
+
+/* Former phNxpNciHal_print_packet() formatting */
+static void legacySnprintfEncode(const uint8_t* p_data, size_t len,
+                                 char* p_hex) {
+  for (size_t i = 0; i < len; i++) {
+    snprintf(&p_hex[i * 2], 3, "%02X", p_data[i]);
+  }
+}
+
+/* Former phNxpNciHal_HexToString() and PhNxpEventLogger::Log() formatting */
+static std::string legacyStreamEncode(const uint8_t* p_data, size_t len) {
+  std::stringstream ss;
+  for (size_t i = 0; i < len; i++) {
+    ss << std::setfill('0') << std::hex << std::uppercase << std::setw(2)
+       << (0xFF & p_data[i]);
+  }
+  return ss.str();
+}
+
+/* Former phNxpNciHal_StringToHex() */
+static void legacyDecode(const char* str, size_t len, char* hex) {
+  for (size_t i = 0; i < len; i += 2) {
+    uint8_t temp = 0x00;
+    if (str[i] >= '0' && str[i] <= '9') {
+      temp = (char(str[i]) - 48) << 4;
+    } else if (toupper(str[i]) >= 'A' && toupper(str[i]) <= 'F') {
+      temp = (char(toupper(str[i])) - 55) << 4;
+    } else {
+      return;
+    }
+    if (str[i + 1] >= '0' && str[i + 1] <= '9') {
+      temp = temp | (char(str[i + 1]) - 48);
+    } else if (toupper(str[i + 1]) >= 'A' && toupper(str[i + 1]) <= 'F') {
+      temp = temp | (char(toupper(str[i + 1])) - 55);
+    } else {
+      return;
+    }
+    hex[i / 2] = temp;
+  }
+}
+
+/* Characters which are not hex digits, around the digit ranges and with the
+ * high bit set */
+static const char kInvalidDigits[] = {'\0', ' ', '/', ':', '@', 'G',
+                                      '`',  'g', (char)0x80, (char)0xC6};
+
+/* Decode result: bytes converted, then the bytes themselves */
+static std::string decodeResult(const std::string& hex) {
+  std::vector<uint8_t> data(hex.size() / 2 + 1, 0xA5);
+  size_t len = phNxpNciHal_hexDecode(hex.data(), hex.size(), data.data());
+  return std::to_string(len) + ":" + std::string(data.begin(), data.end());
+}
+
+/* Outputs of the selected kernel: encode and decode of every byte value,
+ * decode with an invalid digit at every position */
+static std::vector<std::string> hexCodecResults() {
+  std::vector<std::string> results;
+  std::vector<uint8_t> data(256);
+  /* Filled, so that a missing terminator shows */
+  std::vector<char> hex(data.size() * 2 + 1, 'Z');
+  for (size_t i = 0; i < data.size(); i++) data[i] = (uint8_t)i;
+
+  phNxpNciHal_hexEncode(data.data(), data.size(), hex.data());
+  results.emplace_back(hex.data(), hex.size());
+  std::string upper(hex.data(), data.size() * 2);
+  std::string lower(upper);
+  for (char& c : lower) c = (char)tolower(c);
+  results.push_back(decodeResult(upper));
+  results.push_back(decodeResult(lower));
+  /* Odd length, the last digit is ignored */
+  results.push_back(decodeResult(upper.substr(0, upper.size() - 1)));
+  for (size_t pos = 0; pos < upper.size(); pos++) {
+    for (char invalid : kInvalidDigits) {
+      std::string bad(upper);
+      bad[pos] = invalid;
+      results.push_back(decodeResult(bad));
+    }
+  }
+  return results;
+}
+
+/* Selects kernel once its outputs are checked against the scalar ones */
+static bool hexKernelMatchesScalar(tNFC_hexKernel kernel) {
+  if (!phNxpNciHal_hexSetKernel(HEX_KERNEL_SCALAR)) return false;
+  std::vector<std::string> expected = hexCodecResults();
+  if (!phNxpNciHal_hexSetKernel(kernel)) return false;
+  return hexCodecResults() == expected;
+}
+
+static void BM_HexEncodeLegacySnprintf(benchmark::State& state) {
+  std::vector<uint8_t> data = packet(state.range(0));
+  std::vector<char> hex(data.size() * 2 + 1);
+  for (auto _ : state) {
+    legacySnprintfEncode(data.data(), data.size(), hex.data());
+    benchmark::DoNotOptimize(hex.data());
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_HexEncodeLegacySnprintf)->ArgsProduct({kPacketSizes});
+
+static void BM_HexEncodeLegacyStream(benchmark::State& state) {
+  std::vector<uint8_t> data = packet(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(legacyStreamEncode(data.data(), data.size()));
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_HexEncodeLegacyStream)->ArgsProduct({kPacketSizes});
+
+static void BM_HexEncode(benchmark::State& state) {
+  if (!phNxpNciHal_hexSetKernel((tNFC_hexKernel)state.range(1))) {
+    state.SkipWithError("kernel not supported");
+    return;
+  }
+  if (!hexKernelMatchesScalar((tNFC_hexKernel)state.range(1))) {
+    state.SkipWithError("kernel output differs from scalar");
+    return;
+  }
+  std::vector<uint8_t> data = packet(state.range(0));
+  std::vector<char> hex(data.size() * 2 + 1);
+  for (auto _ : state) {
+    phNxpNciHal_hexEncode(data.data(), data.size(), hex.data());
+    benchmark::DoNotOptimize(hex.data());
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_HexEncode)->ArgsProduct({kPacketSizes, kKernels});
+
+static void BM_HexDecodeLegacy(benchmark::State& state) {
+  std::string hex = legacyStreamEncode(packet(state.range(0)).data(),
+                                       state.range(0));
+  std::vector<char> data(state.range(0));
+  for (auto _ : state) {
+    legacyDecode(hex.data(), hex.size(), data.data());
+    benchmark::DoNotOptimize(data.data());
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_HexDecodeLegacy)->ArgsProduct({kPacketSizes});
+
+static void BM_HexDecode(benchmark::State& state) {
+  if (!phNxpNciHal_hexSetKernel((tNFC_hexKernel)state.range(1))) {
+    state.SkipWithError("kernel not supported");
+    return;
+  }
+  if (!hexKernelMatchesScalar((tNFC_hexKernel)state.range(1))) {
+    state.SkipWithError("kernel output differs from scalar");
+    return;
+  }
+  std::string hex = legacyStreamEncode(packet(state.range(0)).data(),
+                                       state.range(0));
+  std::vector<uint8_t> data(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        phNxpNciHal_hexDecode(hex.data(), hex.size(), data.data()));
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_HexDecode)->ArgsProduct({kPacketSizes, kKernels});
+
+static void BM_HexToString(benchmark::State& state) {
+  std::vector<uint8_t> data = packet(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        phNxpNciHal_HexToString(data.data(), data.size()));
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_HexToString)->ArgsProduct({kPacketSizes});
+
+BENCHMARK_MAIN();
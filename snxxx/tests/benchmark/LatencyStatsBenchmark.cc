@@ -0,0 +1,48 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "NxpNfcLatencyStats.h"
+
+/* Stamps and records of one RSP through every RX stage */
+static void BM_LatencyRxPacket(benchmark::State& state) {
+  NfcHalLatencyStats& stats = NfcHalLatencyStats::getInstance();
+  const uint8_t rsp[] = {0x40, 0x03, 0x01, 0x00};
+  for (auto _ : state) {
+    uint64_t readNs = NfcHalLatencyStats::nowNs();
+    stats.markDequeue();
+    stats.rxBegin(rsp, sizeof(rsp), readNs, readNs);
+    stats.rxComplete();
+    stats.rxDelivered();
+    stats.rxEnd();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LatencyRxPacket);
+
+/* Stamps and records of one CMD through every TX stage */
+static void BM_LatencyTxPacket(benchmark::State& state) {
+  NfcHalLatencyStats& stats = NfcHalLatencyStats::getInstance();
+  const uint8_t cmd[] = {0x20, 0x03, 0x00};
+  for (auto _ : state) {
+    NfcHalLatencyStats::TxScope scope;
+    stats.txWindow();
+    stats.txWritten(cmd, sizeof(cmd));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LatencyTxPacket)->ThreadRange(1, 4);
@@ -0,0 +1,46 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <pthread.h>
+
+#include "NxpNfcLockStats.h"
+
+static pthread_mutex_t sMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Uncontended lock and unlock, {statistics enabled} */
+static void BM_LockUnlock(benchmark::State& state) {
+  NfcHalLockStats& stats =
+      NfcHalLockStats::getInstance(NFC_HAL_LOCK_CONCURRENCY);
+  NfcHalLockStats::setEnabled(state.range(0) != 0);
+  for (auto _ : state) {
+    stats.lock(&sMutex, __func__, __LINE__);
+    stats.unlock(&sMutex);
+  }
+  NfcHalLockStats::setEnabled(false);
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LockUnlock)->Arg(0)->Arg(1);
+
+/* Baseline for BM_LockUnlock */
+static void BM_PthreadLockUnlock(benchmark::State& state) {
+  for (auto _ : state) {
+    pthread_mutex_lock(&sMutex);
+    pthread_mutex_unlock(&sMutex);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PthreadLockUnlock);
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <phDal4Nfc_messageQueueLib.h>
+#include <string.h>
+
+#include <thread>
+
+/* Inline payloads: none (payload by reference), NCI header, short and long
+ * NCI packets */
+static const std::vector<int64_t> kPayloadSizes = {0, 3, 34, 258};
+
+static phLibNfc_Message_t message(size_t size) {
+  phLibNfc_Message_t msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.eMsgType = 1;
+  msg.Size = size;
+  for (size_t i = 0; i < size; i++) msg.data[i] = (uint8_t)i;
+  return msg;
+}
+
+/* Post and take on the same thread: queue cost without wakeup */
+static void BM_MsgSndRcv(benchmark::State& state) {
+  intptr_t msqid = phDal4Nfc_msgget(0, 0600);
+  phLibNfc_Message_t msg = message(state.range(0));
+  phLibNfc_Message_t rcv;
+  for (auto _ : state) {
+    phDal4Nfc_msgsnd(msqid, &msg, 0);
+    phDal4Nfc_msgrcv(msqid, &rcv, 0, 0);
+    benchmark::DoNotOptimize(rcv.data);
+  }
+  phDal4Nfc_msgrelease(msqid);
+}
+BENCHMARK(BM_MsgSndRcv)->ArgsProduct({kPayloadSizes});
+
+/* Producer thread posting to the measured consumer, as the TML reader
+ * posts to the HAL client thread */
+static void BM_MsgSndRcvCrossThread(benchmark::State& state) {
+  intptr_t msqid = phDal4Nfc_msgget(0, 0600);
+  phLibNfc_Message_t msg = message(state.range(0));
+  phLibNfc_Message_t rcv;
+  benchmark::IterationCount count = state.max_iterations;
+  std::thread producer([&] {
+    for (benchmark::IterationCount i = 0; i < count; i++) {
+      phDal4Nfc_msgsnd(msqid, &msg, 0);
+    }
+  });
+  for (auto _ : state) {
+    phDal4Nfc_msgrcv(msqid, &rcv, 0, 0);
+    benchmark::DoNotOptimize(rcv.data);
+  }
+  producer.join();
+  phDal4Nfc_msgrelease(msqid);
+}
+BENCHMARK(BM_MsgSndRcvCrossThread)->ArgsProduct({kPayloadSizes})->UseRealTime();
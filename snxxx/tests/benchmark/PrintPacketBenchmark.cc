@@ -0,0 +1,41 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <phNxpLog.h>
+#include <phNxpNciHal_utils.h>
+
+#include <vector>
+
+static const std::vector<int64_t> kPacketSizes = {3, 16, 34, 258};
+
+/* {packet size, NCI log level} */
+static void BM_PrintPacket(benchmark::State& state) {
+  std::vector<uint8_t> packet(state.range(0));
+  for (size_t i = 0; i < packet.size(); i++) packet[i] = (uint8_t)(i + 0x60);
+  gLog_level.ncix_log_level = state.range(1);
+  gLog_level.ncir_log_level = state.range(1);
+  for (auto _ : state) {
+    phNxpNciHal_print_packet("SEND", packet.data(), packet.size());
+    phNxpNciHal_print_packet("RECV", packet.data(), packet.size());
+  }
+  gLog_level.ncix_log_level = NXPLOG_LOG_SILENT_LOGLEVEL;
+  gLog_level.ncir_log_level = NXPLOG_LOG_SILENT_LOGLEVEL;
+  state.SetItemsProcessed(state.iterations() * 2);
+}
+BENCHMARK(BM_PrintPacket)
+    ->ArgsProduct({kPacketSizes,
+                   {NXPLOG_LOG_SILENT_LOGLEVEL, NXPLOG_LOG_INFO_LOGLEVEL}});
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <phNfcNciConstants.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "ReaderPollConfigParser.h"
+
+static uint64_t sNotifiedBytes = 0;
+static uint64_t sNotifications = 0;
+
+static void countPollingFrame(uint16_t data_len, uint8_t* /* p_data */) {
+  sNotifiedBytes += data_len;
+  sNotifications++;
+}
+
+/* L2 event entry: timestamp, gain, event type */
+static void addL2Event(std::vector<uint8_t>& ntf, uint8_t type) {
+  const uint8_t entry[] = {(L2_EVT_TAG << 4) | MIN_LEN_NON_CMA_EVT,
+                           0x12, 0x00, 0x34, 0x01, 0x00, 0x20, type};
+  ntf.insert(ntf.end(), entry, entry + sizeof(entry));
+}
+
+/* CMA event entry: timestamp, event type, event data */
+static void addCmaEvent(std::vector<uint8_t>& ntf, uint8_t type,
+                        uint8_t data) {
+  const uint8_t entry[] = {(CMA_EVT_TAG << 4) | MIN_LEN_CMA_EVT,
+                           0x12, 0x00, 0x56, 0x02, type, data};
+  ntf.insert(ntf.end(), entry, entry + sizeof(entry));
+}
+
+/* Unknown frame announced by a CMA data event, then its extra data entries */
+static void addUnknownFrame(std::vector<uint8_t>& ntf, uint8_t len) {
+  addCmaEvent(ntf, CMA_DATA_TRIGGER_TYPE, len);
+  for (uint8_t done = 0; done < len;) {
+    uint8_t chunk = std::min<uint8_t>(len - done, LX_LENGTH_MASK);
+    ntf.push_back((CMA_EVT_EXTRA_DATA_TAG << 4) | chunk);
+    for (uint8_t i = 0; i < chunk; i++) ntf.push_back(0x30 + done + i);
+    done += chunk;
+  }
+}
+
+/*
+ * Lx NTF of one polling loop of a reader: field on, type A and B polls with
+ * their CMA events, an unknown frame and field off. The loop is repeated
+ * to fill the NTF.
+ */
+static std::vector<uint8_t> lxNotification(int loops, int unknownLen) {
+  std::vector<uint8_t> ntf = {NCI_PROP_NTF_GID, NCI_PROP_LX_NTF_OID, 0x00};
+  for (int i = 0; i < loops; i++) {
+    addL2Event(ntf, EVENT_RF_ON);
+    addL2Event(ntf, (EVENT_MOD_A << 4) | L2_EVENT_TRIGGER_TYPE);
+    addCmaEvent(ntf, CMA_EVENT_TRIGGER_TYPE, REQ_A);
+    addL2Event(ntf, (EVENT_MOD_B << 4) | L2_EVENT_TRIGGER_TYPE);
+    if (unknownLen > 0) addUnknownFrame(ntf, unknownLen);
+    addL2Event(ntf, EVENT_RF_OFF);
+  }
+  ntf[NCI_MSG_LEN_INDEX] = (uint8_t)(ntf.size() - NCI_MESSAGE_OFFSET);
+  return ntf;
+}
+
+static void BM_ParseAndSendReaderPollInfo(benchmark::State& state) {
+  std::vector<uint8_t> ntf = lxNotification(state.range(0), state.range(1));
+  ReaderPollConfigParser& parser = ReaderPollConfigParserInstance;
+  parser.setNotificationType(0);
+  parser.setReaderPollCallBack(countPollingFrame);
+  parser.setBatchingEnabled(false);
+  parser.resetExtraBytesInfo();
+  ReaderPollConfigParser::resetLastKnownValues();
+  sNotifiedBytes = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        parser.parseAndSendReaderPollInfo(ntf.data(), ntf.size()));
+  }
+  state.SetBytesProcessed(state.iterations() * ntf.size());
+  state.counters["notified_bytes_per_ntf"] =
+      (double)sNotifiedBytes / state.iterations();
+}
+/* {polling loops per NTF, unknown frame length} */
+BENCHMARK(BM_ParseAndSendReaderPollInfo)
+    ->Args({1, 0})
+    ->Args({1, 16})
+    ->Args({4, 0})
+    ->Args({2, 40});
+
+/*
+ * Batched: Lx NTFs of a reader sending type A polls, the field staying on,
+ * seen as modulation events or as REQ_A CMA events (CMA only notification
+ * type of the shipped configs). Events are sent once a notification is full.
+ */
+static void BM_ParseAndSendReaderPollInfoBatched(benchmark::State& state) {
+  std::vector<uint8_t> ntf = {NCI_PROP_NTF_GID, NCI_PROP_LX_NTF_OID, 0x00};
+  for (int i = 0; i < state.range(0); i++) {
+    if (state.range(2) == TYPE_ONLY_CMA_EVENTS) {
+      addCmaEvent(ntf, CMA_EVENT_TRIGGER_TYPE, REQ_A);
+    } else {
+      addL2Event(ntf, (EVENT_MOD_A << 4) | L2_EVENT_TRIGGER_TYPE);
+    }
+  }
+  ntf[NCI_MSG_LEN_INDEX] = (uint8_t)(ntf.size() - NCI_MESSAGE_OFFSET);
+  ReaderPollConfigParser& parser = ReaderPollConfigParserInstance;
+  parser.setNotificationType(state.range(2));
+  parser.setReaderPollCallBack(countPollingFrame);
+  parser.setBatchingEnabled(state.range(1) != 0);
+  ReaderPollConfigParser::resetLastKnownValues();
+  sNotifications = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        parser.parseAndSendReaderPollInfo(ntf.data(), ntf.size()));
+  }
+  parser.setBatchingEnabled(false);
+  state.SetBytesProcessed(state.iterations() * ntf.size());
+  state.counters["notifications_per_ntf"] =
+      (double)sNotifications / state.iterations();
+}
+/* {events per NTF, batching, notification type} */
+BENCHMARK(BM_ParseAndSendReaderPollInfoBatched)
+    ->ArgsProduct({{1, 4}, {0, 1}, {0, TYPE_ONLY_CMA_EVENTS}});
+
+/*
+ * Current parser constructed for each Lx NTF, as the HAL used to: the cost of
+ * the construction on top of BM_ParseAndSendReaderPollInfo. The former
+ * allocating parser is not part of the tree any more.
+ */
+static void BM_ParseAndSendReaderPollInfoNewParser(benchmark::State& state) {
+  std::vector<uint8_t> ntf = lxNotification(state.range(0), state.range(1));
+  for (auto _ : state) {
+    ReaderPollConfigParser parser;
+    parser.setNotificationType(0);
+    parser.setReaderPollCallBack(countPollingFrame);
+    benchmark::DoNotOptimize(
+        parser.parseAndSendReaderPollInfo(ntf.data(), ntf.size()));
+  }
+  state.SetBytesProcessed(state.iterations() * ntf.size());
+}
+BENCHMARK(BM_ParseAndSendReaderPollInfoNewParser)
+    ->Args({1, 0})
+    ->Args({1, 16})
+    ->Args({4, 0})
+    ->Args({2, 40});
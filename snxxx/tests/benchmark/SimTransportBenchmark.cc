@@ -0,0 +1,150 @@
+/*
+ * Copyright 2025 NXP
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <NfccSimModel.h>
+#include <NfccSimTransport.h>
+#include <android-base/file.h>
+#include <benchmark/benchmark.h>
+#include <poll.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+/* The virtual NFCC answers at once, a missing packet fails the run */
+#define SIM_READ_TIMEOUT_MS 1000
+
+/* Script loaded by NfccSimTransport on open */
+static const char kSimScript[] =
+    "# No latency, the exchanges time the transport and the model\n"
+    "LATENCY 0 0\n"
+    "# Proprietary commands are rejected, but for the one of the sequence:\n"
+    "# the longest prefix wins\n"
+    "RSP 2F 4F000101\n"
+    "RSP 2F15 4F150100\n"
+    "# ISO-DEP tag found on discovery\n"
+    "NTF 2103 0 61050B01020400FF010000000000\n";
+
+/* A command and the packets expected from the NFCC, in order. A packet is
+ * matched on its first bytes */
+typedef struct {
+  std::vector<uint8_t> cmd;
+  std::vector<std::vector<uint8_t>> answers;
+} tSimExchange;
+
+/*
+ * NCI sequence of a HAL open, core_initialized, discovery and close, as
+ * phNxpNciHal_MinOpen, phNxpNciHal_core_initialized and phNxpNciHal_close
+ * write it. The HAL library itself does not build on a host, the sequence
+ * is replayed on the transport it opens.
+ */
+static const std::vector<tSimExchange> kHalSequence = {
+    /* MinOpen: CORE_RESET, CORE_INIT */
+    {{0x20, 0x00, 0x01, 0x00}, {{0x40, 0x00, 0x01, 0x00}, {0x60, 0x00}}},
+    {{0x20, 0x01, 0x02, 0x00, 0x00}, {{0x40, 0x01}}},
+    /* core_initialized: debug info, nothing set yet */
+    {{0x20, 0x03, 0x05, 0x02, 0xA0, 0x39, 0xA0, 0x5E},
+     {{0x40, 0x03, 0x08, 0x00, 0x02, 0xA0, 0x39, 0x00, 0xA0, 0x5E, 0x00}}},
+    /* NXP_CORE_CONF, one and two byte tags */
+    {{0x20, 0x02, 0x0C, 0x03, 0x00, 0x02, 0xE8, 0x03, 0xA0, 0x5E, 0x01, 0x01,
+      0x32, 0x01, 0x60},
+     {{0x40, 0x02, 0x02, 0x00, 0x00}}},
+    /* Readback, in the order asked */
+    {{0x20, 0x03, 0x05, 0x03, 0x32, 0xA0, 0x5E, 0x00},
+     {{0x40, 0x03, 0x0D, 0x00, 0x03, 0x32, 0x01, 0x60, 0xA0, 0x5E, 0x01, 0x01,
+       0x00, 0x02, 0xE8, 0x03}}},
+    /* Proprietary commands, answered by the script rules */
+    {{0x2F, 0x00, 0x01, 0x00}, {{0x4F, 0x00, 0x01, 0x01}}},
+    {{0x2F, 0x15, 0x01, 0x01}, {{0x4F, 0x15, 0x01, 0x00}}},
+    /* Discovery, a tag is activated */
+    {{0x21, 0x00, 0x04, 0x01, 0x04, 0x01, 0x02}, {{0x41, 0x00, 0x01, 0x00}}},
+    {{0x21, 0x03, 0x03, 0x01, 0x00, 0x01},
+     {{0x41, 0x03, 0x01, 0x00}, {0x61, 0x05, 0x0B, 0x01, 0x02, 0x04}}},
+    /* close: RF_DEACTIVATE to idle, CORE_RESET */
+    {{0x21, 0x06, 0x01, 0x00},
+     {{0x41, 0x06, 0x01, 0x00}, {0x61, 0x06, 0x02, 0x00, 0x00}}},
+    {{0x20, 0x00, 0x01, 0x00}, {{0x40, 0x00, 0x01, 0x00}, {0x60, 0x00}}},
+};
+
+/* Waits for the next packet of the virtual NFCC and reads it */
+static int simRead(NfccSimTransport& transport, void* pHandle, uint8_t* pBuf,
+                   int len) {
+  struct pollfd fd = {(int)(intptr_t)pHandle, POLLIN, 0};
+  if (poll(&fd, 1, SIM_READ_TIMEOUT_MS) <= 0) return -1;
+  return transport.Read(pHandle, pBuf, len);
+}
+
+/* Writes the command of the exchange and checks the packets it brings */
+static bool simExchange(NfccSimTransport& transport, void* pHandle,
+                        const tSimExchange& exchange) {
+  std::vector<uint8_t> cmd(exchange.cmd);
+  uint8_t buf[258];
+
+  if (transport.Write(pHandle, cmd.data(), (int)cmd.size()) !=
+      (int)cmd.size()) {
+    return false;
+  }
+  for (const std::vector<uint8_t>& answer : exchange.answers) {
+    int len = simRead(transport, pHandle, buf, (int)sizeof(buf));
+    if (len < (int)answer.size() ||
+        !std::equal(answer.begin(), answer.end(), buf)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * HAL open/close sequence over NfccSimTransport: open with a script,
+ * CORE_RESET/INIT, SET_CONFIG and its readback, proprietary commands
+ * answered by prefix rules, discovery with an activation, deactivation,
+ * close.
+ */
+static void BM_SimTransportHalSequence(benchmark::State& state) {
+  TemporaryFile script;
+  NfccSimTransport transport;
+  void* pHandle = NULL;
+
+  if (!android::base::WriteStringToFile(kSimScript, script.path)) {
+    state.SkipWithError("cannot write the sim script");
+    return;
+  }
+  setenv(NFCC_SIM_SCRIPT_ENV, script.path, 1);
+  for (auto _ : state) {
+    /* Every run starts from an NFCC with no parameter set */
+    state.PauseTiming();
+    NfccSimModel::getInstance().ClearRules();
+    state.ResumeTiming();
+    if (transport.OpenAndConfigure(NULL, &pHandle) != NFCSTATUS_SUCCESS) {
+      state.SkipWithError("virtual NFCC open failed");
+      break;
+    }
+    bool ok = true;
+    for (const tSimExchange& exchange : kHalSequence) {
+      ok = ok && simExchange(transport, pHandle, exchange);
+    }
+    transport.Close(pHandle);
+    if (!ok) {
+      state.SkipWithError("unexpected packet from the virtual NFCC");
+      break;
+    }
+  }
+  unsetenv(NFCC_SIM_SCRIPT_ENV);
+  NfccSimModel::getInstance().ClearRules();
+  state.SetItemsProcessed(state.iterations() * kHalSequence.size());
+}
+BENCHMARK(BM_SimTransportHalSequence)->UseRealTime();